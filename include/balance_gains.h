@@ -0,0 +1,24 @@
+// Generated by tools/lqr_gains; do not edit. Regenerate with
+//
+//   lqr_gains --out include/balance_gains.h
+//
+// LQR state feedback for the balancing robot, updated every 0.001 s
+// with Q = diag(100, 0.1, 0.01, 0.05) and R = 1: effort = -K x, where
+// x is
+//   pitch (deg)
+//   pitch rate (deg/s)
+//   wheel angle (deg)
+//   wheel rate (deg/s)
+
+#ifndef BALANCE_GAINS_H
+#define BALANCE_GAINS_H
+
+#include "state_feedback.h"
+
+constexpr intpid::StateFeedbackConfig<4> kBalanceGains = {
+    .gains = {{{-16.6290715, -1.74846776, -0.0939279678, -0.356355043}}},
+    .output_min = -255,
+    .output_max = 255,
+};
+
+#endif  // BALANCE_GAINS_H
@@ -0,0 +1,63 @@
+#ifndef HOSTHAL_ADAFRUIT_MLX90393_H
+#define HOSTHAL_ADAFRUIT_MLX90393_H
+
+// A scriptable stand-in for the Adafruit_MLX90393 driver. Tests queue the X/Y
+// samples the sensor should report, and the fake hands them out one per
+// readMeasurement call.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+enum mlx90393_axis {
+  MLX90393_T = 0x1,
+  MLX90393_X = 0x2,
+  MLX90393_Y = 0x4,
+  MLX90393_Z = 0x8,
+};
+
+class Adafruit_MLX90393 {
+ public:
+  Adafruit_MLX90393() = default;
+
+  bool begin_I2C(uint8_t /*i2c_addr*/ = 0x0C) { return true; }
+
+  // Returns the next queued sample. Returns false if the next queued entry is
+  // a failure or if the queue is exhausted (and looping is off).
+  bool readMeasurement(uint8_t axes, std::array<float, 2>& data);
+
+  // Queues a successful read of the given X/Y field values.
+  void PushSample(float x, float y) { samples_.push_back({{x, y}}); }
+
+  // Queues a failed read (e.g. a NACK on the bus).
+  void PushFailure() { samples_.push_back(std::nullopt); }
+
+  void Clear() {
+    samples_.clear();
+    next_ = 0;
+  }
+
+  // If set, the queue restarts from the beginning when it runs out rather
+  // than failing every later read. Useful for benchmarks.
+  void set_loop(bool loop) { loop_ = loop; }
+
+  // Each read advances the fake clock by this much, to model bus latency.
+  void set_read_duration_us(uint32_t us) { read_duration_us_ = us; }
+
+  // The number of samples that have not yet been read.
+  size_t pending() const { return samples_.size() - next_; }
+
+  // The number of calls to readMeasurement.
+  int reads() const { return reads_; }
+
+ private:
+  std::vector<std::optional<std::array<float, 2>>> samples_;
+  size_t next_ = 0;
+  bool loop_ = false;
+  uint32_t read_duration_us_ = 0;
+  int reads_ = 0;
+};
+
+#endif  // HOSTHAL_ADAFRUIT_MLX90393_H
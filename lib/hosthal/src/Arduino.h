@@ -0,0 +1,44 @@
+#ifndef HOSTHAL_ARDUINO_H
+#define HOSTHAL_ARDUINO_H
+
+// The subset of the Arduino core used by the libraries in this project,
+// backed by the fake clock and pins in hosthal.h.
+
+#include <cmath>
+#include <cstdint>
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+// Interrupt handlers live in IRAM on the ESP32; there is no such thing here.
+#define IRAM_ATTR
+
+#define digitalPinToInterrupt(p) (p)
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+
+unsigned long micros();
+unsigned long millis();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+
+// Interrupts fire synchronously from hosthal::SetInput.
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode);
+void attachInterruptArg(uint8_t pin, void (*isr)(void*), void* arg, int mode);
+void detachInterrupt(uint8_t pin);
+
+#endif  // HOSTHAL_ARDUINO_H
@@ -0,0 +1,29 @@
+#ifndef HOSTHAL_CYCLE_COUNTER_H
+#define HOSTHAL_CYCLE_COUNTER_H
+
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace hosthal {
+
+// Reads the host CPU's cycle (or timestamp) counter, for benchmarks and
+// timing reports. Returns 0 where there is no cheap counter, in which case
+// only the wall time can be reported.
+inline uint64_t ReadCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#elif defined(__aarch64__)
+  uint64_t v;
+  asm volatile("mrs %0, cntvct_el0" : "=r"(v));
+  return v;
+#else
+  return 0;
+#endif
+}
+
+}  // namespace hosthal
+
+#endif  // HOSTHAL_CYCLE_COUNTER_H
@@ -0,0 +1,124 @@
+#include "hosthal.h"
+
+#include <array>
+#include <cassert>
+
+#include "Adafruit_MLX90393.h"
+#include "Arduino.h"
+
+namespace hosthal {
+namespace {
+
+uint64_t now_us = 0;
+std::array<PinState, kNumPins> pins;
+
+struct Interrupt {
+  void (*isr)(void*) = nullptr;
+  void* arg = nullptr;
+  int mode = 0;
+};
+std::array<Interrupt, kNumPins> interrupts;
+RegisterFile registers;
+
+PinState& MutablePin(int pin) {
+  assert(pin >= 0 && pin < kNumPins);
+  return pins[pin];
+}
+
+}  // namespace
+
+void Reset() {
+  now_us = 0;
+  pins.fill(PinState{});
+  interrupts.fill(Interrupt{});
+  registers = RegisterFile{};
+}
+
+uint64_t Micros() { return now_us; }
+void SetMicros(uint64_t t) { now_us = t; }
+void AdvanceMicros(uint64_t dt) { now_us += dt; }
+
+const PinState& Pin(int pin) { return MutablePin(pin); }
+
+void SetInput(int pin, int level) {
+  PinState& state = MutablePin(pin);
+  const int previous = state.digital;
+  state.digital = level;
+  const Interrupt& interrupt = interrupts[pin];
+  if (interrupt.isr == nullptr || level == previous) return;
+  if (interrupt.mode == CHANGE || (interrupt.mode == RISING && level) ||
+      (interrupt.mode == FALLING && !level)) {
+    interrupt.isr(interrupt.arg);
+  }
+}
+
+int TotalPinWrites() {
+  int total = 0;
+  for (const PinState& pin : pins) {
+    total += pin.digital_writes + pin.analog_writes;
+  }
+  return total;
+}
+
+RegisterFile& Registers() { return registers; }
+
+int TotalRegisterWrites() {
+  return registers.gpio_writes + registers.ledc_writes;
+}
+
+}  // namespace hosthal
+
+unsigned long micros() { return hosthal::Micros(); }
+unsigned long millis() { return hosthal::Micros() / 1000; }
+void delay(uint32_t ms) { hosthal::AdvanceMicros(uint64_t{ms} * 1000); }
+void delayMicroseconds(uint32_t us) { hosthal::AdvanceMicros(us); }
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  hosthal::MutablePin(pin).mode = mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  hosthal::PinState& state = hosthal::MutablePin(pin);
+  state.digital = val;
+  ++state.digital_writes;
+}
+
+int digitalRead(uint8_t pin) { return hosthal::MutablePin(pin).digital; }
+
+void analogWrite(uint8_t pin, int value) {
+  hosthal::PinState& state = hosthal::MutablePin(pin);
+  state.analog = value;
+  ++state.analog_writes;
+}
+
+bool Adafruit_MLX90393::readMeasurement(uint8_t /*axes*/,
+                                        std::array<float, 2>& data) {
+  ++reads_;
+  hosthal::AdvanceMicros(read_duration_us_);
+  if (next_ == samples_.size()) {
+    if (!loop_ || samples_.empty()) return false;
+    next_ = 0;
+  }
+  const auto& sample = samples_[next_++];
+  if (!sample) return false;
+  data = *sample;
+  return true;
+}
+
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode) {
+  // Stored as an argument-taking handler that ignores its argument.
+  attachInterruptArg(
+      pin, [](void* arg) { reinterpret_cast<void (*)()>(arg)(); },
+      reinterpret_cast<void*>(isr), mode);
+}
+
+void attachInterruptArg(uint8_t pin, void (*isr)(void*), void* arg,
+                        int mode) {
+  hosthal::MutablePin(pin);  // Checks the pin number.
+  hosthal::interrupts[pin] = {isr, arg, mode};
+}
+
+void detachInterrupt(uint8_t pin) {
+  hosthal::MutablePin(pin);
+  hosthal::interrupts[pin] = {};
+}
@@ -0,0 +1,72 @@
+#ifndef HOSTHAL_HOSTHAL_H
+#define HOSTHAL_HOSTHAL_H
+
+#include <cstdint>
+
+// Controls for the fake Arduino layer provided by this library. Code under
+// test talks to the usual Arduino functions (micros(), digitalWrite(), ...);
+// tests use these functions to drive the clock and inspect the pins.
+namespace hosthal {
+
+// The state of a single fake GPIO pin.
+struct PinState {
+  int mode = -1;     // Last value passed to pinMode, or -1 if never set.
+  int digital = 0;   // Last value passed to digitalWrite.
+  int analog = 0;    // Last value passed to analogWrite.
+  int digital_writes = 0;
+  int analog_writes = 0;
+};
+
+constexpr int kNumPins = 64;
+constexpr int kNumLedcChannels = 8;
+
+// A fake of the registers that register-level drivers write directly,
+// bypassing digitalWrite and analogWrite: the GPIO output set and clear
+// registers and the LEDC duty registers.
+struct RegisterFile {
+  // The GPIO output levels, one bit per pin.
+  uint32_t gpio_out = 0;
+  uint32_t ledc_duty[kNumLedcChannels] = {};
+  // The pin each LEDC channel drives, or -1, and the PWM it was configured
+  // for.
+  int ledc_pin[kNumLedcChannels] = {-1, -1, -1, -1, -1, -1, -1, -1};
+  uint32_t ledc_frequency_hz[kNumLedcChannels] = {};
+  int ledc_resolution_bits[kNumLedcChannels] = {};
+
+  // Writes to the set or clear register, and duty updates (each a write of
+  // the duty and its latch).
+  int gpio_writes = 0;
+  int ledc_writes = 0;
+
+  // If set, called after every write, e.g. to check the states a driver
+  // passes through.
+  void (*on_write)(const RegisterFile& registers) = nullptr;
+};
+
+// Returns every pin and the clock to their power-on state.
+void Reset();
+
+// The fake clock. It only moves when a test (or delay()) moves it.
+uint64_t Micros();
+void SetMicros(uint64_t t);
+void AdvanceMicros(uint64_t dt);
+
+const PinState& Pin(int pin);
+
+// Drives a pin from outside, as a sensor would. If an interrupt is attached
+// to the pin and the change matches its mode, the handler runs before this
+// returns.
+void SetInput(int pin, int level);
+
+// Total digitalWrite + analogWrite calls across all pins since Reset().
+int TotalPinWrites();
+
+// Reset() clears these too.
+RegisterFile& Registers();
+
+// Total register writes since Reset(), counted as in RegisterFile.
+int TotalRegisterWrites();
+
+}  // namespace hosthal
+
+#endif  // HOSTHAL_HOSTHAL_H
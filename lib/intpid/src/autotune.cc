@@ -0,0 +1,168 @@
+#include "autotune.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+#include "fixed_math.h"
+
+namespace intpid {
+namespace {
+
+// pi in SQ15x16.
+constexpr int64_t kPi = 205'887;
+
+int32_t Saturate(int64_t x) {
+  return static_cast<int32_t>(
+      std::clamp<int64_t>(x, std::numeric_limits<int32_t>::min(),
+                          std::numeric_limits<int32_t>::max()));
+}
+
+// A tuning rule as ratios: kp = Ku * kp_num / kp_den, and likewise Ti and Td
+// from Tu. A td_num of 0 means no derivative.
+struct Ratios {
+  int kp_num, kp_den;
+  int ti_num, ti_den;
+  int td_num, td_den;
+};
+
+constexpr Ratios RatiosFor(TuningRule rule) {
+  switch (rule) {
+    case TuningRule::kZieglerNichols:
+      return {3, 5, 1, 2, 1, 8};
+    case TuningRule::kZieglerNicholsPi:
+      return {9, 20, 5, 6, 0, 1};
+    case TuningRule::kTyreusLuyben:
+      return {5, 11, 11, 5, 10, 63};
+    case TuningRule::kTyreusLuybenPi:
+      return {5, 16, 11, 5, 0, 1};
+  }
+  return {};
+}
+
+}  // namespace
+
+std::expected<RelayAutotuner, ErrorType> RelayAutotuner::Create(
+    const AutotuneConfig& config) {
+  if (!(config.output_high > config.output_low)) {
+    return std::unexpected(MakeError(Error::kEmptyRelayRange));
+  }
+  if (!(config.hysteresis >= 0)) {
+    return std::unexpected(MakeError(Error::kNegativeHysteresis));
+  }
+  if (config.cycles < 1) {
+    return std::unexpected(MakeError(Error::kTooFewCycles));
+  }
+  return RelayAutotuner(config);
+}
+
+RelayAutotuner::RelayAutotuner(const AutotuneConfig& config)
+    : output_low_(config.output_low),
+      output_high_(config.output_high),
+      hysteresis_(config.hysteresis),
+      cycles_(config.cycles),
+      timeout_(static_cast<int64_t>(config.timeout * 65536.0f)) {}
+
+SQ15x16 RelayAutotuner::elapsed() const {
+  return SQ15x16::fromInternal(Saturate(time_));
+}
+
+SQ15x16 RelayAutotuner::Update(SQ15x16 measurement, SQ15x16 dt) {
+  if (state_ != kRunning) return Midpoint();
+  if (dt > 0) {
+    time_ += dt.getInternal();
+    ++updates_;
+  }
+
+  const SQ15x16 err = setpoint_ - measurement;
+  if (!started_) {
+    started_ = true;
+    high_ = err > 0;
+    max_ = min_ = measurement;
+  }
+  max_ = std::max(max_, measurement);
+  min_ = std::min(min_, measurement);
+
+  if (high_ && err < -hysteresis_) {
+    high_ = false;
+  } else if (!high_ && err > hysteresis_) {
+    high_ = true;
+    // The oscillation that just ended started at the previous rise. The
+    // first one is the plant settling into the cycle, so it is not counted.
+    if (++rises_ >= 3) {
+      period_sum_ += time_ - rise_time_;
+      amplitude_sum_ += (max_.getInternal() - min_.getInternal()) / 2;
+      cycle_updates_ += updates_ - rise_updates_;
+    }
+    rise_time_ = time_;
+    rise_updates_ = updates_;
+    max_ = min_ = measurement;
+    if (rises_ == cycles_ + 2) {
+      Finish();
+      return Midpoint();
+    }
+  }
+
+  if (timeout_ > 0 && time_ >= timeout_) {
+    state_ = kFailed;
+  }
+  return high_ ? output_high_ : output_low_;
+}
+
+SQ15x16 RelayAutotuner::Midpoint() const {
+  return SQ15x16::fromInternal(static_cast<int32_t>(
+      (int64_t{output_low_.getInternal()} + output_high_.getInternal()) / 2));
+}
+
+void RelayAutotuner::Finish() {
+  state_ = kDone;
+  const int64_t amplitude = amplitude_sum_ / cycles_;
+  const int64_t h = hysteresis_.getInternal();
+  // The relay switches at +/-h rather than at zero, which makes the
+  // oscillation larger than the describing function predicts for an ideal
+  // relay; correct for it where possible.
+  const int64_t corrected =
+      amplitude > h ? ISqrt(static_cast<uint64_t>(amplitude * amplitude -
+                                                  h * h))
+                    : amplitude;
+  const int64_t d =
+      (int64_t{output_high_.getInternal()} - output_low_.getInternal()) / 2;
+  if (corrected > 0) {
+    const int64_t four_d_over_a = RoundDiv((4 * d) << 16, corrected);
+    ultimate_gain_ =
+        SQ15x16::fromInternal(Saturate(RoundDiv(four_d_over_a << 16, kPi)));
+  }
+  ultimate_period_ =
+      SQ15x16::fromInternal(Saturate(RoundDiv(period_sum_, cycles_)));
+  mean_dt_ = SQ15x16::fromInternal(
+      Saturate(RoundDiv(period_sum_, std::max(cycle_updates_, 1))));
+}
+
+std::expected<Config, ErrorType> RelayAutotuner::config(
+    TuningRule rule) const {
+  if (state_ != kDone) {
+    return std::unexpected(MakeError(Error::kRelayNotFinished));
+  }
+  const Ratios r = RatiosFor(rule);
+  const int64_t kp =
+      RoundDiv(int64_t{ultimate_gain_.getInternal()} * r.kp_num, r.kp_den);
+  const int64_t ti = RoundDiv(
+      int64_t{ultimate_period_.getInternal()} * r.ti_num, r.ti_den);
+  const int64_t td = RoundDiv(
+      int64_t{ultimate_period_.getInternal()} * r.td_num, r.td_den);
+  // Pid integrates error * dt, but its derivative term is per update, so kd
+  // is kp * Td in units of the update period. ki is kept in Q24 since it is
+  // often tiny.
+  const int64_t ki_q24 = ti > 0 ? RoundDiv(kp << 24, ti) : 0;
+  const int64_t kd =
+      mean_dt_ > 0 ? RoundDiv(kp * td, mean_dt_.getInternal()) : 0;
+  return Config{
+      .kp = static_cast<float>(kp) / (1 << 16),
+      .ki = static_cast<float>(ki_q24) / (1 << 24),
+      .kd = static_cast<float>(kd) / (1 << 16),
+      .output_min = static_cast<float>(output_low_),
+      .output_max = static_cast<float>(output_high_),
+  };
+}
+
+}  // namespace intpid
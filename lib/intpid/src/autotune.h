@@ -0,0 +1,130 @@
+#ifndef INTPID_AUTOTUNE_H
+#define INTPID_AUTOTUNE_H
+
+#include <FixedPointsCommon.h>
+
+#include <cstdint>
+#include <expected>
+
+#include "intpid.h"
+
+namespace intpid {
+
+struct AutotuneConfig {
+  // The two relay outputs. These are also the output limits of the Config
+  // the autotuner returns.
+  float output_low;
+  float output_high;
+
+  // The relay switches only once the error is more than this far past zero,
+  // so measurement noise cannot make it chatter. Set it above the noise
+  // amplitude, in measurement units.
+  float hysteresis;
+
+  // How many oscillations to average. The first full oscillation is always
+  // discarded, since the plant starts from wherever it was.
+  int cycles = 4;
+
+  // Gives up if the oscillation has not been measured after this long, in
+  // the unit of dt. 0 never gives up.
+  float timeout = 0;
+};
+
+// Classic gain formulas from the ultimate gain Ku and period Tu.
+enum class TuningRule {
+  // Fast, with about a quarter-amplitude decay: kp = 0.6 Ku, Ti = Tu / 2,
+  // Td = Tu / 8.
+  kZieglerNichols,
+  // kp = 0.45 Ku, Ti = Tu / 1.2.
+  kZieglerNicholsPi,
+  // Slower and far better damped, for plants that must not overshoot much:
+  // kp = Ku / 2.2, Ti = 2.2 Tu, Td = Tu / 6.3.
+  kTyreusLuyben,
+  // kp = Ku / 3.2, Ti = 2.2 Tu.
+  kTyreusLuybenPi,
+};
+
+// Finds PID gains on the running system with Astrom and Hagglund's relay
+// experiment. The autotuner takes the controller's place in the loop and
+// drives the output between two levels, switching whenever the error changes
+// sign (with hysteresis). Most plants then settle into a steady oscillation.
+// Its period is the ultimate period Tu, and its amplitude a, for a relay
+// amplitude d, gives the ultimate gain Ku = 4 d / (pi sqrt(a^2 - h^2)).
+//
+// Everything is fixed point with no allocation, so this can run on the
+// device in place of the Pid and hand back a Config when it is done.
+class RelayAutotuner {
+ public:
+  enum State {
+    kRunning,
+    kDone,
+    // The timeout passed before enough oscillations were seen.
+    kFailed,
+  };
+
+  RelayAutotuner(RelayAutotuner&&) = default;
+  RelayAutotuner& operator=(RelayAutotuner&&) = default;
+
+  static std::expected<RelayAutotuner, ErrorType> Create(
+      const AutotuneConfig& config);
+
+  void set_setpoint(SQ15x16 setpoint) { setpoint_ = setpoint; }
+
+  // Takes a measurement dt after the previous one and returns the output to
+  // apply. Once the experiment is over this returns the middle of the relay
+  // range; switch over to a Pid built from config().
+  SQ15x16 Update(SQ15x16 measurement, SQ15x16 dt);
+
+  State state() const { return state_; }
+
+  // The time since the first Update, saturated to the range of SQ15x16.
+  SQ15x16 elapsed() const;
+
+  // The measured ultimate gain and period, in output units per measurement
+  // unit and in the unit of dt. Only meaningful once state() is kDone.
+  SQ15x16 ultimate_gain() const { return ultimate_gain_; }
+  SQ15x16 ultimate_period() const { return ultimate_period_; }
+
+  // Returns the gains for rule, for a Pid updated with the same dt as the
+  // experiment, or an error if state() is not kDone.
+  std::expected<Config, ErrorType> config(
+      TuningRule rule = TuningRule::kZieglerNichols) const;
+
+ private:
+  explicit RelayAutotuner(const AutotuneConfig& config);
+
+  SQ15x16 Midpoint() const;
+  void Finish();
+
+  // Fixed at construction. Not const, so the tuner stays move assignable.
+  SQ15x16 output_low_, output_high_, hysteresis_;
+  int cycles_;
+  // In raw SQ15x16 units, widened so that long experiments do not overflow.
+  int64_t timeout_;
+
+  SQ15x16 setpoint_ = 0;
+  State state_ = kRunning;
+  bool started_ = false;
+  bool high_ = false;
+  int64_t time_ = 0;
+  int32_t updates_ = 0;
+
+  // The current oscillation, which starts when the relay switches high.
+  int rises_ = 0;
+  int64_t rise_time_ = 0;
+  int32_t rise_updates_ = 0;
+  SQ15x16 max_ = 0, min_ = 0;
+
+  // Totals over the measured oscillations.
+  int64_t period_sum_ = 0;
+  int64_t amplitude_sum_ = 0;
+  int32_t cycle_updates_ = 0;
+
+  SQ15x16 ultimate_gain_ = 0;
+  SQ15x16 ultimate_period_ = 0;
+  SQ15x16 mean_dt_ = 0;
+};
+
+}  // namespace intpid
+
+#endif  // INTPID_AUTOTUNE_H
@@ -0,0 +1,82 @@
+#ifndef INTPID_ERROR_H
+#define INTPID_ERROR_H
+
+#include <cstdint>
+
+// If set, factories report failures as an Error code rather than a
+// std::string, so no construction path needs the heap. The codes still have
+// messages (ErrorMessage), which are static strings.
+#ifndef INTPID_NO_HEAP
+#define INTPID_NO_HEAP 0
+#endif
+
+#if !INTPID_NO_HEAP
+#include <string>
+#endif
+
+namespace intpid {
+
+// Everything the controller factories can reject.
+enum class Error : uint8_t {
+  // Config.
+  kNegativeDerivativeFilter,
+  kDerivativeFilterNeedsKp,
+  // GainSchedule.
+  kUnorderedBreakpoints,
+  // AutotuneConfig and RelayAutotuner.
+  kEmptyRelayRange,
+  kNegativeHysteresis,
+  kTooFewCycles,
+  kRelayNotFinished,
+  // StateFeedback.
+  kGainOutOfRange,
+};
+
+constexpr const char* ErrorMessage(Error error) {
+  switch (error) {
+    case Error::kNegativeDerivativeFilter:
+      return "derivative_filter must not be negative";
+    case Error::kDerivativeFilterNeedsKp:
+      return "derivative_filter needs a nonzero kp to set its time constant";
+    case Error::kUnorderedBreakpoints:
+      return "breakpoints must be in strictly increasing order";
+    case Error::kEmptyRelayRange:
+      return "output_high must be above output_low";
+    case Error::kNegativeHysteresis:
+      return "hysteresis must not be negative";
+    case Error::kTooFewCycles:
+      return "cycles must be at least 1";
+    case Error::kRelayNotFinished:
+      return "the relay experiment has not finished";
+    case Error::kGainOutOfRange:
+      return "state feedback gains must be representable in SQ15x16";
+  }
+  return "unknown error";
+}
+
+// The error type factories return: the message by default, the bare code
+// with INTPID_NO_HEAP.
+#if INTPID_NO_HEAP
+using ErrorType = Error;
+
+inline ErrorType MakeError(Error error) { return error; }
+
+// Codes have no room for context; the code alone says what failed.
+inline ErrorType WithContext([[maybe_unused]] const char* context,
+                             ErrorType error) {
+  return error;
+}
+#else
+using ErrorType = std::string;
+
+inline ErrorType MakeError(Error error) { return ErrorMessage(error); }
+
+// Prefixes the message with where it came from, e.g. which of several loops.
+inline ErrorType WithContext(const char* context, ErrorType error) {
+  return std::string(context) + ": " + error;
+}
+#endif
+
+}  // namespace intpid
+
+#endif  // INTPID_ERROR_H
@@ -0,0 +1,41 @@
+#ifndef INTPID_FIXED_MATH_H
+#define INTPID_FIXED_MATH_H
+
+#include <cstdint>
+
+namespace intpid {
+
+// Integer helpers for 64-bit intermediate math on raw fixed point values,
+// shared by the controllers, the motor estimators and the orientation
+// filters.
+//
+// Division and shifts round to nearest. Truncating would bias every step of
+// a filter or integrator the same way, and it would settle with an offset.
+inline int64_t RoundDiv(int64_t x, int64_t d) {
+  return (x < 0 ? x - d / 2 : x + d / 2) / d;
+}
+inline int64_t RoundShift(int64_t x, int bits) {
+  return (x + (int64_t{1} << (bits - 1))) >> bits;
+}
+
+// Returns floor(sqrt(x)).
+inline uint32_t ISqrt(uint64_t x) {
+  // Digit-by-digit, two bits of x per bit of the result.
+  uint64_t result = 0;
+  uint64_t bit = uint64_t{1} << 62;
+  while (bit > x) bit >>= 2;
+  while (bit != 0) {
+    if (x >= result + bit) {
+      x -= result + bit;
+      result = (result >> 1) + bit;
+    } else {
+      result >>= 1;
+    }
+    bit >>= 2;
+  }
+  return static_cast<uint32_t>(result);
+}
+
+}  // namespace intpid
+
+#endif  // INTPID_FIXED_MATH_H
@@ -0,0 +1,157 @@
+#ifndef INTPID_GAIN_SCHEDULE_H
+#define INTPID_GAIN_SCHEDULE_H
+
+#include <FixedPointsCommon.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <utility>
+
+#include "intpid.h"
+
+namespace intpid {
+
+// One row of a gain schedule: the gains to use when the scheduling variable
+// is at this value.
+struct Breakpoint {
+  float at;
+  float kp, ki, kd;
+};
+
+// A table of PID gains indexed by a scheduling variable, such as the tilt
+// angle or the wheel speed. Between breakpoints the gains are interpolated
+// linearly; beyond the first and last breakpoints they are held constant.
+//
+// Each segment is stored as its start, the reciprocal of its width and the
+// change in each gain along it, so a lookup is a binary search over N values
+// and a few integer multiplies, with no division and no float.
+template <size_t N>
+class GainSchedule {
+  static_assert(N >= 1, "a gain schedule needs at least one breakpoint");
+
+ public:
+  GainSchedule(GainSchedule&&) = default;
+  GainSchedule& operator=(GainSchedule&&) = default;
+
+  // The breakpoints must be in strictly increasing order of at.
+  static std::expected<GainSchedule, ErrorType> Create(
+      std::span<const Breakpoint, N> breakpoints) {
+    GainSchedule schedule;
+    for (size_t i = 0; i < N; ++i) {
+      const Breakpoint& b = breakpoints[i];
+      schedule.at_[i] = b.at;
+      schedule.gains_[i] = {.kp = b.kp, .ki = b.ki, .kd = b.kd};
+      if (i == 0) continue;
+      if (!(schedule.at_[i] > schedule.at_[i - 1])) {
+        return std::unexpected(MakeError(Error::kUnorderedBreakpoints));
+      }
+      const int64_t width = int64_t{schedule.at_[i].getInternal()} -
+                            schedule.at_[i - 1].getInternal();
+      schedule.inverse_width_[i - 1] = (int64_t{1} << 48) / width;
+      const Gains<SQ15x16>& prev = schedule.gains_[i - 1];
+      const Gains<SQ15x16>& next = schedule.gains_[i];
+      schedule.deltas_[i - 1] = {.kp = next.kp - prev.kp,
+                                 .ki = next.ki - prev.ki,
+                                 .kd = next.kd - prev.kd};
+    }
+    return schedule;
+  }
+
+  static constexpr size_t size() { return N; }
+
+  // Returns the gains at x.
+  Gains<SQ15x16> Lookup(SQ15x16 x) const {
+    // The segment that starts at the last breakpoint at or below x, or the
+    // first segment if x is below all of them.
+    const size_t i =
+        std::upper_bound(at_.begin() + 1, at_.end(), x) - at_.begin() - 1;
+    const int64_t offset = int64_t{x.getInternal()} - at_[i].getInternal();
+    if (offset <= 0 || i == N - 1) return gains_[i];
+    // How far along the segment x is, from 0 to 1 in Q16.
+    const int64_t t =
+        std::min<int64_t>((offset * inverse_width_[i]) >> 32, 1 << 16);
+    const Gains<SQ15x16>& base = gains_[i];
+    const Gains<SQ15x16>& delta = deltas_[i];
+    return {.kp = Lerp(base.kp, delta.kp, t),
+            .ki = Lerp(base.ki, delta.ki, t),
+            .kd = Lerp(base.kd, delta.kd, t)};
+  }
+
+ private:
+  GainSchedule() = default;
+
+  // Returns base + delta * t, with t in Q16, rounded to nearest.
+  static SQ15x16 Lerp(SQ15x16 base, SQ15x16 delta, int64_t t) {
+    const int64_t step = (delta.getInternal() * t + (1 << 15)) >> 16;
+    return SQ15x16::fromInternal(
+        static_cast<int32_t>(base.getInternal() + step));
+  }
+
+  std::array<SQ15x16, N> at_;
+  std::array<Gains<SQ15x16>, N> gains_;
+  // Per segment, so the last entries are unused. The inverse widths are
+  // 1 / width in Q32, which keeps at least 16 bits of precision for any
+  // width SQ15x16 can hold.
+  std::array<int64_t, N> inverse_width_{};
+  std::array<Gains<SQ15x16>, N> deltas_{};
+};
+
+// A Pid whose gains follow a GainSchedule. Each Update looks up the gains for
+// the scheduling variable and hands them to the controller with a bumpless
+// transfer, so moving along the table never kicks the output.
+template <size_t N>
+class ScheduledPid {
+ public:
+  ScheduledPid(ScheduledPid&&) = default;
+  ScheduledPid& operator=(ScheduledPid&&) = default;
+
+  // config provides everything but the gains: the output limits, setpoint
+  // weights and derivative filter. Its gains are ignored.
+  static std::expected<ScheduledPid, ErrorType> Create(
+      const Config& config, std::span<const Breakpoint, N> breakpoints) {
+    auto schedule = GainSchedule<N>::Create(breakpoints);
+    if (!schedule) return std::unexpected(schedule.error());
+    // Validate against the gains the filter's time constant will come from.
+    Config first = config;
+    first.kp = breakpoints[0].kp;
+    first.ki = breakpoints[0].ki;
+    first.kd = breakpoints[0].kd;
+    auto pid = Pid::Create(first);
+    if (!pid) return std::unexpected(pid.error());
+    return ScheduledPid(*std::move(schedule), *std::move(pid));
+  }
+
+  // See Pid::set_setpoint.
+  void set_setpoint(SQ15x16 setpoint) { pid_.set_setpoint(setpoint); }
+
+  // Updates the controller with the gains at scheduled_on. As with
+  // Pid::Update, a dt <= 0 restarts the loop; the gains are then simply
+  // replaced, since there is no previous output to carry on from.
+  SQ15x16 Update(SQ15x16 measurement, SQ15x16 dt, SQ15x16 scheduled_on) {
+    const Gains<SQ15x16> gains = schedule_.Lookup(scheduled_on);
+    if (dt > 0) {
+      pid_.set_gains(gains, measurement);
+    } else {
+      pid_.set_gains(gains);
+    }
+    return pid_.Update(measurement, dt);
+  }
+
+  const Pid& pid() const { return pid_; }
+  const GainSchedule<N>& schedule() const { return schedule_; }
+
+ private:
+  ScheduledPid(GainSchedule<N> schedule, Pid pid)
+      : schedule_(std::move(schedule)), pid_(std::move(pid)) {}
+
+  GainSchedule<N> schedule_;
+  Pid pid_;
+};
+
+}  // namespace intpid
+
+#endif  // INTPID_GAIN_SCHEDULE_H
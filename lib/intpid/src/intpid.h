@@ -4,11 +4,26 @@
 #include <FixedPointsCommon.h>
 
 #include <cassert>
+#include <cmath>
+#include <concepts>
 #include <cstdint>
 #include <expected>
 #include <limits>
 #include <memory>
-#include <string>
+
+#include "error.h"
+
+#ifndef INTPID_SUPPRESS_LOGGING
+#define INTPID_SUPPRESS_LOGGING 0
+#endif
+
+// If set, controllers count saturations, anti-windup engagements and fixed
+// point overflows and underflows by default (see Diagnostics). Off, the
+// instrumentation costs nothing; a controller type can still opt in through
+// its Features.
+#ifndef INTPID_INSTRUMENT
+#define INTPID_INSTRUMENT 0
+#endif
 
 namespace intpid {
 
@@ -17,7 +32,8 @@ namespace intpid {
 // that means your output should be centered somewhere near zero, and have an
 // absolute value of 2^14-1 (which is 16383). On the other hand, be careful to
 // stay away from outputs so small they require more than 13-14 bits of
-// precision.
+// precision. Build with INTPID_INSTRUMENT set to find out whether a
+// controller does either.
 struct Config {
   // Each update, we multiply the error by this number and add it to the output
   // signal.
@@ -44,90 +60,495 @@ struct Config {
   // The minimum and maximum outputs.
   float output_min;
   float output_max;
+
+  // Setpoint weights for a two degree of freedom controller. The P term acts
+  // on p_setpoint_weight * setpoint - measurement and the D term on
+  // d_setpoint_weight * setpoint - measurement; the I term always sees the
+  // full error, so the loop still settles on the setpoint. Turning the
+  // weights down softens the response to setpoint changes without changing
+  // how disturbances are rejected.
+  //
+  // The D weight defaults to 0, which is derivative on measurement: a step in
+  // the setpoint gives no derivative kick. Set it to 1 to differentiate the
+  // error instead.
+  float p_setpoint_weight = 1;
+  float d_setpoint_weight = 0;
+
+  // If positive, the D term is passed through a first order low pass filter
+  // with a time constant of Td / N updates, where Td = kd / kp is the
+  // derivative time in updates and N is this number. Typical values are 2 to
+  // 20; lower is smoother but lags more. 0 leaves the D term unfiltered. In
+  // fixed point the filter closes at least one LSB's share of the gap each
+  // update, so a filter too slow for the type runs faster rather than
+  // freezing the D term.
+  float derivative_filter = 0;
+};
+
+// The gains of a running controller, in its own numeric type. See Config for
+// what each one means.
+template <typename T>
+struct Gains {
+  T kp, ki, kd;
+};
+
+// Returns an error if config cannot be used to build a controller.
+inline std::expected<void, ErrorType> Validate(const Config& config) {
+  if (!(config.derivative_filter >= 0)) {
+    return std::unexpected(MakeError(Error::kNegativeDerivativeFilter));
+  }
+  if (config.derivative_filter > 0 && config.kd != 0 && config.kp == 0) {
+    return std::unexpected(MakeError(Error::kDerivativeFilterNeedsKp));
+  }
+  return {};
+}
+
+namespace internal {
+
+// The share of the gap between the raw and the filtered D term that the
+// filter closes each update: 1 / (1 + Tf), with Tf = kd / (kp N) updates.
+// Unfiltered is 1. config must be valid.
+inline float DerivativeFilterGain(const Config& config) {
+  if (config.derivative_filter == 0 || config.kd == 0) return 1;
+  const float n_kp = config.derivative_filter * std::abs(config.kp);
+  return n_kp / (n_kp + std::abs(config.kd));
+}
+
+}  // namespace internal
+
+// The terms a controller computes. Gains for terms that are not computed are
+// ignored.
+enum class Terms {
+  kP,
+  kPI,
+  kPID,
+};
+
+// How the integrator is kept from winding up while the output is saturated.
+enum class AntiWindup {
+  // The integrator is never held back.
+  kNone,
+  // If the raw output is more than 25% of the output range past a limit, the
+  // integrator keeps its previous value. This is the classic Pid behavior.
+  kCutoff,
+  // The integrator is clamped to the output range.
+  kClamp,
+};
+
+// The compile-time feature set of a BasicPid. Features that are turned off
+// cost no code and no storage.
+//
+// If telemetry is on, the controller records the measurement and the P, I and
+// D terms of the last update so they can be logged.
+//
+// If instrument is on, the controller keeps Diagnostics.
+template <Terms kTerms = Terms::kPID,
+          AntiWindup kAntiWindup = AntiWindup::kCutoff,
+          bool kTelemetry = INTPID_SUPPRESS_LOGGING == 0,
+          bool kInstrument = INTPID_INSTRUMENT != 0>
+struct Features {
+  static constexpr Terms terms = kTerms;
+  static constexpr AntiWindup anti_windup = kAntiWindup;
+  static constexpr bool telemetry = kTelemetry;
+  static constexpr bool instrument = kInstrument;
+
+  static constexpr bool has_i = kTerms != Terms::kP;
+  static constexpr bool has_d = kTerms == Terms::kPID;
+};
+
+// Counts of the events that mean a controller is running outside of the range
+// its numeric type handles well. Each counter wraps after 2^32 events.
+struct Diagnostics {
+  // Updates where the output was clamped to output_min or output_max.
+  uint32_t saturations = 0;
+
+  // Updates where anti-windup held the integrator back.
+  uint32_t anti_windup = 0;
+
+  // Intermediate results, such as kp * err, err * dt or the integrator, that
+  // did not fit in the numeric type. The fixed point types wrap rather than
+  // clamp, so any of these means the output was garbage for that update.
+  uint32_t overflows = 0;
+
+  // Products of two nonzero values that came out as zero: a term or an
+  // integrator step too small for the type's precision, and so lost. A steady
+  // count usually means ki is too small for the fraction bits. The fixed
+  // point types floor products, so a tiny negative one comes out as -1 LSB
+  // and is not counted.
+  uint32_t underflows = 0;
+};
+
+namespace internal {
+
+// A FixedPoints SFixed type with at most 32 bits, whose products fit in 64.
+template <typename T>
+concept FixedPoint = requires(T t) {
+  { t.getInternal() } -> std::signed_integral;
+  T::FractionSize;
+} && sizeof(typename T::InternalType) <= 4;
+
+// Returns true if raw, the exact result of an operation on T's internal
+// representation, does not fit in it.
+template <FixedPoint T>
+bool Overflows(int64_t raw) {
+  using Raw = typename T::InternalType;
+  return raw > std::numeric_limits<Raw>::max() ||
+         raw < std::numeric_limits<Raw>::min();
+}
+
+// Count the problems a + b, a - b or a * b would have in T. Floating point
+// types have neither problem at the magnitudes a controller sees.
+template <typename T>
+void CheckAdd(T a, T b, Diagnostics& diagnostics) {
+  if constexpr (FixedPoint<T>) {
+    diagnostics.overflows +=
+        Overflows<T>(int64_t{a.getInternal()} + b.getInternal());
+  }
+}
+template <typename T>
+void CheckSub(T a, T b, Diagnostics& diagnostics) {
+  if constexpr (FixedPoint<T>) {
+    diagnostics.overflows +=
+        Overflows<T>(int64_t{a.getInternal()} - b.getInternal());
+  }
+}
+template <typename T>
+void CheckMul(T a, T b, Diagnostics& diagnostics) {
+  if constexpr (FixedPoint<T>) {
+    const int64_t exact = int64_t{a.getInternal()} * b.getInternal();
+    const int64_t product = exact >> T::FractionSize;
+    if (Overflows<T>(product)) {
+      ++diagnostics.overflows;
+    } else if (exact != 0 && product == 0) {
+      ++diagnostics.underflows;
+    }
+  }
+}
+
+// Storage for a value that only exists for some feature sets. The tag keeps
+// the empty specializations distinct types so [[no_unique_address]] can fold
+// all of them away.
+template <typename T, bool kEnabled, int kTag>
+struct Slot {
+  T value{};
 };
+template <typename T, int kTag>
+struct Slot<T, false, kTag> {};
+
+}  // namespace internal
 
-class Pid {
+// A PID controller over the numeric type T. T may be any FixedPoints SFixed
+// type (e.g. SQ15x16, or SQ7x24 for small outputs that need more precision) or
+// a floating point type. F is a Features instantiation.
+template <typename T, typename F = Features<>>
+class BasicPid {
  public:
-  Pid(Pid&&) = default;
-  Pid& operator=(Pid&&) = default;
+  using Value = T;
+  using FeatureSet = F;
 
-  static std::expected<Pid, std::string> Create(const Config& config);
+  BasicPid(BasicPid&&) = default;
+  BasicPid& operator=(BasicPid&&) = default;
+
+  static std::expected<BasicPid, ErrorType> Create(const Config& config) {
+    if (auto valid = Validate(config); !valid) {
+      return std::unexpected(valid.error());
+    }
+    return BasicPid(config);
+  }
 
   // Adjusts the setpoint. This must be called once before the first call
   // to Update.
-  void set_setpoint(SQ15x16 setpoint) { setpoint_ = setpoint; }
+  void set_setpoint(T setpoint) {
+    setpoint_ = setpoint;
+    p_setpoint_ = p_weight_ * setpoint;
+    if constexpr (F::has_d) d_setpoint_.value = d_weight_.value * setpoint;
+  }
+
+  // Forgets the loop's history, for a loop that is starting over: the
+  // integrator and the filtered D term go to 0, and the derivative is primed
+  // with measurement, so the next Update sees no change in the error. Call it
+  // after set_setpoint. Update(measurement, 0) does all but the first.
+  void Reset(T measurement) {
+    if constexpr (F::has_i) i_sum_.value = 0;
+    if constexpr (F::has_d) {
+      d_.value = 0;
+      prev_d_err_.value = d_setpoint_.value - measurement;
+    }
+  }
 
   // Updates the PID controller with feedback and returns the new output value.
   // dt is unitless -- it just needs to be consistent with the unit for
-  // integral_time and derivative_time.
-  SQ15x16 Update(SQ15x16 measurement, SQ15x16 dt);
+  // integral_time and derivative_time. A dt of 0 or less restarts the D term
+  // from measurement and returns 0.
+  T Update(T measurement, T dt);
+
+  Gains<T> gains() const {
+    Gains<T> gains = {.kp = kp_, .ki = 0, .kd = 0};
+    if constexpr (F::has_i) gains.ki = ki_.value;
+    if constexpr (F::has_d) gains.kd = kd_.value;
+    return gains;
+  }
+
+  // Changes the gains while the loop is running, without a bump in the
+  // output. Since ki multiplies each step before it is integrated, a new ki
+  // only affects error from now on. The change in the P term at measurement,
+  // the value about to be passed to Update, is moved into the integrator
+  // (if there is one) so the output carries on from where it was. The
+  // derivative filter keeps the time constant it was created with.
+  void set_gains(const Gains<T>& gains, T measurement);
+
+  // Changes the gains with no transfer, for a loop that is about to restart.
+  void set_gains(const Gains<T>& gains) {
+    kp_ = gains.kp;
+    if constexpr (F::has_i) ki_.value = gains.ki;
+    if constexpr (F::has_d) kd_.value = gains.kd;
+  }
+
+  // Telemetry accessors. These values are for testing and logging only.
+  // They are only available if the feature set has telemetry turned on.
+  T setpoint() const
+    requires F::telemetry
+  {
+    return setpoint_;
+  }
+  T measurement() const
+    requires F::telemetry
+  {
+    return telemetry_.value.measurement;
+  }
+  T p() const
+    requires F::telemetry
+  {
+    return telemetry_.value.p;
+  }
+  T i() const
+    requires F::telemetry
+  {
+    return telemetry_.value.i;
+  }
+  T d() const
+    requires F::telemetry
+  {
+    return telemetry_.value.d;
+  }
+  T derr() const
+    requires F::telemetry
+  {
+    return telemetry_.value.derr;
+  }
+  T sum() const
+    requires F::telemetry
+  {
+    return telemetry_.value.sum;
+  }
+
+  // Instrumentation accessors, only available if the feature set has
+  // instrument turned on.
+  const Diagnostics& diagnostics() const
+    requires F::instrument
+  {
+    return diagnostics_.value;
+  }
+  void ClearDiagnostics()
+    requires F::instrument
+  {
+    diagnostics_.value = {};
+  }
 
  private:
-  Pid(const Config& config)
+  static constexpr bool kCutoff =
+      F::has_i && F::anti_windup == AntiWindup::kCutoff;
+  static constexpr bool kClamp =
+      F::has_i && F::anti_windup == AntiWindup::kClamp;
+
+  struct Telemetry {
+    T measurement{}, p{}, i{}, d{}, derr{}, sum{};
+  };
+
+  // The arithmetic on the controller's signals. With instrumentation on,
+  // these count overflows and underflows; otherwise they are the operators.
+  T Add(T a, T b) {
+    if constexpr (F::instrument) internal::CheckAdd(a, b, diagnostics_.value);
+    return a + b;
+  }
+  T Sub(T a, T b) {
+    if constexpr (F::instrument) internal::CheckSub(a, b, diagnostics_.value);
+    return a - b;
+  }
+  T Mul(T a, T b) {
+    if constexpr (F::instrument) internal::CheckMul(a, b, diagnostics_.value);
+    return a * b;
+  }
+  void CountAntiWindup() {
+    if constexpr (F::instrument) ++diagnostics_.value.anti_windup;
+  }
+  void CountSaturation() {
+    if constexpr (F::instrument) ++diagnostics_.value.saturations;
+  }
+
+  BasicPid(const Config& config)
       : kp_(config.kp),
-        ki_(config.ki),
-        kd_(config.kd),
+        p_weight_(config.p_setpoint_weight),
         output_min_(config.output_min),
-        output_max_(config.output_max),
-        integrator_lower_cutoff_(output_min_ -
-                                 .25 * (output_max_ - output_min_)),
-        integrator_upper_cutoff_(output_max_ +
-                                 .25 * (output_max_ - output_min_)) {}
-
-  static SQ15x16 MaxI(SQ15x16 output_min, SQ15x16 output_max) {
-    const auto range = output_max - output_min;
-    const auto absmin = absFixed(output_min);
-    const auto absmax = absFixed(output_max);
-    // We only have an offset from zero if our output does not include zero in
-    // its range.
-    const bool has_offset = output_min > 0 == output_max != 0;
-    const auto offset = absmin > absmax ? absmin : absmax;
-    return 2 * (range + (has_offset ? offset : 0));
+        output_max_(config.output_max) {
+    if constexpr (F::has_i) ki_.value = config.ki;
+    if constexpr (F::has_d) {
+      kd_.value = config.kd;
+      d_weight_.value = config.d_setpoint_weight;
+      d_filter_gain_.value = internal::DerivativeFilterGain(config);
+      if constexpr (internal::FixedPoint<T>) {
+        if (d_filter_gain_.value <= 0) {
+          d_filter_gain_.value = T::fromInternal(1);
+        }
+      }
+    }
+    if constexpr (kCutoff) {
+      integrator_lower_cutoff_.value =
+          output_min_ - .25 * (output_max_ - output_min_);
+      integrator_upper_cutoff_.value =
+          output_max_ + .25 * (output_max_ - output_min_);
+    }
   }
 
-  const SQ15x16 kp_, ki_, kd_;
-  const SQ15x16 integrator_clamp_;
-  const SQ15x16 output_min_, output_max_;
+  T kp_, p_weight_;
+  [[no_unique_address]] internal::Slot<T, F::has_i, 0> ki_;
+  [[no_unique_address]] internal::Slot<T, F::has_d, 1> kd_;
+  [[no_unique_address]] internal::Slot<T, F::has_d, 7> d_weight_;
+  [[no_unique_address]] internal::Slot<T, F::has_d, 8> d_filter_gain_;
+  T output_min_, output_max_;
 
-  SQ15x16 setpoint_ = 0;
+  // The setpoint, and the weighted setpoints the P and D terms act on. The
+  // weighting is done here so that Update does not pay for it.
+  T setpoint_ = 0;
+  T p_setpoint_ = 0;
+  [[no_unique_address]] internal::Slot<T, F::has_d, 9> d_setpoint_;
 
   // Note: unlike other PID controller implementations I've seen, we multiply
   // the error * time by ki before adding it to i_sum_. This means that it's
   // easy to clamp the integrator to the desired range without the risk of
   // overflow (that range being 2x the output range).
-  SQ15x16 i_sum_ = 0;
+  [[no_unique_address]] internal::Slot<T, F::has_i, 2> i_sum_;
 
   // If the raw output is outside of this range, the integrator term is reduced
   // until the raw output would be at the edge of the range.
-  const SQ15x16 integrator_lower_cutoff_;
-  const SQ15x16 integrator_upper_cutoff_;
-
-  SQ15x16 prev_measurement_ = 0;
-  SQ15x16 derr_ = 0;
+  [[no_unique_address]] internal::Slot<T, kCutoff, 3> integrator_lower_cutoff_;
+  [[no_unique_address]] internal::Slot<T, kCutoff, 4> integrator_upper_cutoff_;
 
-#if INTPID_SUPPRESS_LOGGING == 0
- public:
-  // If logging is enabled, we record the values we saw for the
-  // setpoint, measurement, and the calculated P I and D terms.
-  // We also expose the state of the integrator and derr.
-  // These values are for testing only.
-  SQ15x16 setpoint() const { return setpoint_; }
-  SQ15x16 measurement() const { return measurement_; }
-  SQ15x16 p() const { return p_; }
-  SQ15x16 i() const { return i_; }
-  SQ15x16 d() const { return d_; }
-  SQ15x16 derr() const { return derr_; }
-  SQ15x16 sum() const { return sum_; }
+  // The D term's error, d_setpoint_ - measurement, at the previous update,
+  // and the D term after the filter.
+  [[no_unique_address]] internal::Slot<T, F::has_d, 5> prev_d_err_;
+  [[no_unique_address]] internal::Slot<T, F::has_d, 10> d_;
 
- private:
-  SQ15x16 measurement_ = 0;
-  SQ15x16 p_ = 0;
-  SQ15x16 i_ = 0;
-  SQ15x16 d_ = 0;
-  SQ15x16 sum_ = 0;
-#endif
+  [[no_unique_address]] internal::Slot<Telemetry, F::telemetry, 6> telemetry_;
+  [[no_unique_address]] internal::Slot<Diagnostics, F::instrument, 11>
+      diagnostics_;
 };
 
+template <typename T, typename F>
+T BasicPid<T, F>::Update(T measurement, T dt) {
+  if (dt <= 0) {
+    if constexpr (F::has_d) {
+      prev_d_err_.value = d_setpoint_.value - measurement;
+      d_.value = 0;
+    }
+    return 0;
+  }
+  const T err = Sub(setpoint_, measurement);
+
+  const T p = Mul(kp_, Sub(p_setpoint_, measurement));
+  T sum = p;
+
+  T d = 0;
+  T derr = 0;
+  if constexpr (F::has_d) {
+    const T d_err = Sub(d_setpoint_.value, measurement);
+    derr = Sub(d_err, prev_d_err_.value);
+    prev_d_err_.value = d_err;
+    d = Mul(kd_.value, derr);
+    if (d_filter_gain_.value < 1) {
+      d = Add(d_.value, Mul(d_filter_gain_.value, Sub(d, d_.value)));
+    }
+    d_.value = d;
+    sum = Add(sum, d);
+  }
+
+  T di = 0;
+  if constexpr (F::has_i) {
+    const T err_time = Mul(err, dt);
+    di = Mul(err_time, ki_.value);
+    T& i_sum = i_sum_.value;
+    i_sum = Add(i_sum, di);
+    if constexpr (kClamp) {
+      if (i_sum > output_max_) {
+        i_sum = output_max_;
+        CountAntiWindup();
+      } else if (i_sum < output_min_) {
+        i_sum = output_min_;
+        CountAntiWindup();
+      }
+    }
+    sum = Add(sum, i_sum);
+  }
+
+  if (sum > output_max_) {
+    if constexpr (kCutoff) {
+      if (sum > integrator_upper_cutoff_.value) {
+        // Anti-windup: prevent the integrator from going far higher than
+        // needed to saturate the output. This just undoes the increment we
+        // did earlier.
+        i_sum_.value = Sub(i_sum_.value, di);
+        CountAntiWindup();
+      }
+    }
+    sum = output_max_;
+    CountSaturation();
+  } else if (sum < output_min_) {
+    if constexpr (kCutoff) {
+      if (sum < integrator_lower_cutoff_.value) {
+        i_sum_.value = Sub(i_sum_.value, di);
+        CountAntiWindup();
+      }
+    }
+    sum = output_min_;
+    CountSaturation();
+  }
+
+  if constexpr (F::telemetry) {
+    Telemetry& t = telemetry_.value;
+    t.measurement = measurement;
+    t.p = p;
+    if constexpr (F::has_i) t.i = i_sum_.value;
+    t.d = d;
+    t.derr = derr;
+    t.sum = sum;
+  }
+  return sum;
+}
+
+template <typename T, typename F>
+void BasicPid<T, F>::set_gains(const Gains<T>& gains, T measurement) {
+  if constexpr (F::has_i) {
+    if (gains.kp != kp_) {
+      T& i_sum = i_sum_.value;
+      i_sum = Add(i_sum,
+                  Mul(Sub(kp_, gains.kp), Sub(p_setpoint_, measurement)));
+      if constexpr (kClamp) {
+        if (i_sum > output_max_) {
+          i_sum = output_max_;
+        } else if (i_sum < output_min_) {
+          i_sum = output_min_;
+        }
+      }
+    }
+  }
+  set_gains(gains);
+}
+
+// The classic controller: SQ15x16, full PID, cutoff anti-windup, and telemetry
+// unless INTPID_SUPPRESS_LOGGING is set.
+using Pid = BasicPid<SQ15x16>;
+
+extern template class BasicPid<SQ15x16>;
+
 }  // namespace intpid
 
-#endif  // INTPID_INTPID_H
\ No newline at end of file
+#endif  // INTPID_INTPID_H
@@ -0,0 +1,113 @@
+#ifndef INTPID_PID_BANK_H
+#define INTPID_PID_BANK_H
+
+#include <FixedPointsCommon.h>
+
+#include <array>
+#include <cstddef>
+#include <expected>
+#include <span>
+
+#include "intpid.h"
+
+namespace intpid {
+
+// A group of N PID controllers that are updated together. The behavior of
+// each controller is identical to a Pid created from the same Config, but the
+// state of the whole bank is stored as one array per field, so a control tick
+// that runs several loops walks a few short contiguous arrays instead of N
+// separate objects.
+template <size_t N>
+class PidBank {
+ public:
+  PidBank(PidBank&&) = default;
+  PidBank& operator=(PidBank&&) = default;
+
+  static std::expected<PidBank, ErrorType> Create(
+      std::span<const Config, N> configs) {
+    PidBank bank;
+    for (size_t i = 0; i < N; ++i) {
+      const Config& config = configs[i];
+      if (auto valid = Validate(config); !valid) {
+        return std::unexpected(valid.error());
+      }
+      bank.kp_[i] = config.kp;
+      bank.ki_[i] = config.ki;
+      bank.kd_[i] = config.kd;
+      bank.p_weight_[i] = config.p_setpoint_weight;
+      bank.d_weight_[i] = config.d_setpoint_weight;
+      bank.d_filter_gain_[i] = internal::DerivativeFilterGain(config);
+      bank.output_min_[i] = config.output_min;
+      bank.output_max_[i] = config.output_max;
+      // Same cutoffs as Pid.
+      const SQ15x16 range = bank.output_max_[i] - bank.output_min_[i];
+      bank.integrator_lower_cutoff_[i] = bank.output_min_[i] - .25 * range;
+      bank.integrator_upper_cutoff_[i] = bank.output_max_[i] + .25 * range;
+    }
+    return bank;
+  }
+
+  static constexpr size_t size() { return N; }
+
+  // Adjusts the setpoint of controller i. See Pid::set_setpoint.
+  void set_setpoint(size_t i, SQ15x16 setpoint) {
+    setpoint_[i] = setpoint;
+    p_setpoint_[i] = p_weight_[i] * setpoint;
+    d_setpoint_[i] = d_weight_[i] * setpoint;
+  }
+
+  // Updates every controller in the bank. Controller i is fed measurements[i]
+  // and dt[i] and its new output is written to outputs[i]. See Pid::Update.
+  void Update(std::span<const SQ15x16, N> measurements,
+              std::span<const SQ15x16, N> dt, std::span<SQ15x16, N> outputs) {
+    for (size_t i = 0; i < N; ++i) {
+      const SQ15x16 measurement = measurements[i];
+      if (dt[i] <= 0) {
+        prev_d_err_[i] = d_setpoint_[i] - measurement;
+        d_[i] = 0;
+        outputs[i] = 0;
+        continue;
+      }
+      const SQ15x16 err = setpoint_[i] - measurement;
+      const SQ15x16 d_err = d_setpoint_[i] - measurement;
+      const SQ15x16 derr = d_err - prev_d_err_[i];
+      prev_d_err_[i] = d_err;
+
+      SQ15x16 d = kd_[i] * derr;
+      if (d_filter_gain_[i] < 1) d = d_[i] + d_filter_gain_[i] * (d - d_[i]);
+      d_[i] = d;
+
+      const SQ15x16 pd = kp_[i] * (p_setpoint_[i] - measurement) + d;
+      const SQ15x16 di = err * dt[i] * ki_[i];
+      i_sum_[i] += di;
+
+      SQ15x16 sum = pd + i_sum_[i];
+      if (sum > output_max_[i]) {
+        // Anti-windup, as in Pid::Update.
+        if (sum > integrator_upper_cutoff_[i]) i_sum_[i] -= di;
+        sum = output_max_[i];
+      } else if (sum < output_min_[i]) {
+        if (sum < integrator_lower_cutoff_[i]) i_sum_[i] -= di;
+        sum = output_min_[i];
+      }
+      outputs[i] = sum;
+    }
+  }
+
+ private:
+  PidBank() = default;
+
+  std::array<SQ15x16, N> kp_, ki_, kd_;
+  std::array<SQ15x16, N> p_weight_, d_weight_, d_filter_gain_;
+  std::array<SQ15x16, N> output_min_, output_max_;
+  std::array<SQ15x16, N> integrator_lower_cutoff_, integrator_upper_cutoff_;
+
+  // Mutable state, kept together so a tick touches as few lines as possible.
+  std::array<SQ15x16, N> setpoint_{}, p_setpoint_{}, d_setpoint_{};
+  std::array<SQ15x16, N> i_sum_{};
+  std::array<SQ15x16, N> prev_d_err_{}, d_{};
+};
+
+}  // namespace intpid
+
+#endif  // INTPID_PID_BANK_H
@@ -0,0 +1,44 @@
+#ifndef INTPID_PID_TELEMETRY_H
+#define INTPID_PID_TELEMETRY_H
+
+#include <FixedPointsCommon.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "intpid.h"
+#include "record.h"
+
+namespace intpid {
+
+// The number of telemetry channels DiagnosticsRecords fills.
+constexpr size_t kDiagnosticsChannels = 4;
+
+// Returns the Diagnostics counters as telemetry records, on consecutive
+// channels from first_channel in the order saturations, anti_windup,
+// overflows, underflows. Records carry SQ15x16 values, so a count above
+// 32767 is reported as 32767; report and clear the counters often enough
+// (once a second, like the scheduler stats) that this only happens when
+// something is badly wrong.
+inline std::array<telemetry::Record, kDiagnosticsChannels> DiagnosticsRecords(
+    const Diagnostics& diagnostics, uint32_t timestamp,
+    telemetry::Channel first_channel) {
+  const uint32_t counts[kDiagnosticsChannels] = {
+      diagnostics.saturations, diagnostics.anti_windup, diagnostics.overflows,
+      diagnostics.underflows};
+  std::array<telemetry::Record, kDiagnosticsChannels> records;
+  for (size_t i = 0; i < kDiagnosticsChannels; ++i) {
+    const int32_t count =
+        static_cast<int32_t>(std::min<uint32_t>(counts[i], 32767));
+    records[i] = telemetry::Record::Make(
+        timestamp, static_cast<telemetry::Channel>(first_channel + i),
+        SQ15x16(count));
+  }
+  return records;
+}
+
+}  // namespace intpid
+
+#endif  // INTPID_PID_TELEMETRY_H
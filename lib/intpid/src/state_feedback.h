@@ -0,0 +1,104 @@
+#ifndef INTPID_STATE_FEEDBACK_H
+#define INTPID_STATE_FEEDBACK_H
+
+#include <FixedPointsCommon.h>
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+
+#include "error.h"
+
+namespace intpid {
+
+// The gain matrix K of a state feedback law u = -K x, with M inputs and N
+// states, and the limits each input is saturated to. Row i of gains gives
+// input i. tools/lqr_gains designs K for the balancing robot.
+template <size_t N, size_t M = 1>
+struct StateFeedbackConfig {
+  std::array<std::array<float, N>, M> gains;
+  float output_min;
+  float output_max;
+};
+
+// Full state feedback, u = -K x, saturated. Where a PID needs one loop per
+// measured quantity and a cascade to tie them together, this drives every
+// input from the whole state at once: for a self-balancing robot, the effort
+// from pitch, pitch rate, wheel angle and wheel speed together.
+//
+// The controller has no state of its own. Each input is N multiplies summed
+// at full precision in 64 bits and rounded once, so the only error beyond
+// the inputs' own is the quantization of K to SQ15x16. The sum is exact as
+// long as the sum of |K_ij x_j| stays below 2^31; anything past +-32767 is
+// saturated anyway.
+template <size_t N, size_t M = 1>
+class StateFeedback {
+ public:
+  using Config = StateFeedbackConfig<N, M>;
+
+  // Every gain must be within the range of SQ15x16, and a nonzero gain must
+  // not round to zero.
+  static std::expected<StateFeedback, ErrorType> Create(const Config& config) {
+    StateFeedback controller;
+    for (size_t i = 0; i < M; ++i) {
+      for (size_t j = 0; j < N; ++j) {
+        const float k = config.gains[i][j];
+        if (!(std::abs(k) < 32767) ||
+            (k != 0 && std::abs(k) < 1.f / (1 << 16))) {
+          return std::unexpected(MakeError(Error::kGainOutOfRange));
+        }
+        controller.gains_[i][j] = k;
+      }
+    }
+    controller.output_min_ = config.output_min;
+    controller.output_max_ = config.output_max;
+    return controller;
+  }
+
+  static constexpr size_t num_states() { return N; }
+  static constexpr size_t num_inputs() { return M; }
+
+  // Writes -K state, saturated, to outputs.
+  void Update(std::span<const SQ15x16, N> state,
+              std::span<SQ15x16, M> outputs) const {
+    for (size_t i = 0; i < M; ++i) outputs[i] = Row(i, state);
+  }
+
+  // Returns -K state, saturated, for a single input.
+  SQ15x16 Update(std::span<const SQ15x16, N> state) const
+    requires(M == 1)
+  {
+    return Row(0, state);
+  }
+
+  SQ15x16 gain(size_t input, size_t state) const {
+    return gains_[input][state];
+  }
+  SQ15x16 output_min() const { return output_min_; }
+  SQ15x16 output_max() const { return output_max_; }
+
+ private:
+  StateFeedback() = default;
+
+  SQ15x16 Row(size_t i, std::span<const SQ15x16, N> state) const {
+    // Q32 products.
+    int64_t sum = 0;
+    for (size_t j = 0; j < N; ++j) {
+      sum += int64_t{gains_[i][j].getInternal()} * state[j].getInternal();
+    }
+    const int64_t u = (-sum + (int64_t{1} << 15)) >> 16;
+    if (u > output_max_.getInternal()) return output_max_;
+    if (u < output_min_.getInternal()) return output_min_;
+    return SQ15x16::fromInternal(static_cast<int32_t>(u));
+  }
+
+  std::array<std::array<SQ15x16, N>, M> gains_;
+  SQ15x16 output_min_, output_max_;
+};
+
+}  // namespace intpid
+
+#endif  // INTPID_STATE_FEEDBACK_H
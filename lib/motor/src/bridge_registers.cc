@@ -0,0 +1,85 @@
+#include "bridge_registers.h"
+
+#include <Arduino.h>
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <hal/ledc_ll.h>
+#include <soc/gpio_reg.h>
+#include <soc/soc.h>
+#else
+#include "hosthal.h"
+#endif
+
+namespace motor::bridge_registers {
+
+void ConfigureOutput(int pin) {
+  pinMode(pin, OUTPUT);
+  ClearOutputs(uint32_t{1} << pin);
+}
+
+#ifdef ARDUINO_ARCH_ESP32
+
+bool ConfigurePwm(int pin, int channel, uint32_t frequency_hz,
+                  int resolution_bits) {
+  if (!ledcAttachChannel(pin, frequency_hz, resolution_bits, channel)) {
+    return false;
+  }
+  // Leaves the channel's fade parameters at a single step, so later duty
+  // changes only need the duty and the latch.
+  return ledcWrite(pin, 0);
+}
+
+void IRAM_ATTR SetOutputs(uint32_t mask) {
+  REG_WRITE(GPIO_OUT_W1TS_REG, mask);
+}
+
+void IRAM_ATTR ClearOutputs(uint32_t mask) {
+  REG_WRITE(GPIO_OUT_W1TC_REG, mask);
+}
+
+void IRAM_ATTR SetDuty(int channel, uint32_t duty) {
+  ledc_dev_t* const hw = LEDC_LL_GET_HW();
+  const auto ch = static_cast<ledc_channel_t>(channel);
+  ledc_ll_set_duty_int_part(hw, LEDC_LOW_SPEED_MODE, ch, duty);
+  ledc_ll_set_duty_start(hw, LEDC_LOW_SPEED_MODE, ch, true);
+  ledc_ll_ls_channel_update(hw, LEDC_LOW_SPEED_MODE, ch);
+}
+
+#else  // ARDUINO_ARCH_ESP32
+
+bool ConfigurePwm(int pin, int channel, uint32_t frequency_hz,
+                  int resolution_bits) {
+  if (channel < 0 || channel >= hosthal::kNumLedcChannels) return false;
+  pinMode(pin, OUTPUT);
+  hosthal::RegisterFile& registers = hosthal::Registers();
+  registers.ledc_pin[channel] = pin;
+  registers.ledc_frequency_hz[channel] = frequency_hz;
+  registers.ledc_resolution_bits[channel] = resolution_bits;
+  registers.ledc_duty[channel] = 0;
+  return true;
+}
+
+void SetOutputs(uint32_t mask) {
+  hosthal::RegisterFile& registers = hosthal::Registers();
+  registers.gpio_out |= mask;
+  ++registers.gpio_writes;
+  if (registers.on_write != nullptr) registers.on_write(registers);
+}
+
+void ClearOutputs(uint32_t mask) {
+  hosthal::RegisterFile& registers = hosthal::Registers();
+  registers.gpio_out &= ~mask;
+  ++registers.gpio_writes;
+  if (registers.on_write != nullptr) registers.on_write(registers);
+}
+
+void SetDuty(int channel, uint32_t duty) {
+  hosthal::RegisterFile& registers = hosthal::Registers();
+  registers.ledc_duty[channel] = duty;
+  ++registers.ledc_writes;
+  if (registers.on_write != nullptr) registers.on_write(registers);
+}
+
+#endif  // ARDUINO_ARCH_ESP32
+
+}  // namespace motor::bridge_registers
@@ -0,0 +1,34 @@
+#ifndef MOTOR_BRIDGE_REGISTERS_H
+#define MOTOR_BRIDGE_REGISTERS_H
+
+#include <cstdint>
+
+// Direct access to the GPIO and LEDC registers an H-bridge driver needs, for
+// drivers that cannot afford the Arduino layer on every control tick. On the
+// ESP32 each function is a handful of stores to the peripheral. On the host
+// they go to the fake register file in hosthal, which counts them.
+//
+// Only GPIOs 0 to 31 are supported, since the output masks are one register
+// wide.
+namespace motor::bridge_registers {
+
+// Setup. These may go through the Arduino layer and may be slow.
+void ConfigureOutput(int pin);
+// Attaches pin to LEDC channel at frequency_hz, with a duty of 0 to
+// 2^resolution_bits. Returns false if the peripheral refused.
+bool ConfigurePwm(int pin, int channel, uint32_t frequency_hz,
+                  int resolution_bits);
+
+// Drives the pins in mask high (or low) with one write to the GPIO output
+// set (or clear) register. Pins not in mask are untouched, so this is safe
+// to call concurrently with writes to other pins.
+void SetOutputs(uint32_t mask);
+void ClearOutputs(uint32_t mask);
+
+// Sets the channel's duty. The LEDC latches it at the start of the next PWM
+// period, so a period never mixes two duties.
+void SetDuty(int channel, uint32_t duty);
+
+}  // namespace motor::bridge_registers
+
+#endif  // MOTOR_BRIDGE_REGISTERS_H
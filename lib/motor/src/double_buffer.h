@@ -0,0 +1,72 @@
+#ifndef MOTOR_DOUBLE_BUFFER_H
+#define MOTOR_DOUBLE_BUFFER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+namespace motor {
+
+// Hands the latest value from one writer to one reader without locks. The
+// writer always fills the slot the latest value is not in and then publishes
+// it, so it never waits, and a reader copying the latest value is not
+// disturbed by the next publish.
+//
+// This is a seqlock over the two slots. The sequence is twice the number of
+// values published, plus one while a publish is writing its slot. A reader
+// retries only if, by the time its copy is done, the writer has started on
+// the slot it was copying, i.e. has lapped it by two publishes; that way it
+// never returns a torn value, on one core or several.
+//
+// T must be trivially copyable. Publishing from an interrupt is fine; reading
+// from one is not, since the read may retry. The count wraps after 2^31
+// publishes.
+template <typename T>
+class DoubleBuffer {
+ public:
+  static_assert(std::is_trivially_copyable_v<T>);
+
+  void Publish(const T& value) {
+    const uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+    const uint32_t count = sequence >> 1;
+    // Mark the write, and keep the slot's stores after the mark.
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slots_[(count + 1) & 1] = value;
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+  // Copies the latest value into value and returns the number of values
+  // published so far, which identifies it. Returns 0, leaving value alone, if
+  // nothing has been published.
+  uint32_t Read(T& value) const {
+    while (true) {
+      const uint32_t sequence = sequence_.load(std::memory_order_acquire);
+      const uint32_t count = sequence >> 1;
+      if (count == 0) return 0;
+      T copy = slots_[count & 1];
+      std::atomic_thread_fence(std::memory_order_acquire);
+      // The next write to this slot is publish count + 2, which marks the
+      // sequence 2 * count + 3.
+      const uint32_t after = sequence_.load(std::memory_order_relaxed);
+      if (after - 2 * count < 3) {
+        value = copy;
+        return count;
+      }
+    }
+  }
+
+  // The number of values published so far.
+  uint32_t published() const {
+    return sequence_.load(std::memory_order_relaxed) >> 1;
+  }
+
+ private:
+  std::array<T, 2> slots_{};
+  std::atomic<uint32_t> sequence_{0};
+};
+
+}  // namespace motor
+
+#endif  // MOTOR_DOUBLE_BUFFER_H
@@ -0,0 +1,30 @@
+#include "feedback_motor.h"
+
+#include <utility>
+
+namespace motor {
+namespace internal {
+
+std::expected<FeedbackLoops, ErrorType> CreateFeedbackLoops(
+    const FeedbackConfig& config) {
+  if (config.position_divider < 1) {
+    return std::unexpected(MakeError(Error::kBadPositionDivider));
+  }
+  auto velocity = intpid::Pid::Create(config.velocity);
+  if (!velocity) {
+    return std::unexpected(
+        LoopError(Error::kBadVelocityLoop, std::move(velocity.error())));
+  }
+  auto position = intpid::Pid::Create(config.position);
+  if (!position) {
+    return std::unexpected(
+        LoopError(Error::kBadPositionLoop, std::move(position.error())));
+  }
+  return FeedbackLoops{*std::move(velocity), *std::move(position)};
+}
+
+}  // namespace internal
+
+template class BasicFeedbackMotor<>;
+
+}  // namespace motor
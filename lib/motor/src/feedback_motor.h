@@ -1,17 +1,186 @@
 #ifndef MOTOR_FEEDBACK_MOTOR_H
 #define MOTOR_FEEDBACK_MOTOR_H
 
+#include <FixedPointsCommon.h>
+
+#include <cstdint>
+#include <expected>
+#include <utility>
+
+#include "intpid.h"
+#include "motor.h"
+#include "motor_error.h"
+#include "sensor.h"
+
 namespace motor {
 
+struct FeedbackConfig {
+  // The inner loop. Its measurement is Sensor::rate() in degrees/sec and its
+  // output is the signed effort passed to Motor::SetEffort, so output_min and
+  // output_max should be the negative and positive full-scale duty.
+  intpid::Config velocity;
+
+  // The outer loop. Its measurement is Sensor::angle() in degrees and its
+  // output is the target speed for the inner loop, so output_min and
+  // output_max are the slowest and fastest speeds a position move may use.
+  intpid::Config position;
+
+  // The outer loop runs once for every this many inner loop updates. The inner
+  // loop has to keep up with the sensor; the outer loop only has to be fast
+  // compared to the mechanics.
+  int position_divider = 10;
+};
+
+namespace internal {
+
+struct FeedbackLoops {
+  intpid::Pid velocity;
+  intpid::Pid position;
+};
+
+// Checks config and builds its two loops. Shared by every
+// BasicFeedbackMotor, so the error strings are built in one place.
+std::expected<FeedbackLoops, ErrorType> CreateFeedbackLoops(
+    const FeedbackConfig& config);
+
+}  // namespace internal
+
 // A motor that has a position feedback sensor. This type of motor
 // can be set to a target speed or a target position.
-class FeedbackMotor { 
+//
+// The controller is a cascade: an inner velocity loop that runs on every call
+// to Update, and an outer position loop that runs every position_divider
+// updates and sets the inner loop's target speed. In speed mode the outer loop
+// is skipped entirely.
+//
+// M and S are the motor and sensor types the loop calls. With concrete types
+// the calls bind at compile time and inline into the control loop; with the
+// default Motor and Sensor (FeedbackMotor) they are virtual, so any
+// implementation, such as a test fake, can be plugged in at run time.
+template <MotorLike M = Motor, SensorLike S = Sensor>
+class BasicFeedbackMotor {
  public:
-  
+  enum Mode {
+    kStopped,
+    kSpeed,
+    kPosition,
+  };
+
+  BasicFeedbackMotor(BasicFeedbackMotor&&) = default;
+  BasicFeedbackMotor& operator=(BasicFeedbackMotor&&) = default;
+
+  // Neither motor nor sensor is owned, and both must outlive the
+  // FeedbackMotor.
+  static std::expected<BasicFeedbackMotor, ErrorType> Create(
+      M* motor, S* sensor, const FeedbackConfig& config) {
+    if (motor == nullptr || sensor == nullptr) {
+      return std::unexpected(MakeError(Error::kMissingMotorOrSensor));
+    }
+    auto loops = internal::CreateFeedbackLoops(config);
+    if (!loops) return std::unexpected(loops.error());
+    return BasicFeedbackMotor(motor, sensor, *std::move(loops),
+                              config.position_divider);
+  }
+
+  // Holds the given speed in degrees/sec. Positive is clockwise. Coming out
+  // of kStopped the inner loop starts over from the current rate; coming
+  // from kPosition it carries on.
+  void SetTargetSpeed(SQ15x16 speed) {
+    target_speed_ = speed;
+    velocity_.set_setpoint(speed);
+    if (mode_ == kStopped) velocity_.Reset(sensor_->rate());
+    mode_ = kSpeed;
+  }
+
+  // Moves to and holds the given accumulated angle in degrees. The outer loop
+  // starts over from the current angle, so its first D term sees no jump,
+  // and coming out of kStopped so does the inner loop.
+  void SetTargetPosition(SQ15x16 position) {
+    position_.set_setpoint(position);
+    position_.Reset(sensor_->angle());
+    if (mode_ == kStopped) {
+      // The outer loop sets the real target on the next update.
+      target_speed_ = 0;
+      velocity_.set_setpoint(0);
+      velocity_.Reset(sensor_->rate());
+    }
+    mode_ = kPosition;
+    // Run the outer loop on the next update rather than waiting out the rest
+    // of its period.
+    position_countdown_ = 0;
+    position_dt_ = 0;
+  }
+
+  // Stops the motor. Update does nothing until a new target is set, and
+  // neither loop keeps what it had integrated.
+  void Stop(StopMode mode = kCoast) {
+    mode_ = kStopped;
+    effort_ = 0;
+    motor_->Stop(mode);
+  }
+
+  // Runs one step of the controller. Call this right after the sensor has
+  // taken a new sample. dt is the time since the previous call, in the same
+  // unit the gains were tuned for (milliseconds for sched::Tick::dt_ms).
+  void Update(SQ15x16 dt);
+
+  Mode mode() const { return mode_; }
+
+  // The speed the inner loop is currently holding. In position mode this is
+  // the output of the outer loop.
+  SQ15x16 target_speed() const { return target_speed_; }
+
+  // The effort last passed to the motor.
+  int effort() const { return effort_; }
+
+ private:
+  BasicFeedbackMotor(M* motor, S* sensor, internal::FeedbackLoops loops,
+                     int position_divider)
+      : motor_(motor),
+        sensor_(sensor),
+        velocity_(std::move(loops.velocity)),
+        position_(std::move(loops.position)),
+        position_divider_(position_divider) {}
+
+  M* motor_;
+  S* sensor_;
+  intpid::Pid velocity_;
+  intpid::Pid position_;
+  int position_divider_;
+
+  Mode mode_ = kStopped;
+  SQ15x16 target_speed_ = 0;
+  int effort_ = 0;
+
+  // Inner loop updates until the outer loop runs next, and the time that has
+  // passed since it last ran.
+  int position_countdown_ = 0;
+  SQ15x16 position_dt_ = 0;
 };
 
+template <MotorLike M, SensorLike S>
+void BasicFeedbackMotor<M, S>::Update(SQ15x16 dt) {
+  if (mode_ == kStopped) return;
 
+  if (mode_ == kPosition) {
+    position_dt_ += dt;
+    if (--position_countdown_ <= 0) {
+      target_speed_ = position_.Update(sensor_->angle(), position_dt_);
+      velocity_.set_setpoint(target_speed_);
+      position_countdown_ = position_divider_;
+      position_dt_ = 0;
+    }
+  }
 
+  effort_ = roundFixed(velocity_.Update(sensor_->rate(), dt)).getInteger();
+  motor_->SetEffort(effort_);
 }
 
-#endif  // MOTOR_FEEDBACK_MOTOR_H
\ No newline at end of file
+// The run-time polymorphic controller, over any Motor and Sensor.
+using FeedbackMotor = BasicFeedbackMotor<>;
+
+extern template class BasicFeedbackMotor<>;
+
+}  // namespace motor
+
+#endif  // MOTOR_FEEDBACK_MOTOR_H
@@ -0,0 +1,95 @@
+#include "hbridge_motor.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "bridge_registers.h"
+
+namespace motor {
+
+HBridgeMotor::HBridgeMotor(const Pins& pins, uint32_t frequency_hz,
+                           int resolution_bits)
+    : pwm_pin_(pins.pwm),
+      forward_pin_(pins.forward),
+      reverse_pin_(pins.reverse),
+      channel_(pins.channel),
+      forward_mask_(uint32_t{1} << pins.forward),
+      reverse_mask_(uint32_t{1} << pins.reverse),
+      frequency_hz_(frequency_hz),
+      resolution_bits_(resolution_bits),
+      full_scale_(uint32_t{1} << resolution_bits) {}
+
+bool HBridgeMotor::Begin() {
+  bridge_registers::ConfigureOutput(forward_pin_);
+  bridge_registers::ConfigureOutput(reverse_pin_);
+  inputs_ = 0;
+  if (!bridge_registers::ConfigurePwm(pwm_pin_, channel_, frequency_hz_,
+                                      resolution_bits_)) {
+    return false;
+  }
+  duty_ = 0;
+  return true;
+}
+
+void HBridgeMotor::SetInputs(uint32_t inputs) {
+  const uint32_t changed = inputs ^ inputs_;
+  // Release before asserting, so the bridge passes through coast (both
+  // inputs low) and never through a state neither end asked for.
+  if (const uint32_t release = changed & inputs_; release != 0) {
+    bridge_registers::ClearOutputs(release);
+  }
+  if (const uint32_t engage = changed & inputs; engage != 0) {
+    bridge_registers::SetOutputs(engage);
+  }
+  inputs_ = inputs;
+}
+
+void HBridgeMotor::WriteDuty(uint32_t duty) {
+  if (duty == duty_) return;
+  bridge_registers::SetDuty(channel_, duty);
+  duty_ = duty;
+}
+
+void HBridgeMotor::SetEffort(int effort) {
+  const uint32_t duty = static_cast<uint32_t>(std::min<int64_t>(
+      effort < 0 ? -int64_t{effort} : effort, full_scale_));
+  if (effort == 0) {
+    WriteDuty(0);
+    return;
+  }
+  const uint32_t inputs = effort > 0 ? forward_mask_ : reverse_mask_;
+  if (inputs == inputs_) {
+    WriteDuty(duty);
+    return;
+  }
+  // A reversal cannot be one write: the GPIO has separate set and clear
+  // registers, and writing both inputs at once would take a read-modify-write
+  // of the whole output register, racing with anything driving other pins.
+  // Instead the writes are ordered so every state in between is one the
+  // bridge is meant to be in. Releasing the old direction first leaves both
+  // inputs low, which coasts whatever the duty, so the new duty is written
+  // while coasting and the new direction is asserted last. Both inputs are
+  // never high together, and the new duty never drives the old direction.
+  const uint32_t release = inputs_ & ~inputs;
+  if (release != 0) {
+    bridge_registers::ClearOutputs(release);
+    inputs_ &= ~release;
+  }
+  WriteDuty(duty);
+  SetInputs(inputs);
+}
+
+void HBridgeMotor::Stop(StopMode mode) {
+  WriteDuty(0);
+  SetInputs(mode == kBrake ? forward_mask_ | reverse_mask_ : 0);
+}
+
+void HBridgeMotor::SetDirection(Direction direction) {
+  SetInputs(direction == kClockwise ? forward_mask_ : reverse_mask_);
+}
+
+void HBridgeMotor::SetDuty(int duty) {
+  WriteDuty(std::clamp<int>(duty, 0, full_scale_));
+}
+
+}  // namespace motor
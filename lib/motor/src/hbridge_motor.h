@@ -0,0 +1,76 @@
+#ifndef MOTOR_HBRIDGE_MOTOR_H
+#define MOTOR_HBRIDGE_MOTOR_H
+
+#include <cstdint>
+
+#include "motor.h"
+
+namespace motor {
+
+// The same wiring as ThreeWireMotor (a PWM input and two direction inputs, as
+// on the TB6612), driven through the GPIO and LEDC registers directly (see
+// bridge_registers.h) rather than digitalWrite and analogWrite.
+//
+// SetEffort is the control loop's interface. It only writes what changed:
+// holding a direction costs one duty write, or nothing if the duty is the
+// same. A reversal first releases the old direction's input, so the bridge
+// coasts rather than driving the new duty the old way, then writes the duty,
+// then asserts the new direction's input. That is three writes rather than
+// one: see SetEffort in the .cc for why each state in between is safe.
+//
+// The rest of the Motor interface is kept so the driver drops in anywhere a
+// ThreeWireMotor does.
+class HBridgeMotor final : public Motor {
+ public:
+  struct Pins {
+    int pwm;
+    int forward;
+    int reverse;
+    // The LEDC channel to generate the PWM on.
+    int channel = 0;
+  };
+
+  // The duty is 0 to 2^resolution_bits, so full scale is
+  // 2^resolution_bits, not 2^resolution_bits - 1.
+  HBridgeMotor(const Pins& pins, uint32_t frequency_hz = 20'000,
+               int resolution_bits = 10);
+
+  // Configures the pins and coasts. Returns false if the PWM could not be
+  // set up.
+  bool Begin();
+
+  // Drives the motor with a signed effort. Positive is clockwise, and the
+  // magnitude is the duty, saturated to full scale. An effort of 0 leaves
+  // the direction inputs as they are.
+  void SetEffort(int effort) override;
+
+  // The full-scale duty, 2^resolution_bits.
+  int full_scale() const { return static_cast<int>(full_scale_); }
+
+  void Stop(StopMode mode = kCoast) override;
+  void SetDirection(Direction direction) override;
+  void SetDuty(int duty) override;
+
+ private:
+  // The levels of the two direction inputs, as a GPIO mask.
+  void SetInputs(uint32_t inputs);
+  void WriteDuty(uint32_t duty);
+
+  const int pwm_pin_;
+  const int forward_pin_;
+  const int reverse_pin_;
+  const int channel_;
+  const uint32_t forward_mask_;
+  const uint32_t reverse_mask_;
+  const uint32_t frequency_hz_;
+  const int resolution_bits_;
+  const uint32_t full_scale_;
+
+  // What the registers hold, so unchanged writes can be skipped.
+  uint32_t inputs_ = 0;
+  uint32_t duty_ = 0;
+};
+
+}  // namespace motor
+
+#endif  // MOTOR_HBRIDGE_MOTOR_H
@@ -0,0 +1,90 @@
+#include "mlx90393_acquisition.h"
+
+namespace motor {
+
+MLX90393Acquisition::~MLX90393Acquisition() {
+  if (drdy_pin_ >= 0) detachInterrupt(digitalPinToInterrupt(drdy_pin_));
+#ifdef ARDUINO_ARCH_ESP32
+  if (task_ != nullptr) vTaskDelete(task_);
+#endif
+}
+
+void MLX90393Acquisition::Begin(int drdy_pin) {
+  drdy_pin_ = drdy_pin;
+  pinMode(drdy_pin_, INPUT);
+  attachInterruptArg(digitalPinToInterrupt(drdy_pin_),
+                     &MLX90393Acquisition::OnDataReadyTrampoline, this,
+                     RISING);
+}
+
+#ifdef ARDUINO_ARCH_ESP32
+bool MLX90393Acquisition::StartTask(UBaseType_t priority,
+                                    uint32_t stack_size) {
+  return xTaskCreate(&MLX90393Acquisition::TaskMain, "mlx90393", stack_size,
+                     this, priority, &task_) == pdPASS;
+}
+
+bool MLX90393Acquisition::StartTask(UBaseType_t priority,
+                                    std::span<StackType_t> stack,
+                                    StaticTask_t* task_buffer) {
+  task_ = xTaskCreateStatic(&MLX90393Acquisition::TaskMain, "mlx90393",
+                            stack.size(), this, priority, stack.data(),
+                            task_buffer);
+  return task_ != nullptr;
+}
+
+void MLX90393Acquisition::TaskMain(void* arg) {
+  auto* self = static_cast<MLX90393Acquisition*>(arg);
+  while (true) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    self->Service();
+  }
+}
+#endif
+
+void IRAM_ATTR MLX90393Acquisition::OnDataReadyTrampoline(void* arg) {
+  static_cast<MLX90393Acquisition*>(arg)->OnDataReady();
+}
+
+void IRAM_ATTR MLX90393Acquisition::OnDataReady() {
+  interrupt_time_us_.Publish(micros());
+#ifdef ARDUINO_ARCH_ESP32
+  if (task_ != nullptr) {
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(task_, &woken);
+    portYIELD_FROM_ISR(woken);
+  }
+#endif
+}
+
+bool MLX90393Acquisition::Service() {
+  uint32_t timestamp_us;
+  const uint32_t seen = interrupt_time_us_.Read(timestamp_us);
+  if (seen == serviced_) return false;
+  // Each interrupt beyond the first means a conversion that was overwritten
+  // before we got to it. Only the newest can still be read.
+  missed_conversions_ += seen - serviced_ - 1;
+  serviced_ = seen;
+
+  FieldSample sample;
+  if (!sensor_->readMeasurement(MLX90393_X | MLX90393_Y, sample.field)) {
+    ++read_failures_;
+    return false;
+  }
+  sample.timestamp_us = timestamp_us;
+  sample.sequence = ++samples_;
+  latest_.Publish(sample);
+  return true;
+}
+
+bool MLX90393Acquisition::TryConsume(FieldSample& sample) {
+  FieldSample latest;
+  const uint32_t sequence = latest_.Read(latest);
+  if (sequence == consumed_) return false;
+  skipped_ += sequence - consumed_ - 1;
+  consumed_ = sequence;
+  sample = latest;
+  return true;
+}
+
+}  // namespace motor
@@ -0,0 +1,123 @@
+#ifndef MOTOR_MLX90393_ACQUISITION_H
+#define MOTOR_MLX90393_ACQUISITION_H
+
+#include <Arduino.h>
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+#include "Adafruit_MLX90393.h"
+#include "double_buffer.h"
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+namespace motor {
+
+// One X/Y field sample.
+struct FieldSample {
+  std::array<float, 2> field;
+
+  // When the sensor signalled that the conversion was ready.
+  uint32_t timestamp_us;
+
+  // Counts samples read since Begin, starting at 1.
+  uint32_t sequence;
+};
+
+// Reads the MLX90393 as soon as each burst-mode conversion completes, rather
+// than polling it. The sensor's INT pin (with setTrigInt(true) and burst mode
+// on) raises a data-ready interrupt, which only records the time. A reader
+// then fetches the sample over the bus and publishes it to a double buffer,
+// from which MLX90393Sensor::Update takes the latest sample without touching
+// the bus.
+//
+// The reader is Service(). On the ESP32, StartTask runs it in a task that the
+// interrupt wakes; elsewhere (e.g. in tests) call it directly.
+//
+// The reader must finish each read within one conversion period. If a second
+// data-ready interrupt arrives before the first was serviced, the first
+// conversion is lost and counted in missed_conversions().
+class MLX90393Acquisition {
+ public:
+  explicit MLX90393Acquisition(Adafruit_MLX90393* sensor) : sensor_(sensor) {}
+  ~MLX90393Acquisition();
+
+  MLX90393Acquisition(const MLX90393Acquisition&) = delete;
+  MLX90393Acquisition& operator=(const MLX90393Acquisition&) = delete;
+
+  // Attaches the data-ready interrupt to drdy_pin.
+  void Begin(int drdy_pin);
+
+#ifdef ARDUINO_ARCH_ESP32
+  // Starts a task that runs Service whenever the interrupt fires. The
+  // priority should be above the control loop's, so a sample is ready by the
+  // time the loop wants it.
+  bool StartTask(UBaseType_t priority, uint32_t stack_size = 2048);
+
+  // As above, but the task runs on the given stack and control block instead
+  // of ones allocated from the heap. Both must outlive the task.
+  bool StartTask(UBaseType_t priority, std::span<StackType_t> stack,
+                 StaticTask_t* task_buffer);
+
+  // The reader task, or null if it has not been started.
+  TaskHandle_t task() const { return task_; }
+#endif
+
+  // The interrupt handler. Safe to call from an interrupt.
+  void OnDataReady();
+
+  // If a data-ready interrupt has arrived since the last call, reads the
+  // sample and publishes it. Returns true if a sample was published.
+  bool Service();
+
+  // If a sample newer than the last one returned is available, copies it to
+  // sample and returns true. Never blocks and never touches the bus.
+  bool TryConsume(FieldSample& sample);
+
+  // Data-ready interrupts seen.
+  uint32_t interrupts() const { return interrupt_time_us_.published(); }
+  // Conversions overwritten in the sensor before Service read them.
+  uint32_t missed_conversions() const { return missed_conversions_; }
+  // Reads that failed on the bus.
+  uint32_t read_failures() const { return read_failures_; }
+  // Samples replaced by a newer one before TryConsume saw them.
+  uint32_t skipped() const { return skipped_; }
+
+ private:
+  static void IRAM_ATTR OnDataReadyTrampoline(void* arg);
+#ifdef ARDUINO_ARCH_ESP32
+  static void TaskMain(void* arg);
+#endif
+
+  Adafruit_MLX90393* const sensor_;
+  int drdy_pin_ = -1;
+
+  // The time of the latest data-ready interrupt, published by the interrupt.
+  // Its sequence counts the interrupts, so Service reads the count and the
+  // time that goes with it in one consistent snapshot.
+  DoubleBuffer<uint32_t> interrupt_time_us_;
+
+  // Owned by Service.
+  uint32_t serviced_ = 0;
+  uint32_t samples_ = 0;
+  uint32_t missed_conversions_ = 0;
+  uint32_t read_failures_ = 0;
+
+  DoubleBuffer<FieldSample> latest_;
+
+  // Owned by TryConsume.
+  uint32_t consumed_ = 0;
+  uint32_t skipped_ = 0;
+
+#ifdef ARDUINO_ARCH_ESP32
+  TaskHandle_t task_ = nullptr;
+#endif
+};
+
+}  // namespace motor
+
+#endif  // MOTOR_MLX90393_ACQUISITION_H
@@ -3,7 +3,16 @@
 #include <cmath>
 #include <format>
 
+#include "vector_angle.h"
+
 namespace motor {
+namespace {
+
+// The field is converted to integers for the angle engine. Only the ratio of
+// X to Y matters, so we scale up first to keep fractions of a microtesla.
+constexpr float kFieldScale = 16;
+
+}  // namespace
 
 SQ15x16 VectorToAngleDecidegrees(float x, float y) {
   if (x == 0.0 && y == 0.0) {
@@ -21,37 +30,51 @@ SQ15x16 VectorToAngleDecidegrees(float x, float y) {
   return angle;
 }
 
-bool MLX90393Sensor::Update() {
-  std::array<float, 2> data;
-  if (!sensor_->readMeasurement(MLX90393_X | MLX90393_Y, data)) {
-    return false;
-  }
-
-  // Note we only update sample time when we can successfully take a sample.
-  const uint64_t t = micros();
-  const SQ15x16 dt_ms = SQ15x16{SFixed<24, 4>{t - t_} / 1'000};
-  t_ = t;
+void FieldAngleTracker::Add(const std::array<float, 2>& field,
+                            uint32_t timestamp_us) {
+  // Only samples that were actually taken get here, so after a failed read
+  // dt spans the gap back to the last good one.
+  const SQ15x16 dt_ms = SQ15x16{SFixed<24, 4>{timestamp_us - t_} / 1'000};
+  t_ = timestamp_us;
 
-  const SQ15x16 newangle = VectorToAngleDecidegrees(data[0], data[1]);
+  const SQ15x16 newangle =
+      VectorToAngleFixed(static_cast<int32_t>(field[0] * kFieldScale),
+                         static_cast<int32_t>(field[1] * kFieldScale));
   const SQ15x16 delta = newangle - rawangle_;
   rawangle_ = newangle;
 
-  SQ15x16 corrected_delta;
-  if (absFixed(delta) < 180) {
-    // If the delta was less than 180, we'll assume that it's a normal move --
-    // that is, the sensor did not wrap around.
-    corrected_delta = delta;
-  } else {
-    // If the move was more than 180 degrees, we assume that we've wrapped
-    // around. That means the *sign* of the move is the opposite delta, and the
-    // magnitude is 360 - abs(delta).
-    corrected_delta = (delta > 0 ? -360 + delta : 360 + delta);
-  }
+  const SQ15x16 corrected_delta = UnwrapAngleDelta(delta);
 
   // Since we want to accumulate the total angle, we add the adjusted delta.
   angle_ += corrected_delta;
-  speed_ = corrected_delta * dt_ms;
 
+  // The first sample is measured against an arbitrary starting angle, so it
+  // says nothing about the rate.
+  if (has_sample_) {
+    speed_ = estimator_->Update(corrected_delta, dt_ms);
+  } else {
+    estimator_->Reset();
+    has_sample_ = true;
+  }
+}
+
+bool MLX90393Sensor::Update() {
+  std::array<float, 2> data;
+  uint32_t t;
+  if (acquisition_ != nullptr) {
+    FieldSample sample;
+    if (!acquisition_->TryConsume(sample)) return false;
+    data = sample.field;
+    t = sample.timestamp_us;
+  } else {
+    if (!sensor_->readMeasurement(MLX90393_X | MLX90393_Y, data)) {
+      return false;
+    }
+    t = micros();
+  }
+
+  if (recorder_ != nullptr) recorder_->RecordSample(t, data);
+  tracker_.Add(data, t);
   return true;
 }
 
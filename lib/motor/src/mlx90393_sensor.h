@@ -4,36 +4,106 @@
 #include <Arduino.h>
 #include <FixedPointsCommon.h>
 
+#include <array>
+#include <cstdint>
+
 #include "Adafruit_MLX90393.h"
+#include "mlx90393_acquisition.h"
 #include "sensor.h"
+#include "trace.h"
+#include "velocity_estimator.h"
 
 namespace motor {
 
-class MLX90393Sensor : public Sensor {
+// Returns the angle of the vector (x, y) in degrees, between 0 and 360. This is
+// the double precision reference for the integer engines in vector_angle.h.
+SQ15x16 VectorToAngleDecidegrees(float x, float y);
+
+// Given the difference between two absolute angles in [0, 360), returns the
+// shortest signed move between them.
+inline SQ15x16 UnwrapAngleDelta(SQ15x16 delta) {
+  if (absFixed(delta) < 180) {
+    // If the delta was less than 180, we'll assume that it's a normal move --
+    // that is, the sensor did not wrap around.
+    return delta;
+  }
+  // If the move was more than 180 degrees, we assume that we've wrapped
+  // around. That means the *sign* of the move is the opposite delta, and the
+  // magnitude is 360 - abs(delta).
+  return delta > 0 ? -360 + delta : 360 + delta;
+}
+
+// Turns successive X/Y field samples into an accumulated angle and a rate.
+// This is the part of MLX90393Sensor that does not touch the hardware, so
+// recorded samples (see ReplaySensor) go through exactly the same arithmetic.
+class FieldAngleTracker {
+ public:
+  // The rate is estimated by estimator, which is not owned. If it is null, a
+  // FirstDifferenceEstimator is used.
+  explicit FieldAngleTracker(VelocityEstimator* estimator = nullptr)
+      : estimator_(estimator != nullptr ? estimator : &first_difference_) {}
+
+  FieldAngleTracker(const FieldAngleTracker&) = delete;
+  FieldAngleTracker& operator=(const FieldAngleTracker&) = delete;
+
+  // Takes a field sample in microtesla, read at timestamp_us.
+  void Add(const std::array<float, 2>& field, uint32_t timestamp_us);
+
+  SQ15x16 angle() const { return angle_; }
+  SQ15x16 rate() const { return speed_; }
+  void SetAngle(SQ15x16 angle) { angle_ = angle; }
+
+ private:
+  FirstDifferenceEstimator first_difference_;
+  VelocityEstimator* const estimator_;
+  bool has_sample_ = false;
+
+  uint32_t t_ = 0;        // When the last sample was taken.
+  SQ15x16 rawangle_ = 0;  // The last sensed angle.
+  SQ15x16 angle_ = 0;     // The total angle accumulated since startup.
+  SQ15x16 speed_ = 0;
+};
+
+class MLX90393Sensor final : public Sensor {
  public:
-  MLX90393Sensor(Adafruit_MLX90393* sensor) : sensor_(sensor) {}
+  // Polls sensor on each Update. The rate is estimated by estimator, which is
+  // not owned. If it is null, a FirstDifferenceEstimator is used.
+  MLX90393Sensor(Adafruit_MLX90393* sensor,
+                 VelocityEstimator* estimator = nullptr)
+      : sensor_(sensor), tracker_(estimator) {}
+
+  // Takes samples from an interrupt-driven acquisition instead, and uses the
+  // time each conversion completed rather than the time of the Update.
+  MLX90393Sensor(MLX90393Acquisition* acquisition,
+                 VelocityEstimator* estimator = nullptr)
+      : acquisition_(acquisition), tracker_(estimator) {}
+
   ~MLX90393Sensor() override {}
 
+  // Takes a new sample. Returns false if none was available: the read failed
+  // or, with an acquisition, no conversion has completed since the last
+  // Update.
   bool Update();
 
   // Returns the current angle of the in decidegrees. Note that this is the
   // total accumulated angle since startup. The absolute angle is not provided.
-  SQ15x16 angle() override { return angle_; }
+  SQ15x16 angle() override { return tracker_.angle(); }
 
-  // Returns the rate of rotation in degrees/sec during the last sensing
-  // period. Positive is clockwise.
-  SQ15x16 rate() override { return speed_; }
+  // Returns the rate of rotation in degrees/sec, as estimated by the
+  // VelocityEstimator. Positive is clockwise.
+  SQ15x16 rate() override { return tracker_.rate(); }
 
-  void SetAngle(SQ15x16 angle) override { angle_ = angle; };
+  void SetAngle(SQ15x16 angle) override { tracker_.SetAngle(angle); };
 
- private:
-  Adafruit_MLX90393* const sensor_;
+  // Records every sample taken into recorder, which is not owned. Pass null
+  // to stop.
+  void set_recorder(TraceRecorder* recorder) { recorder_ = recorder; }
 
-  // Last angle reading in decidegrees.
-  int64_t t_ = micros();
-  SQ15x16 rawangle_ = 0;  // The last sensed angle.
-  SQ15x16 angle_ = 0;     // The total angle accumulated since startup.
-  SQ15x16 speed_ = 0;
+ private:
+  Adafruit_MLX90393* const sensor_ = nullptr;
+  MLX90393Acquisition* const acquisition_ = nullptr;
+  TraceRecorder* recorder_ = nullptr;
+  FieldAngleTracker tracker_;
 };
 
 }  // namespace motor
@@ -1,6 +1,7 @@
 #ifndef MOTOR_MOTOR_H
 #define MOTOR_MOTOR_H
 
+#include <concepts>
 #include <cstdint>
 
 namespace motor {
@@ -27,8 +28,27 @@ class Motor {
 
   // Sets the motor duty cycle.
   virtual void SetDuty(int duty) = 0;
+
+  // Drives the motor with a signed effort. Positive efforts turn the motor
+  // clockwise and negative efforts counterclockwise; the magnitude is the duty
+  // cycle. Implementations should override this if they can avoid rewriting
+  // the direction on every call.
+  virtual void SetEffort(int effort) {
+    SetDirection(effort < 0 ? kCounterClockwise : kClockwise);
+    SetDuty(effort < 0 ? -effort : effort);
+  }
+};
+
+// What a controller needs from a motor. Motor satisfies it through virtual
+// calls; a concrete driver (declared final, or not derived from Motor at
+// all) satisfies it with calls the compiler can inline into the control
+// loop.
+template <typename M>
+concept MotorLike = requires(M& motor, int effort, StopMode mode) {
+  motor.SetEffort(effort);
+  motor.Stop(mode);
 };
 
 }  // namespace motor
 
-#endif  // MOTOR_MOTOR_H
\ No newline at end of file
+#endif  // MOTOR_MOTOR_H
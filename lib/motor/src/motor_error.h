@@ -0,0 +1,62 @@
+#ifndef MOTOR_MOTOR_ERROR_H
+#define MOTOR_MOTOR_ERROR_H
+
+#include <cstdint>
+#include <utility>
+
+#include "error.h"
+
+#if !INTPID_NO_HEAP
+#include <string>
+#endif
+
+namespace motor {
+
+// Everything the motor factories can reject. Like intpid's Error, these are
+// reported as messages by default and as bare codes with INTPID_NO_HEAP.
+enum class Error : uint8_t {
+  kMissingMotorOrSensor,
+  kBadPositionDivider,
+  // intpid rejected the config of one of the loops.
+  kBadVelocityLoop,
+  kBadPositionLoop,
+};
+
+constexpr const char* ErrorMessage(Error error) {
+  switch (error) {
+    case Error::kMissingMotorOrSensor:
+      return "FeedbackMotor needs a motor and a sensor";
+    case Error::kBadPositionDivider:
+      return "position_divider must be at least 1";
+    case Error::kBadVelocityLoop:
+      return "bad velocity loop config";
+    case Error::kBadPositionLoop:
+      return "bad position loop config";
+  }
+  return "unknown error";
+}
+
+#if INTPID_NO_HEAP
+using ErrorType = Error;
+
+inline ErrorType MakeError(Error error) { return error; }
+
+// The loop's code alone; intpid's code for what it rejected is dropped.
+inline ErrorType LoopError(Error loop,
+                           [[maybe_unused]] intpid::ErrorType error) {
+  return loop;
+}
+#else
+using ErrorType = std::string;
+
+inline ErrorType MakeError(Error error) { return ErrorMessage(error); }
+
+// intpid's message, prefixed with which loop it came from.
+inline ErrorType LoopError(Error loop, intpid::ErrorType error) {
+  return intpid::WithContext(ErrorMessage(loop), std::move(error));
+}
+#endif
+
+}  // namespace motor
+
+#endif  // MOTOR_MOTOR_ERROR_H
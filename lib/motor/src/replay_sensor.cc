@@ -0,0 +1,18 @@
+#include "replay_sensor.h"
+
+namespace motor {
+
+bool ReplaySensor::Update() {
+  const size_t i = FindSample(next_);
+  if (i == events_.size()) {
+    next_ = i;
+    return false;
+  }
+  const TraceEvent& sample = events_[i];
+  timestamp_us_ = sample.timestamp_us;
+  tracker_.Add(sample.field, sample.timestamp_us);
+  next_ = i + 1;
+  return true;
+}
+
+}  // namespace motor
@@ -0,0 +1,70 @@
+#ifndef MOTOR_REPLAY_SENSOR_H
+#define MOTOR_REPLAY_SENSOR_H
+
+#include <FixedPointsCommon.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "mlx90393_sensor.h"
+#include "sensor.h"
+#include "trace.h"
+#include "velocity_estimator.h"
+
+namespace motor {
+
+// A Sensor that plays back the field samples of a recorded trace (see
+// trace.h) instead of reading hardware. Each Update takes the next sample
+// through the same arithmetic as MLX90393Sensor, with the timestamps it was
+// recorded at, so the angles and rates match the board's exactly. Nothing
+// waits on the clock: a trace replays as fast as Update is called.
+class ReplaySensor final : public Sensor {
+ public:
+  // events is not copied and must outlive the sensor. Events other than
+  // samples are skipped. The rate is estimated by estimator, which is not
+  // owned. If it is null, a FirstDifferenceEstimator is used.
+  explicit ReplaySensor(std::span<const TraceEvent> events,
+                        VelocityEstimator* estimator = nullptr)
+      : events_(events), tracker_(estimator) {}
+
+  ~ReplaySensor() override {}
+
+  // Takes the next sample. Returns false once the trace is exhausted.
+  bool Update();
+
+  // Starts the trace over, e.g. to loop it in a benchmark. The angle carries
+  // on from where it is; the rate across the jump back in time is
+  // meaningless.
+  void Rewind() { next_ = 0; }
+
+  // True once every sample has been taken.
+  bool done() const { return FindSample(next_) == events_.size(); }
+
+  // When the last sample taken was recorded, in microseconds.
+  uint32_t timestamp_us() const { return timestamp_us_; }
+
+  // The index in the trace of the next event to look at. Commands between
+  // the last sample and this index were issued in response to it.
+  size_t position() const { return next_; }
+
+  SQ15x16 angle() override { return tracker_.angle(); }
+  SQ15x16 rate() override { return tracker_.rate(); }
+  void SetAngle(SQ15x16 angle) override { tracker_.SetAngle(angle); }
+
+ private:
+  // Returns the index of the first sample at or after i, or events_.size().
+  size_t FindSample(size_t i) const {
+    while (i < events_.size() && events_[i].kind != TraceEvent::kSample) ++i;
+    return i;
+  }
+
+  const std::span<const TraceEvent> events_;
+  size_t next_ = 0;
+  uint32_t timestamp_us_ = 0;
+  FieldAngleTracker tracker_;
+};
+
+}  // namespace motor
+
+#endif  // MOTOR_REPLAY_SENSOR_H
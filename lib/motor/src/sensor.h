@@ -1,6 +1,10 @@
 #ifndef MOTOR_SENSOR_H
 #define MOTOR_SENSOR_H
 
+#include <FixedPointsCommon.h>
+
+#include <concepts>
+
 namespace motor {
 
 class Sensor {
@@ -18,6 +22,13 @@ class Sensor {
   virtual void SetAngle(SQ15x16 angle = 0) = 0;
 };
 
+// What a controller needs from a sensor; see MotorLike.
+template <typename S>
+concept SensorLike = requires(S& sensor) {
+  { sensor.angle() } -> std::convertible_to<SQ15x16>;
+  { sensor.rate() } -> std::convertible_to<SQ15x16>;
+};
+
 }  // namespace motor
 
 #endif  // MOTOR_SENSOR_H
\ No newline at end of file
@@ -26,6 +26,7 @@ void ThreeWireMotor::Stop(StopMode mode) {
       break;
   }
   analogWrite(pwm_pin_, 0);
+  driving_ = false;
 }
 
 void ThreeWireMotor::SetDirection(Direction direction) {
@@ -39,8 +40,16 @@ void ThreeWireMotor::SetDirection(Direction direction) {
       digitalWrite(reverse_pin_, HIGH);
       break;
   }
+  direction_ = direction;
+  driving_ = true;
 }
 
 void ThreeWireMotor::SetDuty(int duty) { analogWrite(pwm_pin_, duty); }
 
-}  // namespace motor
\ No newline at end of file
+void ThreeWireMotor::SetEffort(int effort) {
+  const Direction direction = effort < 0 ? kCounterClockwise : kClockwise;
+  if (!driving_ || direction != direction_) SetDirection(direction);
+  SetDuty(effort < 0 ? -effort : effort);
+}
+
+}  // namespace motor
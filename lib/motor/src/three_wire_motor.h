@@ -5,7 +5,7 @@
 
 namespace motor {
 
-class ThreeWireMotor : public Motor {
+class ThreeWireMotor final : public Motor {
  public:
   // Creates a motor with the given pins.
   ThreeWireMotor(int pwm_pin, int fw_pin, int rev_pin);
@@ -20,12 +20,21 @@ class ThreeWireMotor : public Motor {
   // analogWriteResolution of the pwm_pin_.
   void SetDuty(int duty) override;
 
+  // Only writes the direction pins when the sign of the effort changes, so
+  // steady-state updates cost a single analogWrite.
+  void SetEffort(int effort) override;
+
  private:
   const int pwm_pin_;
   const int forward_pin_;
   const int reverse_pin_;
+
+  // The direction the pins are set for. Only meaningful if driving_ is set;
+  // Stop() leaves the pins in a brake or coast state.
+  Direction direction_ = kClockwise;
+  bool driving_ = false;
 };
 
 }  // namespace motor
 
-#endif  // MOTOR_THREE_WIRE_MOTOR_H
\ No newline at end of file
+#endif  // MOTOR_THREE_WIRE_MOTOR_H
@@ -0,0 +1,47 @@
+#include "trace.h"
+
+#include <Arduino.h>
+
+#include <bit>
+
+namespace motor {
+namespace {
+
+void PutU32(uint32_t v, uint8_t* out) {
+  for (int i = 0; i < 4; ++i) out[i] = v >> (8 * i);
+}
+
+}  // namespace
+
+void EncodeTraceEvent(const TraceEvent& event, uint8_t* out) {
+  PutU32(event.timestamp_us, out);
+  out[4] = event.kind;
+  out[5] = event.kind >> 8;
+  const uint16_t command = event.command;
+  out[6] = command;
+  out[7] = command >> 8;
+  PutU32(std::bit_cast<uint32_t>(event.field[0]), out + 8);
+  PutU32(std::bit_cast<uint32_t>(event.field[1]), out + 12);
+}
+
+void TracingMotor::Stop(StopMode mode) {
+  recorder_->RecordCommand(micros(), TraceEvent::kStop, mode);
+  motor_->Stop(mode);
+}
+
+void TracingMotor::SetDirection(Direction direction) {
+  recorder_->RecordCommand(micros(), TraceEvent::kSetDirection, direction);
+  motor_->SetDirection(direction);
+}
+
+void TracingMotor::SetDuty(int duty) {
+  recorder_->RecordCommand(micros(), TraceEvent::kSetDuty, duty);
+  motor_->SetDuty(duty);
+}
+
+void TracingMotor::SetEffort(int effort) {
+  recorder_->RecordCommand(micros(), TraceEvent::kSetEffort, effort);
+  motor_->SetEffort(effort);
+}
+
+}  // namespace motor
@@ -0,0 +1,202 @@
+#ifndef MOTOR_TRACE_H
+#define MOTOR_TRACE_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "log_format.h"
+#include "motor.h"
+
+// Record and replay of what the motor loop saw and did: the raw X/Y field
+// samples from the MLX90393 with their timestamps, and every command sent to
+// the motor. A trace captured on the board reproduces a control bug on the
+// host, where ReplaySensor (replay_sensor.h) feeds it back through the same
+// angle and rate arithmetic at full speed.
+//
+// A trace dumps as:
+//
+//   "TRCE" u8:version u32:num_events event* u16:checksum
+//   event: u32:timestamp_us u16:kind i16:command f32:x f32:y
+//
+// Every field is little-endian, and the checksum is Fletcher-16 over the
+// events. The dump can sit in the middle of other serial output; ParseTrace
+// (trace_reader.h, host only) looks for the magic.
+namespace motor {
+
+struct TraceEvent {
+  enum Kind : uint16_t {
+    // A field sample. field holds X and Y in microtesla.
+    kSample,
+    // A call to Motor::SetDuty, SetDirection, Stop or SetEffort. command
+    // holds the duty, Direction, StopMode or effort.
+    kSetDuty,
+    kSetDirection,
+    kStop,
+    kSetEffort,
+  };
+
+  // micros() when the sample was taken or the command issued.
+  uint32_t timestamp_us;
+  Kind kind;
+  int16_t command;
+  std::array<float, 2> field;
+};
+
+static_assert(sizeof(TraceEvent) == 16);
+
+constexpr uint8_t kTraceMagic[4] = {'T', 'R', 'C', 'E'};
+constexpr uint8_t kTraceVersion = 1;
+constexpr size_t kTraceHeaderSize = 9;
+constexpr size_t kTraceEventSize = 16;
+
+// Captures events into a caller-provided buffer. Recording is a handful of
+// stores and never allocates, so it can stay on in the control loop.
+//
+// Several tasks may record at once, e.g. the control loop its samples and
+// another task its commands: each event claims its slot with one atomic
+// increment. Stop recording (set_recording(false)) before reading the events
+// or dumping them.
+class TraceRecorder {
+ public:
+  enum Mode {
+    // Keeps the first events and drops the rest once the buffer is full, to
+    // capture what follows a known start.
+    kKeepFirst,
+    // Overwrites the oldest events, so the buffer always holds the latest,
+    // e.g. the moments before a fault.
+    kKeepLatest,
+  };
+
+  explicit TraceRecorder(std::span<TraceEvent> buffer, Mode mode = kKeepFirst)
+      : buffer_(buffer), mode_(mode) {}
+
+  TraceRecorder(const TraceRecorder&) = delete;
+  TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+  void RecordSample(uint32_t timestamp_us, const std::array<float, 2>& field) {
+    Record({.timestamp_us = timestamp_us,
+            .kind = TraceEvent::kSample,
+            .command = 0,
+            .field = field});
+  }
+
+  // Commands are saturated to the range of int16_t.
+  void RecordCommand(uint32_t timestamp_us, TraceEvent::Kind kind,
+                     int command) {
+    Record({.timestamp_us = timestamp_us,
+            .kind = kind,
+            .command = static_cast<int16_t>(
+                std::clamp<int>(command, INT16_MIN, INT16_MAX)),
+            .field = {}});
+  }
+
+  // While false, Record calls are ignored.
+  void set_recording(bool recording) {
+    recording_.store(recording, std::memory_order_release);
+  }
+  bool recording() const {
+    return recording_.load(std::memory_order_acquire);
+  }
+
+  // The number of events held, at most capacity().
+  size_t size() const { return std::min<size_t>(recorded(), buffer_.size()); }
+  size_t capacity() const { return buffer_.size(); }
+  bool full() const { return recorded() >= buffer_.size(); }
+
+  // Events dropped (kKeepFirst) or overwritten (kKeepLatest) for lack of
+  // room.
+  uint32_t dropped() const { return recorded() - size(); }
+
+  // Forgets every event and starts recording again.
+  void Clear() {
+    recorded_.store(0, std::memory_order_relaxed);
+    set_recording(true);
+  }
+
+  // Returns the i-th oldest event held.
+  const TraceEvent& operator[](size_t i) const {
+    if (mode_ == kKeepFirst || !full()) return buffer_[i];
+    return buffer_[(recorded() + i) % buffer_.size()];
+  }
+
+  // Encodes the events held, oldest first, and passes the bytes to
+  // write(const uint8_t* data, size_t size) in pieces of at most
+  // kTraceEventSize bytes, e.g. to Serial.write.
+  template <typename Write>
+  void Dump(Write&& write) const;
+
+ private:
+  uint32_t recorded() const {
+    return recorded_.load(std::memory_order_acquire);
+  }
+
+  void Record(const TraceEvent& event) {
+    if (!recording() || buffer_.empty()) return;
+    const uint32_t n = recorded_.fetch_add(1, std::memory_order_acq_rel);
+    if (n < buffer_.size()) {
+      buffer_[n] = event;
+    } else if (mode_ == kKeepLatest) {
+      buffer_[n % buffer_.size()] = event;
+    }
+  }
+
+  const std::span<TraceEvent> buffer_;
+  const Mode mode_;
+  std::atomic<bool> recording_{true};
+  // Every event recorded since the last Clear, including those dropped.
+  std::atomic<uint32_t> recorded_{0};
+};
+
+// Writes event to out in the dump format.
+void EncodeTraceEvent(const TraceEvent& event, uint8_t* out);
+
+template <typename Write>
+void TraceRecorder::Dump(Write&& write) const {
+  uint8_t bytes[kTraceEventSize];
+  const uint32_t count = size();
+  bytes[0] = kTraceMagic[0];
+  bytes[1] = kTraceMagic[1];
+  bytes[2] = kTraceMagic[2];
+  bytes[3] = kTraceMagic[3];
+  bytes[4] = kTraceVersion;
+  for (int i = 0; i < 4; ++i) bytes[5 + i] = count >> (8 * i);
+  write(static_cast<const uint8_t*>(bytes), kTraceHeaderSize);
+
+  uint16_t checksum = 0;
+  for (size_t i = 0; i < count; ++i) {
+    EncodeTraceEvent((*this)[i], bytes);
+    checksum = telemetry::Fletcher16(bytes, kTraceEventSize, checksum);
+    write(static_cast<const uint8_t*>(bytes), kTraceEventSize);
+  }
+  bytes[0] = checksum;
+  bytes[1] = checksum >> 8;
+  write(static_cast<const uint8_t*>(bytes), size_t{2});
+}
+
+// A Motor that records every command into a TraceRecorder and then passes it
+// on to the real motor. Neither is owned.
+class TracingMotor : public Motor {
+ public:
+  TracingMotor(Motor* motor, TraceRecorder* recorder)
+      : motor_(motor), recorder_(recorder) {}
+
+  void Stop(StopMode mode = kCoast) override;
+  void SetDirection(Direction direction) override;
+  void SetDuty(int duty) override;
+
+  // Recorded as one event and passed on as one call, so the motor's own
+  // SetEffort still decides which pins to write.
+  void SetEffort(int effort) override;
+
+ private:
+  Motor* const motor_;
+  TraceRecorder* const recorder_;
+};
+
+}  // namespace motor
+
+#endif  // MOTOR_TRACE_H
@@ -0,0 +1,144 @@
+#include "vector_angle.h"
+
+#include <cstdint>
+
+namespace motor {
+namespace {
+
+// Angles in this file are the raw representation of SQ15x16 degrees.
+constexpr int32_t kDeg90 = int32_t{90} << 16;
+constexpr int32_t kDeg180 = int32_t{180} << 16;
+constexpr int32_t kDeg360 = int32_t{360} << 16;
+
+// atan(2^-i) in degrees.
+constexpr int32_t kCordicAngles[] = {
+    2949120, 1740967, 919879, 466945, 234379, 117304, 58666, 29335,
+    14668,   7334,    3667,   1833,   917,    458,    229,   115,
+    57,      29,      14,     7,      4,      2,
+};
+static_assert(MOTOR_CORDIC_ITERATIONS > 0 &&
+                  MOTOR_CORDIC_ITERATIONS <=
+                      sizeof(kCordicAngles) / sizeof(kCordicAngles[0]),
+              "MOTOR_CORDIC_ITERATIONS out of range");
+
+// atan(i / 128) in degrees, for i in [0, 128].
+constexpr int kTableBits = 7;
+constexpr int32_t kAtanTable[(1 << kTableBits) + 1] = {
+    0, 29335, 58666, 87990, 117304, 146603, 175884, 205144,
+    234379, 263585, 292760, 321899, 350999, 380058, 409070, 438034,
+    466945, 495801, 524598, 553333, 582003, 610605, 639135, 667591,
+    695970, 724268, 752484, 780613, 808654, 836604, 864460, 892219,
+    919879, 947438, 974893, 1002241, 1029481, 1056611, 1083627, 1110529,
+    1137313, 1163979, 1190524, 1216947, 1243245, 1269417, 1295461, 1321376,
+    1347161, 1372813, 1398332, 1423717, 1448965, 1474076, 1499049, 1523882,
+    1548575, 1573127, 1597536, 1621803, 1645926, 1669904, 1693738, 1717426,
+    1740967, 1764362, 1787610, 1810710, 1833663, 1856467, 1879123, 1901631,
+    1923990, 1946200, 1968261, 1990173, 2011937, 2033552, 2055018, 2076336,
+    2097505, 2118526, 2139399, 2160125, 2180703, 2201134, 2221419, 2241558,
+    2261551, 2281398, 2301101, 2320659, 2340074, 2359345, 2378474, 2397460,
+    2416306, 2435010, 2453574, 2471999, 2490285, 2508433, 2526443, 2544317,
+    2562055, 2579658, 2597126, 2614461, 2631664, 2648734, 2665673, 2682482,
+    2699161, 2715711, 2732134, 2748430, 2764600, 2780644, 2796564, 2812361,
+    2828035, 2843587, 2859019, 2874330, 2889523, 2904597, 2919554, 2934395,
+    2949120,
+};
+
+int BitWidth(uint32_t v) { return v == 0 ? 0 : 32 - __builtin_clz(v); }
+
+uint32_t Abs(int32_t v) {
+  return v < 0 ? uint32_t{0} - static_cast<uint32_t>(v)
+               : static_cast<uint32_t>(v);
+}
+
+// Maps an angle in [0, 90] degrees measured from the positive X axis onto the
+// quadrant given by the signs of x and y.
+int32_t ToQuadrant(int32_t first_quadrant_angle, int32_t x, int32_t y) {
+  int32_t angle;
+  if (x >= 0) {
+    angle = y >= 0 ? first_quadrant_angle : kDeg360 - first_quadrant_angle;
+  } else {
+    angle = y >= 0 ? kDeg180 - first_quadrant_angle
+                   : kDeg180 + first_quadrant_angle;
+  }
+  return angle >= kDeg360 ? angle - kDeg360 : angle;
+}
+
+}  // namespace
+
+SQ15x16 VectorToAngleCordic(int32_t x, int32_t y) {
+  if (x == 0 && y == 0) return 0;
+
+  uint32_t ux = Abs(x);
+  uint32_t uy = Abs(y);
+
+  // Normalize so the larger component is in [2^28, 2^29). This uses the full
+  // word for precision while leaving room for the CORDIC gain (~1.65) and the
+  // first rotation (up to sqrt(2)).
+  const int shift = BitWidth(ux > uy ? ux : uy) - 29;
+  if (shift > 0) {
+    ux >>= shift;
+    uy >>= shift;
+  } else {
+    ux <<= -shift;
+    uy <<= -shift;
+  }
+
+  // Rotate (ux, uy), which is in the first quadrant, onto the X axis.
+  int32_t cx = static_cast<int32_t>(ux);
+  int32_t cy = static_cast<int32_t>(uy);
+  int32_t z = 0;
+  for (int i = 0; i < MOTOR_CORDIC_ITERATIONS; ++i) {
+    const int32_t dx = cy >> i;
+    const int32_t dy = cx >> i;
+    if (cy > 0) {
+      cx += dx;
+      cy -= dy;
+      z += kCordicAngles[i];
+    } else {
+      cx -= dx;
+      cy += dy;
+      z -= kCordicAngles[i];
+    }
+  }
+  if (z < 0) z = 0;
+  if (z > kDeg90) z = kDeg90;
+  return SQ15x16::fromInternal(ToQuadrant(z, x, y));
+}
+
+SQ15x16 VectorToAngleTable(int32_t x, int32_t y) {
+  if (x == 0 && y == 0) return 0;
+
+  uint32_t ux = Abs(x);
+  uint32_t uy = Abs(y);
+  const bool steep = uy > ux;
+  uint32_t hi = steep ? uy : ux;
+  uint32_t lo = steep ? ux : uy;
+
+  // Keep hi below 2^16 so the ratio can be formed in 32 bits. Rounding (rather
+  // than truncating) halves the error this adds for large inputs.
+  const int shift = BitWidth(hi) - 16;
+  if (shift > 0) {
+    const uint32_t half = uint32_t{1} << (shift - 1);
+    hi = (hi + half) >> shift;
+    lo = (lo + half) >> shift;
+    if (hi == 0x10000) {
+      hi >>= 1;
+      lo >>= 1;
+    }
+  }
+
+  // ratio = lo / hi in [0, 1] with 16 fractional bits, rounded to nearest.
+  const uint32_t ratio = ((lo << 16) + hi / 2) / hi;
+  constexpr int kFracBits = 16 - kTableBits;
+  const uint32_t index = ratio >> kFracBits;
+  const int32_t frac = static_cast<int32_t>(ratio & ((1u << kFracBits) - 1));
+  int32_t angle = kAtanTable[index];
+  if (frac != 0) {
+    angle += ((kAtanTable[index + 1] - angle) * frac) >> kFracBits;
+  }
+
+  if (steep) angle = kDeg90 - angle;
+  return SQ15x16::fromInternal(ToQuadrant(angle, x, y));
+}
+
+}  // namespace motor
@@ -0,0 +1,53 @@
+#ifndef MOTOR_VECTOR_ANGLE_H
+#define MOTOR_VECTOR_ANGLE_H
+
+#include <FixedPointsCommon.h>
+
+#include <cstdint>
+
+// Integer-only replacements for VectorToAngleDecidegrees. These avoid float
+// and double math entirely, which matters on parts without an FPU (e.g. the
+// ESP32-C6), where atan2 on doubles is the slowest step in the sensing loop.
+//
+// All functions take the raw X and Y components of a vector. Only the ratio of
+// the two matters, so any consistent unit works; small magnitudes (under a few
+// hundred counts) limit the achievable precision. Components must be greater
+// than INT32_MIN. The result is in degrees, in [0, 360). The zero vector maps
+// to 0.
+
+// Selects the engine used by VectorToAngleFixed.
+#define MOTOR_ANGLE_ENGINE_CORDIC 1
+#define MOTOR_ANGLE_ENGINE_TABLE 2
+#ifndef MOTOR_ANGLE_ENGINE
+#define MOTOR_ANGLE_ENGINE MOTOR_ANGLE_ENGINE_TABLE
+#endif
+
+// The number of CORDIC iterations. Each iteration adds roughly one bit of
+// precision, up to a maximum of 22 (beyond which the angle table underflows
+// SQ15x16).
+#ifndef MOTOR_CORDIC_ITERATIONS
+#define MOTOR_CORDIC_ITERATIONS 16
+#endif
+
+namespace motor {
+
+// Vectoring-mode CORDIC: shifts and adds only. With the default 16 iterations
+// the maximum error is below 0.002 degrees.
+SQ15x16 VectorToAngleCordic(int32_t x, int32_t y);
+
+// Octant reduction, one integer divide, and linear interpolation in a 129
+// entry atan table (516 bytes). The maximum error is below 0.0015 degrees.
+SQ15x16 VectorToAngleTable(int32_t x, int32_t y);
+
+// Calls the engine selected by MOTOR_ANGLE_ENGINE.
+inline SQ15x16 VectorToAngleFixed(int32_t x, int32_t y) {
+#if MOTOR_ANGLE_ENGINE == MOTOR_ANGLE_ENGINE_CORDIC
+  return VectorToAngleCordic(x, y);
+#else
+  return VectorToAngleTable(x, y);
+#endif
+}
+
+}  // namespace motor
+
+#endif  // MOTOR_VECTOR_ANGLE_H
@@ -0,0 +1,97 @@
+#include "velocity_estimator.h"
+
+#include <limits>
+#include <numbers>
+
+#include "fixed_math.h"
+
+namespace motor {
+namespace {
+
+using intpid::RoundDiv;
+using intpid::RoundShift;
+
+// The estimators do their intermediate math on the raw Q16 values in 64 bits,
+// and only saturate back to SQ15x16 at the end.
+SQ15x16 SaturateRaw(int64_t raw) {
+  if (raw > std::numeric_limits<int32_t>::max()) {
+    raw = std::numeric_limits<int32_t>::max();
+  } else if (raw < std::numeric_limits<int32_t>::min()) {
+    raw = std::numeric_limits<int32_t>::min();
+  }
+  return SQ15x16::fromInternal(static_cast<int32_t>(raw));
+}
+
+// Returns value * gain as a raw Q16 value.
+int64_t MulRaw(SQ15x16 value, SQ7x24 gain) {
+  return RoundShift(int64_t{value.getInternal()} * gain.getInternal(), 24);
+}
+
+// Returns the distance covered at rate (per second) in dt_ms, as a raw Q16
+// value.
+int64_t DistanceRaw(SQ15x16 rate, SQ15x16 dt_ms) {
+  return RoundDiv(
+      RoundShift(int64_t{rate.getInternal()} * dt_ms.getInternal(), 16),
+      1'000);
+}
+
+}  // namespace
+
+SQ15x16 RatePerSecond(SQ15x16 delta, SQ15x16 dt_ms) {
+  if (dt_ms <= 0) return 0;
+  return SaturateRaw(RoundDiv(int64_t{delta.getInternal()} * 1'000 << 16,
+                              dt_ms.getInternal()));
+}
+
+SQ15x16 FirstDifferenceEstimator::Update(SQ15x16 delta, SQ15x16 dt_ms) {
+  if (dt_ms <= 0) return rate_;
+  rate_ = RatePerSecond(delta, dt_ms);
+  return rate_;
+}
+
+SQ15x16 AlphaBetaEstimator::Update(SQ15x16 delta, SQ15x16 dt_ms) {
+  if (dt_ms <= 0) return rate_;
+  // The prediction error: how far the measured angle moved beyond what the
+  // current rate predicted, plus what was left uncorrected last time.
+  const SQ15x16 error = SaturateRaw(int64_t{residual_.getInternal()} +
+                                    delta.getInternal() -
+                                    DistanceRaw(rate_, dt_ms));
+  residual_ = SaturateRaw(error.getInternal() - MulRaw(error, alpha_));
+  rate_ = SaturateRaw(int64_t{rate_.getInternal()} +
+                      RatePerSecond(SaturateRaw(MulRaw(error, beta_)), dt_ms)
+                          .getInternal());
+  return rate_;
+}
+
+void AlphaBetaEstimator::Reset() {
+  residual_ = 0;
+  rate_ = 0;
+}
+
+TrackingLoopEstimator::TrackingLoopEstimator(float natural_frequency_hz,
+                                             float damping)
+    : kp_(2 * damping * 2 * std::numbers::pi_v<float> * natural_frequency_hz /
+          1'000),
+      ki_((2 * std::numbers::pi_v<float> * natural_frequency_hz) *
+          (2 * std::numbers::pi_v<float> * natural_frequency_hz) / 1'000'000) {}
+
+SQ15x16 TrackingLoopEstimator::Update(SQ15x16 delta, SQ15x16 dt_ms) {
+  if (dt_ms <= 0) return rate_;
+  // Advance the estimated angle at the loop's rate, and compare.
+  error_ = SaturateRaw(int64_t{error_.getInternal()} + delta.getInternal() -
+                       DistanceRaw(tracking_rate_, dt_ms));
+  // ki is per ms^2, so ki * error * dt is in degrees/ms.
+  const int64_t di = RoundShift(MulRaw(error_, ki_) * dt_ms.getInternal(), 16);
+  rate_ = SaturateRaw(int64_t{rate_.getInternal()} + di * 1'000);
+  tracking_rate_ = SaturateRaw(int64_t{rate_.getInternal()} +
+                               MulRaw(error_, kp_) * 1'000);
+  return rate_;
+}
+
+void TrackingLoopEstimator::Reset() {
+  error_ = 0;
+  tracking_rate_ = 0;
+  rate_ = 0;
+}
+
+}  // namespace motor
@@ -0,0 +1,146 @@
+#ifndef MOTOR_VELOCITY_ESTIMATOR_H
+#define MOTOR_VELOCITY_ESTIMATOR_H
+
+#include <FixedPointsCommon.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Estimators that turn a stream of angle samples into a rotation rate. They
+// are all integer-only, like vector_angle.h.
+//
+// Estimators see the change in angle since the previous sample rather than
+// the angle itself, so rebasing the sensor (Sensor::SetAngle) or the
+// accumulated angle running out of SQ15x16 range does not disturb them.
+
+namespace motor {
+
+class VelocityEstimator {
+ public:
+  virtual ~VelocityEstimator() {}
+
+  // Takes the change in angle in degrees since the previous sample and the
+  // time between the two samples in milliseconds, and returns the estimated
+  // rate in degrees/sec. If dt_ms is not positive, the sample is ignored and
+  // the previous estimate is returned.
+  virtual SQ15x16 Update(SQ15x16 delta, SQ15x16 dt_ms) = 0;
+
+  // Forgets all history. The next estimate starts from zero.
+  virtual void Reset() = 0;
+};
+
+// Returns delta / dt_ms in units per second, saturated to the range of
+// SQ15x16. Unlike dividing the SQ15x16 values directly, this keeps full
+// precision and cannot overflow in the intermediate steps.
+SQ15x16 RatePerSecond(SQ15x16 delta, SQ15x16 dt_ms);
+
+// The rate over the last sample interval. This has the least lag (half a
+// sample) and the most noise: angle noise is amplified by 1/dt.
+class FirstDifferenceEstimator : public VelocityEstimator {
+ public:
+  SQ15x16 Update(SQ15x16 delta, SQ15x16 dt_ms) override;
+  void Reset() override { rate_ = 0; }
+
+ private:
+  SQ15x16 rate_ = 0;
+};
+
+// The rate over the last kSamples sample intervals. Noise falls by a factor of
+// kSamples compared to FirstDifferenceEstimator, and the lag grows to
+// kSamples / 2 sample periods.
+template <size_t kSamples>
+class MovingAverageEstimator : public VelocityEstimator {
+ public:
+  static_assert(kSamples > 0);
+
+  SQ15x16 Update(SQ15x16 delta, SQ15x16 dt_ms) override;
+  void Reset() override;
+
+ private:
+  std::array<SQ15x16, kSamples> deltas_{};
+  std::array<SQ15x16, kSamples> dts_{};
+  size_t next_ = 0;
+  SQ15x16 delta_sum_ = 0;
+  SQ15x16 dt_sum_ = 0;
+  SQ15x16 rate_ = 0;
+};
+
+// An alpha-beta filter: predicts the angle from the current rate estimate,
+// then corrects the angle by alpha and the rate by beta times the prediction
+// error. Typical values have 0 < alpha <= 1 and 0 < beta < 2 * (2 - alpha);
+// smaller values reject more noise and respond more slowly. Ramps in angle
+// (constant speeds) are tracked without bias.
+class AlphaBetaEstimator : public VelocityEstimator {
+ public:
+  AlphaBetaEstimator(float alpha, float beta) : alpha_(alpha), beta_(beta) {}
+
+  SQ15x16 Update(SQ15x16 delta, SQ15x16 dt_ms) override;
+  void Reset() override;
+
+ private:
+  const SQ7x24 alpha_;
+  const SQ7x24 beta_;
+
+  // The measured angle minus the estimated angle, after the last correction.
+  SQ15x16 residual_ = 0;
+  SQ15x16 rate_ = 0;
+};
+
+// A type-II tracking loop, like the ones used for resolvers: a PI controller
+// drives an estimated angle to follow the measured one, and the integrator
+// holds the rate. Because of the double integration it follows constant speeds
+// without bias and constant accelerations with a fixed lag, and the rate is
+// filtered by a second order low-pass with the given natural frequency.
+class TrackingLoopEstimator : public VelocityEstimator {
+ public:
+  // damping = 1 is critically damped; lower values respond faster but
+  // overshoot.
+  explicit TrackingLoopEstimator(float natural_frequency_hz,
+                                 float damping = 1);
+
+  SQ15x16 Update(SQ15x16 delta, SQ15x16 dt_ms) override;
+  void Reset() override;
+
+ private:
+  // Gains in per-millisecond units, where they are small enough to need the
+  // extra fractional bits of SQ7x24.
+  const SQ7x24 kp_;  // 2 * damping * wn
+  const SQ7x24 ki_;  // wn^2
+
+  // The measured angle minus the estimated angle.
+  SQ15x16 error_ = 0;
+  // The loop's output: integrator plus proportional term. The estimated angle
+  // advances at this rate.
+  SQ15x16 tracking_rate_ = 0;
+  // The integrator, which is the reported rate.
+  SQ15x16 rate_ = 0;
+};
+
+template <size_t kSamples>
+SQ15x16 MovingAverageEstimator<kSamples>::Update(SQ15x16 delta,
+                                                 SQ15x16 dt_ms) {
+  if (dt_ms <= 0) return rate_;
+  // Running sums: subtract the sample that falls out of the window.
+  delta_sum_ += delta - deltas_[next_];
+  dt_sum_ += dt_ms - dts_[next_];
+  deltas_[next_] = delta;
+  dts_[next_] = dt_ms;
+  next_ = next_ + 1 == kSamples ? 0 : next_ + 1;
+  rate_ = RatePerSecond(delta_sum_, dt_sum_);
+  return rate_;
+}
+
+template <size_t kSamples>
+void MovingAverageEstimator<kSamples>::Reset() {
+  deltas_.fill(0);
+  dts_.fill(0);
+  next_ = 0;
+  delta_sum_ = 0;
+  dt_sum_ = 0;
+  rate_ = 0;
+}
+
+}  // namespace motor
+
+#endif  // MOTOR_VELOCITY_ESTIMATOR_H
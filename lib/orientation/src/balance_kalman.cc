@@ -0,0 +1,214 @@
+#include "balance_kalman.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+
+#include "fixed_math.h"
+
+namespace orientation {
+namespace {
+
+using intpid::RoundDiv;
+
+template <typename T>
+T FromFixed(SQ15x16 v) {
+  if constexpr (std::is_floating_point_v<T>) {
+    return static_cast<T>(static_cast<float>(v));
+  } else {
+    return v;
+  }
+}
+
+// Converts a variance, rounding a positive one that would vanish in fixed
+// point up to one LSB.
+template <typename T>
+T Variance(float v) {
+  const T t = v;
+  if constexpr (!std::is_floating_point_v<T>) {
+    if (v > 0 && t <= 0) return T::fromInternal(1);
+  }
+  return t;
+}
+
+// In fixed point, limits the initial sigmas so their variances fit.
+template <typename T>
+BalanceKalmanConfig Limited(BalanceKalmanConfig config) {
+  if constexpr (!std::is_floating_point_v<T>) {
+    constexpr float kMax = BasicBalanceKalman<T>::kMaxInitialSigma;
+    for (float* sigma : {&config.initial_pitch_rate_sigma,
+                         &config.initial_wheel_rate_sigma,
+                         &config.initial_gyro_bias_sigma}) {
+      *sigma = std::clamp(*sigma, -kMax, kMax);
+    }
+  }
+  return config;
+}
+
+// Returns v * dt_ms / 1000, e.g. the change over dt_ms of something with
+// rate v per second. In fixed point the product is exact and rounded once,
+// where going through dt in seconds would quantize it to 1/65536 s.
+template <typename T>
+T PerSecond(T v, T dt_ms) {
+  if constexpr (std::is_floating_point_v<T>) {
+    return v * dt_ms / 1000;
+  } else {
+    return T::fromInternal(static_cast<typename T::InternalType>(
+        RoundDiv(int64_t{v.getInternal()} * dt_ms.getInternal(),
+                 int64_t{1'000} << T::FractionSize)));
+  }
+}
+
+}  // namespace
+
+template <typename T>
+BasicBalanceKalman<T>::BasicBalanceKalman(const BalanceKalmanConfig& config)
+    : config_(Limited<T>(config)),
+      accel_pitch_r_(Variance<T>(config.accel_pitch_noise *
+                                 config.accel_pitch_noise)),
+      gyro_r_(Variance<T>(config.gyro_noise * config.gyro_noise)),
+      wheel_angle_r_(Variance<T>(config.wheel_angle_noise *
+                                 config.wheel_angle_noise)) {
+  Reset();
+}
+
+template <typename T>
+void BasicBalanceKalman<T>::SetPeriod(T dt_ms) {
+  period_ms_ = dt_ms;
+  // Integrating white acceleration of density q over s seconds adds
+  // q [s^3/3, s^2/2; s^2/2, s] to an angle and its rate.
+  const float s = static_cast<float>(dt_ms) / 1000;
+  const float pitch_q = config_.pitch_accel_noise * config_.pitch_accel_noise;
+  const float wheel_q = config_.wheel_accel_noise * config_.wheel_accel_noise;
+  pitch_q_angle_ = Variance<T>(pitch_q * s * s * s / 3);
+  pitch_q_cross_ = Variance<T>(pitch_q * s * s / 2);
+  pitch_q_rate_ = Variance<T>(pitch_q * s);
+  wheel_q_angle_ = Variance<T>(wheel_q * s * s * s / 3);
+  wheel_q_cross_ = Variance<T>(wheel_q * s * s / 2);
+  wheel_q_rate_ = Variance<T>(wheel_q * s);
+  bias_q_ = Variance<T>(config_.gyro_bias_drift * config_.gyro_bias_drift * s);
+}
+
+template <typename T>
+void BasicBalanceKalman<T>::Predict(T dt_ms) {
+  if (dt_ms <= 0) return;
+  // The process noise only depends on dt, which rarely changes.
+  if (dt_ms != period_ms_) SetPeriod(dt_ms);
+
+  x_[kPitch] += PerSecond(x_[kPitchRate], dt_ms);
+  x_[kWheelAngle] += PerSecond(x_[kWheelRate], dt_ms);
+
+  // P = F P F' + Q, where F adds dt times each rate to its angle. Rows
+  // first, then columns, then the lower triangle from the upper.
+  for (size_t c = 0; c < kNumBalanceStates; ++c) {
+    p_[kPitch][c] += PerSecond(p_[kPitchRate][c], dt_ms);
+    p_[kWheelAngle][c] += PerSecond(p_[kWheelRate][c], dt_ms);
+  }
+  for (size_t r = 0; r < kNumBalanceStates; ++r) {
+    p_[r][kPitch] += PerSecond(p_[r][kPitchRate], dt_ms);
+    p_[r][kWheelAngle] += PerSecond(p_[r][kWheelRate], dt_ms);
+  }
+  p_[kPitch][kPitch] += pitch_q_angle_;
+  p_[kPitch][kPitchRate] += pitch_q_cross_;
+  p_[kPitchRate][kPitchRate] += pitch_q_rate_;
+  p_[kWheelAngle][kWheelAngle] += wheel_q_angle_;
+  p_[kWheelAngle][kWheelRate] += wheel_q_cross_;
+  p_[kWheelRate][kWheelRate] += wheel_q_rate_;
+  p_[kGyroBias][kGyroBias] += bias_q_;
+  for (size_t r = 1; r < kNumBalanceStates; ++r) {
+    for (size_t c = 0; c < r; ++c) p_[r][c] = p_[c][r];
+  }
+}
+
+template <typename T>
+void BasicBalanceKalman<T>::Observe(size_t i, size_t j, T z, T r) {
+  // With H the row with ones at i and j, P H' is column i plus column j and
+  // the innovation variance is H P H' + r.
+  Vector pht;
+  for (size_t k = 0; k < kNumBalanceStates; ++k) {
+    pht[k] = j == i ? p_[k][i] : p_[k][i] + p_[k][j];
+  }
+  const T s = (j == i ? pht[i] : pht[i] + pht[j]) + r;
+  const T innovation = z - (j == i ? x_[i] : x_[i] + x_[j]);
+
+  // Each gain is divided out on its own rather than multiplied by 1 / s,
+  // which in fixed point would lose most of its bits when s is small.
+  Vector k;
+  for (size_t a = 0; a < kNumBalanceStates; ++a) {
+    k[a] = pht[a] / s;
+    x_[a] += k[a] * innovation;
+  }
+
+  // P -= K (P H')'. Only the upper triangle is computed, so P stays
+  // symmetric whatever the rounding.
+  for (size_t a = 0; a < kNumBalanceStates; ++a) {
+    for (size_t b = a; b < kNumBalanceStates; ++b) {
+      p_[a][b] -= k[a] * pht[b];
+      p_[b][a] = p_[a][b];
+    }
+    if constexpr (!std::is_floating_point_v<T>) {
+      if (p_[a][a] <= 0) p_[a][a] = T::fromInternal(1);
+    }
+  }
+}
+
+template <typename T>
+void BasicBalanceKalman<T>::UpdateImu(const ImuSample& sample) {
+  const bool have_gravity =
+      sample.accel_x != 0 || sample.accel_y != 0 || sample.accel_z != 0;
+  if (have_gravity) {
+    const T accel_pitch = FromFixed<T>(PitchFromGravity(
+        sample.accel_x.getInternal(), sample.accel_y.getInternal(),
+        sample.accel_z.getInternal()));
+    if (pitch_initialized_) {
+      Observe(kPitch, kPitch, accel_pitch, accel_pitch_r_);
+    } else {
+      // Whatever Predict did to the pitch so far meant nothing.
+      x_[kPitch] = accel_pitch;
+      for (size_t k = 0; k < kNumBalanceStates; ++k) {
+        p_[kPitch][k] = p_[k][kPitch] = 0;
+      }
+      p_[kPitch][kPitch] = accel_pitch_r_;
+      pitch_initialized_ = true;
+    }
+  }
+  if (!pitch_initialized_) return;
+  // The gyro reads the rate plus its bias.
+  Observe(kPitchRate, kGyroBias, FromFixed<T>(sample.gyro_y), gyro_r_);
+}
+
+template <typename T>
+void BasicBalanceKalman<T>::UpdateWheelAngle(T degrees) {
+  if (wheel_initialized_) {
+    Observe(kWheelAngle, kWheelAngle, degrees, wheel_angle_r_);
+    return;
+  }
+  x_[kWheelAngle] = degrees;
+  for (size_t k = 0; k < kNumBalanceStates; ++k) {
+    p_[kWheelAngle][k] = p_[k][kWheelAngle] = 0;
+  }
+  p_[kWheelAngle][kWheelAngle] = wheel_angle_r_;
+  wheel_initialized_ = true;
+}
+
+template <typename T>
+void BasicBalanceKalman<T>::Reset() {
+  pitch_initialized_ = false;
+  wheel_initialized_ = false;
+  x_ = {};
+  p_ = {};
+  // The angles are set by their first measurements.
+  p_[kPitch][kPitch] = accel_pitch_r_;
+  p_[kWheelAngle][kWheelAngle] = wheel_angle_r_;
+  p_[kPitchRate][kPitchRate] = Variance<T>(config_.initial_pitch_rate_sigma *
+                                           config_.initial_pitch_rate_sigma);
+  p_[kWheelRate][kWheelRate] = Variance<T>(config_.initial_wheel_rate_sigma *
+                                           config_.initial_wheel_rate_sigma);
+  p_[kGyroBias][kGyroBias] = Variance<T>(config_.initial_gyro_bias_sigma *
+                                         config_.initial_gyro_bias_sigma);
+}
+
+template class BasicBalanceKalman<SQ15x16>;
+template class BasicBalanceKalman<float>;
+
+}  // namespace orientation
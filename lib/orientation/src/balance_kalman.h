@@ -0,0 +1,162 @@
+#ifndef ORIENTATION_BALANCE_KALMAN_H
+#define ORIENTATION_BALANCE_KALMAN_H
+
+#include <FixedPointsCommon.h>
+
+#include <array>
+#include <cstddef>
+#include <span>
+
+#include "orientation.h"
+
+namespace orientation {
+
+// The states BasicBalanceKalman estimates, in the order of its state vector
+// and covariance. The first four are the state intpid::StateFeedback<4>
+// balances on (see include/balance_gains.h): angles in degrees and rates in
+// degrees/sec, with the wheel angle the wheels' mean rotation relative to the
+// chassis, as their magnet sensors read it.
+enum BalanceState : size_t {
+  kPitch,
+  kPitchRate,
+  kWheelAngle,
+  kWheelRate,
+  kGyroBias,
+  kNumBalanceStates,
+};
+
+// Noise levels, as standard deviations. The process noise is white: the
+// rates are driven by random accelerations and the gyro bias by a random
+// walk, each with the given density.
+struct BalanceKalmanConfig {
+  // The chassis' pitch acceleration, in degrees/s^2/sqrt(Hz).
+  float pitch_accel_noise = 20;
+  // The wheels' acceleration, in degrees/s^2/sqrt(Hz).
+  float wheel_accel_noise = 300;
+  // The drift of the gyro bias, in degrees/s/sqrt(s).
+  float gyro_bias_drift = 0.1;
+
+  // The pitch the accelerometer sees, in degrees. This also has to cover the
+  // chassis' own acceleration, which the filter does not model.
+  float accel_pitch_noise = 2;
+  // The gyro's pitch rate, in degrees/sec.
+  float gyro_noise = 0.05;
+  // The wheel angle, in degrees, including its quantization.
+  float wheel_angle_noise = 0.06;
+
+  // Before the first measurements, for the states no single sample gives.
+  float initial_pitch_rate_sigma = 50;
+  float initial_wheel_rate_sigma = 50;
+  float initial_gyro_bias_sigma = 2;
+};
+
+// A Kalman filter for the whole balance state: pitch and pitch rate from the
+// IMU, the wheel angle and rate from the magnet sensors, and the gyro's bias,
+// with the covariance of the estimate. Where ComplementaryFilter and
+// MahonyFilter only fuse the IMU, and the wheel rate would otherwise come
+// from differencing quantized angles, this weighs every measurement by its
+// noise, so the estimate feeds a StateFeedback controller directly. It
+// learns the gyro bias like MahonyFilter, and the wheel rate it reports is
+// much quieter than a difference of consecutive angles.
+//
+// The model is two independent constant-velocity pairs, pitch and wheel,
+// plus a constant bias. Each cycle is a Predict followed by the measurements
+// in any order, each folded in as a scalar update, so there are no matrix
+// inversions and everything is sized at compile time. A measurement touches
+// only the rows it observes, and Predict only the two pairs.
+//
+// T is SQ15x16 (BalanceKalman) for the board or float for comparison. In
+// fixed point every nonzero process noise term is at least one LSB per
+// Predict, so very small drifts are rounded up, and any covariance that
+// rounds negative is clamped to one LSB. The covariance is in degrees and
+// degrees/sec squared: the defaults keep it far below the 32767 SQ15x16
+// allows, and initial sigmas are clamped to kMaxInitialSigma, above which
+// they would overflow it.
+//
+// The estimate is for the time of the latest measurements: Predict moves it
+// forward and the updates correct it, with no filtering delay.
+template <typename T>
+class BasicBalanceKalman {
+ public:
+  using Vector = std::array<T, kNumBalanceStates>;
+  using Matrix = std::array<Vector, kNumBalanceStates>;
+
+  // The largest initial sigma whose variance fits SQ15x16, with room for the
+  // first Predict.
+  static constexpr float kMaxInitialSigma = 180;
+
+  explicit BasicBalanceKalman(const BalanceKalmanConfig& config = {});
+
+  // Moves the estimate dt_ms milliseconds forward. Non-positive dt_ms is
+  // ignored.
+  void Predict(T dt_ms);
+
+  // Folds in an IMU sample, taken at the time of the last Predict: the pitch
+  // from the accelerometer and the gyro's pitch rate. The first sample after
+  // construction or Reset sets the pitch from the accelerometer alone. Until
+  // then samples with no gravity are ignored, and after that they only give
+  // the rate.
+  void UpdateImu(const ImuSample& sample);
+
+  // Folds in the wheel angle in degrees, taken at the time of the last
+  // Predict. The first reading after construction or Reset sets the angle.
+  void UpdateWheelAngle(T degrees);
+
+  // One whole cycle: Predict, then both measurements.
+  void Update(const ImuSample& sample, T wheel_degrees, T dt_ms) {
+    Predict(dt_ms);
+    UpdateImu(sample);
+    UpdateWheelAngle(wheel_degrees);
+  }
+
+  // Forgets the current estimate.
+  void Reset();
+
+  const BalanceKalmanConfig& config() const { return config_; }
+  const Vector& state() const { return x_; }
+  const Matrix& covariance() const { return p_; }
+
+  // The pitch, pitch rate, wheel angle and wheel rate, for a StateFeedback.
+  std::span<const T, 4> balance_state() const {
+    return std::span<const T, kNumBalanceStates>(x_).template first<4>();
+  }
+
+  T pitch() const { return x_[kPitch]; }
+  T pitch_rate() const { return x_[kPitchRate]; }
+  T wheel_angle() const { return x_[kWheelAngle]; }
+  T wheel_rate() const { return x_[kWheelRate]; }
+  T gyro_bias() const { return x_[kGyroBias]; }
+
+ private:
+  // Folds in z, a measurement of state i, plus state j if j is not i, with
+  // variance r.
+  void Observe(size_t i, size_t j, T z, T r);
+
+  // Recomputes the per-Predict process noise for a new dt_ms.
+  void SetPeriod(T dt_ms);
+
+  const BalanceKalmanConfig config_;
+  // The measurement variances.
+  const T accel_pitch_r_, gyro_r_, wheel_angle_r_;
+
+  bool pitch_initialized_ = false;
+  bool wheel_initialized_ = false;
+  Vector x_{};
+  Matrix p_{};
+
+  // The process noise for one Predict of period_ms_: per pair, the angle,
+  // cross and rate terms.
+  T period_ms_ = 0;
+  T pitch_q_angle_ = 0, pitch_q_cross_ = 0, pitch_q_rate_ = 0;
+  T wheel_q_angle_ = 0, wheel_q_cross_ = 0, wheel_q_rate_ = 0;
+  T bias_q_ = 0;
+};
+
+extern template class BasicBalanceKalman<SQ15x16>;
+extern template class BasicBalanceKalman<float>;
+
+using BalanceKalman = BasicBalanceKalman<SQ15x16>;
+
+}  // namespace orientation
+
+#endif  // ORIENTATION_BALANCE_KALMAN_H
@@ -0,0 +1,45 @@
+#include "complementary_filter.h"
+
+#include "fixed_math.h"
+
+namespace orientation {
+
+using intpid::RoundDiv;
+
+void ComplementaryFilter::Update(const ImuSample& sample, SQ15x16 dt_ms) {
+  if (dt_ms <= 0) return;
+  pitch_rate_ = sample.gyro_y;
+
+  const bool have_gravity =
+      sample.accel_x != 0 || sample.accel_y != 0 || sample.accel_z != 0;
+  const SQ15x16 accel_pitch = PitchFromGravity(sample.accel_x.getInternal(),
+                                               sample.accel_y.getInternal(),
+                                               sample.accel_z.getInternal());
+  if (!initialized_) {
+    if (!have_gravity) return;
+    pitch_ = accel_pitch;
+    initialized_ = true;
+    return;
+  }
+
+  // Integrate the gyro: rate is per second, dt in milliseconds.
+  const int64_t dt = dt_ms.getInternal();
+  int64_t pitch = pitch_.getInternal() +
+                  RoundDiv(int64_t{pitch_rate_.getInternal()} * dt,
+                           int64_t{1'000} << 16);
+
+  // Then move dt / (time_constant + dt) of the way to the accelerometer.
+  if (have_gravity) {
+    pitch += RoundDiv((accel_pitch.getInternal() - pitch) * dt,
+                      time_constant_ms_.getInternal() + dt);
+  }
+  pitch_ = SQ15x16::fromInternal(static_cast<int32_t>(pitch));
+}
+
+void ComplementaryFilter::Reset() {
+  initialized_ = false;
+  pitch_ = 0;
+  pitch_rate_ = 0;
+}
+
+}  // namespace orientation
@@ -0,0 +1,38 @@
+#ifndef ORIENTATION_COMPLEMENTARY_FILTER_H
+#define ORIENTATION_COMPLEMENTARY_FILTER_H
+
+#include <FixedPointsCommon.h>
+
+#include "orientation.h"
+
+namespace orientation {
+
+// The classic balance-bot filter: integrates the gyro, and pulls the result
+// toward the accelerometer's pitch with the given time constant. Gyro drift
+// is corrected on time scales longer than the time constant, and
+// accelerometer noise and vibration are rejected on shorter ones. A constant
+// gyro bias leaves a steady pitch error of bias * time_constant.
+//
+// This costs one square root, one angle lookup and one divide per sample.
+class ComplementaryFilter : public OrientationFilter {
+ public:
+  explicit ComplementaryFilter(float time_constant_ms)
+      : time_constant_ms_(time_constant_ms) {}
+
+  void Update(const ImuSample& sample, SQ15x16 dt_ms) override;
+  void Reset() override;
+
+  SQ15x16 pitch() const override { return pitch_; }
+  SQ15x16 pitch_rate() const override { return pitch_rate_; }
+
+ private:
+  const SQ15x16 time_constant_ms_;
+
+  bool initialized_ = false;
+  SQ15x16 pitch_ = 0;
+  SQ15x16 pitch_rate_ = 0;
+};
+
+}  // namespace orientation
+
+#endif  // ORIENTATION_COMPLEMENTARY_FILTER_H
@@ -0,0 +1,153 @@
+#include "mahony_filter.h"
+
+#include <numbers>
+
+#include "fixed_math.h"
+
+namespace orientation {
+namespace {
+
+using intpid::ISqrt;
+using intpid::RoundDiv;
+using intpid::RoundShift;
+
+constexpr int kQ = 30;
+constexpr int64_t kOne = int64_t{1} << kQ;
+
+// Unit conversions: pi/180 in Q30, and 180/pi in Q16.
+constexpr int64_t kRadPerDegQ30 =
+    static_cast<int64_t>(std::numbers::pi / 180 * kOne + 0.5);
+constexpr int64_t kDegPerRadQ16 =
+    static_cast<int64_t>(180 / std::numbers::pi * (1 << 16) + 0.5);
+
+int64_t MulQ30(int64_t a, int64_t b) { return RoundShift(a * b, kQ); }
+
+// Returns gain * x, for a gain in Q24 and x in Q30, in Q30.
+int64_t MulGain(SQ7x24 gain, int64_t x) {
+  return RoundShift(int64_t{gain.getInternal()} * x, 24);
+}
+
+// Scales v to unit length in Q30. Returns false for the zero vector.
+bool Normalize(std::array<int64_t, 3>& v) {
+  uint64_t norm2 = 0;
+  for (int64_t c : v) norm2 += static_cast<uint64_t>(c * c);
+  const int64_t norm = ISqrt(norm2);
+  if (norm == 0) return false;
+  for (int64_t& c : v) c = RoundDiv(c << kQ, norm);
+  return true;
+}
+
+SQ15x16 RadiansQ30ToDegrees(int64_t radians) {
+  return SQ15x16::fromInternal(
+      static_cast<int32_t>(RoundShift(radians * kDegPerRadQ16, kQ)));
+}
+
+}  // namespace
+
+void MahonyFilter::Update(const ImuSample& sample, SQ15x16 dt_ms) {
+  if (dt_ms <= 0) return;
+
+  std::array<int64_t, 3> up = {sample.accel_x.getInternal(),
+                               sample.accel_y.getInternal(),
+                               sample.accel_z.getInternal()};
+  const bool have_gravity = Normalize(up);
+  if (!initialized_) {
+    if (!have_gravity) return;
+    Align(up);
+    initialized_ = true;
+    pitch_rate_ = sample.gyro_y;
+    UpdatePitch();
+    return;
+  }
+
+  const int64_t q0 = q_[0], q1 = q_[1], q2 = q_[2], q3 = q_[3];
+  const int64_t dt_s = RoundDiv(int64_t{dt_ms.getInternal()} << 14, 1'000);
+  std::array<int64_t, 3> w = {
+      RoundShift(sample.gyro_x.getInternal() * kRadPerDegQ30, 16),
+      RoundShift(sample.gyro_y.getInternal() * kRadPerDegQ30, 16),
+      RoundShift(sample.gyro_z.getInternal() * kRadPerDegQ30, 16),
+  };
+
+  if (have_gravity) {
+    // The up direction the current attitude predicts, and its error against
+    // the measured one.
+    const int64_t vx = 2 * (MulQ30(q1, q3) - MulQ30(q0, q2));
+    const int64_t vy = 2 * (MulQ30(q0, q1) + MulQ30(q2, q3));
+    const int64_t vz =
+        MulQ30(q0, q0) - MulQ30(q1, q1) - MulQ30(q2, q2) + MulQ30(q3, q3);
+    const std::array<int64_t, 3> e = {
+        MulQ30(up[1], vz) - MulQ30(up[2], vy),
+        MulQ30(up[2], vx) - MulQ30(up[0], vz),
+        MulQ30(up[0], vy) - MulQ30(up[1], vx),
+    };
+    for (int i = 0; i < 3; ++i) {
+      if (ki_ != 0) integral_[i] += MulQ30(MulGain(ki_, e[i]), dt_s);
+      w[i] += MulGain(kp_, e[i]);
+    }
+  }
+  for (int i = 0; i < 3; ++i) w[i] += integral_[i];
+
+  // q += q * (0, w) * dt / 2.
+  const int64_t hx = RoundShift(w[0] * dt_s, kQ + 1);
+  const int64_t hy = RoundShift(w[1] * dt_s, kQ + 1);
+  const int64_t hz = RoundShift(w[2] * dt_s, kQ + 1);
+  std::array<int64_t, 4> q = {
+      q0 - MulQ30(q1, hx) - MulQ30(q2, hy) - MulQ30(q3, hz),
+      q1 + MulQ30(q0, hx) + MulQ30(q2, hz) - MulQ30(q3, hy),
+      q2 + MulQ30(q0, hy) - MulQ30(q1, hz) + MulQ30(q3, hx),
+      q3 + MulQ30(q0, hz) + MulQ30(q1, hy) - MulQ30(q2, hx),
+  };
+
+  // Renormalize. The quaternion only drifts from unit length by about the
+  // square of the step, so one Newton step for 1/sqrt(n) around 1 suffices
+  // and saves a square root and four divides.
+  int64_t norm2 = 0;
+  for (int64_t c : q) norm2 += MulQ30(c, c);
+  const int64_t scale = (3 * kOne - norm2) / 2;
+  for (int i = 0; i < 4; ++i) q_[i] = static_cast<int32_t>(MulQ30(q[i], scale));
+
+  pitch_rate_ = sample.gyro_y + RadiansQ30ToDegrees(integral_[1]);
+  UpdatePitch();
+}
+
+void MahonyFilter::Align(const std::array<int64_t, 3>& up) {
+  // The shortest rotation taking up to +Z: (1 + up.z, up x Z), normalized.
+  std::array<int64_t, 4> q = {kOne + up[2], up[1], -up[0], 0};
+  if (q[0] < kOne / 1024) {
+    // Nearly upside down, where that is ill-conditioned. Any half turn about
+    // a horizontal axis is as good.
+    q = {0, kOne, 0, 0};
+  }
+  uint64_t norm2 = 0;
+  for (int64_t c : q) norm2 += static_cast<uint64_t>(c * c);
+  const int64_t norm = ISqrt(norm2);
+  for (int i = 0; i < 4; ++i) {
+    q_[i] = static_cast<int32_t>(RoundDiv(q[i] << kQ, norm));
+  }
+}
+
+void MahonyFilter::UpdatePitch() {
+  const int64_t q0 = q_[0], q1 = q_[1], q2 = q_[2], q3 = q_[3];
+  const int64_t vx = 2 * (MulQ30(q1, q3) - MulQ30(q0, q2));
+  const int64_t vy = 2 * (MulQ30(q0, q1) + MulQ30(q2, q3));
+  const int64_t vz =
+      MulQ30(q0, q0) - MulQ30(q1, q1) - MulQ30(q2, q2) + MulQ30(q3, q3);
+  // Halved to stay inside PitchFromGravity's range despite rounding.
+  pitch_ = PitchFromGravity(vx >> 1, vy >> 1, vz >> 1);
+}
+
+void MahonyFilter::Reset() {
+  initialized_ = false;
+  q_ = {1 << 30, 0, 0, 0};
+  integral_ = {};
+  pitch_ = 0;
+  pitch_rate_ = 0;
+}
+
+std::array<SQ15x16, 3> MahonyFilter::gyro_bias() const {
+  return {-RadiansQ30ToDegrees(integral_[0]),
+          -RadiansQ30ToDegrees(integral_[1]),
+          -RadiansQ30ToDegrees(integral_[2])};
+}
+
+}  // namespace orientation
@@ -0,0 +1,63 @@
+#ifndef ORIENTATION_MAHONY_FILTER_H
+#define ORIENTATION_MAHONY_FILTER_H
+
+#include <FixedPointsCommon.h>
+
+#include <array>
+#include <cstdint>
+
+#include "orientation.h"
+
+namespace orientation {
+
+// Mahony's nonlinear complementary filter on the full attitude quaternion.
+// The cross product of the measured and estimated gravity directions is fed
+// back into the gyro through a PI controller. The proportional gain sets how
+// quickly the accelerometer corrects the attitude, and the integral term
+// learns the gyro bias, so unlike ComplementaryFilter a constant bias leaves
+// no steady pitch error. Without a magnetometer, yaw is not corrected.
+//
+// The quaternion is kept in Q2.30 and all intermediate math is in 64 bits.
+// This costs two square roots, four divides and an angle lookup (one more
+// divide with the table engine) per sample.
+class MahonyFilter : public OrientationFilter {
+ public:
+  // kp is in 1/s and ki in 1/s^2. Typical values are kp = 1..5, and
+  // ki = kp^2 / 4, which learns the bias as fast as possible without
+  // overshoot. ki = 0 turns off bias estimation.
+  MahonyFilter(float kp, float ki) : kp_(kp), ki_(ki) {}
+
+  void Update(const ImuSample& sample, SQ15x16 dt_ms) override;
+  void Reset() override;
+
+  SQ15x16 pitch() const override { return pitch_; }
+  SQ15x16 pitch_rate() const override { return pitch_rate_; }
+
+  // The estimated gyro bias on each axis in degrees/sec. Only learned if ki
+  // is nonzero.
+  std::array<SQ15x16, 3> gyro_bias() const;
+
+ private:
+  // Sets the attitude to the smallest rotation that explains the measured
+  // gravity direction.
+  void Align(const std::array<int64_t, 3>& up);
+  void UpdatePitch();
+
+  const SQ7x24 kp_;
+  const SQ7x24 ki_;
+
+  bool initialized_ = false;
+
+  // The attitude quaternion (w, x, y, z), in Q2.30.
+  std::array<int32_t, 4> q_ = {1 << 30, 0, 0, 0};
+
+  // The integral term: minus the gyro bias, in rad/s, in Q30.
+  std::array<int64_t, 3> integral_ = {};
+
+  SQ15x16 pitch_ = 0;
+  SQ15x16 pitch_rate_ = 0;
+};
+
+}  // namespace orientation
+
+#endif  // ORIENTATION_MAHONY_FILTER_H
@@ -0,0 +1,24 @@
+#include "mpu6050_imu.h"
+
+#ifdef ARDUINO_ARCH_ESP32
+
+namespace orientation {
+
+bool Mpu6050Imu::Read(ImuSample& sample) {
+  sensors_event_t accel, gyro, temp;
+  if (!mpu_->getEvent(&accel, &gyro, &temp)) return false;
+
+  // The library reports m/s^2 and rad/s.
+  constexpr float kDegreesPerRadian = 180 / PI;
+  sample.accel_x = accel.acceleration.x;
+  sample.accel_y = accel.acceleration.y;
+  sample.accel_z = accel.acceleration.z;
+  sample.gyro_x = gyro.gyro.x * kDegreesPerRadian;
+  sample.gyro_y = gyro.gyro.y * kDegreesPerRadian;
+  sample.gyro_z = gyro.gyro.z * kDegreesPerRadian;
+  return true;
+}
+
+}  // namespace orientation
+
+#endif  // ARDUINO_ARCH_ESP32
@@ -0,0 +1,30 @@
+#ifndef ORIENTATION_MPU6050_IMU_H
+#define ORIENTATION_MPU6050_IMU_H
+
+#ifdef ARDUINO_ARCH_ESP32
+
+#include <Adafruit_MPU6050.h>
+
+#include "orientation.h"
+
+namespace orientation {
+
+// Reads ImuSamples from an MPU6050. The device must already be set up with
+// begin() and the desired ranges and filter bandwidth.
+class Mpu6050Imu {
+ public:
+  explicit Mpu6050Imu(Adafruit_MPU6050* mpu) : mpu_(mpu) {}
+
+  // Reads one sample. Returns false, leaving sample alone, if the read
+  // failed.
+  bool Read(ImuSample& sample);
+
+ private:
+  Adafruit_MPU6050* const mpu_;
+};
+
+}  // namespace orientation
+
+#endif  // ARDUINO_ARCH_ESP32
+
+#endif  // ORIENTATION_MPU6050_IMU_H
@@ -0,0 +1,20 @@
+#include "orientation.h"
+
+#include "fixed_math.h"
+#include "vector_angle.h"
+
+namespace orientation {
+
+using intpid::ISqrt;
+
+SQ15x16 PitchFromGravity(int32_t x, int32_t y, int32_t z) {
+  // The length of the vector's projection onto the YZ plane. Using it rather
+  // than z alone keeps the pitch correct when the IMU is also rolled.
+  const int32_t yz = static_cast<int32_t>(
+      ISqrt(static_cast<uint64_t>(int64_t{y} * y) +
+            static_cast<uint64_t>(int64_t{z} * z)));
+  const SQ15x16 angle = motor::VectorToAngleFixed(yz, -x);
+  return angle > 180 ? angle - 360 : angle;
+}
+
+}  // namespace orientation
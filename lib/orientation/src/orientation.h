@@ -0,0 +1,54 @@
+#ifndef ORIENTATION_ORIENTATION_H
+#define ORIENTATION_ORIENTATION_H
+
+#include <FixedPointsCommon.h>
+
+#include <cstdint>
+
+// Attitude estimation for the balance input. The filters fuse a 6-axis IMU
+// (e.g. the MPU6050) into the pitch angle and pitch rate, one sample at a
+// time, with integer math only.
+//
+// Axes are the IMU's own, right-handed. Pitch is the rotation about the Y
+// axis, so a positive pitch tips the X axis down, and the pitch rate is the
+// gyro's Y rate.
+
+namespace orientation {
+
+// One reading from a 6-axis IMU.
+struct ImuSample {
+  // Specific force, in any unit: only the direction is used. At rest and
+  // level, this points up the Z axis.
+  SQ15x16 accel_x, accel_y, accel_z;
+
+  // Angular rate in degrees/sec.
+  SQ15x16 gyro_x, gyro_y, gyro_z;
+};
+
+class OrientationFilter {
+ public:
+  virtual ~OrientationFilter() {}
+
+  // Adds a sample taken dt_ms milliseconds after the previous one. The first
+  // sample after construction or Reset initializes the estimate from the
+  // accelerometer alone. Samples with a non-positive dt_ms are ignored.
+  virtual void Update(const ImuSample& sample, SQ15x16 dt_ms) = 0;
+
+  // Forgets the current estimate.
+  virtual void Reset() = 0;
+
+  // Returns the pitch in degrees, in [-90, 90].
+  virtual SQ15x16 pitch() const = 0;
+
+  // Returns the pitch rate in degrees/sec, as corrected by the filter.
+  virtual SQ15x16 pitch_rate() const = 0;
+};
+
+// Returns the pitch, in degrees in [-90, 90], at which the up vector (x, y, z)
+// is seen by the IMU. Components must be within +/-2^30. The zero vector
+// gives 0.
+SQ15x16 PitchFromGravity(int32_t x, int32_t y, int32_t z);
+
+}  // namespace orientation
+
+#endif  // ORIENTATION_ORIENTATION_H
@@ -0,0 +1,49 @@
+#ifndef SCHED_CLOCK_H
+#define SCHED_CLOCK_H
+
+#include <cstdint>
+
+namespace sched {
+
+// The time source and sleep primitive a Scheduler runs on. Times are in
+// microseconds and wrap at 2^32; compare them with unsigned subtraction.
+class Clock {
+ public:
+  virtual ~Clock() {}
+
+  virtual uint32_t NowMicros() = 0;
+
+  // Blocks until NowMicros() is at or past deadline. Returns immediately if
+  // the deadline has already passed.
+  virtual void SleepUntil(uint32_t deadline) = 0;
+};
+
+// A clock that only moves when told to, for running schedulers on the host.
+// Sleeping jumps straight to the deadline, plus an optional wake-up latency
+// that models the OS scheduling us late.
+class VirtualClock : public Clock {
+ public:
+  uint32_t NowMicros() override { return now_; }
+
+  void SleepUntil(uint32_t deadline) override {
+    if (static_cast<int32_t>(deadline - now_) > 0) {
+      now_ = deadline + wake_latency_;
+    }
+  }
+
+  // Moves time forward, e.g. to model the time a stage takes to run.
+  void Advance(uint32_t us) { now_ += us; }
+
+  void set_now(uint32_t now) { now_ = now; }
+
+  // Applies to the next and every later SleepUntil that actually sleeps.
+  void set_wake_latency(uint32_t us) { wake_latency_ = us; }
+
+ private:
+  uint32_t now_ = 0;
+  uint32_t wake_latency_ = 0;
+};
+
+}  // namespace sched
+
+#endif  // SCHED_CLOCK_H
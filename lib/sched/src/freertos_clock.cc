@@ -0,0 +1,41 @@
+#include "freertos_clock.h"
+
+#ifdef ARDUINO_ARCH_ESP32
+
+namespace sched {
+
+FreeRtosClock::FreeRtosClock() {
+  const esp_timer_create_args_t args = {
+      .callback = &FreeRtosClock::OnTimer,
+      .arg = this,
+      .dispatch_method = ESP_TIMER_TASK,
+      .name = "sched",
+      .skip_unhandled_events = true,
+  };
+  ESP_ERROR_CHECK(esp_timer_create(&args, &timer_));
+}
+
+FreeRtosClock::~FreeRtosClock() {
+  esp_timer_stop(timer_);
+  esp_timer_delete(timer_);
+}
+
+uint32_t FreeRtosClock::NowMicros() {
+  return static_cast<uint32_t>(esp_timer_get_time());
+}
+
+void FreeRtosClock::SleepUntil(uint32_t deadline) {
+  const int32_t remaining = static_cast<int32_t>(deadline - NowMicros());
+  if (remaining <= 0) return;
+  waiter_ = xTaskGetCurrentTaskHandle();
+  ESP_ERROR_CHECK(esp_timer_start_once(timer_, remaining));
+  ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+}
+
+void FreeRtosClock::OnTimer(void* arg) {
+  xTaskNotifyGive(static_cast<FreeRtosClock*>(arg)->waiter_);
+}
+
+}  // namespace sched
+
+#endif  // ARDUINO_ARCH_ESP32
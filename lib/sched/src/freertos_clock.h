@@ -0,0 +1,39 @@
+#ifndef SCHED_FREERTOS_CLOCK_H
+#define SCHED_FREERTOS_CLOCK_H
+
+#ifdef ARDUINO_ARCH_ESP32
+
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "clock.h"
+
+namespace sched {
+
+// A Clock backed by the esp_timer hardware timer. SleepUntil arms a one-shot
+// timer for the deadline and blocks the calling task on a task notification,
+// so the wake-up is accurate to the timer (tens of microseconds) rather than
+// to the 1 ms FreeRTOS tick, and the CPU is free while waiting.
+//
+// SleepUntil must always be called from the same task.
+class FreeRtosClock : public Clock {
+ public:
+  FreeRtosClock();
+  ~FreeRtosClock() override;
+
+  uint32_t NowMicros() override;
+  void SleepUntil(uint32_t deadline) override;
+
+ private:
+  static void OnTimer(void* arg);
+
+  esp_timer_handle_t timer_ = nullptr;
+  TaskHandle_t waiter_ = nullptr;
+};
+
+}  // namespace sched
+
+#endif  // ARDUINO_ARCH_ESP32
+
+#endif  // SCHED_FREERTOS_CLOCK_H
@@ -0,0 +1,68 @@
+#ifndef SCHED_JITTER_HISTOGRAM_H
+#define SCHED_JITTER_HISTOGRAM_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace sched {
+
+// Counts samples (in microseconds) into power-of-two buckets: bucket 0 holds
+// 0, bucket i holds [2^(i-1), 2^i), and the last bucket holds everything
+// larger. Fixed size and allocation free.
+class JitterHistogram {
+ public:
+  static constexpr size_t kNumBuckets = 16;
+
+  void Add(uint32_t us) {
+    ++buckets_[BucketOf(us)];
+    ++count_;
+    if (us > max_) max_ = us;
+  }
+
+  void Clear() { *this = JitterHistogram(); }
+
+  // The lowest value that falls in bucket i.
+  static constexpr uint32_t BucketFloor(size_t i) {
+    return i == 0 ? 0 : uint32_t{1} << (i - 1);
+  }
+
+  static size_t BucketOf(uint32_t us) {
+    if (us == 0) return 0;
+    const size_t bucket = 32 - __builtin_clz(us);
+    return bucket < kNumBuckets ? bucket : kNumBuckets - 1;
+  }
+
+  uint32_t bucket(size_t i) const { return buckets_[i]; }
+  uint32_t count() const { return count_; }
+  uint32_t max() const { return max_; }
+
+  // An upper bound on the value at or below which the given fraction (0 to 1)
+  // of samples fall.
+  uint32_t Percentile(float fraction) const;
+
+ private:
+  std::array<uint32_t, kNumBuckets> buckets_{};
+  uint32_t count_ = 0;
+  uint32_t max_ = 0;
+};
+
+inline uint32_t JitterHistogram::Percentile(float fraction) const {
+  if (count_ == 0) return 0;
+  uint32_t rank = static_cast<uint32_t>(fraction * count_);
+  if (rank == 0) rank = 1;
+  uint32_t seen = 0;
+  for (size_t i = 0; i < kNumBuckets - 1; ++i) {
+    seen += buckets_[i];
+    if (seen >= rank) {
+      // The bucket's largest value, capped by the largest sample seen.
+      const uint32_t upper = BucketFloor(i + 1) - (i == 0 ? 0 : 1);
+      return upper < max_ ? upper : max_;
+    }
+  }
+  return max_;
+}
+
+}  // namespace sched
+
+#endif  // SCHED_JITTER_HISTOGRAM_H
@@ -0,0 +1,93 @@
+#include "memory_report.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <esp_heap_caps.h>
+#ifdef CONFIG_HEAP_TASK_TRACKING
+#include <esp_heap_task_info.h>
+#endif
+#endif
+
+namespace sched {
+namespace {
+
+// Appends to out at *length, keeping it nul-terminated and never writing
+// past its end.
+void Append(std::span<char> out, size_t* length, const char* format, ...) {
+  if (*length + 1 >= out.size()) return;
+  va_list args;
+  va_start(args, format);
+  const int n = vsnprintf(out.data() + *length, out.size() - *length, format,
+                          args);
+  va_end(args);
+  if (n < 0) return;
+  *length = std::min(*length + n, out.size() - 1);
+}
+
+}  // namespace
+
+size_t FormatMemoryReport(std::span<const TaskMemory> tasks,
+                          const HeapMemory& heap, std::span<char> out) {
+  if (out.empty()) return 0;
+  out[0] = '\0';
+  size_t length = 0;
+  Append(out, &length, "%-16s %6s %6s %6s %7s\n", "task", "stack", "peak",
+         "free", "heap");
+  for (const TaskMemory& task : tasks) {
+    Append(out, &length, "%-16s %6u %6u %6u", task.name,
+           static_cast<unsigned>(task.stack_bytes),
+           static_cast<unsigned>(task.stack_peak()),
+           static_cast<unsigned>(task.stack_min_free));
+    if (task.heap_bytes >= 0) {
+      Append(out, &length, " %7d", static_cast<int>(task.heap_bytes));
+    } else {
+      Append(out, &length, " %7s", "?");
+    }
+    Append(out, &length, LowOnStack(task) ? " LOW\n" : "\n");
+  }
+  Append(out, &length, "heap free %u min %u largest %u\n",
+         static_cast<unsigned>(heap.free_bytes),
+         static_cast<unsigned>(heap.min_free_bytes),
+         static_cast<unsigned>(heap.largest_free_block));
+  return length;
+}
+
+#ifdef ARDUINO_ARCH_ESP32
+TaskMemory ReadTaskMemory(TaskHandle_t task, uint32_t stack_bytes) {
+  TaskMemory memory = {
+      .name = pcTaskGetName(task),
+      .stack_bytes = stack_bytes,
+      .stack_min_free = uxTaskGetStackHighWaterMark(task),
+  };
+#ifdef CONFIG_HEAP_TASK_TRACKING
+  // With caps and mask zero every heap matches.
+  heap_task_info_params_t params = {};
+  heap_task_totals_t totals[1] = {};
+  size_t num_totals = 0;
+  params.tasks = &task;
+  params.num_tasks = 1;
+  params.totals = totals;
+  params.num_totals = &num_totals;
+  params.max_totals = 1;
+  heap_caps_get_per_task_info(&params);
+  memory.heap_bytes = 0;
+  for (size_t i = 0; i < num_totals; ++i) {
+    for (size_t size : totals[i].size) memory.heap_bytes += size;
+  }
+#endif
+  return memory;
+}
+
+HeapMemory ReadHeapMemory() {
+  return {
+      .free_bytes = heap_caps_get_free_size(MALLOC_CAP_8BIT),
+      .min_free_bytes = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT),
+      .largest_free_block = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT),
+  };
+}
+#endif
+
+}  // namespace sched
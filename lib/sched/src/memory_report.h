@@ -0,0 +1,69 @@
+#ifndef SCHED_MEMORY_REPORT_H
+#define SCHED_MEMORY_REPORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+// Where the RAM goes at run time: each task's stack against the budget it was
+// declared with, the heap each task holds, and the state of the heap as a
+// whole. Collecting and formatting a report allocates nothing, so it can run
+// from any task. The static RAM (.data and .bss) is known at build time; see
+// tools/ram_report.py.
+namespace sched {
+
+// Stack sizes are in bytes, as FreeRTOS counts them on the ESP32.
+struct TaskMemory {
+  const char* name;
+  // The stack the task was created with.
+  uint32_t stack_bytes;
+  // The least stack that has ever been free, i.e. the high-water mark.
+  uint32_t stack_min_free;
+  // The heap the task has allocated and not freed, or -1 if unknown (heap
+  // task tracking is off).
+  int32_t heap_bytes = -1;
+
+  uint32_t stack_peak() const { return stack_bytes - stack_min_free; }
+};
+
+struct HeapMemory {
+  uint32_t free_bytes;
+  // The least the heap has ever had free.
+  uint32_t min_free_bytes;
+  // The largest single allocation that would currently succeed.
+  uint32_t largest_free_block;
+};
+
+// A task whose free stack has ever dropped below this is flagged in the
+// report: its budget has too little headroom for a deeper call path not yet
+// seen.
+constexpr uint32_t kStackHeadroomBytes = 256;
+
+inline bool LowOnStack(const TaskMemory& task) {
+  return task.stack_min_free < kStackHeadroomBytes;
+}
+
+// Writes a report of tasks and heap to out as lines of text, truncated to
+// fit, and always nul-terminated if out is not empty. Returns the length
+// written, excluding the terminator.
+size_t FormatMemoryReport(std::span<const TaskMemory> tasks,
+                          const HeapMemory& heap, std::span<char> out);
+
+#ifdef ARDUINO_ARCH_ESP32
+// Reads the stack high-water mark of task, which was created with
+// stack_bytes of stack, and the heap it holds if CONFIG_HEAP_TASK_TRACKING is
+// enabled.
+TaskMemory ReadTaskMemory(TaskHandle_t task, uint32_t stack_bytes);
+
+// Reads the state of the default (8-bit capable) heap.
+HeapMemory ReadHeapMemory();
+#endif
+
+}  // namespace sched
+
+#endif  // SCHED_MEMORY_REPORT_H
@@ -0,0 +1,140 @@
+#ifndef SCHED_SCHEDULER_H
+#define SCHED_SCHEDULER_H
+
+#include <FixedPointsCommon.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "clock.h"
+#include "jitter_histogram.h"
+
+namespace sched {
+
+// Describes the tick a stage is running in.
+struct Tick {
+  // Counts ticks since the scheduler started, including skipped ones.
+  uint32_t index;
+
+  // When the tick was supposed to start, and when it actually did.
+  uint32_t deadline_us;
+  uint32_t start_us;
+
+  // The measured time since the start of the previous tick. This, not the
+  // nominal period, is what should be passed to Pid::Update.
+  uint32_t dt_us;
+
+  // dt_us in milliseconds.
+  SQ15x16 dt_ms() const { return SQ15x16{SFixed<24, 4>{dt_us} / 1'000}; }
+};
+
+// One step of the control loop, e.g. sense, compute or actuate.
+class Stage {
+ public:
+  virtual ~Stage() {}
+  virtual void Run(const Tick& tick) = 0;
+};
+
+// Timing statistics for a Scheduler.
+struct SchedulerStats {
+  // How late each tick started relative to its deadline.
+  JitterHistogram start_jitter;
+
+  // Ticks whose stages ran past the next tick's deadline.
+  uint32_t overruns = 0;
+
+  // Deadlines that were skipped entirely because of overruns.
+  uint32_t skipped_ticks = 0;
+
+  // The longest time all stages took in one tick.
+  uint32_t max_busy_us = 0;
+};
+
+// Runs a fixed list of stages, in order, once per period. Deadlines are
+// absolute (start + n * period), so the loop does not drift no matter how long
+// the stages take or how late the clock wakes us.
+//
+// If a tick's stages run past the next deadline, that is counted as an
+// overrun. The scheduler then starts the next tick immediately, as long as it
+// is less than a full period late; deadlines that are a full period or more in
+// the past are skipped rather than run back to back.
+template <size_t kMaxStages>
+class Scheduler {
+ public:
+  Scheduler(Clock* clock, uint32_t period_us)
+      : clock_(clock), period_us_(period_us) {}
+
+  // Appends a stage. Returns false if kMaxStages stages are already added.
+  bool AddStage(Stage* stage) {
+    if (num_stages_ == kMaxStages) return false;
+    stages_[num_stages_++] = stage;
+    return true;
+  }
+
+  // Waits for the next deadline and runs every stage once.
+  void RunOnce();
+
+  // Runs ticks forever.
+  [[noreturn]] void Run() {
+    while (true) RunOnce();
+  }
+
+  uint32_t period_us() const { return period_us_; }
+  const SchedulerStats& stats() const { return stats_; }
+  void ClearStats() { stats_ = SchedulerStats(); }
+
+ private:
+  Clock* const clock_;
+  const uint32_t period_us_;
+  std::array<Stage*, kMaxStages> stages_{};
+  size_t num_stages_ = 0;
+
+  bool started_ = false;
+  uint32_t index_ = 0;
+  uint32_t next_deadline_ = 0;
+  uint32_t last_start_ = 0;
+  SchedulerStats stats_;
+};
+
+template <size_t kMaxStages>
+void Scheduler<kMaxStages>::RunOnce() {
+  if (!started_) {
+    // The first tick starts now and has no meaningful dt.
+    started_ = true;
+    next_deadline_ = clock_->NowMicros();
+    last_start_ = next_deadline_;
+  }
+  clock_->SleepUntil(next_deadline_);
+
+  const uint32_t start = clock_->NowMicros();
+  const Tick tick = {.index = index_,
+                     .deadline_us = next_deadline_,
+                     .start_us = start,
+                     .dt_us = start - last_start_};
+  stats_.start_jitter.Add(start - next_deadline_);
+  last_start_ = start;
+
+  for (size_t i = 0; i < num_stages_; ++i) stages_[i]->Run(tick);
+
+  const uint32_t end = clock_->NowMicros();
+  const uint32_t busy = end - start;
+  if (busy > stats_.max_busy_us) stats_.max_busy_us = busy;
+
+  ++index_;
+  next_deadline_ += period_us_;
+  if (static_cast<int32_t>(end - next_deadline_) > 0) {
+    ++stats_.overruns;
+    // Skip any deadline that is already a full period in the past.
+    while (static_cast<int32_t>(end - next_deadline_) >=
+           static_cast<int32_t>(period_us_)) {
+      next_deadline_ += period_us_;
+      ++index_;
+      ++stats_.skipped_ticks;
+    }
+  }
+}
+
+}  // namespace sched
+
+#endif  // SCHED_SCHEDULER_H
@@ -0,0 +1,231 @@
+#include "balancing_robot.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+namespace sim {
+namespace {
+
+constexpr double kDegrees = 180 / std::numbers::pi;
+
+}  // namespace
+
+// With x the axle's forward position and theta the pitch, the Lagrangian of
+// the chassis and both wheels gives
+//
+//   a x'' + b cos(theta) theta'' - b sin(theta) theta'^2 = tau / r
+//   b cos(theta) x'' + c theta'' - M g l sin(theta) = -tau
+//
+// where tau is the sum of the motor torques, which push the wheels forward
+// and the chassis back, and
+//
+//   a = M + 2 m_w + 2 I_w / r^2,  b = M l,  c = M l^2 + I_b.
+//
+// Yaw only sees the difference of the torques, through yaw_inertia_, which
+// includes the wheels' share.
+BalancingRobot::BalancingRobot(const RobotParams& params)
+    : params_(params),
+      motors_{DcMotor(params.motor), DcMotor(params.motor)},
+      a_(params.body.mass_kg + 2 * params.body.wheel_mass_kg +
+         2 * params.body.wheel_inertia / (params.body.wheel_radius_m *
+                                          params.body.wheel_radius_m)),
+      b_(params.body.mass_kg * params.body.com_height_m),
+      c_(params.body.mass_kg * params.body.com_height_m *
+             params.body.com_height_m +
+         params.body.pitch_inertia),
+      yaw_inertia_(params.body.yaw_inertia +
+                   (params.body.wheel_mass_kg +
+                    params.body.wheel_inertia /
+                        (params.body.wheel_radius_m *
+                         params.body.wheel_radius_m)) *
+                       params.body.track_width_m *
+                       params.body.track_width_m / 2) {}
+
+// With sin(theta) = theta, cos(theta) = 1 and theta'^2 = 0, and the wheel
+// angle phi = x / r - theta, the equations above solve to
+//
+//   theta'' = (a b g theta - (a + b / r) tau) / det
+//   phi''   = -(b g (b / r + a) theta - (c / r^2 + 2 b / r + a) tau) / det
+//
+// with det = a c - b^2. Each motor's torque is k_u u - k_w phi', from its
+// drive voltage and its back EMF and friction.
+LinearModel BalancingRobot::Linearize(const RobotParams& params) {
+  const BalancingRobot robot(params);
+  const double a = robot.a_, b = robot.b_, c = robot.c_;
+  const double r = params.body.wheel_radius_m;
+  const double g = params.body.gravity;
+  const DcMotorParams& motor = params.motor;
+  const double kt = motor.gear_ratio * motor.torque_constant;
+  const double k_u =
+      kt * motor.supply_volts / (motor.resistance_ohms * motor.max_duty);
+  const double k_w = kt * kt / motor.resistance_ohms + motor.viscous_friction;
+
+  const double det = a * c - b * b;
+  // How theta'' and phi'' depend on theta and on the total torque.
+  const double pitch_on_pitch = a * b * g / det;
+  const double pitch_on_torque = -(a + b / r) / det;
+  const double wheel_on_pitch = -b * g * (b / r + a) / det;
+  const double wheel_on_torque = (c / (r * r) + 2 * b / r + a) / det;
+
+  // The total torque of both motors is 2 k_u u - 2 k_w phi'; u is in duty
+  // and the model in degrees.
+  LinearModel model = {};
+  model.a[0][1] = 1;
+  model.a[1][0] = pitch_on_pitch;
+  model.a[1][3] = -2 * k_w * pitch_on_torque;
+  model.a[2][3] = 1;
+  model.a[3][0] = wheel_on_pitch;
+  model.a[3][3] = -2 * k_w * wheel_on_torque;
+  model.b[1] = 2 * k_u * pitch_on_torque * kDegrees;
+  model.b[3] = 2 * k_u * wheel_on_torque * kDegrees;
+  return model;
+}
+
+void BalancingRobot::Reset(double pitch_degrees, double pitch_rate_dps) {
+  state_ = {};
+  if (params_.mount == RobotParams::kFree) {
+    state_.pitch = pitch_degrees / kDegrees;
+    state_.pitch_rate = pitch_rate_dps / kDegrees;
+  }
+  fallen_ = false;
+}
+
+BalancingRobot::State BalancingRobot::Derivative(const State& s) const {
+  const BodyParams& body = params_.body;
+  std::array<double, 2> torque;
+  for (int i = 0; i < 2; ++i) {
+    torque[i] = motors_[i].Torque(s.wheel_rate[i] - s.pitch_rate);
+  }
+
+  State d{.pitch = s.pitch_rate,
+          .pitch_rate = 0,
+          .wheel = s.wheel_rate,
+          .wheel_rate = {}};
+  if (params_.mount == RobotParams::kClamped || fallen_) {
+    d.wheel_rate = {torque[0] / body.wheel_inertia,
+                    torque[1] / body.wheel_inertia};
+    return d;
+  }
+
+  const double r = body.wheel_radius_m;
+  const double sin = std::sin(s.pitch);
+  const double cos = std::cos(s.pitch);
+  const double tau = torque[0] + torque[1];
+  // The right-hand sides of the two equations above.
+  const double fx = tau / r + b_ * sin * s.pitch_rate * s.pitch_rate;
+  const double fpitch = b_ * body.gravity * sin - tau;
+  const double det = a_ * c_ - b_ * b_ * cos * cos;
+  const double accel = (c_ * fx - b_ * cos * fpitch) / det;
+  d.pitch_rate = (a_ * fpitch - b_ * cos * fx) / det;
+
+  const double yaw_accel = body.track_width_m / (2 * r) *
+                           (torque[kRight] - torque[kLeft]) / yaw_inertia_;
+  const double spin = body.track_width_m / 2 * yaw_accel;
+  d.wheel_rate[kLeft] = (accel - spin) / r;
+  d.wheel_rate[kRight] = (accel + spin) / r;
+  return d;
+}
+
+void BalancingRobot::Step(double dt) {
+  auto add = [](const State& s, const State& d, double h) {
+    return State{
+        .pitch = s.pitch + h * d.pitch,
+        .pitch_rate = s.pitch_rate + h * d.pitch_rate,
+        .wheel = {s.wheel[0] + h * d.wheel[0], s.wheel[1] + h * d.wheel[1]},
+        .wheel_rate = {s.wheel_rate[0] + h * d.wheel_rate[0],
+                       s.wheel_rate[1] + h * d.wheel_rate[1]},
+    };
+  };
+  const State k1 = Derivative(state_);
+  const State k2 = Derivative(add(state_, k1, dt / 2));
+  const State k3 = Derivative(add(state_, k2, dt / 2));
+  const State k4 = Derivative(add(state_, k3, dt));
+  state_ = add(state_, k1, dt / 6);
+  state_ = add(state_, k2, dt / 3);
+  state_ = add(state_, k3, dt / 3);
+  state_ = add(state_, k4, dt / 6);
+
+  const double limit = params_.body.fall_pitch_degrees / kDegrees;
+  if (!fallen_ && std::abs(state_.pitch) >= limit) {
+    fallen_ = true;
+    state_.pitch = std::clamp(state_.pitch, -limit, limit);
+    state_.pitch_rate = 0;
+  }
+}
+
+void BalancingRobot::Advance(uint32_t dt_us) {
+  while (dt_us > 0) {
+    const uint32_t step = std::min(dt_us, params_.physics_step_us);
+    Step(step * 1e-6);
+    time_us_ += step;
+    dt_us -= step;
+  }
+}
+
+double BalancingRobot::pitch_degrees() const {
+  return state_.pitch * kDegrees;
+}
+
+double BalancingRobot::pitch_rate_dps() const {
+  return state_.pitch_rate * kDegrees;
+}
+
+BalancingRobot::Accelerations BalancingRobot::accelerations() const {
+  const State d = Derivative(state_);
+  return {
+      .pitch = d.pitch_rate * kDegrees,
+      .forward = params_.body.wheel_radius_m *
+                 (d.wheel_rate[0] + d.wheel_rate[1]) / 2,
+  };
+}
+
+double BalancingRobot::position_m() const {
+  return params_.body.wheel_radius_m * (state_.wheel[0] + state_.wheel[1]) / 2;
+}
+
+double BalancingRobot::velocity_mps() const {
+  return params_.body.wheel_radius_m *
+         (state_.wheel_rate[0] + state_.wheel_rate[1]) / 2;
+}
+
+double BalancingRobot::yaw_degrees() const {
+  return params_.body.wheel_radius_m *
+         (state_.wheel[kRight] - state_.wheel[kLeft]) /
+         params_.body.track_width_m * kDegrees;
+}
+
+double BalancingRobot::yaw_rate_dps() const {
+  return params_.body.wheel_radius_m *
+         (state_.wheel_rate[kRight] - state_.wheel_rate[kLeft]) /
+         params_.body.track_width_m * kDegrees;
+}
+
+double BalancingRobot::wheel_degrees(Wheel wheel) const {
+  return (state_.wheel[wheel] - state_.pitch) * kDegrees;
+}
+
+double BalancingRobot::wheel_rate_dps(Wheel wheel) const {
+  return (state_.wheel_rate[wheel] - state_.pitch_rate) * kDegrees;
+}
+
+double BalancingRobot::Energy() const {
+  const BodyParams& body = params_.body;
+  if (params_.mount == RobotParams::kClamped) {
+    return body.wheel_inertia / 2 *
+           (state_.wheel_rate[0] * state_.wheel_rate[0] +
+            state_.wheel_rate[1] * state_.wheel_rate[1]);
+  }
+  const double v = velocity_mps();
+  const double yaw_rate = yaw_rate_dps() / kDegrees;
+  const double pitch_rate = state_.pitch_rate;
+  const double kinetic = a_ * v * v / 2 +
+                         b_ * std::cos(state_.pitch) * v * pitch_rate +
+                         c_ * pitch_rate * pitch_rate / 2 +
+                         yaw_inertia_ * yaw_rate * yaw_rate / 2;
+  const double potential =
+      b_ * body.gravity * (std::cos(state_.pitch) - 1);
+  return kinetic + potential;
+}
+
+}  // namespace sim
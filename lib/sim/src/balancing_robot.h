@@ -0,0 +1,167 @@
+#ifndef SIM_BALANCING_ROBOT_H
+#define SIM_BALANCING_ROBOT_H
+
+#include <array>
+#include <cstdint>
+
+#include "dc_motor.h"
+
+// A physics model of the self-balancing robot, for closed-loop tests of the
+// real controller code on the host. The motors and sensors implement the
+// same interfaces as the hardware, and with 1 ms control periods a simulated
+// second costs a few milliseconds.
+//
+// Conventions follow the robot's own: x is forward, z is up, and pitch is the
+// rotation about the axle (the IMU's Y axis) that tips the chassis forward.
+// A positive effort on either motor turns its wheel forward, and its magnet
+// sensor reads the wheel's rotation relative to the chassis as positive. On
+// the real robot, one side is mounted mirrored and its wiring is swapped to
+// match.
+
+namespace sim {
+
+enum Wheel {
+  kLeft,
+  kRight,
+};
+
+// The defaults are roughly a 0.5 kg robot with 68 mm wheels.
+struct BodyParams {
+  // The chassis, without the wheels. The pitch inertia is about the center
+  // of mass.
+  double mass_kg = 0.5;
+  double com_height_m = 0.06;
+  double pitch_inertia = 1e-3;
+  double yaw_inertia = 2e-3;
+
+  // Each wheel, with the inertia about its axle.
+  double wheel_mass_kg = 0.03;
+  double wheel_radius_m = 0.034;
+  double wheel_inertia = 1.7e-5;
+
+  // The distance between the wheels' contact points.
+  double track_width_m = 0.15;
+
+  // Beyond this pitch in degrees the chassis lies on the ground.
+  double fall_pitch_degrees = 60;
+
+  double gravity = 9.81;
+};
+
+struct RobotParams {
+  enum Mount {
+    // On the ground, rolling without slipping.
+    kFree,
+    // Held upright with the wheels off the ground, as on a test bench. Each
+    // wheel then only has its own inertia.
+    kClamped,
+  };
+
+  BodyParams body;
+  DcMotorParams motor;
+  Mount mount = kFree;
+
+  // The integration step. Advance splits longer intervals into steps of at
+  // most this length.
+  uint32_t physics_step_us = 250;
+};
+
+// The robot linearized about upright and at rest, with both motors driven at
+// the same effort u: x' = a x + b u. The state x is the pitch, the pitch rate,
+// the wheels' mean rotation relative to the chassis and its rate, as the IMU
+// and the motors' magnet sensors read them, in degrees and degrees/s. Every
+// state is an angle or its rate, so a is the same in radians; only b scales.
+struct LinearModel {
+  std::array<std::array<double, 4>, 4> a;
+  std::array<double, 4> b;
+};
+
+// A two-wheeled inverted pendulum. Both wheels roll without slipping, so the
+// chassis moves forward with their mean and yaws with their difference.
+// Pitch and forward motion use the full nonlinear equations, and yaw is
+// treated as independent of pitch. Integration is 4th order Runge-Kutta with
+// the motor drive held over each step.
+//
+// Once the pitch passes fall_pitch_degrees the robot is fallen: the chassis
+// stays where it landed and the wheels spin freely. Nothing after that is
+// meant to be realistic.
+class BalancingRobot {
+ public:
+  explicit BalancingRobot(const RobotParams& params = {});
+
+  BalancingRobot(const BalancingRobot&) = delete;
+  BalancingRobot& operator=(const BalancingRobot&) = delete;
+
+  DcMotor& motor(Wheel wheel) { return motors_[wheel]; }
+
+  // Places the robot at rest at the origin with the given pitch, and clears
+  // fallen(). The clock keeps running.
+  void Reset(double pitch_degrees = 0, double pitch_rate_dps = 0);
+
+  // Runs the physics for dt_us microseconds of simulated time.
+  void Advance(uint32_t dt_us);
+
+  // Simulated microseconds since construction.
+  uint64_t time_us() const { return time_us_; }
+
+  bool fallen() const { return fallen_; }
+
+  double pitch_degrees() const;
+  double pitch_rate_dps() const;
+
+  struct Accelerations {
+    double pitch;    // In degrees/s^2.
+    double forward;  // Of the axle, in m/s^2.
+  };
+
+  // The accelerations at the current state and drive.
+  Accelerations accelerations() const;
+
+  // The axle's distance travelled and forward speed.
+  double position_m() const;
+  double velocity_mps() const;
+
+  double yaw_degrees() const;
+  double yaw_rate_dps() const;
+
+  // The rotation of a wheel relative to the chassis, which is what its motor
+  // and magnet sensor see.
+  double wheel_degrees(Wheel wheel) const;
+  double wheel_rate_dps(Wheel wheel) const;
+
+  // The mechanical energy in joules, with zero upright and at rest. With
+  // coasting, frictionless motors it is conserved.
+  double Energy() const;
+
+  const RobotParams& params() const { return params_; }
+
+  // The model of a free robot linearized about upright, for designing
+  // controllers (see tools/lqr_gains). The motors are taken to be driven, so
+  // their back EMF always brakes the wheels.
+  static LinearModel Linearize(const RobotParams& params);
+
+ private:
+  // Pitch, then the absolute rotation of each wheel, and their rates: pitch
+  // and wheels in radians.
+  struct State {
+    double pitch, pitch_rate;
+    std::array<double, 2> wheel, wheel_rate;
+  };
+
+  State Derivative(const State& s) const;
+  void Step(double dt);
+
+  const RobotParams params_;
+  std::array<DcMotor, 2> motors_;
+
+  // Constant terms of the equations of motion; see the .cc file.
+  const double a_, b_, c_, yaw_inertia_;
+
+  State state_{};
+  uint64_t time_us_ = 0;
+  bool fallen_ = false;
+};
+
+}  // namespace sim
+
+#endif  // SIM_BALANCING_ROBOT_H
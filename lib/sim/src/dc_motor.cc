@@ -0,0 +1,44 @@
+#include "dc_motor.h"
+
+#include <algorithm>
+
+namespace sim {
+
+void DcMotor::Stop(motor::StopMode mode) {
+  bridge_ = mode == motor::kBrake ? kShorted : kOpen;
+  duty_ = 0;
+}
+
+void DcMotor::SetDirection(motor::Direction direction) {
+  bridge_ = direction == motor::kClockwise ? kForward : kReverse;
+}
+
+void DcMotor::SetDuty(int duty) {
+  duty_ = std::clamp(duty, 0, params_.max_duty);
+}
+
+double DcMotor::volts() const {
+  const double volts = params_.supply_volts * duty_ / params_.max_duty;
+  switch (bridge_) {
+    case kForward:
+      return volts;
+    case kReverse:
+      return -volts;
+    default:
+      return 0;
+  }
+}
+
+double DcMotor::Current(double speed) const {
+  if (bridge_ == kOpen) return 0;
+  // Both a driven and a shorted winding see the back EMF of the motor shaft.
+  const double back_emf = params_.torque_constant * params_.gear_ratio * speed;
+  return (volts() - back_emf) / params_.resistance_ohms;
+}
+
+double DcMotor::Torque(double speed) const {
+  return params_.gear_ratio * params_.torque_constant * Current(speed) -
+         params_.viscous_friction * speed;
+}
+
+}  // namespace sim
@@ -0,0 +1,78 @@
+#ifndef SIM_DC_MOTOR_H
+#define SIM_DC_MOTOR_H
+
+#include "motor.h"
+
+namespace sim {
+
+// A brushed DC gear motor. The defaults are roughly a 30:1 N20 motor on a
+// 2S LiPo.
+struct DcMotorParams {
+  double supply_volts = 7.4;
+  double resistance_ohms = 5;
+
+  // Torque per amp at the motor shaft in Nm/A, which is also the back EMF in
+  // V per rad/s.
+  double torque_constant = 0.005;
+
+  // Motor shaft turns per output shaft turn.
+  double gear_ratio = 30;
+
+  // Viscous friction at the output shaft, in Nm per rad/s.
+  double viscous_friction = 2e-4;
+
+  // The duty cycle that drives the motor at the full supply voltage, i.e. the
+  // top of the analogWrite range.
+  int max_duty = 255;
+};
+
+// Drives a DcMotor exactly as ThreeWireMotor drives an H-bridge with
+// IN1/IN2 direction pins and a PWM enable: SetDirection sets the pins,
+// SetDuty the PWM, and Stop sets both pins high (brake) or low (coast) and
+// the duty to 0.
+//
+// The model is the steady-state electrical one: inductance is ignored, since
+// its time constant is far below any control period. While the bridge drives
+// the motor the winding sees the duty-averaged supply voltage (the bridge
+// short-brakes during the off phase of the PWM). With both pins high the
+// winding is shorted, and with both low it is open and carries no current.
+class DcMotor final : public motor::Motor {
+ public:
+  explicit DcMotor(const DcMotorParams& params = {}) : params_(params) {}
+
+  void Stop(motor::StopMode mode = motor::kCoast) override;
+  void SetDirection(motor::Direction direction) override;
+
+  // Duties outside [0, max_duty] are clamped, as analogWrite would.
+  void SetDuty(int duty) override;
+
+  // Returns the torque in Nm on the output shaft when it turns at speed
+  // rad/s. Positive is clockwise.
+  double Torque(double speed) const;
+
+  // Returns the winding current in amps at the given output speed.
+  double Current(double speed) const;
+
+  // The voltage across the winding, averaged over a PWM period. Only
+  // meaningful while the bridge is driving.
+  double volts() const;
+
+  const DcMotorParams& params() const { return params_; }
+
+ private:
+  // The levels of the direction pins, as ThreeWireMotor would write them.
+  enum Bridge {
+    kForward,
+    kReverse,
+    kShorted,
+    kOpen,
+  };
+
+  const DcMotorParams params_;
+  Bridge bridge_ = kOpen;
+  int duty_ = 0;
+};
+
+}  // namespace sim
+
+#endif  // SIM_DC_MOTOR_H
@@ -0,0 +1,43 @@
+#ifndef SIM_LOOPBACK_H
+#define SIM_LOOPBACK_H
+
+#include <FixedPointsCommon.h>
+
+#include "motor.h"
+#include "sensor.h"
+
+namespace sim {
+
+// A motor and sensor that close the loop on themselves, with none of the
+// robot's physics: the sensor's rate follows the effort last sent to the
+// motor at once. Both are final, so a controller bound to them at compile
+// time can inline every call, and neither allocates.
+class LoopbackMotor final : public motor::Motor {
+ public:
+  void Stop(motor::StopMode /*mode*/) override { effort = 0; }
+  void SetDirection(motor::Direction /*direction*/) override {}
+  void SetDuty(int /*duty*/) override {}
+  void SetEffort(int e) override { effort = e; }
+
+  int effort = 0;
+};
+
+class LoopbackSensor final : public motor::Sensor {
+ public:
+  // The rate is gain times the motor's effort. The motor is not owned.
+  explicit LoopbackSensor(const LoopbackMotor* motor, int gain = 1)
+      : motor_(motor), gain_(gain) {}
+
+  SQ15x16 angle() override { return angle_; }
+  SQ15x16 rate() override { return motor_->effort * gain_; }
+  void SetAngle(SQ15x16 angle) override { angle_ = angle; }
+
+ private:
+  const LoopbackMotor* const motor_;
+  const int gain_;
+  SQ15x16 angle_ = 0;
+};
+
+}  // namespace sim
+
+#endif  // SIM_LOOPBACK_H
@@ -0,0 +1,39 @@
+#include "magnet_sensor.h"
+
+#include <cmath>
+
+#include "mlx90393_sensor.h"
+
+namespace sim {
+
+bool MagnetSensor::Update() {
+  const uint64_t t = robot_->time_us();
+  if (has_sample_ && t - t_ < params_.conversion_period_us) return false;
+
+  double reading = robot_->wheel_degrees(wheel_) +
+                   params_.noise_degrees * noise_(rng_);
+  reading -= 360 * std::floor(reading / 360);
+  if (params_.resolution_degrees > 0) {
+    reading = params_.resolution_degrees *
+              std::floor(reading / params_.resolution_degrees);
+  }
+  const SQ15x16 newangle = reading < 360 ? SQ15x16{reading} : SQ15x16{0};
+
+  const uint32_t dt_us = static_cast<uint32_t>(t - t_);
+  const SQ15x16 dt_ms = SQ15x16{SFixed<24, 4>{dt_us} / 1'000};
+  t_ = t;
+
+  const SQ15x16 delta = motor::UnwrapAngleDelta(newangle - rawangle_);
+  rawangle_ = newangle;
+  angle_ += delta;
+
+  if (has_sample_) {
+    speed_ = estimator_->Update(delta, dt_ms);
+  } else {
+    estimator_->Reset();
+    has_sample_ = true;
+  }
+  return true;
+}
+
+}  // namespace sim
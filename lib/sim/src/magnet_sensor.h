@@ -0,0 +1,71 @@
+#ifndef SIM_MAGNET_SENSOR_H
+#define SIM_MAGNET_SENSOR_H
+
+#include <FixedPointsCommon.h>
+
+#include <cstdint>
+#include <random>
+
+#include "balancing_robot.h"
+#include "sensor.h"
+#include "velocity_estimator.h"
+
+namespace sim {
+
+struct MagnetSensorParams {
+  // The step of the absolute angle reading, in degrees. The MLX90393 at its
+  // usual gain and a 6 mm magnet resolves about a tenth of a degree.
+  double resolution_degrees = 0.1;
+
+  // Standard deviation of the reading's noise, in degrees.
+  double noise_degrees = 0.05;
+
+  // The time between conversions. Update returns false if called sooner than
+  // this after the previous sample. 0 samples on every Update.
+  uint32_t conversion_period_us = 1000;
+};
+
+// A magnet-angle sensor on one wheel, standing in for MLX90393Sensor. Each
+// sample reads the wheel's angle relative to the chassis, adds noise, wraps
+// it to [0, 360) and quantizes it, and from then on follows MLX90393Sensor:
+// the angle is accumulated from unwrapped deltas, and the rate comes from a
+// motor::VelocityEstimator with dt from the simulated clock.
+class MagnetSensor final : public motor::Sensor {
+ public:
+  // Neither robot nor estimator is owned. If estimator is null, a
+  // FirstDifferenceEstimator is used.
+  MagnetSensor(const BalancingRobot* robot, Wheel wheel,
+               const MagnetSensorParams& params = {}, uint32_t seed = 1,
+               motor::VelocityEstimator* estimator = nullptr)
+      : robot_(robot),
+        wheel_(wheel),
+        params_(params),
+        rng_(seed),
+        estimator_(estimator != nullptr ? estimator : &first_difference_) {}
+
+  // Takes a new sample. Returns false if the next conversion is not done.
+  bool Update();
+
+  SQ15x16 angle() override { return angle_; }
+  SQ15x16 rate() override { return speed_; }
+  void SetAngle(SQ15x16 angle) override { angle_ = angle; }
+
+ private:
+  const BalancingRobot* const robot_;
+  const Wheel wheel_;
+  const MagnetSensorParams params_;
+  std::mt19937 rng_;
+  std::normal_distribution<double> noise_{0, 1};
+  motor::FirstDifferenceEstimator first_difference_;
+  motor::VelocityEstimator* const estimator_;
+  bool has_sample_ = false;
+
+  uint64_t t_ = 0;
+  SQ15x16 rawangle_ = 0;
+  SQ15x16 angle_ = 0;
+  SQ15x16 speed_ = 0;
+};
+
+}  // namespace sim
+
+#endif  // SIM_MAGNET_SENSOR_H
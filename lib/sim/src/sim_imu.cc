@@ -0,0 +1,38 @@
+#include "sim_imu.h"
+
+#include <cmath>
+#include <numbers>
+
+namespace sim {
+
+orientation::ImuSample SimImu::Read() {
+  constexpr double kRadians = std::numbers::pi / 180;
+  const double h = params_.height_m;
+  const double pitch = robot_->pitch_degrees() * kRadians;
+  const double rate = robot_->pitch_rate_dps() * kRadians;
+  const BalancingRobot::Accelerations accel = robot_->accelerations();
+  const double pitch_accel = accel.pitch * kRadians;
+  const double sin = std::sin(pitch);
+  const double cos = std::cos(pitch);
+
+  // The IMU's acceleration in the world frame, plus the reaction to gravity.
+  const double fx =
+      accel.forward + h * (pitch_accel * cos - rate * rate * sin);
+  const double fz = robot_->params().body.gravity -
+                    h * (pitch_accel * sin + rate * rate * cos);
+
+  auto noisy = [this](double value, double sigma) {
+    return SQ15x16{value + sigma * noise_(rng_)};
+  };
+  return {
+      .accel_x = noisy(fx * cos - fz * sin, params_.accel_noise),
+      .accel_y = noisy(0, params_.accel_noise),
+      .accel_z = noisy(fx * sin + fz * cos, params_.accel_noise),
+      .gyro_x = noisy(0, params_.gyro_noise),
+      .gyro_y = noisy(robot_->pitch_rate_dps() + params_.gyro_bias,
+                      params_.gyro_noise),
+      .gyro_z = noisy(robot_->yaw_rate_dps(), params_.gyro_noise),
+  };
+}
+
+}  // namespace sim
@@ -0,0 +1,46 @@
+#ifndef SIM_SIM_IMU_H
+#define SIM_SIM_IMU_H
+
+#include <cstdint>
+#include <random>
+
+#include "balancing_robot.h"
+#include "orientation.h"
+
+namespace sim {
+
+struct ImuParams {
+  // Height of the IMU above the axle, in meters.
+  double height_m = 0.08;
+
+  // Standard deviations of the noise on each axis, in m/s^2 and degrees/sec.
+  double accel_noise = 0.2;
+  double gyro_noise = 0.05;
+
+  // A constant offset added to the gyro's Y (pitch) rate, in degrees/sec.
+  double gyro_bias = 0;
+};
+
+// A 6-axis IMU on the chassis, standing in for Mpu6050Imu. Each Read returns
+// the specific force at the IMU in m/s^2, including the acceleration of the
+// chassis, and the angular rate, in the IMU axes described in
+// orientation.h, with noise.
+class SimImu {
+ public:
+  // The robot is not owned.
+  SimImu(const BalancingRobot* robot, const ImuParams& params = {},
+         uint32_t seed = 1)
+      : robot_(robot), params_(params), rng_(seed) {}
+
+  orientation::ImuSample Read();
+
+ private:
+  const BalancingRobot* const robot_;
+  const ImuParams params_;
+  std::mt19937 rng_;
+  std::normal_distribution<double> noise_{0, 1};
+};
+
+}  // namespace sim
+
+#endif  // SIM_SIM_IMU_H
@@ -0,0 +1,35 @@
+#include "water_heater.h"
+
+#include <cassert>
+
+namespace sim {
+
+void WaterHeaterModel::set_power(float power_fraction) {
+  assert(power_fraction >= 0 && power_fraction <= 1);
+  power_fraction_ = power_fraction;
+}
+
+void WaterHeaterModel::Update(int32_t dt_secs) {
+  // Calculate the temperature lost to water draining.
+  const float grams_drained = flow_rate_ * dt_secs;
+  const float delta_c_drain =
+      (grams_drained / water_mass_g_) * (input_temp_ - water_temp_);
+
+  // Calculate the temperature lost to the environment.
+  constexpr float surface_area_m2 = 2.5f;
+  constexpr float air_temp = 20.0f;
+  const float heat_lost_to_air =
+      surface_area_m2 * r_factor_ * (water_temp_ - air_temp) * dt_secs;
+  constexpr float water_specific_heat = 4.186f;  // J/g/C
+  const float delta_c_air =
+      -heat_lost_to_air / water_mass_g_ / water_specific_heat;
+
+  // Calculate the heat gained from the heating element.
+  const float energy_from_heater = power_fraction_ * max_power_ * dt_secs;
+  const float delta_c_heater =
+      energy_from_heater / water_mass_g_ / water_specific_heat;
+
+  water_temp_ = water_temp_ + delta_c_drain + delta_c_air + delta_c_heater;
+}
+
+}  // namespace sim
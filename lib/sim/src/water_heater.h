@@ -0,0 +1,55 @@
+#ifndef SIM_WATER_HEATER_H
+#define SIM_WATER_HEATER_H
+
+#include <cstdint>
+
+namespace sim {
+
+// A tank water heater: an electric element heats the water, which loses heat
+// to the surrounding air and to cold inflow replacing the hot water drawn
+// off. Temperatures are in celsius.
+class WaterHeaterModel {
+ public:
+  WaterHeaterModel(float water_mass_g, float r_factor, float input_temp_celcius,
+                   float max_power_joules)
+      : water_mass_g_(water_mass_g),
+        r_factor_(r_factor),
+        input_temp_(input_temp_celcius),
+        max_power_(max_power_joules),
+        // Default setpoint is 130f in celcius.
+        setpoint_(54),
+        water_temp_(input_temp_celcius),
+        power_fraction_(0),
+        flow_rate_(0) {}
+
+  float temp() const { return water_temp_; }
+
+  float setpoint() const { return setpoint_; }
+  void set_setpoint(float setpoint) { setpoint_ = setpoint; }
+
+  // 0 to 1
+  void set_power(float power_fraction);
+
+  // Sets the number of grams of water per second draining
+  // from the tank.
+  void set_flow_rate(float flow_rate) { flow_rate_ = flow_rate; }
+
+  // Updates the state of the water heater as if the given number of
+  // seconds have passed.
+  void Update(int32_t dt_secs);
+
+ private:
+  const float water_mass_g_;
+  const float r_factor_;
+  const float input_temp_;
+  const float max_power_;
+
+  int32_t setpoint_;
+  float water_temp_;
+  float power_fraction_;
+  float flow_rate_;
+};
+
+}  // namespace sim
+
+#endif  // SIM_WATER_HEATER_H
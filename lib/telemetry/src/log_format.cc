@@ -0,0 +1,125 @@
+#include "log_format.h"
+
+#include <cassert>
+#include <cstring>
+
+namespace telemetry {
+namespace {
+
+void PutU16(uint16_t v, uint8_t* out) {
+  out[0] = v & 0xff;
+  out[1] = v >> 8;
+}
+
+void PutU32(uint32_t v, uint8_t* out) {
+  for (int i = 0; i < 4; ++i) out[i] = (v >> (8 * i)) & 0xff;
+}
+
+}  // namespace
+
+size_t PutVarint(uint32_t v, uint8_t* out) {
+  size_t n = 0;
+  while (v >= 0x80) {
+    out[n++] = static_cast<uint8_t>(v | 0x80);
+    v >>= 7;
+  }
+  out[n++] = static_cast<uint8_t>(v);
+  return n;
+}
+
+bool GetVarint(const uint8_t*& p, const uint8_t* end, uint32_t& v) {
+  uint32_t result = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    if (p == end) return false;
+    const uint8_t byte = *p++;
+    result |= static_cast<uint32_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      v = result;
+      return true;
+    }
+  }
+  return false;
+}
+
+uint16_t Fletcher16(const uint8_t* data, size_t size, uint16_t checksum) {
+  uint32_t a = checksum & 0xFF, b = checksum >> 8;
+  while (size > 0) {
+    // 359 bytes is the most we can sum before b could overflow 32 bits.
+    const size_t block = size < 359 ? size : 359;
+    for (size_t i = 0; i < block; ++i) {
+      a += data[i];
+      b += a;
+    }
+    a %= 255;
+    b %= 255;
+    data += block;
+    size -= block;
+  }
+  return static_cast<uint16_t>((b << 8) | a);
+}
+
+size_t EncodeHeader(uint32_t ticks_per_second,
+                    std::span<const ChannelInfo> channels,
+                    std::span<uint8_t> out) {
+  uint8_t scratch[kMaxVarintSize];
+  size_t n = 0;
+  auto put = [&](const uint8_t* data, size_t size) {
+    if (n + size > out.size()) return false;
+    memcpy(out.data() + n, data, size);
+    n += size;
+    return true;
+  };
+  auto put_varint = [&](uint32_t v) {
+    return put(scratch, PutVarint(v, scratch));
+  };
+
+  if (!put(kLogMagic, sizeof(kLogMagic)) || !put(&kLogVersion, 1) ||
+      !put_varint(ticks_per_second) || !put_varint(channels.size())) {
+    return 0;
+  }
+  for (const ChannelInfo& channel : channels) {
+    const size_t length = strlen(channel.name);
+    if (!put_varint(channel.id) || !put_varint(length) ||
+        !put(reinterpret_cast<const uint8_t*>(channel.name), length)) {
+      return 0;
+    }
+  }
+  return n;
+}
+
+FrameEncoder::FrameEncoder(std::span<uint8_t> buffer) : buffer_(buffer) {
+  assert(buffer.size() >= kMinFrameBufferSize);
+  assert(buffer.size() - kFrameHeaderSize - kFrameTrailerSize <= 0xffff);
+}
+
+bool FrameEncoder::Add(const Record& record) {
+  if (size_ + kMaxRecordSize + kFrameTrailerSize > buffer_.size()) {
+    return false;
+  }
+  uint8_t* out = buffer_.data();
+  if (empty()) {
+    out[0] = kFrameSync[0];
+    out[1] = kFrameSync[1];
+    PutU32(record.timestamp, out + 4);
+    last_timestamp_ = record.timestamp;
+  }
+  size_ += PutVarint(record.channel, out + size_);
+  // Unsigned subtraction handles the 32-bit timestamp wrapping.
+  size_ += PutVarint(record.timestamp - last_timestamp_, out + size_);
+  PutU32(static_cast<uint32_t>(record.raw_value), out + size_);
+  size_ += 4;
+  last_timestamp_ = record.timestamp;
+  return true;
+}
+
+std::span<const uint8_t> FrameEncoder::Finish() {
+  if (empty()) return {};
+  uint8_t* out = buffer_.data();
+  PutU16(static_cast<uint16_t>(size_ - kFrameHeaderSize), out + 2);
+  PutU16(Fletcher16(out + 2, size_ - 2), out + size_);
+  const size_t frame_size = size_ + kFrameTrailerSize;
+  size_ = kFrameHeaderSize;
+  return buffer_.first(frame_size);
+}
+
+}  // namespace telemetry
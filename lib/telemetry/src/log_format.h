@@ -0,0 +1,94 @@
+#ifndef TELEMETRY_LOG_FORMAT_H
+#define TELEMETRY_LOG_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "record.h"
+
+// A compact binary encoding for streams of telemetry records, shared by the
+// firmware (which writes it to the serial port) and host tools (which decode
+// it, see lib/telemetry_host).
+//
+// A log is a header followed by any number of frames. A writer on a live
+// link repeats the header between frames every so often, so a reader that
+// attaches late can still name the channels:
+//
+//   header: "TLOG" u8:version varint:ticks_per_second varint:num_channels
+//           { varint:channel varint:name_length name_bytes }*
+//   frame:  u8:0xA5 u8:0x5A u16:payload_length u32:base_timestamp
+//           payload u16:checksum
+//   record: varint:channel varint:timestamp_delta i32:raw_value
+//
+// Multi-byte fixed-width fields are little-endian. Varints are LEB128. The
+// first record in a frame is relative to base_timestamp, and each later record
+// to the one before it, so a record at a steady rate takes six or seven
+// bytes. The checksum is Fletcher-16 over everything in the frame after the
+// sync bytes and before the checksum. Frames are independent, so a reader can
+// resynchronize after a corrupt or truncated frame by scanning for the next
+// sync bytes.
+namespace telemetry {
+
+constexpr uint8_t kLogMagic[4] = {'T', 'L', 'O', 'G'};
+constexpr uint8_t kLogVersion = 1;
+constexpr uint8_t kFrameSync[2] = {0xA5, 0x5A};
+
+constexpr size_t kFrameHeaderSize = 8;
+constexpr size_t kFrameTrailerSize = 2;
+constexpr size_t kMaxVarintSize = 5;
+constexpr size_t kMaxRecordSize = 3 + kMaxVarintSize + 4;
+constexpr size_t kMinFrameBufferSize =
+    kFrameHeaderSize + kMaxRecordSize + kFrameTrailerSize;
+
+// Names a channel in the log header.
+struct ChannelInfo {
+  Channel id;
+  const char* name;
+};
+
+// Writes v as a varint to out, which must have room for kMaxVarintSize bytes.
+// Returns the number of bytes written.
+size_t PutVarint(uint32_t v, uint8_t* out);
+
+// Reads a varint from [p, end) and advances p. Returns false if the input ends
+// early or the varint is longer than 32 bits.
+bool GetVarint(const uint8_t*& p, const uint8_t* end, uint32_t& v);
+
+// Returns the Fletcher-16 checksum of data. To checksum data that arrives in
+// pieces, pass each piece the checksum of the ones before it.
+uint16_t Fletcher16(const uint8_t* data, size_t size, uint16_t checksum = 0);
+
+// Writes a log header to out. ticks_per_second is the unit of the record
+// timestamps (e.g. 1'000'000 for micros()). Returns the number of bytes
+// written, or 0 if out is too small.
+size_t EncodeHeader(uint32_t ticks_per_second,
+                    std::span<const ChannelInfo> channels,
+                    std::span<uint8_t> out);
+
+// Packs records into frames in a caller-provided buffer. Does not allocate.
+class FrameEncoder {
+ public:
+  // buffer must be at least kMinFrameBufferSize bytes and no more than 64 KiB.
+  explicit FrameEncoder(std::span<uint8_t> buffer);
+
+  // Appends a record to the current frame. Returns false if the frame is full,
+  // in which case the caller should Finish() it and Add() the record again.
+  bool Add(const Record& record);
+
+  bool empty() const { return size_ == kFrameHeaderSize; }
+
+  // Completes the current frame and returns its bytes. The returned span is
+  // valid until the next call to Add. Returns an empty span if no records were
+  // added.
+  std::span<const uint8_t> Finish();
+
+ private:
+  const std::span<uint8_t> buffer_;
+  size_t size_ = kFrameHeaderSize;
+  uint32_t last_timestamp_ = 0;
+};
+
+}  // namespace telemetry
+
+#endif  // TELEMETRY_LOG_FORMAT_H
@@ -0,0 +1,53 @@
+#ifndef TELEMETRY_RECORD_H
+#define TELEMETRY_RECORD_H
+
+#include <FixedPointsCommon.h>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace telemetry {
+
+// Identifies what a record measures. Channel ids are assigned by the
+// application.
+using Channel = uint16_t;
+
+// One telemetry sample in binary form. Producing one is a few integer stores;
+// formatting it as text is left to whoever drains the records.
+struct Record {
+  // The time of the sample, in whatever tick the application uses. The
+  // firmware uses micros(), which wraps after ~71 minutes.
+  uint32_t timestamp;
+
+  // The raw representation of an SQ15x16 value.
+  int32_t raw_value;
+
+  Channel channel;
+
+  // Unused for now; keeps the record a multiple of four bytes.
+  uint16_t reserved;
+
+  static Record Make(uint32_t timestamp, Channel channel, SQ15x16 value) {
+    return Record{.timestamp = timestamp,
+                  .raw_value = value.getInternal(),
+                  .channel = channel,
+                  .reserved = 0};
+  }
+
+  // A record of a count, e.g. microseconds or events. Counts beyond the range
+  // of SQ15x16 are saturated to it rather than wrapped, so a value that large
+  // still reads as at least +-32767.
+  static Record MakeCount(uint32_t timestamp, Channel channel, int64_t count) {
+    return Make(timestamp, channel,
+                SQ15x16(static_cast<int32_t>(
+                    std::clamp<int64_t>(count, -32767, 32767))));
+  }
+
+  SQ15x16 value() const { return SQ15x16::fromInternal(raw_value); }
+};
+
+static_assert(sizeof(Record) == 12);
+
+}  // namespace telemetry
+
+#endif  // TELEMETRY_RECORD_H
@@ -0,0 +1,82 @@
+#ifndef TELEMETRY_SPSC_RING_H
+#define TELEMETRY_SPSC_RING_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace telemetry {
+
+// A fixed-size single-producer/single-consumer queue. Exactly one thread (or
+// task) may call TryPush and exactly one may call TryPop.
+//
+// Both sides are wait-free: each call does a bounded amount of work and never
+// blocks on the other side. When the queue is full, TryPush drops the new item
+// and counts it rather than waiting, so a slow consumer can never stall the
+// producer (e.g. the control loop).
+//
+// N must be a power of two. One slot is never used, so the queue holds up to
+// N - 1 items.
+template <typename T, size_t N>
+class SpscRing {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "N must be a power of two");
+
+ public:
+  SpscRing() = default;
+  SpscRing(const SpscRing&) = delete;
+  SpscRing& operator=(const SpscRing&) = delete;
+
+  // Producer side. Returns false, and counts a drop, if the queue is full.
+  bool TryPush(const T& item) {
+    const uint32_t head = head_.load(std::memory_order_relaxed);
+    const uint32_t next = (head + 1) & kMask;
+    if (next == tail_.load(std::memory_order_acquire)) {
+      // Only the producer writes dropped_, so this need not be an atomic
+      // read-modify-write.
+      dropped_.store(dropped_.load(std::memory_order_relaxed) + 1,
+                     std::memory_order_relaxed);
+      return false;
+    }
+    items_[head] = item;
+    head_.store(next, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side. Returns false if the queue is empty.
+  bool TryPop(T& item) {
+    const uint32_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_.load(std::memory_order_acquire)) return false;
+    item = items_[tail];
+    tail_.store((tail + 1) & kMask, std::memory_order_release);
+    return true;
+  }
+
+  // The number of items dropped because the queue was full. Safe to read from
+  // either side.
+  uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+  // The number of items waiting. Exact only when called from one of the two
+  // sides while the other is idle; otherwise a snapshot.
+  size_t size() const {
+    return (head_.load(std::memory_order_acquire) -
+            tail_.load(std::memory_order_acquire)) &
+           kMask;
+  }
+
+  static constexpr size_t capacity() { return N - 1; }
+
+ private:
+  static constexpr uint32_t kMask = N - 1;
+
+  // The producer and consumer indices are kept apart so the two sides do not
+  // keep invalidating each other's cache line.
+  alignas(64) std::atomic<uint32_t> head_{0};
+  std::atomic<uint32_t> dropped_{0};
+  alignas(64) std::atomic<uint32_t> tail_{0};
+  alignas(64) std::array<T, N> items_;
+};
+
+}  // namespace telemetry
+
+#endif  // TELEMETRY_SPSC_RING_H
@@ -0,0 +1,110 @@
+#include "log_export.h"
+
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace telemetry {
+namespace {
+
+double Seconds(const LogReader& reader, uint64_t timestamp) {
+  return reader.ticks_per_second() == 0
+             ? static_cast<double>(timestamp)
+             : static_cast<double>(timestamp) / reader.ticks_per_second();
+}
+
+}  // namespace
+
+void WriteLongCsv(LogReader& reader, FILE* out) {
+  fprintf(out, "t,channel,value\n");
+  reader.ForEach([&](const Sample& s) {
+    const std::string& name = reader.ChannelNameOf(s.channel);
+    if (name.empty()) {
+      fprintf(out, "%.6f,%u,%.5f\n", Seconds(reader, s.timestamp),
+              unsigned{s.channel}, float{s.value()});
+    } else {
+      fprintf(out, "%.6f,%s,%.5f\n", Seconds(reader, s.timestamp),
+              name.c_str(), float{s.value()});
+    }
+  });
+}
+
+void WriteWideCsv(LogReader& reader, FILE* out) {
+  const auto& channels = reader.channels();
+  std::map<Channel, size_t> column;
+  fprintf(out, "t");
+  for (size_t i = 0; i < channels.size(); ++i) {
+    column[channels[i].id] = i;
+    fprintf(out, ",%s", channels[i].name.c_str());
+  }
+  fprintf(out, "\n");
+
+  std::vector<float> row(channels.size());
+  std::vector<bool> present(channels.size());
+  bool have_row = false;
+  uint64_t row_timestamp = 0;
+  auto flush = [&] {
+    if (!have_row) return;
+    fprintf(out, "%.6f", Seconds(reader, row_timestamp));
+    for (size_t i = 0; i < row.size(); ++i) {
+      if (present[i]) {
+        fprintf(out, ",%.5f", row[i]);
+      } else {
+        fprintf(out, ",");
+      }
+      present[i] = false;
+    }
+    fprintf(out, "\n");
+  };
+  reader.ForEach([&](const Sample& s) {
+    const auto it = column.find(s.channel);
+    if (it == column.end()) return;
+    if (!have_row || s.timestamp != row_timestamp) {
+      flush();
+      have_row = true;
+      row_timestamp = s.timestamp;
+    }
+    row[it->second] = float{s.value()};
+    present[it->second] = true;
+  });
+  flush();
+}
+
+std::expected<void, std::string> WriteColumns(LogReader& reader,
+                                              const std::string& prefix) {
+  struct Files {
+    FILE* t = nullptr;
+    FILE* v = nullptr;
+  };
+  std::map<Channel, Files> files;
+  std::string error;
+  auto open = [&](const std::string& path) -> FILE* {
+    FILE* f = fopen(path.c_str(), "wb");
+    if (f == nullptr && error.empty()) error = path + ": " + strerror(errno);
+    return f;
+  };
+  reader.ForEach([&](const Sample& s) {
+    auto it = files.find(s.channel);
+    if (it == files.end()) {
+      std::string name = reader.ChannelNameOf(s.channel);
+      if (name.empty()) name = std::to_string(s.channel);
+      const std::string base = prefix + "." + name;
+      it = files.emplace(s.channel, Files{open(base + ".t"), open(base + ".v")})
+               .first;
+    }
+    const double t = Seconds(reader, s.timestamp);
+    const float v = float{s.value()};
+    if (it->second.t != nullptr) fwrite(&t, sizeof(t), 1, it->second.t);
+    if (it->second.v != nullptr) fwrite(&v, sizeof(v), 1, it->second.v);
+  });
+  for (auto& [channel, f] : files) {
+    if (f.t != nullptr) fclose(f.t);
+    if (f.v != nullptr) fclose(f.v);
+  }
+  if (!error.empty()) return std::unexpected(error);
+  return {};
+}
+
+}  // namespace telemetry
@@ -0,0 +1,31 @@
+#ifndef TELEMETRY_HOST_LOG_EXPORT_H
+#define TELEMETRY_HOST_LOG_EXPORT_H
+
+#include <cstdio>
+#include <expected>
+#include <string>
+
+#include "log_reader.h"
+
+namespace telemetry {
+
+// Writes one "timestamp,channel,value" row per record. Timestamps are in
+// seconds.
+void WriteLongCsv(LogReader& reader, FILE* out);
+
+// Writes one row per distinct timestamp with a column per channel, in the
+// order of the header's channel dictionary. Channels with no record at a
+// timestamp are left empty. Timestamps are in seconds.
+void WriteWideCsv(LogReader& reader, FILE* out);
+
+// Writes two raw little-endian arrays per channel, suitable for
+// numpy.fromfile:
+//
+//   <prefix>.<channel name>.t    float64 timestamps in seconds
+//   <prefix>.<channel name>.v    float32 values
+std::expected<void, std::string> WriteColumns(LogReader& reader,
+                                              const std::string& prefix);
+
+}  // namespace telemetry
+
+#endif  // TELEMETRY_HOST_LOG_EXPORT_H
@@ -0,0 +1,150 @@
+#include "log_reader.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+namespace telemetry {
+
+MappedFile::MappedFile(MappedFile&& other)
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) {
+  if (this != &other) {
+    this->~MappedFile();
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+  }
+  return *this;
+}
+
+MappedFile::~MappedFile() {
+  if (data_ != nullptr) {
+    munmap(const_cast<uint8_t*>(data_), size_);
+  }
+}
+
+std::expected<MappedFile, std::string> MappedFile::Open(
+    const std::string& path) {
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return std::unexpected(path + ": " + strerror(errno));
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    const std::string error = path + ": " + strerror(errno);
+    close(fd);
+    return std::unexpected(error);
+  }
+  const size_t size = st.st_size;
+  if (size == 0) {
+    close(fd);
+    return MappedFile(nullptr, 0);
+  }
+  void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    return std::unexpected(path + ": mmap: " + strerror(errno));
+  }
+  // Decoding is a single forward pass.
+  madvise(data, size, MADV_SEQUENTIAL);
+  return MappedFile(static_cast<const uint8_t*>(data), size);
+}
+
+std::expected<LogReader, std::string> LogReader::Parse(
+    std::span<const uint8_t> data) {
+  const uint8_t* const end = data.data() + data.size();
+  // A capture can start anywhere in the stream; the firmware repeats the
+  // header so there is always one to start from.
+  const uint8_t* p = std::search(data.data(), end, std::begin(kLogMagic),
+                                 std::end(kLogMagic));
+  if (end - p < static_cast<ptrdiff_t>(sizeof(kLogMagic) + 1)) {
+    return std::unexpected("not a telemetry log");
+  }
+  LogReader reader({});
+  const uint8_t* const frames = reader.ParseHeader(p, end);
+  if (frames == nullptr) return std::unexpected(reader.header_error_);
+  reader.frames_ = std::span<const uint8_t>(frames, end);
+  return reader;
+}
+
+const uint8_t* LogReader::ParseHeader(const uint8_t* p, const uint8_t* end) {
+  p += sizeof(kLogMagic);
+  if (*p++ != kLogVersion) {
+    header_error_ = "unsupported log version";
+    return nullptr;
+  }
+  uint32_t ticks_per_second, num_channels;
+  if (!GetVarint(p, end, ticks_per_second) ||
+      !GetVarint(p, end, num_channels)) {
+    header_error_ = "truncated header";
+    return nullptr;
+  }
+  std::vector<ChannelName> channels;
+  for (uint32_t i = 0; i < num_channels; ++i) {
+    uint32_t id, length;
+    if (!GetVarint(p, end, id) || !GetVarint(p, end, length) ||
+        static_cast<size_t>(end - p) < length) {
+      header_error_ = "truncated channel dictionary";
+      return nullptr;
+    }
+    channels.push_back(ChannelName{
+        .id = static_cast<Channel>(id),
+        .name = std::string(reinterpret_cast<const char*>(p), length)});
+    p += length;
+  }
+  ticks_per_second_ = ticks_per_second;
+  channels_ = std::move(channels);
+  return p;
+}
+
+const std::string& LogReader::ChannelNameOf(Channel id) const {
+  static const std::string kUnnamed;
+  for (const ChannelName& channel : channels_) {
+    if (channel.id == id) return channel.name;
+  }
+  return kUnnamed;
+}
+
+const uint8_t* LogReader::NextFrame(const uint8_t* p, const uint8_t* end) {
+  // Skip a repeated header between frames without counting it as damage.
+  if (end - p > static_cast<ptrdiff_t>(sizeof(kLogMagic)) &&
+      memcmp(p, kLogMagic, sizeof(kLogMagic)) == 0) {
+    LogReader header({});
+    if (const uint8_t* next = header.ParseHeader(p, end); next != nullptr) {
+      p = next;
+    }
+  }
+  bool skipped = false;
+  while (end - p >= static_cast<ptrdiff_t>(kFrameHeaderSize +
+                                           kFrameTrailerSize)) {
+    p = static_cast<const uint8_t*>(memchr(p, kFrameSync[0], end - p - 1));
+    if (p == nullptr) break;
+    if (p[1] == kFrameSync[1]) {
+      const size_t payload_size = p[2] | (p[3] << 8);
+      const size_t frame_size =
+          kFrameHeaderSize + payload_size + kFrameTrailerSize;
+      if (static_cast<size_t>(end - p) >= frame_size) {
+        const uint8_t* checksum = p + kFrameHeaderSize + payload_size;
+        if (Fletcher16(p + 2, frame_size - kFrameTrailerSize - 2) ==
+            (checksum[0] | (checksum[1] << 8))) {
+          if (skipped) ++corrupt_frames_;
+          return p;
+        }
+      }
+    }
+    skipped = true;
+    ++p;
+  }
+  if (skipped || p != end) ++corrupt_frames_;
+  return end;
+}
+
+}  // namespace telemetry
@@ -0,0 +1,135 @@
+#ifndef TELEMETRY_HOST_LOG_READER_H
+#define TELEMETRY_HOST_LOG_READER_H
+
+#include <FixedPointsCommon.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "log_format.h"
+#include "record.h"
+
+namespace telemetry {
+
+// A read-only memory mapping of a whole file. Captures can be many gigabytes,
+// so they are paged in by the OS as they are decoded rather than read into
+// memory.
+class MappedFile {
+ public:
+  MappedFile(MappedFile&& other);
+  MappedFile& operator=(MappedFile&& other);
+  ~MappedFile();
+
+  static std::expected<MappedFile, std::string> Open(const std::string& path);
+
+  std::span<const uint8_t> data() const { return {data_, size_}; }
+
+ private:
+  MappedFile(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+// A decoded record. Timestamps are extended to 64 bits, so they keep
+// increasing across wraps of the 32-bit on-device counter.
+struct Sample {
+  uint64_t timestamp;
+  Channel channel;
+  int32_t raw_value;
+
+  SQ15x16 value() const { return SQ15x16::fromInternal(raw_value); }
+};
+
+// Decodes a log in the format described in log_format.h. Anything before the
+// first header is skipped, so a capture may start in the middle of a stream,
+// and headers repeated between frames are skipped too. The reader does not
+// copy the data; it must outlive the reader.
+class LogReader {
+ public:
+  struct ChannelName {
+    Channel id;
+    std::string name;
+  };
+
+  static std::expected<LogReader, std::string> Parse(
+      std::span<const uint8_t> data);
+
+  uint32_t ticks_per_second() const { return ticks_per_second_; }
+  const std::vector<ChannelName>& channels() const { return channels_; }
+
+  // Returns the name of the channel, or an empty string if the header did not
+  // name it.
+  const std::string& ChannelNameOf(Channel id) const;
+
+  // Calls fn(const Sample&) for every record in the log, in order. Corrupt or
+  // truncated frames are skipped and counted in corrupt_frames().
+  template <typename Fn>
+  void ForEach(Fn&& fn);
+
+  size_t corrupt_frames() const { return corrupt_frames_; }
+
+ private:
+  LogReader(std::span<const uint8_t> frames) : frames_(frames) {}
+
+  static uint32_t ReadU32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (uint32_t{p[3]} << 24);
+  }
+
+  // Reads the header at p into this reader. Returns a pointer to the byte
+  // after it, or nullptr with header_error_ set.
+  const uint8_t* ParseHeader(const uint8_t* p, const uint8_t* end);
+
+  // Returns a pointer to the first intact frame at or after p, or end.
+  const uint8_t* NextFrame(const uint8_t* p, const uint8_t* end);
+
+  std::span<const uint8_t> frames_;
+  uint32_t ticks_per_second_ = 0;
+  std::vector<ChannelName> channels_;
+  const char* header_error_ = nullptr;
+  size_t corrupt_frames_ = 0;
+};
+
+template <typename Fn>
+void LogReader::ForEach(Fn&& fn) {
+  corrupt_frames_ = 0;
+  const uint8_t* p = frames_.data();
+  const uint8_t* const end = p + frames_.size();
+  uint64_t epoch = 0;
+  uint32_t last_base = 0;
+  while ((p = NextFrame(p, end)) != end) {
+    const size_t payload_size = p[2] | (p[3] << 8);
+    const uint32_t base = ReadU32(p + 4);
+    if (base < last_base) epoch += uint64_t{1} << 32;
+    last_base = base;
+
+    const uint8_t* r = p + kFrameHeaderSize;
+    const uint8_t* const payload_end = r + payload_size;
+    uint64_t timestamp = epoch + base;
+    while (r < payload_end) {
+      uint32_t channel, delta;
+      if (!GetVarint(r, payload_end, channel) ||
+          !GetVarint(r, payload_end, delta) || payload_end - r < 4) {
+        // The checksum matched, so this was written wrong rather than
+        // damaged in transit. Skip the rest of the frame.
+        ++corrupt_frames_;
+        break;
+      }
+      const uint32_t raw = ReadU32(r);
+      r += 4;
+      timestamp += delta;
+      fn(Sample{.timestamp = timestamp,
+                .channel = static_cast<Channel>(channel),
+                .raw_value = static_cast<int32_t>(raw)});
+    }
+    p = payload_end + kFrameTrailerSize;
+  }
+}
+
+}  // namespace telemetry
+
+#endif  // TELEMETRY_HOST_LOG_READER_H
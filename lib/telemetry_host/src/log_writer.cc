@@ -0,0 +1,46 @@
+#include "log_writer.h"
+
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace telemetry {
+
+std::expected<std::unique_ptr<LogWriter>, std::string> LogWriter::Open(
+    const std::string& path, uint32_t ticks_per_second,
+    std::span<const ChannelInfo> channels) {
+  FILE* f = fopen(path.c_str(), "wb");
+  if (f == nullptr) {
+    return std::unexpected(path + ": " + strerror(errno));
+  }
+  size_t header_size = 64;
+  for (const ChannelInfo& channel : channels) {
+    header_size += strlen(channel.name) + 2 * kMaxVarintSize;
+  }
+  std::vector<uint8_t> header(header_size);
+  const size_t n = EncodeHeader(ticks_per_second, channels, header);
+  if (n == 0 || fwrite(header.data(), 1, n, f) != n) {
+    fclose(f);
+    return std::unexpected(path + ": failed to write header");
+  }
+  return std::unique_ptr<LogWriter>(new LogWriter(f));
+}
+
+void LogWriter::Write(const Record& record) {
+  if (!encoder_.Add(record)) {
+    const auto frame = encoder_.Finish();
+    fwrite(frame.data(), 1, frame.size(), f_);
+    encoder_.Add(record);
+  }
+}
+
+void LogWriter::Close() {
+  if (f_ == nullptr) return;
+  const auto frame = encoder_.Finish();
+  fwrite(frame.data(), 1, frame.size(), f_);
+  fclose(f_);
+  f_ = nullptr;
+}
+
+}  // namespace telemetry
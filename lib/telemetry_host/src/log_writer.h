@@ -0,0 +1,46 @@
+#ifndef TELEMETRY_HOST_LOG_WRITER_H
+#define TELEMETRY_HOST_LOG_WRITER_H
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <expected>
+#include <memory>
+#include <span>
+#include <string>
+
+#include "log_format.h"
+#include "record.h"
+
+namespace telemetry {
+
+// Writes a binary telemetry log to a file. Used by host simulations and tests;
+// the firmware streams the same frames over the serial port.
+class LogWriter {
+ public:
+  LogWriter(LogWriter&& other) = delete;
+  ~LogWriter() { Close(); }
+
+  static std::expected<std::unique_ptr<LogWriter>, std::string> Open(
+      const std::string& path, uint32_t ticks_per_second,
+      std::span<const ChannelInfo> channels);
+
+  void Write(const Record& record);
+  void Write(uint32_t timestamp, Channel channel, SQ15x16 value) {
+    Write(Record::Make(timestamp, channel, value));
+  }
+
+  // Flushes the last frame and closes the file.
+  void Close();
+
+ private:
+  explicit LogWriter(FILE* f) : f_(f) {}
+
+  FILE* f_;
+  std::array<uint8_t, 4096> buffer_;
+  FrameEncoder encoder_{buffer_};
+};
+
+}  // namespace telemetry
+
+#endif  // TELEMETRY_HOST_LOG_WRITER_H
@@ -0,0 +1,69 @@
+#include "trace_reader.h"
+
+#include <algorithm>
+#include <bit>
+#include <format>
+#include <optional>
+
+#include "log_format.h"
+
+namespace motor {
+namespace {
+
+uint32_t GetU32(const uint8_t* p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | (uint32_t{p[3]} << 24);
+}
+
+uint16_t GetU16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+
+// Decodes the dump trace starts with.
+std::expected<std::vector<TraceEvent>, std::string> ParseDump(
+    std::span<const uint8_t> trace) {
+  if (trace.size() < kTraceHeaderSize) {
+    return std::unexpected("trace header is truncated");
+  }
+  if (trace[4] != kTraceVersion) {
+    return std::unexpected(
+        std::format("unsupported trace version {}", trace[4]));
+  }
+  const uint32_t count = GetU32(&trace[5]);
+  const size_t size = kTraceHeaderSize + size_t{count} * kTraceEventSize + 2;
+  if (trace.size() < size) {
+    return std::unexpected(
+        std::format("trace of {} events is truncated", count));
+  }
+
+  std::vector<TraceEvent> events;
+  events.reserve(count);
+  uint16_t checksum = 0;
+  const uint8_t* p = &trace[kTraceHeaderSize];
+  for (uint32_t i = 0; i < count; ++i, p += kTraceEventSize) {
+    checksum = telemetry::Fletcher16(p, kTraceEventSize, checksum);
+    events.push_back(
+        {.timestamp_us = GetU32(p),
+         .kind = static_cast<TraceEvent::Kind>(GetU16(p + 4)),
+         .command = static_cast<int16_t>(GetU16(p + 6)),
+         .field = {std::bit_cast<float>(GetU32(p + 8)),
+                   std::bit_cast<float>(GetU32(p + 12))}});
+  }
+  if (GetU16(p) != checksum) return std::unexpected("trace checksum mismatch");
+  return events;
+}
+
+}  // namespace
+
+std::expected<std::vector<TraceEvent>, std::string> ParseTrace(
+    std::span<const uint8_t> data) {
+  std::optional<std::string> first_error;
+  for (auto start = data.begin();; ++start) {
+    start = std::search(start, data.end(), std::begin(kTraceMagic),
+                        std::end(kTraceMagic));
+    if (start == data.end()) break;
+    auto events = ParseDump(std::span<const uint8_t>(start, data.end()));
+    if (events) return events;
+    if (!first_error) first_error = std::move(events.error());
+  }
+  return std::unexpected(first_error.value_or("no trace found"));
+}
+
+}  // namespace motor
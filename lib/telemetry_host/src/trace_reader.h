@@ -0,0 +1,27 @@
+#ifndef TELEMETRY_HOST_TRACE_READER_H
+#define TELEMETRY_HOST_TRACE_READER_H
+
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "trace.h"
+
+namespace motor {
+
+// Finds the first trace dump (see trace.h) in data, which may hold other
+// output around it, and decodes it.
+//
+// Every occurrence of the magic is a candidate: one that does not start a
+// whole dump with a good checksum, such as the magic turning up in text or a
+// dump cut short by a reset, is skipped in favor of the next. Dumps after the
+// first good one are ignored; pass the data after it to read them. If no
+// candidate decodes, the error is why the first one did not.
+std::expected<std::vector<TraceEvent>, std::string> ParseTrace(
+    std::span<const uint8_t> data);
+
+}  // namespace motor
+
+#endif  // TELEMETRY_HOST_TRACE_READER_H
@@ -0,0 +1,313 @@
+#include "differential.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+
+#include "cycle_counter.h"
+
+namespace tune {
+namespace {
+
+// The same algorithm and features as intpid::Pid, in double and without the
+// telemetry.
+using ReferencePid = intpid::BasicPid<
+    double, intpid::Features<intpid::Terms::kPID, intpid::AntiWindup::kCutoff,
+                             false, false>>;
+
+class Plant {
+ public:
+  explicit Plant(const PlantParams& params) : params_(params) {}
+
+  double output() const {
+    return params_.kind == PlantParams::kThirdOrderLag ? x_[2] : x_[0];
+  }
+
+  void Update(double input, double dt) {
+    constexpr int kSubsteps = 10;
+    const double h = dt / kSubsteps;
+    const double u = params_.gain * input;
+    const double tau = params_.tau;
+    for (int i = 0; i < kSubsteps; ++i) {
+      switch (params_.kind) {
+        case PlantParams::kLag:
+          x_[0] += h * (u - x_[0]) / tau;
+          break;
+        case PlantParams::kThirdOrderLag:
+          x_[0] += h * (u - x_[0]) / tau;
+          x_[1] += h * (x_[0] - x_[1]) / tau;
+          x_[2] += h * (x_[1] - x_[2]) / tau;
+          break;
+        case PlantParams::kSecondOrder:
+          // Semi-implicit Euler: velocity first, then position with the new
+          // velocity, which keeps a lightly damped plant from gaining energy.
+          x_[1] += h * ((u - x_[0]) / (tau * tau) -
+                        2 * params_.zeta * x_[1] / tau);
+          x_[0] += h * x_[1];
+          break;
+        case PlantParams::kIntegratingLag:
+          x_[1] += h * (u - x_[1]) / tau;
+          x_[0] += h * x_[1];
+          break;
+      }
+    }
+  }
+
+ private:
+  const PlantParams params_;
+  std::array<double, 3> x_ = {};
+};
+
+const char* KindName(PlantParams::Kind kind) {
+  switch (kind) {
+    case PlantParams::kLag:
+      return "lag";
+    case PlantParams::kThirdOrderLag:
+      return "lag3";
+    case PlantParams::kSecondOrder:
+      return "second_order";
+    case PlantParams::kIntegratingLag:
+      return "integrating";
+  }
+  return "?";
+}
+
+}  // namespace
+
+DifferentialReport RunDifferential(const DifferentialCase& c) {
+  DifferentialReport report;
+  report.output_range = c.config.output_max - c.config.output_min;
+  auto reference = ReferencePid::Create(c.config);
+  auto open_loop = intpid::Pid::Create(c.config);
+  auto closed_loop = intpid::Pid::Create(c.config);
+  if (!reference || !open_loop || !closed_loop || c.profile.empty()) {
+    constexpr double kInf = std::numeric_limits<double>::infinity();
+    report.max_output_divergence = report.rms_output_divergence = kInf;
+    report.max_tracking_divergence = report.rms_tracking_divergence = kInf;
+    return report;
+  }
+
+  Plant reference_plant(c.plant), fixed_plant(c.plant);
+  std::mt19937 rng(c.seed);
+  std::normal_distribution<double> noise(0, 1);
+  const SQ15x16 fixed_dt = c.dt;
+
+  const double initial = c.profile[0].setpoint;
+  reference->set_setpoint(initial);
+  open_loop->set_setpoint(initial);
+  closed_loop->set_setpoint(initial);
+  reference->Update(0, 0);
+  open_loop->Update(0, 0);
+  closed_loop->Update(0, 0);
+
+  double output_squares = 0, tracking_squares = 0;
+  int64_t samples = 0;
+  for (const Hold& hold : c.profile) {
+    reference->set_setpoint(hold.setpoint);
+    open_loop->set_setpoint(hold.setpoint);
+    closed_loop->set_setpoint(hold.setpoint);
+
+    // The extremes of each loop's plant output over the end of the hold.
+    const int window = hold.updates - hold.updates / 3;
+    double reference_min = std::numeric_limits<double>::infinity();
+    double reference_max = -reference_min;
+    double fixed_min = reference_min, fixed_max = reference_max;
+
+    for (int i = 0; i < hold.updates; ++i) {
+      const double e = c.noise > 0 ? c.noise * noise(rng) : 0;
+      const double reference_measurement = reference_plant.output() + e;
+      const double fixed_measurement = fixed_plant.output() + e;
+
+      const double reference_output =
+          reference->Update(reference_measurement, c.dt);
+      const double open_output =
+          float{open_loop->Update(reference_measurement, fixed_dt)};
+      const double closed_output =
+          float{closed_loop->Update(fixed_measurement, fixed_dt)};
+      reference_plant.Update(reference_output, c.dt);
+      fixed_plant.Update(closed_output, c.dt);
+
+      const double output_divergence =
+          std::abs(open_output - reference_output);
+      const double tracking_divergence =
+          std::abs(fixed_plant.output() - reference_plant.output());
+      report.max_output_divergence =
+          std::max(report.max_output_divergence, output_divergence);
+      report.max_tracking_divergence =
+          std::max(report.max_tracking_divergence, tracking_divergence);
+      output_squares += output_divergence * output_divergence;
+      tracking_squares += tracking_divergence * tracking_divergence;
+      ++samples;
+
+      if (i >= window) {
+        reference_min = std::min(reference_min, reference_plant.output());
+        reference_max = std::max(reference_max, reference_plant.output());
+        fixed_min = std::min(fixed_min, fixed_plant.output());
+        fixed_max = std::max(fixed_max, fixed_plant.output());
+      }
+    }
+    if (hold.updates - window > 0) {
+      const double excess =
+          (fixed_max - fixed_min) - (reference_max - reference_min);
+      report.limit_cycle_swing = std::max(report.limit_cycle_swing, excess);
+    }
+  }
+  report.rms_output_divergence = std::sqrt(output_squares / samples);
+  report.rms_tracking_divergence = std::sqrt(tracking_squares / samples);
+  report.limit_cycle = report.limit_cycle_swing > c.limit_cycle_band;
+  return report;
+}
+
+DifferentialCase RandomDifferentialCase(uint32_t seed,
+                                        const CaseRanges& ranges) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> unit(0, 1);
+  const auto uniform = [&](double lo, double hi) {
+    return lo + (hi - lo) * unit(rng);
+  };
+  const auto log_uniform = [&](double lo, double hi) {
+    return lo * std::pow(hi / lo, unit(rng));
+  };
+  const auto chance = [&](double p) { return unit(rng) < p; };
+
+  DifferentialCase c;
+  c.seed = seed;
+  PlantParams& plant = c.plant;
+  plant.kind = static_cast<PlantParams::Kind>(
+      std::uniform_int_distribution<int>(0, 3)(rng));
+
+  // The measurement and output scales, and the update period.
+  const double scale = log_uniform(ranges.min_scale, ranges.max_scale);
+  c.scale = scale;
+  const double limit = log_uniform(ranges.min_limit, ranges.max_limit);
+  const bool bipolar = chance(.5);
+  c.dt = ranges.periods[std::uniform_int_distribution<size_t>(
+      0, ranges.periods.size() - 1)(rng)];
+  const double tau_updates = log_uniform(5, 200);
+  plant.tau = tau_updates * c.dt;
+
+  // Gains from the usual rules of thumb for each plant, detuned at random.
+  // kd is per update, so Td is divided by dt.
+  double kp = 0, ti = 1, td = 0;
+  switch (plant.kind) {
+    case PlantParams::kLag:
+      plant.gain = scale * uniform(2, 4) / limit;
+      kp = log_uniform(.5, 4) / plant.gain;
+      ti = plant.tau * log_uniform(.5, 2);
+      td = plant.tau * uniform(.05, .25);
+      break;
+    case PlantParams::kThirdOrderLag:
+      plant.gain = scale * uniform(2, 4) / limit;
+      kp = log_uniform(.3, 2) / plant.gain;
+      ti = plant.tau * log_uniform(2, 5);
+      td = plant.tau * uniform(.2, .6);
+      break;
+    case PlantParams::kSecondOrder:
+      plant.gain = scale * uniform(2, 4) / limit;
+      plant.zeta = uniform(.2, 1);
+      kp = log_uniform(.5, 4) / plant.gain;
+      ti = plant.tau * log_uniform(1, 4);
+      td = plant.tau * uniform(.1, .5);
+      break;
+    case PlantParams::kIntegratingLag:
+      // Full output covers the scale in a few time constants.
+      plant.gain = scale * uniform(.5, 1) / (limit * plant.tau);
+      kp = log_uniform(.1, .5) / (plant.gain * plant.tau);
+      ti = plant.tau * log_uniform(10, 40);
+      td = plant.tau * uniform(.3, 1);
+      break;
+  }
+  c.config = {.kp = static_cast<float>(kp),
+              .ki = static_cast<float>(kp / ti),
+              .kd = chance(.5) ? static_cast<float>(kp * td / c.dt) : 0,
+              .output_min = static_cast<float>(bipolar ? -limit : 0),
+              .output_max = static_cast<float>(limit)};
+  if (chance(.3)) c.config.p_setpoint_weight = uniform(.3, 1);
+  if (chance(.2)) c.config.d_setpoint_weight = 1;
+  if (chance(.3)) c.config.derivative_filter = log_uniform(2, 20);
+
+  // Steps between setpoints the output range can hold, each long enough to
+  // settle.
+  const int updates = std::clamp(
+      static_cast<int>(tau_updates *
+                       (plant.kind == PlantParams::kLag ? 10 : 30)),
+      200, 6000);
+  const double low = bipolar ? -scale : .1 * scale;
+  for (int i = 0; i < 4; ++i) {
+    c.profile.push_back({.setpoint = uniform(low, scale), .updates = updates});
+  }
+
+  c.noise = chance(.5) ? 0 : scale * log_uniform(1e-4, 1e-2);
+  c.limit_cycle_band = .01 * scale + 4 * c.noise;
+  return c;
+}
+
+std::string Describe(const DifferentialCase& c) {
+  char text[512];
+  snprintf(text, sizeof(text),
+           "%s scale=%.4g gain=%.4g tau=%.4g zeta=%.2g dt=%g kp=%.4g ki=%.4g "
+           "kd=%.4g out=[%g,%g] b=%g c=%g N=%g noise=%.3g seed=%u",
+           KindName(c.plant.kind), c.scale, c.plant.gain, c.plant.tau,
+           c.plant.zeta, c.dt, c.config.kp, c.config.ki, c.config.kd,
+           c.config.output_min, c.config.output_max,
+           c.config.p_setpoint_weight, c.config.d_setpoint_weight,
+           c.config.derivative_filter, c.noise,
+           static_cast<unsigned>(c.seed));
+  return text;
+}
+
+UpdateCost MeasureUpdateCost(const intpid::Config& config, int updates) {
+  UpdateCost cost = {};
+  auto fixed = intpid::Pid::Create(config);
+  auto reference = ReferencePid::Create(config);
+  if (!fixed || !reference || updates <= 0) return cost;
+
+  // Measurements across the output range, so the controllers go in and out
+  // of saturation as they do in use.
+  std::array<double, 64> measurements;
+  const double mid = (config.output_max + config.output_min) / 2;
+  const double span = config.output_max - config.output_min;
+  for (size_t i = 0; i < measurements.size(); ++i) {
+    measurements[i] = mid + span * (static_cast<double>(i * 37 % 64) / 64 - .5);
+  }
+  std::array<SQ15x16, 64> fixed_measurements;
+  for (size_t i = 0; i < measurements.size(); ++i) {
+    fixed_measurements[i] = measurements[i];
+  }
+  fixed->set_setpoint(mid);
+  reference->set_setpoint(mid);
+
+  using Clock = std::chrono::steady_clock;
+  [[maybe_unused]] volatile int32_t fixed_sink = 0;
+  const SQ15x16 fixed_dt = 1;
+  auto start = Clock::now();
+  uint64_t start_cycles = hosthal::ReadCycles();
+  for (int i = 0; i < updates; ++i) {
+    fixed_sink = fixed->Update(fixed_measurements[i & 63], fixed_dt)
+                     .getInternal();
+  }
+  cost.fixed_cycles =
+      static_cast<double>(hosthal::ReadCycles() - start_cycles) / updates;
+  cost.fixed_ns =
+      std::chrono::duration<double, std::nano>(Clock::now() - start).count() /
+      updates;
+
+  [[maybe_unused]] volatile double reference_sink = 0;
+  start = Clock::now();
+  start_cycles = hosthal::ReadCycles();
+  for (int i = 0; i < updates; ++i) {
+    reference_sink = reference->Update(measurements[i & 63], 1);
+  }
+  cost.reference_cycles =
+      static_cast<double>(hosthal::ReadCycles() - start_cycles) / updates;
+  cost.reference_ns =
+      std::chrono::duration<double, std::nano>(Clock::now() - start).count() /
+      updates;
+  return cost;
+}
+
+}  // namespace tune
@@ -0,0 +1,128 @@
+#ifndef TUNE_DIFFERENTIAL_H
+#define TUNE_DIFFERENTIAL_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "intpid.h"
+
+// Differential testing of the fixed point Pid against the same algorithm in
+// double precision, to measure what fixed point costs in control quality and
+// to find the configs where it breaks down.
+//
+// Each case runs three controllers in lockstep over one setpoint profile:
+//
+//  - The reference, a BasicPid<double>, in closed loop with its own plant.
+//  - A Pid fed the reference loop's measurements. Its output minus the
+//    reference's is the controller's arithmetic error alone.
+//  - A Pid in closed loop with its own copy of the plant. Its plant output
+//    minus the reference plant's is what the error does to the loop, and its
+//    behavior at the end of each setpoint hold shows limit cycles.
+
+namespace tune {
+
+// A linear plant, simulated in double with several Euler substeps per update.
+struct PlantParams {
+  enum Kind {
+    // gain / (tau s + 1)
+    kLag,
+    // gain / (tau s + 1)^3
+    kThirdOrderLag,
+    // gain w^2 / (s^2 + 2 zeta w s + w^2), with w = 1 / tau.
+    kSecondOrder,
+    // gain / (s (tau s + 1)), e.g. a motor's position.
+    kIntegratingLag,
+  };
+
+  Kind kind = kLag;
+  double gain = 1;
+  double tau = 1;
+  double zeta = 1;
+};
+
+// One hold of the setpoint profile.
+struct Hold {
+  double setpoint;
+  int updates;
+};
+
+struct DifferentialCase {
+  intpid::Config config;
+  PlantParams plant;
+  std::vector<Hold> profile;
+  double dt = 1;
+
+  // The largest setpoint magnitude the profile might use, to put the
+  // tracking divergence in proportion.
+  double scale = 1;
+
+  // The standard deviation of Gaussian noise added to every measurement.
+  // Every loop sees the same noise.
+  double noise = 0;
+  uint32_t seed = 1;
+
+  // The loop is limit cycling if, over the last third of a hold, the fixed
+  // point loop's plant output swings this much more (peak to peak) than the
+  // reference's, in measurement units.
+  double limit_cycle_band = 0;
+};
+
+struct DifferentialReport {
+  // |fixed output - reference output| for the same measurements.
+  double max_output_divergence = 0;
+  double rms_output_divergence = 0;
+
+  // |fixed loop plant output - reference loop plant output|.
+  double max_tracking_divergence = 0;
+  double rms_tracking_divergence = 0;
+
+  // The largest excess swing of the fixed point loop at the end of a hold
+  // (see DifferentialCase::limit_cycle_band), and whether it was over the
+  // band.
+  double limit_cycle_swing = 0;
+  bool limit_cycle = false;
+
+  // The controllers' output range, output_max - output_min, to put the
+  // output divergence in proportion.
+  double output_range = 0;
+};
+
+// Runs the case. A config Pid::Create rejects runs nothing and reports
+// infinite divergence.
+DifferentialReport RunDifferential(const DifferentialCase& c);
+
+// The ranges RandomDifferentialCase draws from. The defaults span everything
+// the fixed point Pid claims to support: outputs within +-16383, and
+// measurements no smaller than about 0.1.
+struct CaseRanges {
+  // The largest setpoint magnitude, drawn on a log scale.
+  double min_scale = .1, max_scale = 1000;
+  // The output limit magnitude, drawn on a log scale.
+  double min_limit = 1, max_limit = 10000;
+  // The update period is one of these.
+  std::vector<double> periods = {1, .01, .001};
+};
+
+// A random case: plant kind, scale and time constant, a config designed for
+// it with randomly detuned gains and random output limits, setpoint weights
+// and derivative filter, and a profile of setpoint steps.
+DifferentialCase RandomDifferentialCase(uint32_t seed,
+                                        const CaseRanges& ranges = {});
+
+// A one-line description of the case for reports.
+std::string Describe(const DifferentialCase& c);
+
+// The average cost of one Update, in cycles of the CPU's timestamp counter
+// (0 where there is none) and in nanoseconds.
+struct UpdateCost {
+  double fixed_cycles, reference_cycles;
+  double fixed_ns, reference_ns;
+};
+
+// Times updates calls to Update on each controller built from config.
+UpdateCost MeasureUpdateCost(const intpid::Config& config, int updates);
+
+}  // namespace tune
+
+#endif  // TUNE_DIFFERENTIAL_H
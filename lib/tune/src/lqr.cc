@@ -0,0 +1,208 @@
+#include "lqr.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace tune {
+
+Matrix::Matrix(std::initializer_list<std::initializer_list<double>> rows)
+    : rows_(rows.size()), cols_(rows.size() ? rows.begin()->size() : 0) {
+  v_.reserve(rows_ * cols_);
+  for (const auto& row : rows) v_.insert(v_.end(), row.begin(), row.end());
+}
+
+Matrix Matrix::Identity(int n) {
+  Matrix m(n, n);
+  for (int i = 0; i < n; ++i) m(i, i) = 1;
+  return m;
+}
+
+Matrix Matrix::Diagonal(const std::vector<double>& diagonal) {
+  const int n = diagonal.size();
+  Matrix m(n, n);
+  for (int i = 0; i < n; ++i) m(i, i) = diagonal[i];
+  return m;
+}
+
+Matrix Matrix::Transposed() const {
+  Matrix t(cols_, rows_);
+  for (int r = 0; r < rows_; ++r) {
+    for (int c = 0; c < cols_; ++c) t(c, r) = (*this)(r, c);
+  }
+  return t;
+}
+
+double Matrix::Norm() const {
+  double norm = 0;
+  for (int r = 0; r < rows_; ++r) {
+    double sum = 0;
+    for (int c = 0; c < cols_; ++c) sum += std::abs((*this)(r, c));
+    norm = std::max(norm, sum);
+  }
+  return norm;
+}
+
+Matrix operator+(const Matrix& a, const Matrix& b) {
+  Matrix sum = a;
+  for (size_t i = 0; i < sum.v_.size(); ++i) sum.v_[i] += b.v_[i];
+  return sum;
+}
+
+Matrix operator-(const Matrix& a, const Matrix& b) {
+  Matrix difference = a;
+  for (size_t i = 0; i < difference.v_.size(); ++i) {
+    difference.v_[i] -= b.v_[i];
+  }
+  return difference;
+}
+
+Matrix operator*(const Matrix& a, const Matrix& b) {
+  Matrix product(a.rows_, b.cols_);
+  for (int r = 0; r < a.rows_; ++r) {
+    for (int k = 0; k < a.cols_; ++k) {
+      const double x = a(r, k);
+      for (int c = 0; c < b.cols_; ++c) product(r, c) += x * b(k, c);
+    }
+  }
+  return product;
+}
+
+Matrix operator*(double s, const Matrix& a) {
+  Matrix product = a;
+  for (double& x : product.v_) x *= s;
+  return product;
+}
+
+std::expected<Matrix, std::string> Inverse(const Matrix& m) {
+  const int n = m.rows();
+  Matrix a = m;
+  Matrix inverse = Matrix::Identity(n);
+  for (int col = 0; col < n; ++col) {
+    int pivot = col;
+    for (int r = col + 1; r < n; ++r) {
+      if (std::abs(a(r, col)) > std::abs(a(pivot, col))) pivot = r;
+    }
+    if (!(std::abs(a(pivot, col)) > 1e-300)) {
+      return std::unexpected("matrix is singular");
+    }
+    for (int c = 0; c < n; ++c) {
+      std::swap(a(col, c), a(pivot, c));
+      std::swap(inverse(col, c), inverse(pivot, c));
+    }
+    const double scale = 1 / a(col, col);
+    for (int c = 0; c < n; ++c) {
+      a(col, c) *= scale;
+      inverse(col, c) *= scale;
+    }
+    for (int r = 0; r < n; ++r) {
+      if (r == col || a(r, col) == 0) continue;
+      const double factor = a(r, col);
+      for (int c = 0; c < n; ++c) {
+        a(r, c) -= factor * a(col, c);
+        inverse(r, c) -= factor * inverse(col, c);
+      }
+    }
+  }
+  return inverse;
+}
+
+Matrix Exp(const Matrix& m) {
+  // Scale m to a norm below 1/2, where 20 terms of the series are exact to
+  // double precision, then square the result back up.
+  const double norm = m.Norm();
+  const int squarings =
+      norm > 0.5 ? static_cast<int>(std::ceil(std::log2(norm / 0.5))) : 0;
+  const Matrix scaled = std::ldexp(1.0, -squarings) * m;
+  Matrix result = Matrix::Identity(m.rows());
+  Matrix term = result;
+  for (int i = 1; i <= 20; ++i) {
+    term = (1.0 / i) * (term * scaled);
+    result = result + term;
+  }
+  for (int i = 0; i < squarings; ++i) result = result * result;
+  return result;
+}
+
+DiscreteModel Discretize(const Matrix& a, const Matrix& b, double dt) {
+  // The exponential of [[a b] [0 0]] dt is [[Ad Bd] [0 I]].
+  const int n = a.rows(), m = b.cols();
+  Matrix augmented(n + m, n + m);
+  for (int r = 0; r < n; ++r) {
+    for (int c = 0; c < n; ++c) augmented(r, c) = a(r, c) * dt;
+    for (int c = 0; c < m; ++c) augmented(r, n + c) = b(r, c) * dt;
+  }
+  const Matrix e = Exp(augmented);
+  DiscreteModel model{Matrix(n, n), Matrix(n, m)};
+  for (int r = 0; r < n; ++r) {
+    for (int c = 0; c < n; ++c) model.a(r, c) = e(r, c);
+    for (int c = 0; c < m; ++c) model.b(r, c) = e(r, n + c);
+  }
+  return model;
+}
+
+std::expected<Matrix, std::string> SolveDare(const DiscreteModel& model,
+                                             const Matrix& q,
+                                             const Matrix& r) {
+  auto r_inverse = Inverse(r);
+  if (!r_inverse) return std::unexpected("R must be invertible");
+  const int n = model.a.rows();
+  const Matrix identity = Matrix::Identity(n);
+  Matrix a = model.a;
+  Matrix g = model.b * *r_inverse * model.b.Transposed();
+  Matrix h = q;
+  for (int iteration = 0; iteration < 100; ++iteration) {
+    auto w = Inverse(identity + g * h);
+    if (!w) return std::unexpected("the Riccati iteration broke down");
+    const Matrix next_a = a * *w * a;
+    const Matrix next_g = g + a * *w * g * a.Transposed();
+    const Matrix next_h = h + a.Transposed() * h * *w * a;
+    const double change = (next_h - h).Norm();
+    a = next_a;
+    g = next_g;
+    h = next_h;
+    if (!std::isfinite(change)) break;
+    if (change <= 1e-12 * h.Norm()) return h;
+  }
+  return std::unexpected(
+      "the Riccati equation has no stabilizing solution; is the model "
+      "controllable?");
+}
+
+std::expected<Matrix, std::string> LqrGain(const DiscreteModel& model,
+                                           const Matrix& q, const Matrix& r) {
+  auto p = SolveDare(model, q, r);
+  if (!p) return std::unexpected(p.error());
+  const Matrix bt_p = model.b.Transposed() * *p;
+  auto inverse = Inverse(r + bt_p * model.b);
+  if (!inverse) return std::unexpected("R + B' P B is singular");
+  Matrix k = *inverse * bt_p * model.a;
+  if (!(SpectralRadius(ClosedLoop(model, k)) < 1)) {
+    return std::unexpected("the closed loop is not stable");
+  }
+  return k;
+}
+
+Matrix ClosedLoop(const DiscreteModel& model, const Matrix& k) {
+  return model.a - model.b * k;
+}
+
+double SpectralRadius(const Matrix& a) {
+  // a^(2^i) = e^log_scale m, with m kept at norm 1 so nothing overflows. The
+  // norm of a^j grows as rho^j times a factor that the 2^i-th root removes.
+  constexpr int kSquarings = 40;
+  Matrix m = a;
+  double log_scale = 0;
+  for (int i = 0; i < kSquarings; ++i) {
+    const double norm = m.Norm();
+    if (norm == 0) return 0;
+    m = (1 / norm) * m;
+    log_scale = 2 * (log_scale + std::log(norm));
+    m = m * m;
+  }
+  const double norm = m.Norm();
+  if (norm == 0) return 0;
+  return std::exp((log_scale + std::log(norm)) / std::ldexp(1.0, kSquarings));
+}
+
+}  // namespace tune
@@ -0,0 +1,89 @@
+#ifndef TUNE_LQR_H
+#define TUNE_LQR_H
+
+#include <expected>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+// Offline design of linear quadratic regulators: the gain K of the state
+// feedback u = -K x that minimizes the sum over every step of
+// x' Q x + u' R u, for a discrete linear model x[k+1] = A x[k] + B u[k].
+// tools/lqr_gains runs this on the balancing robot's model and writes K out
+// for intpid::StateFeedback.
+
+namespace tune {
+
+// A small dense matrix of doubles, with the few operations the design needs.
+class Matrix {
+ public:
+  Matrix() = default;
+  Matrix(int rows, int cols) : rows_(rows), cols_(cols), v_(rows * cols) {}
+
+  // Row by row, e.g. Matrix({{1, 2}, {3, 4}}).
+  Matrix(std::initializer_list<std::initializer_list<double>> rows);
+
+  static Matrix Identity(int n);
+  static Matrix Diagonal(const std::vector<double>& diagonal);
+
+  int rows() const { return rows_; }
+  int cols() const { return cols_; }
+
+  double& operator()(int r, int c) { return v_[r * cols_ + c]; }
+  double operator()(int r, int c) const { return v_[r * cols_ + c]; }
+
+  Matrix Transposed() const;
+
+  // The largest absolute row sum, the infinity norm.
+  double Norm() const;
+
+  friend Matrix operator+(const Matrix& a, const Matrix& b);
+  friend Matrix operator-(const Matrix& a, const Matrix& b);
+  friend Matrix operator*(const Matrix& a, const Matrix& b);
+  friend Matrix operator*(double s, const Matrix& a);
+
+ private:
+  int rows_ = 0, cols_ = 0;
+  std::vector<double> v_;
+};
+
+// The inverse of a square matrix, by Gauss-Jordan elimination with partial
+// pivoting, or an error if it is singular.
+std::expected<Matrix, std::string> Inverse(const Matrix& m);
+
+// e^m, by scaling and squaring a Taylor series.
+Matrix Exp(const Matrix& m);
+
+struct DiscreteModel {
+  Matrix a, b;
+};
+
+// The continuous model x' = a x + b u sampled every dt with the input held
+// in between (a zero-order hold), as a controller updated every dt sees it.
+DiscreteModel Discretize(const Matrix& a, const Matrix& b, double dt);
+
+// Solves the discrete algebraic Riccati equation
+//
+//   P = A' P A - A' P B (R + B' P B)^-1 B' P A + Q
+//
+// for the stabilizing P by the structure-preserving doubling algorithm, which
+// converges quadratically. Fails if (A, B) cannot be stabilized or the
+// iteration does not converge.
+std::expected<Matrix, std::string> SolveDare(const DiscreteModel& model,
+                                             const Matrix& q,
+                                             const Matrix& r);
+
+// The LQR gain K = (R + B' P B)^-1 B' P A, one row per input.
+std::expected<Matrix, std::string> LqrGain(const DiscreteModel& model,
+                                           const Matrix& q, const Matrix& r);
+
+// The discrete closed loop A - B K.
+Matrix ClosedLoop(const DiscreteModel& model, const Matrix& k);
+
+// The spectral radius of a: the largest magnitude of its eigenvalues, from
+// the growth of its powers. Below 1, x[k+1] = a x[k] decays to 0.
+double SpectralRadius(const Matrix& a);
+
+}  // namespace tune
+
+#endif  // TUNE_LQR_H
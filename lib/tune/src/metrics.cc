@@ -0,0 +1,42 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace tune {
+
+void MetricsRecorder::Add(double dt, double setpoint, double measurement,
+                          bool saturated) {
+  if (!started_ || setpoint != setpoint_) {
+    started_ = true;
+    setpoint_ = setpoint;
+    direction_ = setpoint >= measurement ? 1 : -1;
+    step_start_ = metrics_.duration;
+    settled_steps_ = metrics_.settling_time;
+  }
+
+  const double error = setpoint - measurement;
+  metrics_.duration += dt;
+  metrics_.ise += error * error * dt;
+  metrics_.iae += std::abs(error) * dt;
+  metrics_.overshoot = std::max(metrics_.overshoot, -error * direction_);
+  if (!(std::abs(error) <= settle_band_)) {
+    metrics_.settling_time =
+        settled_steps_ + metrics_.duration - step_start_;
+  }
+  if (saturated) metrics_.saturated_time += dt;
+}
+
+double Cost(const Metrics& metrics, const CostWeights& weights) {
+  const double cost = weights.ise * metrics.ise + weights.iae * metrics.iae +
+                      weights.overshoot * metrics.overshoot +
+                      weights.settling_time * metrics.settling_time +
+                      weights.saturated_time * metrics.saturated_time;
+  if (!std::isfinite(cost) || !std::isfinite(metrics.ise)) {
+    return std::numeric_limits<double>::infinity();
+  }
+  return cost;
+}
+
+}  // namespace tune
@@ -0,0 +1,67 @@
+#ifndef TUNE_METRICS_H
+#define TUNE_METRICS_H
+
+namespace tune {
+
+// How well one closed-loop run tracked its setpoint. Times are in the unit of
+// the dt passed to MetricsRecorder::Add, and errors in the measurement's unit.
+struct Metrics {
+  // Integrated squared and absolute error.
+  double ise = 0;
+  double iae = 0;
+
+  // The furthest the measurement went past the setpoint, in the direction it
+  // was approached from. 0 if it never did.
+  double overshoot = 0;
+
+  // For each setpoint, the time from when it was set to the end of the last
+  // sample whose error was outside the settling band, summed.
+  double settling_time = 0;
+
+  // Total time the controller output sat at one of its limits.
+  double saturated_time = 0;
+
+  double duration = 0;
+};
+
+// Accumulates Metrics one sample at a time, as a scenario runs.
+class MetricsRecorder {
+ public:
+  // Errors within settle_band of zero count as settled.
+  explicit MetricsRecorder(double settle_band) : settle_band_(settle_band) {}
+
+  // Adds a sample that held for dt. A new setpoint starts a new step, which
+  // is approached from the side the measurement is on.
+  void Add(double dt, double setpoint, double measurement, bool saturated);
+
+  const Metrics& metrics() const { return metrics_; }
+
+ private:
+  const double settle_band_;
+  Metrics metrics_;
+
+  // The current step.
+  bool started_ = false;
+  double setpoint_ = 0;
+  double direction_ = 1;
+  double step_start_ = 0;
+  // Settling time of the steps before this one.
+  double settled_steps_ = 0;
+};
+
+// The weights of each metric in the cost to minimize.
+struct CostWeights {
+  double ise = 1;
+  double iae = 0;
+  double overshoot = 0;
+  double settling_time = 0;
+  double saturated_time = 0;
+};
+
+// Returns the weighted sum of the metrics. A run that blew up (any metric not
+// finite) costs infinity, so it always ranks last.
+double Cost(const Metrics& metrics, const CostWeights& weights);
+
+}  // namespace tune
+
+#endif  // TUNE_METRICS_H
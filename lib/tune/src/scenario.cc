@@ -0,0 +1,88 @@
+#include "scenario.h"
+
+#include <limits>
+
+#include "balancing_robot.h"
+#include "feedback_motor.h"
+#include "magnet_sensor.h"
+#include "water_heater.h"
+
+namespace tune {
+namespace {
+
+// The position loop keeps the bench gains while the velocity gains are
+// searched, rather than sharing their config.
+constexpr intpid::Config kPositionConfig = {
+    .kp = 4, .ki = 0, .kd = 0, .output_min = -720, .output_max = 720};
+
+}  // namespace
+
+intpid::Config WaterHeaterScenario::base_config() const {
+  return {.kp = 15., .ki = .002, .kd = 75, .output_min = 0, .output_max = 100};
+}
+
+Metrics WaterHeaterScenario::Run(const intpid::Config& config) const {
+  constexpr int dt = 60;
+  sim::WaterHeaterModel model(200'000, 20, 20, 11700);
+  auto pid = intpid::Pid::Create(config);
+  if (!pid) return {.ise = std::numeric_limits<double>::infinity()};
+  pid->Update(model.temp(), 0);
+
+  MetricsRecorder recorder(/*settle_band=*/0.5);
+  for (int t = 0; t < 12 * 60 * 60; t += dt) {
+    if (t > 4 * 60 * 60 && t < 5 * 60 * 60) {
+      model.set_flow_rate(80);
+    } else if (t > 5 * 60 * 60 && t < 8 * 60 * 60) {
+      model.set_flow_rate(10);
+    } else if (t > 8 * 60 * 60 && t < 9 * 60 * 60) {
+      model.set_flow_rate(4 * 80);
+    } else if (t > 9 * 60 * 60) {
+      model.set_flow_rate(0);
+    }
+
+    pid->set_setpoint(model.setpoint());
+    const SQ15x16 power = pid->Update(model.temp(), dt);
+    model.set_power(float{power} / 100.0);
+    model.Update(dt);
+    recorder.Add(dt, model.setpoint(), model.temp(),
+                 power <= config.output_min || power >= config.output_max);
+  }
+  return recorder.metrics();
+}
+
+intpid::Config MotorSpeedScenario::base_config() const {
+  return {.kp = 0.05,
+          .ki = 0.02,
+          .kd = 0,
+          .output_min = -255,
+          .output_max = 255};
+}
+
+Metrics MotorSpeedScenario::Run(const intpid::Config& config) const {
+  constexpr uint32_t kPeriodUs = 1000;
+  constexpr SQ15x16 kDtMs = 1;
+  sim::RobotParams params;
+  params.mount = sim::RobotParams::kClamped;
+  sim::BalancingRobot robot(params);
+  sim::MagnetSensor sensor(&robot, sim::kLeft);
+  auto motor = motor::FeedbackMotor::Create(
+      &robot.motor(sim::kLeft), &sensor,
+      {.velocity = config, .position = kPositionConfig});
+  if (!motor) return {.ise = std::numeric_limits<double>::infinity()};
+
+  MetricsRecorder recorder(/*settle_band=*/40);
+  for (const float speed : {720.0f, -360.0f, 0.0f}) {
+    motor->SetTargetSpeed(speed);
+    for (int i = 0; i < 1000; ++i) {
+      sensor.Update();
+      motor->Update(kDtMs);
+      robot.Advance(kPeriodUs);
+      recorder.Add(float{kDtMs}, speed, robot.wheel_rate_dps(sim::kLeft),
+                   motor->effort() <= config.output_min ||
+                       motor->effort() >= config.output_max);
+    }
+  }
+  return recorder.metrics();
+}
+
+}  // namespace tune
@@ -0,0 +1,55 @@
+#ifndef TUNE_SCENARIO_H
+#define TUNE_SCENARIO_H
+
+#include <string_view>
+
+#include "intpid.h"
+#include "metrics.h"
+
+namespace tune {
+
+// A closed-loop test of one controller against a simulated plant: a fresh
+// plant, a profile of setpoints and disturbances, and how to score the run.
+//
+// Run is called concurrently from many threads, so it must build all of its
+// state locally.
+class Scenario {
+ public:
+  virtual ~Scenario() {}
+
+  virtual std::string_view name() const = 0;
+
+  // The config the search starts from: the output limits, which are part of
+  // the plant rather than the tuning, and the current hand-tuned gains.
+  virtual intpid::Config base_config() const = 0;
+
+  // Runs the whole profile with a controller built from config.
+  virtual Metrics Run(const intpid::Config& config) const = 0;
+};
+
+// The 12 hour profile from the intpid test: a 200 liter tank heated from 20
+// to 54 C, then a shower, a trickle and every shower in the house at once.
+// One update per simulated minute; times are in seconds.
+class WaterHeaterScenario : public Scenario {
+ public:
+  std::string_view name() const override { return "water_heater"; }
+  intpid::Config base_config() const override;
+  Metrics Run(const intpid::Config& config) const override;
+};
+
+// The FeedbackMotor velocity loop on the bench (sim::BalancingRobot clamped)
+// with a simulated magnet sensor, at 1 kHz: steps from rest to 720 deg/s,
+// to -360 deg/s and back to rest, one second each. The metrics use the true
+// wheel speed; the sensor's quantization noise keeps it within about 30
+// deg/s of the target, so the settling band is 40. Times are in
+// milliseconds.
+class MotorSpeedScenario : public Scenario {
+ public:
+  std::string_view name() const override { return "motor_speed"; }
+  intpid::Config base_config() const override;
+  Metrics Run(const intpid::Config& config) const override;
+};
+
+}  // namespace tune
+
+#endif  // TUNE_SCENARIO_H
@@ -0,0 +1,180 @@
+#include "search.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <random>
+#include <thread>
+
+namespace tune {
+namespace {
+
+// Candidates are generated in unit coordinates: each gain's range mapped to
+// [0, 1], on a log scale where the range allows it.
+using Point = std::array<double, 3>;
+
+float FromUnit(const GainRange& range, double u) {
+  if (range.min == range.max) return range.min;
+  if (range.min > 0) {
+    return range.min * std::pow(range.max / range.min, u);
+  }
+  return range.min + u * (range.max - range.min);
+}
+
+double ToUnit(const GainRange& range, float value) {
+  if (range.min == range.max) return 0;
+  value = std::clamp(value, range.min, range.max);
+  if (range.min > 0) {
+    return std::log(value / range.min) / std::log(range.max / range.min);
+  }
+  return (value - range.min) / (range.max - range.min);
+}
+
+intpid::Config ToConfig(const SearchSpace& space, const intpid::Config& base,
+                        const Point& u) {
+  intpid::Config config = base;
+  config.kp = FromUnit(space.kp, u[0]);
+  config.ki = FromUnit(space.ki, u[1]);
+  config.kd = FromUnit(space.kd, u[2]);
+  return config;
+}
+
+Point ToPoint(const SearchSpace& space, const intpid::Config& config) {
+  return {ToUnit(space.kp, config.kp), ToUnit(space.ki, config.ki),
+          ToUnit(space.kd, config.kd)};
+}
+
+}  // namespace
+
+std::expected<void, std::string> Validate(const SearchSpace& space) {
+  for (const GainRange& range : {space.kp, space.ki, space.kd}) {
+    if (!(range.min >= 0 && range.min <= range.max)) {
+      return std::unexpected("gain ranges must satisfy 0 <= min <= max");
+    }
+  }
+  return {};
+}
+
+std::vector<Candidate> Evaluate(const Scenario& scenario,
+                                const CostWeights& weights,
+                                std::span<const intpid::Config> configs,
+                                int threads) {
+  std::vector<Candidate> candidates(configs.size());
+  std::atomic<size_t> next = 0;
+  auto worker = [&] {
+    for (size_t i = next++; i < configs.size(); i = next++) {
+      const Metrics metrics = scenario.Run(configs[i]);
+      candidates[i] = {configs[i], metrics, Cost(metrics, weights)};
+    }
+  };
+
+  if (threads <= 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  threads = std::min<size_t>(threads, configs.size());
+  std::vector<std::thread> pool;
+  for (int i = 1; i < threads; ++i) pool.emplace_back(worker);
+  worker();
+  for (std::thread& thread : pool) thread.join();
+  return candidates;
+}
+
+void SortByCost(std::vector<Candidate>& candidates) {
+  std::stable_sort(candidates.begin(), candidates.end(),
+                   [](const Candidate& a, const Candidate& b) {
+                     return a.cost < b.cost;
+                   });
+}
+
+std::vector<intpid::Config> GridConfigs(const SearchSpace& space,
+                                        const intpid::Config& base,
+                                        int points_per_axis) {
+  // A fixed gain only needs one point.
+  auto points = [&](const GainRange& range) {
+    return range.min == range.max ? 1 : std::max(points_per_axis, 1);
+  };
+  auto unit = [](int i, int n) { return n == 1 ? 0.0 : double(i) / (n - 1); };
+  const int nkp = points(space.kp), nki = points(space.ki),
+            nkd = points(space.kd);
+
+  std::vector<intpid::Config> configs;
+  configs.reserve(nkp * nki * nkd);
+  for (int p = 0; p < nkp; ++p) {
+    for (int i = 0; i < nki; ++i) {
+      for (int d = 0; d < nkd; ++d) {
+        configs.push_back(ToConfig(
+            space, base, {unit(p, nkp), unit(i, nki), unit(d, nkd)}));
+      }
+    }
+  }
+  return configs;
+}
+
+std::vector<intpid::Config> RandomConfigs(const SearchSpace& space,
+                                          const intpid::Config& base,
+                                          int count, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> uniform(0, 1);
+  std::vector<intpid::Config> configs;
+  configs.reserve(count);
+  for (int i = 0; i < count; ++i) {
+    const double kp = uniform(rng), ki = uniform(rng), kd = uniform(rng);
+    configs.push_back(ToConfig(space, base, {kp, ki, kd}));
+  }
+  return configs;
+}
+
+std::expected<std::vector<Candidate>, std::string> EvolutionSearch(
+    const Scenario& scenario, const CostWeights& weights,
+    const SearchSpace& space, const intpid::Config& base,
+    const EvolutionOptions& options, int threads) {
+  if (options.population < 1) {
+    return std::unexpected("population must be at least 1");
+  }
+
+  // Below this spread a generation can no longer find anything new, and
+  // above it the samples mostly land on the edges of the range.
+  constexpr double kMinSpread = 0.005;
+  constexpr double kMaxSpread = 0.5;
+
+  std::mt19937 rng(options.seed);
+  std::normal_distribution<double> normal(0, 1);
+  Point mean = ToPoint(space, base);
+  Point spread = {0.25, 0.25, 0.25};
+  const int parents = std::clamp(options.parents, 1, options.population);
+
+  std::vector<Candidate> all;
+  std::vector<intpid::Config> configs(options.population);
+  for (int g = 0; g < options.generations; ++g) {
+    for (intpid::Config& config : configs) {
+      Point u;
+      for (int k = 0; k < 3; ++k) {
+        u[k] = std::clamp(mean[k] + spread[k] * normal(rng), 0.0, 1.0);
+      }
+      config = ToConfig(space, base, u);
+    }
+    std::vector<Candidate> generation =
+        Evaluate(scenario, weights, configs, threads);
+    SortByCost(generation);
+
+    Point sum = {}, sum_squares = {};
+    for (int i = 0; i < parents; ++i) {
+      const Point u = ToPoint(space, generation[i].config);
+      for (int k = 0; k < 3; ++k) {
+        sum[k] += u[k];
+        sum_squares[k] += u[k] * u[k];
+      }
+    }
+    for (int k = 0; k < 3; ++k) {
+      mean[k] = sum[k] / parents;
+      const double variance =
+          std::max(0.0, sum_squares[k] / parents - mean[k] * mean[k]);
+      spread[k] = std::clamp(std::sqrt(variance), kMinSpread, kMaxSpread);
+    }
+    all.insert(all.end(), generation.begin(), generation.end());
+  }
+  return all;
+}
+
+}  // namespace tune
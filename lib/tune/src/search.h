@@ -0,0 +1,83 @@
+#ifndef TUNE_SEARCH_H
+#define TUNE_SEARCH_H
+
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "intpid.h"
+#include "metrics.h"
+#include "scenario.h"
+
+// Offline search for PID gains. Every candidate is an independent run of a
+// Scenario, so candidates are simply spread across threads; there is no
+// shared state beyond the index of the next candidate to run.
+
+namespace tune {
+
+// The range searched for one gain. A positive min is searched on a log scale,
+// so each decade gets the same attention; a min of 0 is searched linearly.
+// min == max holds the gain fixed.
+struct GainRange {
+  float min;
+  float max;
+};
+
+struct SearchSpace {
+  GainRange kp, ki, kd;
+};
+
+// Checks that every range is ordered and non-negative.
+std::expected<void, std::string> Validate(const SearchSpace& space);
+
+struct Candidate {
+  intpid::Config config;
+  Metrics metrics;
+  double cost;
+};
+
+// Runs every config in the scenario on the given number of threads (0 uses
+// every core) and returns the candidates in the order of configs.
+std::vector<Candidate> Evaluate(const Scenario& scenario,
+                                const CostWeights& weights,
+                                std::span<const intpid::Config> configs,
+                                int threads = 0);
+
+// Sorts candidates from best to worst.
+void SortByCost(std::vector<Candidate>& candidates);
+
+// points_per_axis values of each gain, evenly spaced over its range, in every
+// combination. Output limits come from base.
+std::vector<intpid::Config> GridConfigs(const SearchSpace& space,
+                                        const intpid::Config& base,
+                                        int points_per_axis);
+
+// count configs drawn uniformly (on the scale described for GainRange).
+std::vector<intpid::Config> RandomConfigs(const SearchSpace& space,
+                                          const intpid::Config& base,
+                                          int count, uint32_t seed);
+
+struct EvolutionOptions {
+  int generations = 20;
+  int population = 64;
+  // The best this many of each generation set the next one's distribution.
+  int parents = 16;
+  uint32_t seed = 1;
+};
+
+// A cross-entropy evolution strategy, CMA-ES with a diagonal covariance:
+// each generation samples a population from a normal distribution over the
+// (log-)scaled search space, and the best parents move its mean and shrink
+// or widen its spread. The first generation is centered on base. Returns
+// every candidate evaluated, in no particular order, or an error if the
+// population is empty.
+std::expected<std::vector<Candidate>, std::string> EvolutionSearch(
+    const Scenario& scenario, const CostWeights& weights,
+    const SearchSpace& space, const intpid::Config& base,
+    const EvolutionOptions& options, int threads = 0);
+
+}  // namespace tune
+
+#endif  // TUNE_SEARCH_H
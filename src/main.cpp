@@ -1,17 +1,227 @@
 #include "Adafruit_MLX90393.h"
+#include "freertos_clock.h"
+#include "hbridge_motor.h"
+#include "log_format.h"
+#include "memory_report.h"
+#include "mlx90393_acquisition.h"
 #include "mlx90393_sensor.h"
+#include "record.h"
+#include "scheduler.h"
+#include "spsc_ring.h"
 #include "three_wire_motor.h"
+#include "trace.h"
 
 constexpr int pin_pwma = 0;
 constexpr int pin_ain1 = 1;
 constexpr int pin_ain2 = 8;
 
+// The GPIO wired to the MLX90393's INT pin. If set, each burst-mode sample
+// is read as soon as it converts and the control loop only picks it up;
+// otherwise the control loop polls the sensor over I2C.
+#ifndef MLX90393_DRDY_PIN
+#define MLX90393_DRDY_PIN -1
+#endif
+
 Adafruit_MLX90393 sensor = Adafruit_MLX90393();
+#if MLX90393_DRDY_PIN >= 0
+motor::MLX90393Acquisition mlx_acquisition(&sensor);
+motor::MLX90393Sensor motor_sensor(&mlx_acquisition);
+#else
 motor::MLX90393Sensor motor_sensor(&sensor);
+#endif
+
+// If set, the motor is driven through the GPIO and LEDC registers directly
+// (lib/motor/src/hbridge_motor.h) instead of digitalWrite and analogWrite.
+#ifndef MOTOR_REGISTER_DRIVER
+#define MOTOR_REGISTER_DRIVER 0
+#endif
+
+#if MOTOR_REGISTER_DRIVER
+motor::HBridgeMotor motor1(
+    {.pwm = pin_pwma, .forward = pin_ain1, .reverse = pin_ain2}, 128, 8);
+#else
 motor::ThreeWireMotor motor1(pin_pwma, pin_ain1, pin_ain2);
+#endif
+
+// If set, the first MOTOR_TRACE sensor samples and motor commands are
+// recorded (lib/motor/src/trace.h) and dumped to the serial port once the
+// buffer fills. Capture the port to a file and replay it on the host with
+// motor::ParseTrace (lib/telemetry_host) and motor::ReplaySensor. Each event
+// takes 16 bytes.
+#ifndef MOTOR_TRACE
+#define MOTOR_TRACE 0
+#endif
+
+#if MOTOR_TRACE
+motor::TraceEvent trace_buffer[MOTOR_TRACE];
+motor::TraceRecorder trace_recorder(trace_buffer);
+motor::TracingMotor traced_motor1(&motor1, &trace_recorder);
+motor::Motor& motor_out = traced_motor1;
+#else
+motor::Motor& motor_out = motor1;
+#endif
 
 #define MLX90393_CS 10
 
+// Every task runs on a statically allocated stack of a declared size, so the
+// RAM the firmware needs is fixed at link time and tools/ram_report.py
+// accounts for all of it. Sizes are in bytes. The control loop runs in the
+// Arduino loop task, whose stack is CONFIG_ARDUINO_LOOP_STACK_SIZE.
+constexpr uint32_t kMotorTaskStackBytes = 1024;
+constexpr uint32_t kTelemetryTaskStackBytes = 4096;
+constexpr uint32_t kMlxTaskStackBytes = 2048;
+
+StackType_t motor_task_stack[kMotorTaskStackBytes];
+StaticTask_t motor_task;
+StackType_t telemetry_task_stack[kTelemetryTaskStackBytes];
+StaticTask_t telemetry_task;
+#if MLX90393_DRDY_PIN >= 0
+StackType_t mlx_task_stack[kMlxTaskStackBytes];
+StaticTask_t mlx_task;
+#endif
+
+TaskHandle_t motor_task_handle;
+TaskHandle_t telemetry_task_handle;
+TaskHandle_t control_task_handle;
+
+// If set, the telemetry task prints each task's stack high-water mark against
+// its budget, and the state of the heap, every MEMORY_REPORT seconds. Text
+// telemetry only; the report would corrupt a binary log.
+#ifndef MEMORY_REPORT
+#define MEMORY_REPORT 0
+#endif
+
+void MaybePrintMemoryReport(uint32_t now_ms) {
+#if MEMORY_REPORT
+  static uint32_t last_ms = 0;
+  if (now_ms - last_ms < MEMORY_REPORT * 1000u) return;
+  last_ms = now_ms;
+  const sched::TaskMemory tasks[] = {
+      sched::ReadTaskMemory(control_task_handle,
+                            CONFIG_ARDUINO_LOOP_STACK_SIZE),
+      sched::ReadTaskMemory(motor_task_handle, kMotorTaskStackBytes),
+      sched::ReadTaskMemory(telemetry_task_handle, kTelemetryTaskStackBytes),
+#if MLX90393_DRDY_PIN >= 0
+      sched::ReadTaskMemory(mlx_acquisition.task(), kMlxTaskStackBytes),
+#endif
+  };
+  static char text[512];
+  sched::FormatMemoryReport(tasks, sched::ReadHeapMemory(), text);
+  Serial.print(text);
+#endif
+}
+
+// If set, telemetry is sent as a binary log (lib/telemetry/src/log_format.h)
+// instead of teleplot text. Capture the serial port to a file and decode it
+// with tools/tlog_decode or tools/pid_plotter.py.
+#ifndef TELEMETRY_BINARY
+#define TELEMETRY_BINARY 0
+#endif
+
+// Telemetry channels, and the names they are given on the serial port.
+enum TelemetryChannel : telemetry::Channel {
+  kChannelAngle,
+  kChannelSpeed,
+  kChannelJitterMax,
+  kChannelOverruns,
+  // In binary mode only: the records dropped since the last DROPPED record.
+  kChannelDropped,
+  kNumChannels,
+};
+constexpr telemetry::ChannelInfo kChannelInfo[kNumChannels] = {
+    {kChannelAngle, "ANGLE"},
+    {kChannelSpeed, "SPEED"},
+    {kChannelJitterMax, "JITTER_MAX_US"},
+    {kChannelOverruns, "OVERRUNS"},
+    {kChannelDropped, "DROPPED"},
+};
+
+// The control loop pushes binary records here; the telemetry task formats
+// them and writes them to the serial port.
+telemetry::SpscRing<telemetry::Record, 256> telemetry_ring;
+
+// Once the trace buffer is full, stops recording and dumps it. Called from
+// the telemetry task, between writes of telemetry.
+void MaybeDumpTrace() {
+#if MOTOR_TRACE
+  if (!trace_recorder.recording() || !trace_recorder.full()) return;
+  trace_recorder.set_recording(false);
+  trace_recorder.Dump(
+      [](const uint8_t* data, size_t size) { Serial.write(data, size); });
+#endif
+}
+
+#if TELEMETRY_BINARY
+// Drains telemetry_ring to the serial port as a binary log. Runs at the
+// lowest priority so serial output never delays the control loop.
+void TelemetryTask(void*) {
+  // How often the header is repeated, so a decoder attached after boot or
+  // after a reconnect can sync.
+  constexpr uint32_t kHeaderPeriodMs = 1'000;
+  static uint8_t header[64];
+  const size_t header_size =
+      telemetry::EncodeHeader(1'000'000, kChannelInfo, header);
+  uint32_t header_sent_ms = 0;
+  bool header_sent = false;
+  uint32_t reported_dropped = 0;
+
+  static uint8_t frame[256];
+  telemetry::FrameEncoder encoder(frame);
+  const auto add = [&](const telemetry::Record& record) {
+    if (!encoder.Add(record)) {
+      const auto bytes = encoder.Finish();
+      Serial.write(bytes.data(), bytes.size());
+      encoder.Add(record);
+    }
+  };
+  while (true) {
+    const uint32_t now_ms = millis();
+    if (!header_sent || now_ms - header_sent_ms >= kHeaderPeriodMs) {
+      Serial.write(header, header_size);
+      header_sent_ms = now_ms;
+      header_sent = true;
+    }
+
+    telemetry::Record record;
+    while (telemetry_ring.TryPop(record)) add(record);
+    const uint32_t dropped = telemetry_ring.dropped();
+    if (dropped != reported_dropped) {
+      add(telemetry::Record::MakeCount(micros(), kChannelDropped,
+                                       dropped - reported_dropped));
+      reported_dropped = dropped;
+    }
+    const auto bytes = encoder.Finish();
+    Serial.write(bytes.data(), bytes.size());
+    MaybeDumpTrace();
+    delay(5);
+  }
+}
+#else
+// Drains telemetry_ring to the serial port in teleplot format. Runs at the
+// lowest priority so serial output never delays the control loop.
+void TelemetryTask(void*) {
+  uint32_t reported_dropped = 0;
+  while (true) {
+    telemetry::Record record;
+    while (telemetry_ring.TryPop(record)) {
+      if (record.channel < kNumChannels) {
+        Serial.printf(">%s:%u:%f\n", kChannelInfo[record.channel].name,
+                      static_cast<unsigned>(record.timestamp / 1000),
+                      float{record.value()});
+      }
+    }
+    const uint32_t dropped = telemetry_ring.dropped();
+    if (dropped != reported_dropped) {
+      Serial.printf(">DROPPED:%u\n", static_cast<unsigned>(dropped));
+      reported_dropped = dropped;
+    }
+    MaybeDumpTrace();
+    MaybePrintMemoryReport(millis());
+    delay(5);
+  }
+}
+#endif
+
 double VectorToAngle(double x, double y) {
   if (x == 0.0 && y == 0.0) {
     return 0.0;  // Angle is undefined for the zero vector
@@ -28,36 +238,74 @@ double VectorToAngle(double x, double y) {
   return angle;
 }
 
+// The control loop runs these stages in order every kControlPeriodUs.
+constexpr uint32_t kControlPeriodUs = 10'000;
+
+class SenseStage : public sched::Stage {
+ public:
+  void Run(const sched::Tick& tick) override { motor_sensor.Update(); }
+};
+
+class TelemetryStage : public sched::Stage {
+ public:
+  void Run(const sched::Tick& tick) override;
+};
+
+sched::Scheduler<2>* control_scheduler;
+SenseStage sense_stage;
+TelemetryStage telemetry_stage;
+
+void TelemetryStage::Run(const sched::Tick& tick) {
+  const uint32_t now = tick.start_us;
+  telemetry_ring.TryPush(
+      telemetry::Record::Make(now, kChannelAngle, motor_sensor.angle()));
+  telemetry_ring.TryPush(
+      telemetry::Record::Make(now, kChannelSpeed, motor_sensor.rate()));
+
+  // Once a second, report and reset the loop timing statistics.
+  if (tick.index % (1'000'000 / kControlPeriodUs) == 0) {
+    const sched::SchedulerStats& stats = control_scheduler->stats();
+    telemetry_ring.TryPush(telemetry::Record::MakeCount(
+        now, kChannelJitterMax, stats.start_jitter.max()));
+    telemetry_ring.TryPush(
+        telemetry::Record::MakeCount(now, kChannelOverruns, stats.overruns));
+    control_scheduler->ClearStats();
+  }
+}
+
 constexpr uint8_t i2c_addr = 0x18;
 
 void setup(void) {
+#if !MOTOR_REGISTER_DRIVER
   analogWriteFrequency(pin_pwma, 128);
   analogWriteResolution(pin_pwma, 8);
+#endif
 
   motor1.Begin();
 
-  xTaskCreate(
+  control_task_handle = xTaskGetCurrentTaskHandle();
+  motor_task_handle = xTaskCreateStatic(
       +[](void*) {
         motor::Direction direction = motor::kClockwise;
         motor::Direction other_direction = motor::kCounterClockwise;
 
         while (true) {
           delay(1000);
-          motor1.SetDirection(direction);
+          motor_out.SetDirection(direction);
           delay(1000);
-          motor1.SetDuty(256 * 0.5);
+          motor_out.SetDuty(256 * 0.5);
           delay(1000);
-          motor1.SetDuty(256 * 0.75);
+          motor_out.SetDuty(256 * 0.75);
           delay(1000);
-          motor1.SetDuty(256 * 1);
+          motor_out.SetDuty(256 * 1);
           delay(1000);
-          motor1.Stop(motor::kBrake);
+          motor_out.Stop(motor::kBrake);
           delay(500);
-          motor1.Stop(motor::kCoast);
+          motor_out.Stop(motor::kCoast);
           std::swap(direction, other_direction);
         }
       },
-      "motor", 1024, NULL, 1, NULL);
+      "motor", kMotorTaskStackBytes, NULL, 1, motor_task_stack, &motor_task);
 
   Serial.begin(115200);
 
@@ -132,13 +380,29 @@ void setup(void) {
   if (!sensor.startBurstMode(MLX90393_X | MLX90393_Y)) {
     Serial.println("Failed to start burst mode");
   }
-}
 
-void loop(void) {
-  motor_sensor.Update();
+#if MOTOR_TRACE
+  motor_sensor.set_recorder(&trace_recorder);
+#endif
+
+#if MLX90393_DRDY_PIN >= 0
+  // The reader task must exist before the first interrupt can wake it.
+  mlx_acquisition.StartTask(configMAX_PRIORITIES - 1, mlx_task_stack,
+                            &mlx_task);
+  mlx_acquisition.Begin(MLX90393_DRDY_PIN);
+#endif
 
-  Serial.printf(">ANGLE:%f\n>SPEED:%f\n", float{motor_sensor.angle()},
-                float{motor_sensor.rate()});
+  telemetry_task_handle = xTaskCreateStatic(
+      TelemetryTask, "telemetry", kTelemetryTaskStackBytes, NULL,
+      tskIDLE_PRIORITY, telemetry_task_stack, &telemetry_task);
+
+  // The esp_timer service is not running during static initialization, so
+  // the clock is created here.
+  static sched::FreeRtosClock control_clock;
+  static sched::Scheduler<2> scheduler(&control_clock, kControlPeriodUs);
+  scheduler.AddStage(&sense_stage);
+  scheduler.AddStage(&telemetry_stage);
+  control_scheduler = &scheduler;
+}
 
-  delay(10);
-}
\ No newline at end of file
+void loop(void) { control_scheduler->RunOnce(); }
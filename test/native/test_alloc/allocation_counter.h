@@ -0,0 +1,32 @@
+#ifndef TEST_ALLOC_ALLOCATION_COUNTER_H
+#define TEST_ALLOC_ALLOCATION_COUNTER_H
+
+// This suite replaces the global operator new (see main.cc) to check that
+// the code meant to run on the device without a heap never allocates.
+
+namespace alloc_test {
+
+// Counts calls to operator new, on any thread, while it is alive. Counters
+// must not overlap.
+class AllocationCounter {
+ public:
+  AllocationCounter();
+  ~AllocationCounter();
+
+  AllocationCounter(const AllocationCounter&) = delete;
+  AllocationCounter& operator=(const AllocationCounter&) = delete;
+
+  int allocations() const;
+};
+
+// Returns the allocations made by fn().
+template <typename Fn>
+int AllocationsBy(Fn&& fn) {
+  AllocationCounter counter;
+  fn();
+  return counter.allocations();
+}
+
+}  // namespace alloc_test
+
+#endif  // TEST_ALLOC_ALLOCATION_COUNTER_H
@@ -0,0 +1,130 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <array>
+#include <vector>
+
+#include "allocation_counter.h"
+#include "autotune.h"
+#include "gain_schedule.h"
+#include "intpid.h"
+#include "pid_bank.h"
+#include "state_feedback.h"
+
+namespace intpid {
+namespace {
+
+using alloc_test::AllocationsBy;
+
+constexpr Config kConfig = {.kp = 2,
+                            .ki = .5,
+                            .kd = 1,
+                            .output_min = -255,
+                            .output_max = 255,
+                            .derivative_filter = 8};
+
+constexpr std::array<Breakpoint, 2> kBreakpoints = {{
+    {.at = 0, .kp = 1, .ki = .1, .kd = 0},
+    {.at = 10, .kp = 4, .ki = .4, .kd = 1},
+}};
+
+TEST(AllocationCounter, SeesAllocations) {
+  std::vector<int> v;
+  EXPECT_EQ(AllocationsBy([&] { v.resize(4); }), 1);
+  EXPECT_EQ(AllocationsBy([&] { v.resize(2); }), 0);
+}
+
+TEST(NoHeap, PidUpdate) {
+  auto pid = *Pid::Create(kConfig);
+  pid.set_setpoint(100);
+  EXPECT_EQ(AllocationsBy([&] {
+              for (int i = 0; i < 1000; ++i) pid.Update(i % 200, 1);
+              pid.set_gains({.kp = 3, .ki = 1, .kd = 0}, 10);
+              pid.Update(0, 0);
+            }),
+            0);
+}
+
+TEST(NoHeap, PidBankUpdate) {
+  const std::array<Config, 2> configs = {kConfig, kConfig};
+  auto bank = *PidBank<2>::Create(configs);
+  std::array<SQ15x16, 2> measurements = {1, 2}, dts = {1, 1}, outputs;
+  EXPECT_EQ(AllocationsBy([&] {
+              for (int i = 0; i < 1000; ++i) {
+                bank.Update(measurements, dts, outputs);
+              }
+            }),
+            0);
+}
+
+TEST(NoHeap, ScheduledPidUpdate) {
+  auto pid = *ScheduledPid<2>::Create(kConfig, kBreakpoints);
+  pid.set_setpoint(50);
+  EXPECT_EQ(AllocationsBy([&] {
+              for (int i = 0; i < 1000; ++i) pid.Update(i % 100, 1, i % 12);
+            }),
+            0);
+}
+
+TEST(NoHeap, RelayAutotunerUpdate) {
+  auto tuner = *RelayAutotuner::Create(
+      {.output_low = -100, .output_high = 100, .hysteresis = 1});
+  SQ15x16 y = 0;
+  EXPECT_EQ(AllocationsBy([&] {
+              for (int i = 0; i < 1000; ++i) y += tuner.Update(y, 1) / 100;
+            }),
+            0);
+}
+
+TEST(NoHeap, StateFeedbackUpdate) {
+  const auto controller = *StateFeedback<4>::Create(
+      {.gains = {{{-16, -1.7, -.09, -.35}}},
+       .output_min = -255,
+       .output_max = 255});
+  EXPECT_EQ(AllocationsBy([&] {
+              for (int i = 0; i < 1000; ++i) {
+                controller.Update(std::array<SQ15x16, 4>{i % 7, 1, i, -i});
+              }
+            }),
+            0);
+}
+
+TEST(NoHeap, CreateSucceedsWithoutAllocating) {
+  EXPECT_EQ(AllocationsBy([] {
+              auto pid = Pid::Create(kConfig);
+              auto bank = PidBank<1>::Create(std::array{kConfig});
+              auto scheduled = ScheduledPid<2>::Create(kConfig, kBreakpoints);
+              EXPECT_TRUE(pid && bank && scheduled);
+            }),
+            0);
+}
+
+// Only error codes are allocation free: by default an error is a message.
+TEST(NoHeap, CreateFailsWithoutAllocating) {
+  if (!INTPID_NO_HEAP) GTEST_SKIP() << "needs INTPID_NO_HEAP";
+  Config bad = kConfig;
+  bad.derivative_filter = -1;
+  const std::array<Breakpoint, 2> unordered = {kBreakpoints[1],
+                                               kBreakpoints[0]};
+  EXPECT_EQ(AllocationsBy([&] {
+              EXPECT_FALSE(Pid::Create(bad));
+              EXPECT_FALSE(PidBank<1>::Create(std::array{bad}));
+              EXPECT_FALSE(ScheduledPid<2>::Create(kConfig, unordered));
+              EXPECT_FALSE(RelayAutotuner::Create(
+                  {.output_low = 1, .output_high = 0, .hysteresis = 0}));
+            }),
+            0);
+}
+
+#if INTPID_NO_HEAP
+TEST(NoHeap, ErrorsAreCodes) {
+  Config bad = kConfig;
+  bad.kp = 0;
+  EXPECT_EQ(Pid::Create(bad).error(), Error::kDerivativeFilterNeedsKp);
+  EXPECT_STREQ(ErrorMessage(Error::kDerivativeFilterNeedsKp),
+               "derivative_filter needs a nonzero kp to set its time constant");
+}
+#endif
+
+}  // namespace
+}  // namespace intpid
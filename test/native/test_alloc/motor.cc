@@ -0,0 +1,84 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <array>
+
+#include "allocation_counter.h"
+#include "feedback_motor.h"
+#include "hbridge_motor.h"
+#include "hosthal.h"
+#include "loopback.h"
+#include "trace.h"
+
+namespace motor {
+namespace {
+
+using alloc_test::AllocationsBy;
+using sim::LoopbackMotor;
+using sim::LoopbackSensor;
+
+constexpr FeedbackConfig kConfig = {
+    .velocity = {.kp = .05, .ki = .02, .output_min = -255, .output_max = 255},
+    .position = {.kp = 4, .output_min = -360, .output_max = 360},
+    .position_divider = 5,
+};
+
+TEST(NoHeap, FeedbackMotorUpdate) {
+  LoopbackMotor motor;
+  LoopbackSensor sensor(&motor);
+  auto fm = *FeedbackMotor::Create(&motor, &sensor, kConfig);
+  EXPECT_EQ(AllocationsBy([&] {
+              fm.SetTargetSpeed(100);
+              for (int i = 0; i < 1000; ++i) fm.Update(2);
+              fm.SetTargetPosition(90);
+              for (int i = 0; i < 1000; ++i) fm.Update(2);
+              fm.Stop();
+            }),
+            0);
+}
+
+TEST(NoHeap, HBridgeMotorSetEffort) {
+  hosthal::Reset();
+  HBridgeMotor motor({.pwm = 0, .forward = 1, .reverse = 8}, 20'000, 10);
+  ASSERT_TRUE(motor.Begin());
+  EXPECT_EQ(AllocationsBy([&] {
+              for (int i = -1000; i < 1000; ++i) motor.SetEffort(i);
+              motor.Stop(kBrake);
+            }),
+            0);
+}
+
+TEST(NoHeap, TraceRecordAndDump) {
+  std::array<TraceEvent, 16> buffer;
+  TraceRecorder recorder(buffer, TraceRecorder::kKeepLatest);
+  LoopbackMotor motor;
+  TracingMotor traced(&motor, &recorder);
+  size_t dumped = 0;
+  EXPECT_EQ(AllocationsBy([&] {
+              for (int i = 0; i < 100; ++i) {
+                recorder.RecordSample(i, {1, 2});
+                traced.SetEffort(i);
+              }
+              recorder.set_recording(false);
+              recorder.Dump(
+                  [&](const uint8_t* data, size_t size) { dumped += size; });
+            }),
+            0);
+  EXPECT_GT(dumped, 0);
+}
+
+#if INTPID_NO_HEAP
+TEST(NoHeap, MotorErrorsAreCodes) {
+  LoopbackMotor motor;
+  LoopbackSensor sensor(&motor);
+  FeedbackConfig config = kConfig;
+  EXPECT_EQ(FeedbackMotor::Create(nullptr, &sensor, config).error(),
+            Error::kMissingMotorOrSensor);
+  config.velocity.derivative_filter = -1;
+  EXPECT_EQ(FeedbackMotor::Create(&motor, &sensor, config).error(),
+            Error::kBadVelocityLoop);
+}
+#endif
+
+}  // namespace
+}  // namespace motor
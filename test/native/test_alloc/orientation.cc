@@ -0,0 +1,25 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "allocation_counter.h"
+#include "balance_kalman.h"
+
+namespace orientation {
+namespace {
+
+using alloc_test::AllocationsBy;
+
+TEST(NoHeap, BalanceKalmanCycle) {
+  BalanceKalman filter;
+  EXPECT_EQ(AllocationsBy([&] {
+              for (int i = 0; i < 1000; ++i) {
+                filter.Update({.accel_x = i % 3, .accel_z = 10, .gyro_y = 2},
+                              i % 11, 1);
+              }
+              filter.Reset();
+            }),
+            0);
+}
+
+}  // namespace
+}  // namespace orientation
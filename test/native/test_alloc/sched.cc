@@ -0,0 +1,49 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "allocation_counter.h"
+#include "clock.h"
+#include "record.h"
+#include "scheduler.h"
+#include "spsc_ring.h"
+
+namespace sched {
+namespace {
+
+using alloc_test::AllocationsBy;
+
+class CountingStage : public Stage {
+ public:
+  void Run(const Tick& tick) override { ++runs; }
+
+  int runs = 0;
+};
+
+TEST(NoHeap, SchedulerRunOnce) {
+  VirtualClock clock;
+  Scheduler<2> scheduler(&clock, 1000);
+  CountingStage sense, compute;
+  scheduler.AddStage(&sense);
+  scheduler.AddStage(&compute);
+  EXPECT_EQ(AllocationsBy([&] {
+              for (int i = 0; i < 1000; ++i) scheduler.RunOnce();
+              scheduler.ClearStats();
+            }),
+            0);
+  EXPECT_EQ(compute.runs, 1000);
+}
+
+TEST(NoHeap, TelemetryRing) {
+  telemetry::SpscRing<telemetry::Record, 16> ring;
+  EXPECT_EQ(AllocationsBy([&] {
+              for (int i = 0; i < 100; ++i) {
+                ring.TryPush(telemetry::Record::Make(i, 0, SQ15x16(i)));
+                telemetry::Record record;
+                ring.TryPop(record);
+              }
+            }),
+            0);
+}
+
+}  // namespace
+}  // namespace sched
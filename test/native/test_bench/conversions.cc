@@ -0,0 +1,80 @@
+#include <benchmark/benchmark.h>
+
+#include <FixedPointsCommon.h>
+
+#include <array>
+#include <cstdint>
+
+#include "cycles.h"
+#include "mlx90393_sensor.h"
+
+// The fixed point conversions and small helpers that sit on the sensing and
+// control paths.
+namespace motor {
+namespace {
+
+template <typename T, size_t N = 64>
+std::array<T, N> Ramp(float from, float step) {
+  std::array<T, N> v;
+  for (size_t i = 0; i < N; ++i) v[i] = T(from + step * i);
+  return v;
+}
+
+void BM_FloatToSQ15x16(benchmark::State& state) {
+  const auto in = Ramp<float>(-300, 9.7f);
+  size_t i = 0;
+  bench::CycleCounter cycles(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(SQ15x16(in[i++ % in.size()]));
+  }
+}
+BENCHMARK(BM_FloatToSQ15x16);
+
+void BM_SQ15x16ToFloat(benchmark::State& state) {
+  const auto in = Ramp<SQ15x16>(-300, 9.7f);
+  size_t i = 0;
+  bench::CycleCounter cycles(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(float{in[i++ % in.size()]});
+  }
+}
+BENCHMARK(BM_SQ15x16ToFloat);
+
+void BM_SQ15x16Multiply(benchmark::State& state) {
+  const auto in = Ramp<SQ15x16>(-300, 9.7f);
+  const SQ15x16 k = 1.37;
+  size_t i = 0;
+  bench::CycleCounter cycles(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(in[i++ % in.size()] * k);
+  }
+}
+BENCHMARK(BM_SQ15x16Multiply);
+
+// The microseconds-to-milliseconds step MLX90393Sensor::Update applies to
+// each sample interval.
+void BM_MicrosToMillis(benchmark::State& state) {
+  std::array<uint64_t, 64> in;
+  for (size_t i = 0; i < in.size(); ++i) in[i] = 900 + 13 * i;
+  size_t i = 0;
+  bench::CycleCounter cycles(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        SQ15x16{SFixed<24, 4>{in[i++ % in.size()]} / 1'000});
+  }
+}
+BENCHMARK(BM_MicrosToMillis);
+
+void BM_UnwrapAngleDelta(benchmark::State& state) {
+  // Half of these wrap.
+  const auto in = Ramp<SQ15x16>(-359, 11.2f);
+  size_t i = 0;
+  bench::CycleCounter cycles(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(UnwrapAngleDelta(in[i++ % in.size()]));
+  }
+}
+BENCHMARK(BM_UnwrapAngleDelta);
+
+}  // namespace
+}  // namespace motor
@@ -0,0 +1,38 @@
+#ifndef TEST_BENCH_CYCLES_H
+#define TEST_BENCH_CYCLES_H
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+#include "cycle_counter.h"
+
+namespace bench {
+
+using hosthal::ReadCycles;
+
+// Measures cycles across the benchmark loop and reports them as a
+// "cycles_per_op" counter, averaged over iterations * ops_per_iteration.
+class CycleCounter {
+ public:
+  explicit CycleCounter(benchmark::State& state, int64_t ops_per_iteration = 1)
+      : state_(state), ops_(ops_per_iteration), start_(ReadCycles()) {}
+
+  ~CycleCounter() {
+    const uint64_t cycles = ReadCycles() - start_;
+    const int64_t ops = state_.iterations() * ops_;
+    if (cycles != 0 && ops > 0) {
+      state_.counters["cycles_per_op"] =
+          static_cast<double>(cycles) / static_cast<double>(ops);
+    }
+  }
+
+ private:
+  benchmark::State& state_;
+  const int64_t ops_;
+  const uint64_t start_;
+};
+
+}  // namespace bench
+
+#endif  // TEST_BENCH_CYCLES_H
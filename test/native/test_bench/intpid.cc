@@ -0,0 +1,205 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <vector>
+
+#include "balance_gains.h"
+#include "cycles.h"
+#include "gain_schedule.h"
+#include "intpid.h"
+#include "pid_bank.h"
+#include "state_feedback.h"
+
+namespace intpid {
+namespace {
+
+constexpr size_t kLoops = 4;
+
+constexpr Config kConfig = {
+    .kp = 2, .ki = .5, .kd = 1, .output_min = -255, .output_max = 255};
+
+// Measurements that keep the controllers moving in and out of saturation.
+std::array<SQ15x16, 64> Measurements() {
+  std::array<SQ15x16, 64> m;
+  for (size_t i = 0; i < m.size(); ++i) {
+    m[i] = static_cast<int>(i * 37 % 200) - 100;
+  }
+  return m;
+}
+
+void BM_PidIndependent(benchmark::State& state) {
+  std::vector<Pid> pids;
+  for (size_t i = 0; i < kLoops; ++i) {
+    pids.push_back(*Pid::Create(kConfig));
+    pids.back().set_setpoint(10);
+  }
+  const auto m = Measurements();
+  const SQ15x16 dt = 1;
+  size_t t = 0;
+  for (auto _ : state) {
+    for (size_t i = 0; i < kLoops; ++i) {
+      benchmark::DoNotOptimize(pids[i].Update(m[(t + i) % m.size()], dt));
+    }
+    ++t;
+  }
+  state.SetItemsProcessed(state.iterations() * kLoops);
+}
+BENCHMARK(BM_PidIndependent);
+
+void BM_PidBank(benchmark::State& state) {
+  std::array<Config, kLoops> configs;
+  configs.fill(kConfig);
+  auto bank = *PidBank<kLoops>::Create(configs);
+  for (size_t i = 0; i < kLoops; ++i) bank.set_setpoint(i, 10);
+  const auto m = Measurements();
+  std::array<SQ15x16, kLoops> measurements, outputs;
+  std::array<SQ15x16, kLoops> dt;
+  dt.fill(1);
+  size_t t = 0;
+  for (auto _ : state) {
+    for (size_t i = 0; i < kLoops; ++i) {
+      measurements[i] = m[(t + i) % m.size()];
+    }
+    bank.Update(measurements, dt, outputs);
+    benchmark::DoNotOptimize(outputs);
+    ++t;
+  }
+  state.SetItemsProcessed(state.iterations() * kLoops);
+}
+BENCHMARK(BM_PidBank);
+
+void BM_PidCreate(benchmark::State& state) {
+  bench::CycleCounter cycles(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Pid::Create(kConfig));
+  }
+}
+BENCHMARK(BM_PidCreate);
+
+// The cost of one Update for each numeric type and feature set. Run with
+// --benchmark_filter=BM_BasicPidUpdate for the cycles-per-update table.
+// Ranges are kept small enough for SQ7x24.
+template <typename P>
+void BM_BasicPidUpdate(benchmark::State& state) {
+  using T = typename P::Value;
+  auto pid = *P::Create(
+      {.kp = 2, .ki = .5, .kd = 1, .output_min = -10, .output_max = 10});
+  pid.set_setpoint(T(1));
+  std::array<T, 64> m;
+  const auto fixed = Measurements();
+  for (size_t i = 0; i < m.size(); ++i) m[i] = T(float{fixed[i]} / 16);
+  const T dt = T(1);
+  size_t t = 0;
+  bench::CycleCounter cycles(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(pid.Update(m[t % m.size()], dt));
+    ++t;
+  }
+}
+
+using PNoTelemetry =
+    BasicPid<SQ15x16, Features<Terms::kP, AntiWindup::kNone, false>>;
+using PINoTelemetry =
+    BasicPid<SQ15x16, Features<Terms::kPI, AntiWindup::kCutoff, false>>;
+using PIClamp =
+    BasicPid<SQ15x16, Features<Terms::kPI, AntiWindup::kClamp, false>>;
+using PidNoTelemetry =
+    BasicPid<SQ15x16, Features<Terms::kPID, AntiWindup::kCutoff, false>>;
+
+BENCHMARK_TEMPLATE(BM_BasicPidUpdate, Pid);
+BENCHMARK_TEMPLATE(BM_BasicPidUpdate, PidNoTelemetry);
+BENCHMARK_TEMPLATE(BM_BasicPidUpdate, PINoTelemetry);
+BENCHMARK_TEMPLATE(BM_BasicPidUpdate, PIClamp);
+BENCHMARK_TEMPLATE(BM_BasicPidUpdate, PNoTelemetry);
+BENCHMARK_TEMPLATE(BM_BasicPidUpdate, BasicPid<SQ7x24>);
+BENCHMARK_TEMPLATE(BM_BasicPidUpdate, BasicPid<SFixed<19, 12>>);
+BENCHMARK_TEMPLATE(BM_BasicPidUpdate, BasicPid<float>);
+
+// The same loop as BM_BasicPidUpdate<Pid>, but with the gains scheduled over
+// a table of N breakpoints spanning [-32, 32]. The scheduling variable sweeps
+// the table so every lookup lands in a different place and most updates
+// change the gains. The difference from BM_BasicPidUpdate<Pid> is the
+// per-tick cost of the lookup and the bumpless transfer.
+template <size_t N>
+void BM_ScheduledPidUpdate(benchmark::State& state) {
+  std::array<Breakpoint, N> breakpoints;
+  for (size_t i = 0; i < N; ++i) {
+    const float at = N == 1 ? 0 : -32 + 64.f * i / (N - 1);
+    breakpoints[i] = {.at = at, .kp = 2 + at / 32, .ki = .5, .kd = 1};
+  }
+  auto pid = *ScheduledPid<N>::Create(
+      {.kp = 0, .ki = 0, .kd = 0, .output_min = -10, .output_max = 10},
+      breakpoints);
+  pid.set_setpoint(1);
+  std::array<SQ15x16, 64> m;
+  const auto fixed = Measurements();
+  for (size_t i = 0; i < m.size(); ++i) m[i] = fixed[i] / 16;
+  const SQ15x16 dt = 1;
+  size_t t = 0;
+  bench::CycleCounter cycles(state);
+  for (auto _ : state) {
+    const SQ15x16 x = static_cast<int>(t * 13 % 80) - 40;
+    benchmark::DoNotOptimize(pid.Update(m[t % m.size()], dt, x));
+    ++t;
+  }
+}
+BENCHMARK_TEMPLATE(BM_ScheduledPidUpdate, 1);
+BENCHMARK_TEMPLATE(BM_ScheduledPidUpdate, 4);
+BENCHMARK_TEMPLATE(BM_ScheduledPidUpdate, 16);
+
+// One balancing control tick from pitch, pitch rate, wheel angle and wheel
+// rate, the two ways the robot can be controlled. The cascade is the
+// smallest that balances: a wheel speed loop setting the pitch for a pitch
+// loop, and it still ignores the wheel angle. The state feedback uses all
+// four states, with the gains from tools/lqr_gains.
+struct BalanceSample {
+  SQ15x16 pitch, pitch_rate, wheel_angle, wheel_rate;
+};
+
+std::array<BalanceSample, 64> BalanceSamples() {
+  std::array<BalanceSample, 64> samples;
+  const auto m = Measurements();
+  for (size_t i = 0; i < samples.size(); ++i) {
+    samples[i] = {.pitch = m[i] / 32,
+                  .pitch_rate = m[(i + 16) % m.size()] / 4,
+                  .wheel_angle = m[(i + 32) % m.size()] * 4,
+                  .wheel_rate = m[(i + 48) % m.size()]};
+  }
+  return samples;
+}
+
+void BM_BalanceCascadedPid(benchmark::State& state) {
+  auto speed = *Pid::Create(
+      {.kp = .01, .ki = .001, .kd = 0, .output_min = -5, .output_max = 5});
+  auto pitch = *Pid::Create(
+      {.kp = 25, .ki = 0, .kd = 3, .output_min = -255, .output_max = 255});
+  const auto samples = BalanceSamples();
+  const SQ15x16 dt = 1;
+  size_t t = 0;
+  bench::CycleCounter cycles(state);
+  for (auto _ : state) {
+    const BalanceSample& s = samples[t % samples.size()];
+    pitch.set_setpoint(speed.Update(s.wheel_rate, dt));
+    benchmark::DoNotOptimize(pitch.Update(s.pitch, dt));
+    ++t;
+  }
+}
+BENCHMARK(BM_BalanceCascadedPid);
+
+void BM_BalanceStateFeedback(benchmark::State& state) {
+  const auto controller = *StateFeedback<4>::Create(kBalanceGains);
+  const auto samples = BalanceSamples();
+  size_t t = 0;
+  bench::CycleCounter cycles(state);
+  for (auto _ : state) {
+    const BalanceSample& s = samples[t % samples.size()];
+    const std::array<SQ15x16, 4> x = {s.pitch, s.pitch_rate, s.wheel_angle,
+                                      s.wheel_rate};
+    benchmark::DoNotOptimize(controller.Update(x));
+    ++t;
+  }
+}
+BENCHMARK(BM_BalanceStateFeedback);
+
+}  // namespace
+}  // namespace intpid
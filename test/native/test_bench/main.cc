@@ -0,0 +1,25 @@
+#include <benchmark/benchmark.h>
+#include <gtest/gtest.h>
+
+// Benchmarks run under `pio test -e native_bench`. Extra arguments are passed
+// through to Google Benchmark, e.g. to get machine-readable results, as one
+// command:
+//
+//   pio test -e native_bench -a "--benchmark_out=bench.json"
+//       -a "--benchmark_out_format=json"
+//
+// tools/bench_compare.py diffs two such files, e.g. from consecutive commits.
+// Benchmarks that report a cycles_per_op counter use bench::CycleCounter.
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  ::benchmark::Initialize(&argc, argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+  ::benchmark::Shutdown();
+
+  // PlatformIO's googletest runner expects a gtest summary.
+  if (RUN_ALL_TESTS())
+    ;
+
+  // Always return zero-code and allow PlatformIO to parse results
+  return 0;
+}
@@ -0,0 +1,232 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include "cycles.h"
+#include "feedback_motor.h"
+#include "hbridge_motor.h"
+#include "hosthal.h"
+#include "loopback.h"
+#include "mlx90393_sensor.h"
+#include "replay_sensor.h"
+#include "three_wire_motor.h"
+#include "trace.h"
+#include "vector_angle.h"
+#include "velocity_estimator.h"
+
+namespace motor {
+namespace {
+
+using sim::LoopbackMotor;
+using sim::LoopbackSensor;
+
+// Queues one full turn of samples in small steps, so Update() exercises both
+// the normal and the wrap-around branches.
+void QueueTurn(Adafruit_MLX90393& fake, int steps) {
+  for (int i = 0; i < steps; ++i) {
+    const double radians = 2 * PI * i / steps;
+    fake.PushSample(400 * cos(radians), 400 * sin(radians));
+  }
+}
+
+void BM_MLX90393SensorUpdate(benchmark::State& state) {
+  hosthal::Reset();
+  Adafruit_MLX90393 fake;
+  QueueTurn(fake, 360);
+  fake.set_loop(true);
+  fake.set_read_duration_us(1000);
+  MLX90393Sensor sensor(&fake);
+  bench::CycleCounter cycles(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(sensor.Update());
+  }
+  benchmark::DoNotOptimize(sensor.angle());
+}
+BENCHMARK(BM_MLX90393SensorUpdate);
+
+// The same turn from a trace, as a replayed regression test runs it.
+void BM_ReplaySensorUpdate(benchmark::State& state) {
+  std::vector<TraceEvent> trace;
+  for (int i = 0; i < 360; ++i) {
+    const double radians = 2 * PI * i / 360;
+    trace.push_back({.timestamp_us = static_cast<uint32_t>(1000 * i),
+                     .kind = TraceEvent::kSample,
+                     .field = {static_cast<float>(400 * cos(radians)),
+                               static_cast<float>(400 * sin(radians))}});
+  }
+  ReplaySensor sensor(trace);
+  bench::CycleCounter cycles(state);
+  for (auto _ : state) {
+    if (!sensor.Update()) sensor.Rewind();
+  }
+  benchmark::DoNotOptimize(sensor.angle());
+}
+BENCHMARK(BM_ReplaySensorUpdate);
+
+void BM_TraceRecordSample(benchmark::State& state) {
+  std::array<TraceEvent, 1024> buffer;
+  TraceRecorder recorder(buffer, TraceRecorder::kKeepLatest);
+  uint32_t t = 0;
+  bench::CycleCounter cycles(state);
+  for (auto _ : state) {
+    recorder.RecordSample(t++, {400, 300});
+  }
+  benchmark::DoNotOptimize(recorder[0]);
+}
+BENCHMARK(BM_TraceRecordSample);
+
+// A control loop's efforts: a slow sine, so most ticks change the duty by a
+// little or not at all, with a reversal every half period. The time is only
+// the host fakes'; writes_per_op is what carries over to the board.
+template <typename M>
+void RunEfforts(benchmark::State& state, M& motor) {
+  std::array<int, 512> efforts;
+  for (size_t i = 0; i < efforts.size(); ++i) {
+    efforts[i] = static_cast<int>(200 * sin(2 * PI * i / efforts.size()));
+  }
+  size_t i = 0;
+  bench::CycleCounter cycles(state);
+  for (auto _ : state) {
+    motor.SetEffort(efforts[i]);
+    i = (i + 1) % efforts.size();
+  }
+}
+
+void BM_ThreeWireMotorSetEffort(benchmark::State& state) {
+  hosthal::Reset();
+  ThreeWireMotor motor(0, 1, 8);
+  motor.Begin();
+  RunEfforts(state, motor);
+  state.counters["writes_per_op"] = benchmark::Counter(
+      hosthal::TotalPinWrites(), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_ThreeWireMotorSetEffort);
+
+void BM_HBridgeMotorSetEffort(benchmark::State& state) {
+  hosthal::Reset();
+  HBridgeMotor motor({.pwm = 0, .forward = 1, .reverse = 8});
+  motor.Begin();
+  RunEfforts(state, motor);
+  state.counters["writes_per_op"] = benchmark::Counter(
+      hosthal::TotalRegisterWrites(), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_HBridgeMotorSetEffort);
+
+FeedbackConfig LoopbackConfig() {
+  return {.velocity = {.kp = 0.05,
+                       .ki = 0.02,
+                       .kd = 0,
+                       .output_min = -255,
+                       .output_max = 255},
+          .position = {.kp = 4,
+                       .ki = 0,
+                       .kd = 0,
+                       .output_min = -360,
+                       .output_max = 360},
+          .position_divider = 5};
+}
+
+// M and S are the types the controller is bound to: Motor and Sensor for
+// virtual calls, or the loopback types for static ones.
+template <typename M, typename S>
+void BM_FeedbackMotorUpdate(benchmark::State& state) {
+  LoopbackMotor motor;
+  LoopbackSensor sensor(&motor, /*gain=*/4);
+  auto fm = *BasicFeedbackMotor<M, S>::Create(&motor, &sensor,
+                                              LoopbackConfig());
+  fm.SetTargetPosition(100);
+  bench::CycleCounter cycles(state);
+  for (auto _ : state) {
+    fm.Update(1);
+  }
+  benchmark::DoNotOptimize(motor.effort);
+}
+BENCHMARK(BM_FeedbackMotorUpdate<Motor, Sensor>);
+BENCHMARK(BM_FeedbackMotorUpdate<LoopbackMotor, LoopbackSensor>);
+
+// A full turn of field vectors at a typical magnitude, as raw counts.
+struct Vectors {
+  static constexpr int kCount = 256;
+  std::array<int32_t, kCount> x, y;
+
+  Vectors() {
+    for (int i = 0; i < kCount; ++i) {
+      const double radians = 2 * PI * i / kCount;
+      x[i] = static_cast<int32_t>(6400 * cos(radians));
+      y[i] = static_cast<int32_t>(6400 * sin(radians));
+    }
+  }
+};
+
+void BM_VectorToAngleDecidegrees(benchmark::State& state) {
+  const Vectors v;
+  int i = 0;
+  bench::CycleCounter cycles(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(VectorToAngleDecidegrees(v.x[i], v.y[i]));
+    i = (i + 1) % Vectors::kCount;
+  }
+}
+BENCHMARK(BM_VectorToAngleDecidegrees);
+
+void BM_VectorToAngleCordic(benchmark::State& state) {
+  const Vectors v;
+  int i = 0;
+  bench::CycleCounter cycles(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(VectorToAngleCordic(v.x[i], v.y[i]));
+    i = (i + 1) % Vectors::kCount;
+  }
+}
+BENCHMARK(BM_VectorToAngleCordic);
+
+void BM_VectorToAngleTable(benchmark::State& state) {
+  const Vectors v;
+  int i = 0;
+  bench::CycleCounter cycles(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(VectorToAngleTable(v.x[i], v.y[i]));
+    i = (i + 1) % Vectors::kCount;
+  }
+}
+BENCHMARK(BM_VectorToAngleTable);
+
+// The estimators are called through the base class, as the sensor does.
+void RunVelocityEstimator(benchmark::State& state,
+                          VelocityEstimator& estimator) {
+  const SQ15x16 delta = 0.3;
+  const SQ15x16 dt_ms = 1;
+  bench::CycleCounter cycles(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(estimator.Update(delta, dt_ms));
+  }
+}
+
+void BM_FirstDifferenceEstimator(benchmark::State& state) {
+  FirstDifferenceEstimator estimator;
+  RunVelocityEstimator(state, estimator);
+}
+BENCHMARK(BM_FirstDifferenceEstimator);
+
+void BM_MovingAverageEstimator(benchmark::State& state) {
+  MovingAverageEstimator<8> estimator;
+  RunVelocityEstimator(state, estimator);
+}
+BENCHMARK(BM_MovingAverageEstimator);
+
+void BM_AlphaBetaEstimator(benchmark::State& state) {
+  AlphaBetaEstimator estimator(0.1, 0.005);
+  RunVelocityEstimator(state, estimator);
+}
+BENCHMARK(BM_AlphaBetaEstimator);
+
+void BM_TrackingLoopEstimator(benchmark::State& state) {
+  TrackingLoopEstimator estimator(20);
+  RunVelocityEstimator(state, estimator);
+}
+BENCHMARK(BM_TrackingLoopEstimator);
+
+}  // namespace
+}  // namespace motor
@@ -0,0 +1,159 @@
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <numbers>
+#include <random>
+#include <vector>
+
+#include "balance_kalman.h"
+#include "complementary_filter.h"
+#include "cycles.h"
+#include "mahony_filter.h"
+#include "orientation.h"
+
+namespace orientation {
+namespace {
+
+constexpr double kPi = std::numbers::pi;
+constexpr double kDtMs = 1;
+
+// Five seconds of a 1 Hz, 15 degree sway at 1 kHz, with gyro noise and bias
+// and accelerometer vibration, and the true pitch for each sample.
+struct SwayTrace {
+  static constexpr int kCount = 5'000;
+  std::vector<ImuSample> samples;
+  std::vector<double> pitch;
+
+  SwayTrace() {
+    std::mt19937 rng(42);
+    std::normal_distribution<double> gyro_noise(0, 0.05);
+    std::normal_distribution<double> accel_noise(0, 0.3);
+    for (int i = 0; i < kCount; ++i) {
+      const double t = i * kDtMs / 1000;
+      const double p = 15 * std::sin(2 * kPi * t);
+      const double rate = 15 * 2 * kPi * std::cos(2 * kPi * t);
+      const double radians = p * kPi / 180;
+      samples.push_back({
+          .accel_x = -std::sin(radians) * 9.81 + accel_noise(rng),
+          .accel_y = accel_noise(rng),
+          .accel_z = std::cos(radians) * 9.81 + accel_noise(rng),
+          .gyro_x = gyro_noise(rng),
+          .gyro_y = rate + 1.5 + gyro_noise(rng),
+          .gyro_z = gyro_noise(rng),
+      });
+      pitch.push_back(p);
+    }
+  }
+};
+
+// Times one Update per iteration, then replays the trace once more from the
+// start to report the RMS pitch error over its second half.
+void RunFilter(benchmark::State& state, OrientationFilter& filter) {
+  static const SwayTrace trace;
+  const SQ15x16 dt_ms = kDtMs;
+  int i = 0;
+  {
+    bench::CycleCounter cycles(state);
+    for (auto _ : state) {
+      filter.Update(trace.samples[i], dt_ms);
+      benchmark::DoNotOptimize(filter.pitch());
+      i = (i + 1) % SwayTrace::kCount;
+    }
+  }
+
+  filter.Reset();
+  double sum = 0;
+  for (i = 0; i < SwayTrace::kCount; ++i) {
+    filter.Update(trace.samples[i], dt_ms);
+    if (i >= SwayTrace::kCount / 2) {
+      const double error = float{filter.pitch()} - trace.pitch[i];
+      sum += error * error;
+    }
+  }
+  state.counters["rms_error_deg"] = std::sqrt(sum / (SwayTrace::kCount / 2));
+}
+
+void BM_ComplementaryFilter(benchmark::State& state) {
+  ComplementaryFilter filter(500);
+  RunFilter(state, filter);
+}
+BENCHMARK(BM_ComplementaryFilter);
+
+void BM_MahonyFilter(benchmark::State& state) {
+  MahonyFilter filter(2, 1);
+  RunFilter(state, filter);
+}
+BENCHMARK(BM_MahonyFilter);
+
+// A BalanceKalman cycle on the sway trace, with the wheels swinging 200
+// degrees at 0.5 Hz under 0.1 degree readings. Counters as for RunFilter.
+template <typename T>
+void BM_BalanceKalman(benchmark::State& state) {
+  static const SwayTrace trace;
+  static const std::vector<T> wheel = [] {
+    std::vector<T> angles;
+    for (int i = 0; i < SwayTrace::kCount; ++i) {
+      const double t = i * kDtMs / 1000;
+      angles.push_back(T(std::round(2000 * std::sin(kPi * t)) / 10));
+    }
+    return angles;
+  }();
+  BasicBalanceKalman<T> filter;
+  const T dt_ms = kDtMs;
+  int i = 0;
+  {
+    bench::CycleCounter cycles(state);
+    for (auto _ : state) {
+      filter.Update(trace.samples[i], wheel[i], dt_ms);
+      benchmark::DoNotOptimize(filter.state());
+      i = (i + 1) % SwayTrace::kCount;
+    }
+  }
+
+  filter.Reset();
+  double sum = 0;
+  for (i = 0; i < SwayTrace::kCount; ++i) {
+    filter.Update(trace.samples[i], wheel[i], dt_ms);
+    if (i >= SwayTrace::kCount / 2) {
+      const double error = static_cast<float>(filter.pitch()) - trace.pitch[i];
+      sum += error * error;
+    }
+  }
+  state.counters["rms_error_deg"] = std::sqrt(sum / (SwayTrace::kCount / 2));
+}
+BENCHMARK_TEMPLATE(BM_BalanceKalman, SQ15x16);
+BENCHMARK_TEMPLATE(BM_BalanceKalman, float);
+
+// The parts of a cycle on their own. Each runs on a fresh copy of a settled
+// filter, so the covariance stays realistic, and the copy of its 35 values
+// is included in the count.
+enum KalmanStep { kPredict, kImu, kWheel };
+
+template <typename T, KalmanStep kStep>
+void BM_BalanceKalmanStep(benchmark::State& state) {
+  BasicBalanceKalman<T> settled;
+  for (int i = 0; i < 1'000; ++i) {
+    settled.Update(ImuSample{.accel_z = 1, .gyro_y = 0.5}, T(i % 7),
+                   T(kDtMs));
+  }
+  settled.Predict(T(kDtMs));
+  const T dt_ms = kDtMs;
+  const ImuSample sample = {.accel_x = 0.1, .accel_z = 9.8, .gyro_y = 3};
+  bench::CycleCounter cycles(state);
+  for (auto _ : state) {
+    BasicBalanceKalman<T> filter = settled;
+    if constexpr (kStep == kPredict) filter.Predict(dt_ms);
+    if constexpr (kStep == kImu) filter.UpdateImu(sample);
+    if constexpr (kStep == kWheel) filter.UpdateWheelAngle(T(3));
+    benchmark::DoNotOptimize(filter.state());
+  }
+}
+BENCHMARK_TEMPLATE(BM_BalanceKalmanStep, SQ15x16, kPredict);
+BENCHMARK_TEMPLATE(BM_BalanceKalmanStep, SQ15x16, kImu);
+BENCHMARK_TEMPLATE(BM_BalanceKalmanStep, SQ15x16, kWheel);
+BENCHMARK_TEMPLATE(BM_BalanceKalmanStep, float, kPredict);
+BENCHMARK_TEMPLATE(BM_BalanceKalmanStep, float, kImu);
+BENCHMARK_TEMPLATE(BM_BalanceKalmanStep, float, kWheel);
+
+}  // namespace
+}  // namespace orientation
@@ -0,0 +1,72 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "balancing_robot.h"
+#include "complementary_filter.h"
+#include "cycles.h"
+#include "magnet_sensor.h"
+#include "sim_imu.h"
+
+namespace sim {
+namespace {
+
+constexpr uint32_t kPeriodUs = 1000;
+
+// One simulated second per iteration: the physics alone, with both motors
+// at a fixed effort on the bench.
+void BM_SimulatePhysics(benchmark::State& state) {
+  RobotParams params;
+  params.mount = RobotParams::kClamped;
+  BalancingRobot robot(params);
+  robot.motor(kLeft).SetEffort(100);
+  robot.motor(kRight).SetEffort(-100);
+  {
+    bench::CycleCounter cycles(state, 1'000'000 / kPeriodUs);
+    for (auto _ : state) {
+      for (uint32_t i = 0; i < 1'000'000 / kPeriodUs; ++i) {
+        robot.Advance(kPeriodUs);
+      }
+    }
+  }
+  benchmark::DoNotOptimize(robot.wheel_degrees(kLeft));
+  state.counters["realtime_factor"] =
+      benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_SimulatePhysics);
+
+// One simulated second per iteration of a balancing robot with both magnet
+// sensors, the IMU, and a 1 kHz state feedback loop.
+void BM_SimulateBalancing(benchmark::State& state) {
+  BalancingRobot robot;
+  SimImu imu(&robot);
+  MagnetSensor left(&robot, kLeft, {}, 2);
+  MagnetSensor right(&robot, kRight, {}, 3);
+  orientation::ComplementaryFilter filter(200);
+  {
+    bench::CycleCounter cycles(state, 1'000'000 / kPeriodUs);
+    for (auto _ : state) {
+      for (uint32_t i = 0; i < 1'000'000 / kPeriodUs; ++i) {
+        left.Update();
+        right.Update();
+        filter.Update(imu.Read(), 1);
+        const double effort =
+            25 * float{filter.pitch()} + 3 * float{filter.pitch_rate()} +
+            0.1 * (float{left.rate()} + float{right.rate()}) +
+            0.01 * (float{left.angle()} + float{right.angle()});
+        const int duty = std::lround(std::clamp(effort, -255.0, 255.0));
+        robot.motor(kLeft).SetEffort(duty);
+        robot.motor(kRight).SetEffort(duty);
+        robot.Advance(kPeriodUs);
+      }
+    }
+  }
+  if (robot.fallen()) state.SkipWithError("the robot fell");
+  state.counters["realtime_factor"] =
+      benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_SimulateBalancing);
+
+}  // namespace
+}  // namespace sim
@@ -0,0 +1,37 @@
+#include <benchmark/benchmark.h>
+
+#include "cycles.h"
+#include "record.h"
+#include "spsc_ring.h"
+
+namespace telemetry {
+namespace {
+
+// The producer-side cost the control loop pays per sample.
+void BM_SpscRingPushPop(benchmark::State& state) {
+  SpscRing<Record, 256> ring;
+  Record out;
+  uint32_t t = 0;
+  bench::CycleCounter cycles(state);
+  for (auto _ : state) {
+    ring.TryPush(Record::Make(t++, 1, SQ15x16(3.25)));
+    ring.TryPop(out);
+    benchmark::DoNotOptimize(out);
+  }
+}
+BENCHMARK(BM_SpscRingPushPop);
+
+// Pushing into a full ring only bumps the drop counter.
+void BM_SpscRingPushFull(benchmark::State& state) {
+  SpscRing<Record, 4> ring;
+  while (ring.TryPush(Record::Make(0, 0, 0))) {
+  }
+  bench::CycleCounter cycles(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ring.TryPush(Record::Make(1, 1, 1)));
+  }
+}
+BENCHMARK(BM_SpscRingPushFull);
+
+}  // namespace
+}  // namespace telemetry
@@ -0,0 +1,214 @@
+#include "autotune.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numbers>
+#include <type_traits>
+
+#include "intpid.h"
+#include "water_heater.h"
+
+namespace intpid {
+namespace {
+
+// Three first order lags of 1 s in series, 1 / (s + 1)^3. Its ultimate gain
+// is 8, at a period of 2 pi / sqrt(3) s.
+class ThirdOrderLag {
+ public:
+  static constexpr double kUltimateGain = 8;
+  static constexpr double kUltimatePeriod = 2 * std::numbers::pi / 1.7320508;
+
+  double value() const { return stages_[2]; }
+  void Update(double input, double dt) {
+    for (double& stage : stages_) {
+      stage += (input - stage) * dt;
+      input = stage;
+    }
+  }
+
+ private:
+  std::array<double, 3> stages_ = {};
+};
+
+constexpr double kDt = 0.01;
+
+// Runs the relay experiment on the lag until it finishes or a minute passes.
+RelayAutotuner Autotune(const AutotuneConfig& config, ThirdOrderLag& plant,
+                        double setpoint = 1) {
+  auto tuner = *RelayAutotuner::Create(config);
+  tuner.set_setpoint(setpoint);
+  for (int i = 0; i < 60 / kDt && tuner.state() == RelayAutotuner::kRunning;
+       ++i) {
+    const SQ15x16 output = tuner.Update(plant.value(), kDt);
+    plant.Update(float{output}, kDt);
+  }
+  return tuner;
+}
+
+struct StepResponse {
+  double overshoot;
+  double settling_time;
+};
+
+// Steps the lag from 0 to 1 under a Pid built from config.
+StepResponse Step(const Config& config) {
+  auto pid = *Pid::Create(config);
+  pid.set_setpoint(1);
+  ThirdOrderLag plant;
+  pid.Update(plant.value(), 0);
+  StepResponse response = {};
+  for (int i = 0; i < 60 / kDt; ++i) {
+    plant.Update(float{pid.Update(plant.value(), kDt)}, kDt);
+    response.overshoot = std::max(response.overshoot, plant.value() - 1);
+    if (std::abs(plant.value() - 1) > 0.05) response.settling_time = i * kDt;
+  }
+  return response;
+}
+
+TEST(RelayAutotuner, IsMoveAssignable) {
+  static_assert(std::is_move_assignable_v<RelayAutotuner>);
+  auto tuner = *RelayAutotuner::Create(
+      {.output_low = 0, .output_high = 1, .hysteresis = 0});
+  tuner = *RelayAutotuner::Create(
+      {.output_low = 0, .output_high = 2, .hysteresis = 0});
+  EXPECT_EQ(tuner.state(), RelayAutotuner::kRunning);
+}
+
+TEST(RelayAutotuner, RejectsBadConfigs) {
+  EXPECT_FALSE(RelayAutotuner::Create({.output_low = 1,
+                                       .output_high = 1,
+                                       .hysteresis = 0}));
+  EXPECT_FALSE(RelayAutotuner::Create({.output_low = 0,
+                                       .output_high = 1,
+                                       .hysteresis = -1}));
+  EXPECT_FALSE(RelayAutotuner::Create(
+      {.output_low = 0, .output_high = 1, .hysteresis = 0, .cycles = 0}));
+}
+
+TEST(RelayAutotuner, FindsTheUltimateGainAndPeriod) {
+  ThirdOrderLag plant;
+  const RelayAutotuner tuner = Autotune(
+      {.output_low = -2, .output_high = 4, .hysteresis = 0.01}, plant);
+  ASSERT_EQ(tuner.state(), RelayAutotuner::kDone);
+  // The describing function is an approximation: the relay's harmonics bias
+  // the gain a few percent low.
+  EXPECT_NEAR(float{tuner.ultimate_gain()}, ThirdOrderLag::kUltimateGain,
+              0.1 * ThirdOrderLag::kUltimateGain);
+  EXPECT_NEAR(float{tuner.ultimate_period()}, ThirdOrderLag::kUltimatePeriod,
+              0.03 * ThirdOrderLag::kUltimatePeriod);
+  // The plant starting from rest, one settling oscillation and the four
+  // measured.
+  EXPECT_LT(float{tuner.elapsed()}, 7 * ThirdOrderLag::kUltimatePeriod);
+}
+
+TEST(RelayAutotuner, OutputsTheRelayThenTheMidpoint) {
+  ThirdOrderLag plant;
+  auto tuner = *RelayAutotuner::Create(
+      {.output_low = -2, .output_high = 4, .hysteresis = 0.01, .cycles = 1});
+  tuner.set_setpoint(1);
+  EXPECT_EQ(tuner.Update(0, kDt), 4);
+  EXPECT_EQ(tuner.Update(1.5, kDt), -2);
+  EXPECT_EQ(tuner.Update(1.005, kDt), -2);  // Within the hysteresis.
+  EXPECT_EQ(tuner.Update(0.98, kDt), 4);
+  while (tuner.state() == RelayAutotuner::kRunning) {
+    plant.Update(float{tuner.Update(plant.value(), kDt)}, kDt);
+  }
+  EXPECT_EQ(tuner.Update(plant.value(), kDt), 1);
+}
+
+TEST(RelayAutotuner, ConfigFollowsTheRule) {
+  ThirdOrderLag plant;
+  const RelayAutotuner tuner = Autotune(
+      {.output_low = -2, .output_high = 4, .hysteresis = 0.01}, plant);
+  const double ku = float{tuner.ultimate_gain()};
+  const double tu = float{tuner.ultimate_period()};
+
+  const Config zn = *tuner.config(TuningRule::kZieglerNichols);
+  EXPECT_NEAR(zn.kp, 0.6 * ku, 1e-3);
+  EXPECT_NEAR(zn.ki, zn.kp / (tu / 2), 1e-3);
+  // kd is per update, and updates are kDt apart.
+  EXPECT_NEAR(zn.kd, zn.kp * tu / 8 / kDt, 0.5);
+  EXPECT_EQ(zn.output_min, -2);
+  EXPECT_EQ(zn.output_max, 4);
+
+  const Config pi = *tuner.config(TuningRule::kTyreusLuybenPi);
+  EXPECT_NEAR(pi.kp, ku / 3.2, 1e-3);
+  EXPECT_NEAR(pi.ki, pi.kp / (2.2 * tu), 1e-4);
+  EXPECT_EQ(pi.kd, 0);
+}
+
+TEST(RelayAutotuner, ConfigNeedsAFinishedExperiment) {
+  auto tuner = *RelayAutotuner::Create(
+      {.output_low = 0, .output_high = 1, .hysteresis = 0.1});
+  EXPECT_FALSE(tuner.config().has_value());
+}
+
+TEST(RelayAutotuner, TimesOutWithoutAnOscillation) {
+  auto tuner = *RelayAutotuner::Create(
+      {.output_low = 0, .output_high = 1, .hysteresis = 0.1, .timeout = 5});
+  tuner.set_setpoint(1);
+  // The output does nothing, so the relay never switches.
+  for (int i = 0; i < 4 / kDt; ++i) tuner.Update(0, kDt);
+  EXPECT_EQ(tuner.state(), RelayAutotuner::kRunning);
+  for (int i = 0; i < 2 / kDt; ++i) tuner.Update(0, kDt);
+  EXPECT_EQ(tuner.state(), RelayAutotuner::kFailed);
+  EXPECT_FALSE(tuner.config().has_value());
+}
+
+TEST(RelayAutotuner, TunedGainsControlThePlant) {
+  ThirdOrderLag plant;
+  const RelayAutotuner tuner = Autotune(
+      {.output_low = -2, .output_high = 4, .hysteresis = 0.01}, plant);
+  const StepResponse zn = Step(*tuner.config(TuningRule::kZieglerNichols));
+  const StepResponse tl = Step(*tuner.config(TuningRule::kTyreusLuyben));
+  EXPECT_LT(zn.settling_time, 20);
+  EXPECT_LT(tl.settling_time, 20);
+  // Tyreus-Luyben trades speed for damping.
+  EXPECT_LT(tl.overshoot, zn.overshoot);
+  EXPECT_LT(tl.overshoot, 0.25);
+}
+
+// The relay experiment on the intpid test's water heater, one update per
+// minute, then a PI controller from the result holding the setpoint against
+// a steady trickle of draw.
+TEST(RelayAutotuner, TunesTheWaterHeater) {
+  constexpr int dt = 60;
+  sim::WaterHeaterModel model(200'000, 20, 20, 11700);
+  // Warm up to near the setpoint first, as the heater would in normal use.
+  model.set_power(1);
+  while (model.temp() < model.setpoint() - 1) model.Update(dt);
+
+  auto tuner = *RelayAutotuner::Create({.output_low = 0,
+                                        .output_high = 100,
+                                        .hysteresis = 0.05,
+                                        .timeout = 12 * 60 * 60});
+  tuner.set_setpoint(model.setpoint());
+  while (tuner.state() == RelayAutotuner::kRunning) {
+    model.set_power(float{tuner.Update(model.temp(), dt)} / 100);
+    model.Update(dt);
+  }
+  ASSERT_EQ(tuner.state(), RelayAutotuner::kDone);
+  EXPECT_LT(float{tuner.elapsed()}, 6 * 60 * 60);
+
+  auto pid = *Pid::Create(*tuner.config(TuningRule::kTyreusLuybenPi));
+  pid.set_setpoint(model.setpoint());
+  pid.Update(model.temp(), 0);
+  model.set_flow_rate(20);
+  double worst = 0;
+  for (int t = 0; t < 2 * 60 * 60; t += dt) {
+    model.set_power(float{pid.Update(model.temp(), dt)} / 100);
+    model.Update(dt);
+    if (t > 60 * 60) {
+      worst = std::max<double>(worst,
+                               std::abs(model.temp() - model.setpoint()));
+    }
+  }
+  EXPECT_LT(worst, 0.5);
+}
+
+}  // namespace
+}  // namespace intpid
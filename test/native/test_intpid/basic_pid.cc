@@ -0,0 +1,272 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "intpid.h"
+
+namespace intpid {
+namespace {
+
+using PNoTelemetry =
+    BasicPid<SQ15x16, Features<Terms::kP, AntiWindup::kNone, false, false>>;
+using PIClamp =
+    BasicPid<SQ15x16, Features<Terms::kPI, AntiWindup::kClamp, false, false>>;
+using PidNoTelemetry =
+    BasicPid<SQ15x16,
+             Features<Terms::kPID, AntiWindup::kCutoff, false, false>>;
+using PidQ7x24 = BasicPid<SQ7x24>;
+using PidQ19x12 = BasicPid<SFixed<19, 12>>;
+using PidFloat = BasicPid<float>;
+
+// Features that are turned off must not take any space.
+static_assert(sizeof(PNoTelemetry) == 6 * sizeof(SQ15x16));
+static_assert(sizeof(PIClamp) == 8 * sizeof(SQ15x16));
+static_assert(sizeof(PidNoTelemetry) == 16 * sizeof(SQ15x16));
+static_assert(sizeof(Pid) > sizeof(PidNoTelemetry) ||
+              INTPID_SUPPRESS_LOGGING != 0);
+
+template <typename P>
+concept HasTelemetry = requires(const P& p) { p.sum(); };
+static_assert(!HasTelemetry<PNoTelemetry>);
+static_assert(HasTelemetry<PidQ7x24> == (INTPID_SUPPRESS_LOGGING == 0));
+
+// A first order lag: the state moves toward the input with time constant tau.
+class LagModel {
+ public:
+  explicit LagModel(double tau) : tau_(tau) {}
+  double value() const { return value_; }
+  void Update(double input, double dt) {
+    value_ += (input - value_) * dt / tau_;
+  }
+
+ private:
+  const double tau_;
+  double value_ = 0;
+};
+
+// Runs the controller against the lag model from rest to a setpoint of 4 and
+// returns the final value. Checks that the output never leaves its range.
+template <typename P>
+double RunStep(P& pid, int ticks) {
+  using T = typename P::Value;
+  LagModel model(20);
+  pid.set_setpoint(T(4));
+  pid.Update(T(0), T(0));
+  for (int t = 0; t < ticks; ++t) {
+    const T output = pid.Update(T(static_cast<float>(model.value())), T(1));
+    EXPECT_GE(static_cast<float>(output), -10);
+    EXPECT_LE(static_cast<float>(output), 10);
+    model.Update(static_cast<float>(output), 1);
+  }
+  return model.value();
+}
+
+constexpr Config kConfig = {
+    .kp = 2, .ki = .2, .kd = 1, .output_min = -10, .output_max = 10};
+
+template <typename P>
+class BasicPidTest : public ::testing::Test {};
+
+using IntegratingPids =
+    ::testing::Types<Pid, PIClamp, PidNoTelemetry, PidQ7x24, PidQ19x12,
+                     PidFloat>;
+TYPED_TEST_SUITE(BasicPidTest, IntegratingPids);
+
+TYPED_TEST(BasicPidTest, SettlesOnSetpoint) {
+  auto pid = *TypeParam::Create(kConfig);
+  EXPECT_NEAR(RunStep(pid, 1000), 4, 1e-2);
+}
+
+TYPED_TEST(BasicPidTest, RecoversFromSaturation) {
+  auto pid = *TypeParam::Create(kConfig);
+  using T = typename TypeParam::Value;
+  pid.set_setpoint(T(100));
+  // A long stretch of saturation must not wind the integrator up past the
+  // output range.
+  for (int t = 0; t < 1000; ++t) pid.Update(T(0), T(1));
+  // A small overshoot is enough to come off the rail right away.
+  pid.set_setpoint(T(0));
+  EXPECT_LT(static_cast<float>(pid.Update(T(2), T(1))), 10);
+}
+
+TEST(BasicPid, ProportionalOnlyLeavesSteadyStateError) {
+  auto pid = *PNoTelemetry::Create(kConfig);
+  // With only P, the loop settles where kp * (4 - x) = x.
+  EXPECT_NEAR(RunStep(pid, 1000), 4. * 2 / 3, 1e-2);
+}
+
+TEST(BasicPid, ClampBoundsIntegrator) {
+  auto pid = *PIClamp::Create(
+      {.kp = 0, .ki = 1, .kd = 0, .output_min = -1, .output_max = 1});
+  pid.set_setpoint(50);
+  for (int t = 0; t < 100; ++t) EXPECT_LE(pid.Update(0, 1), 1);
+  pid.set_setpoint(-50);
+  // Clamped at +1, so two ticks of -50 error pull it all the way down.
+  EXPECT_EQ(pid.Update(0, 1), -1);
+}
+
+TEST(BasicPid, ValidatesTheDerivativeFilter) {
+  Config config = kConfig;
+  config.derivative_filter = -1;
+  EXPECT_FALSE(Pid::Create(config).has_value());
+  // The filter's time constant is kd / (kp N).
+  config.derivative_filter = 10;
+  config.kp = 0;
+  EXPECT_FALSE(Pid::Create(config).has_value());
+  config.kd = 0;
+  EXPECT_TRUE(Pid::Create(config).has_value());
+}
+
+// A gain of 1 / (1 + 1e6) rounds to 0 in SQ15x16, which would leave the
+// filtered D term at 0 forever, so it is kept at one LSB instead.
+TEST(BasicPid, SlowDerivativeFilterStillMoves) {
+  auto pid = *Pid::Create({.kp = 1,
+                           .ki = 0,
+                           .kd = 1000,
+                           .output_min = -2000,
+                           .output_max = 2000,
+                           .derivative_filter = .001});
+  pid.set_setpoint(0);
+  pid.Update(0, 0);
+  // P alone is -1; the D term adds a little of its -1000.
+  EXPECT_LT(pid.Update(1, 1), -1);
+}
+
+TEST(BasicPid, ResetForgetsTheIntegratorAndTheDerivative) {
+  Config config = kConfig;
+  config.derivative_filter = 4;
+  auto pid = *Pid::Create(config);
+  auto fresh = *Pid::Create(config);
+  pid.set_setpoint(5);
+  pid.Update(0, 0);
+  for (int t = 0; t < 20; ++t) pid.Update(t % 3, 1);
+  pid.Reset(40);
+  fresh.set_setpoint(5);
+  fresh.Update(40, 0);
+  EXPECT_EQ(pid.Update(41, 1), fresh.Update(41, 1));
+}
+
+// A setpoint step moves the D term only if it is weighted in.
+TEST(BasicPid, DerivativeOnMeasurementHasNoKick) {
+  Config config = {
+      .kp = 1, .ki = 0, .kd = 5, .output_min = -100, .output_max = 100};
+  auto on_measurement = *PidNoTelemetry::Create(config);
+  config.d_setpoint_weight = 1;
+  auto on_error = *PidNoTelemetry::Create(config);
+  for (auto* pid : {&on_measurement, &on_error}) {
+    pid->set_setpoint(0);
+    pid->Update(0, 0);
+    pid->set_setpoint(2);
+  }
+  EXPECT_EQ(on_measurement.Update(0, 1), 2);
+  EXPECT_EQ(on_error.Update(0, 1), 2 + 5 * 2);
+  // Both see the measurement move the same way.
+  EXPECT_EQ(on_measurement.Update(1, 1), 1 - 5);
+  EXPECT_EQ(on_error.Update(1, 1), 1 - 5);
+}
+
+// After a measurement step, the filtered D term jumps by the filter gain
+// 1 / (1 + kd / (kp N)) of the raw kick and then decays by the same share
+// each update.
+TEST(BasicPid, FilteredDerivativeDecaysGeometrically) {
+  // kd / (kp N) = 1, so the gain is exactly 1/2.
+  auto pid = *PidNoTelemetry::Create({.kp = 1,
+                                      .ki = 0,
+                                      .kd = 4,
+                                      .output_min = -100,
+                                      .output_max = 100,
+                                      .derivative_filter = 4});
+  pid.set_setpoint(0);
+  pid.Update(0, 0);
+  EXPECT_EQ(pid.Update(1, 1), -1 - 2);
+  EXPECT_EQ(pid.Update(1, 1), -1 - 1);
+  EXPECT_EQ(pid.Update(1, 1), -1 - .5);
+  EXPECT_EQ(pid.Update(1, 1), -1 - .25);
+  // A restart drops what is left of the old kick, so the next step starts
+  // from 0 too.
+  pid.Update(1, 0);
+  EXPECT_EQ(pid.Update(2, 1), -2 - 2);
+}
+
+// Holds the lag model at 4 with a noisy sensor and returns the RMS change in
+// the output from one update to the next.
+template <typename P>
+double OutputJitter(P& pid) {
+  LagModel model(20);
+  std::mt19937 rng(7);
+  std::normal_distribution<double> noise(0, .05);
+  pid.set_setpoint(4);
+  pid.Update(0, 0);
+  double prev = 0, sum_squares = 0;
+  constexpr int kTicks = 2000;
+  for (int t = 0; t < kTicks; ++t) {
+    const double output =
+        float{pid.Update(static_cast<float>(model.value() + noise(rng)), 1)};
+    model.Update(output, 1);
+    // Skip the step at the start.
+    if (t > 200) sum_squares += (output - prev) * (output - prev);
+    prev = output;
+  }
+  EXPECT_NEAR(model.value(), 4, .1);
+  return std::sqrt(sum_squares / (kTicks - 201));
+}
+
+TEST(BasicPid, DerivativeFilterRejectsNoise) {
+  Config config = {
+      .kp = 2, .ki = .2, .kd = 8, .output_min = -100, .output_max = 100};
+  auto raw = *PidNoTelemetry::Create(config);
+  config.derivative_filter = 2;
+  auto filtered = *PidNoTelemetry::Create(config);
+  const double raw_jitter = OutputJitter(raw);
+  const double filtered_jitter = OutputJitter(filtered);
+  EXPECT_LT(filtered_jitter, raw_jitter / 3);
+}
+
+struct StepResponse {
+  double overshoot;
+  int settling_ticks;
+};
+
+// Steps the lag model from rest to 4 and measures the response.
+StepResponse Step(const Config& config) {
+  auto pid = *PidNoTelemetry::Create(config);
+  LagModel model(20);
+  pid.set_setpoint(4);
+  pid.Update(0, 0);
+  StepResponse response = {};
+  for (int t = 0; t < 1000; ++t) {
+    model.Update(float{pid.Update(static_cast<float>(model.value()), 1)}, 1);
+    response.overshoot = std::max(response.overshoot, model.value() - 4);
+    if (std::abs(model.value() - 4) > .04) response.settling_ticks = t;
+  }
+  EXPECT_NEAR(model.value(), 4, 1e-2);
+  return response;
+}
+
+TEST(BasicPid, SetpointWeightSoftensTheStep) {
+  Config config = {
+      .kp = 4, .ki = .5, .kd = 0, .output_min = -100, .output_max = 100};
+  const StepResponse full = Step(config);
+  config.p_setpoint_weight = .3;
+  const StepResponse weighted = Step(config);
+  EXPECT_GT(full.overshoot, .1);
+  EXPECT_LT(weighted.overshoot, full.overshoot / 2);
+  EXPECT_LT(weighted.settling_ticks, 1000);
+}
+
+TEST(BasicPid, DerivativeFilterKeepsTheStepResponse) {
+  Config config = {
+      .kp = 4, .ki = .5, .kd = 5, .output_min = -100, .output_max = 100};
+  const StepResponse raw = Step(config);
+  config.derivative_filter = 5;
+  const StepResponse filtered = Step(config);
+  EXPECT_NEAR(filtered.overshoot, raw.overshoot, .05);
+  EXPECT_NEAR(filtered.settling_ticks, raw.settling_ticks,
+              .2 * raw.settling_ticks);
+}
+
+}  // namespace
+}  // namespace intpid
@@ -0,0 +1,164 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "intpid.h"
+#include "pid_telemetry.h"
+
+namespace intpid {
+namespace {
+
+using InstrumentedPid =
+    BasicPid<SQ15x16, Features<Terms::kPID, AntiWindup::kCutoff, false, true>>;
+using InstrumentedPIClamp =
+    BasicPid<SQ15x16, Features<Terms::kPI, AntiWindup::kClamp, false, true>>;
+using InstrumentedFloat =
+    BasicPid<float, Features<Terms::kPID, AntiWindup::kCutoff, false, true>>;
+using PidNoTelemetry =
+    BasicPid<SQ15x16,
+             Features<Terms::kPID, AntiWindup::kCutoff, false, false>>;
+
+template <typename P>
+concept HasDiagnostics = requires(const P& p) { p.diagnostics(); };
+static_assert(HasDiagnostics<InstrumentedPid>);
+static_assert(HasDiagnostics<Pid> == (INTPID_INSTRUMENT != 0));
+// With instrumentation off there is nothing left of it.
+static_assert(sizeof(InstrumentedPid) ==
+              sizeof(PidNoTelemetry) + sizeof(Diagnostics));
+static_assert(!HasDiagnostics<PidNoTelemetry>);
+
+constexpr Config kConfig = {
+    .kp = 2, .ki = .5, .kd = 1, .output_min = -10, .output_max = 10};
+
+TEST(Diagnostics, QuietInRange) {
+  auto pid = *InstrumentedPid::Create(kConfig);
+  pid.set_setpoint(1);
+  pid.Update(0, 0);
+  for (int t = 0; t < 100; ++t) pid.Update(t % 2 ? .5 : 1.5, 1);
+  const Diagnostics& d = pid.diagnostics();
+  EXPECT_EQ(d.saturations, 0);
+  EXPECT_EQ(d.anti_windup, 0);
+  EXPECT_EQ(d.overflows, 0);
+  EXPECT_EQ(d.underflows, 0);
+}
+
+TEST(Diagnostics, CountsSaturationAndAntiWindup) {
+  auto pid = *InstrumentedPid::Create(kConfig);
+  pid.set_setpoint(100);
+  pid.Update(0, 0);
+  for (int t = 0; t < 10; ++t) pid.Update(0, 1);
+  // kp * 100 alone is past the cutoff, so anti-windup holds the integrator
+  // on every update.
+  EXPECT_EQ(pid.diagnostics().saturations, 10);
+  EXPECT_EQ(pid.diagnostics().anti_windup, 10);
+  pid.ClearDiagnostics();
+  EXPECT_EQ(pid.diagnostics().saturations, 0);
+}
+
+TEST(Diagnostics, CountsIntegratorClamping) {
+  auto pid = *InstrumentedPIClamp::Create(
+      {.kp = 0, .ki = 1, .kd = 0, .output_min = -1, .output_max = 1});
+  pid.set_setpoint(.5);
+  for (int t = 0; t < 5; ++t) pid.Update(0, 1);
+  // .5, 1, then clamped from 1.5 on.
+  EXPECT_EQ(pid.diagnostics().anti_windup, 3);
+  EXPECT_EQ(pid.diagnostics().saturations, 0);
+}
+
+TEST(Diagnostics, CountsOverflows) {
+  auto pid = *InstrumentedPid::Create(
+      {.kp = 200, .ki = 0, .kd = 0, .output_min = -100, .output_max = 100});
+  pid.set_setpoint(0);
+  pid.Update(0, 0);
+  pid.Update(-100, 1);
+  EXPECT_EQ(pid.diagnostics().overflows, 0);
+  // 200 * 200 does not fit in SQ15x16 and wraps.
+  pid.Update(-200, 1);
+  EXPECT_GE(pid.diagnostics().overflows, 1);
+  // A measurement far enough away overflows the error itself.
+  pid.ClearDiagnostics();
+  pid.set_setpoint(20000);
+  pid.Update(-20000, 1);
+  EXPECT_GE(pid.diagnostics().overflows, 1);
+}
+
+TEST(Diagnostics, CountsUnderflows) {
+  // 2^-16 is the smallest step SQ15x16 has, so an integrator step of
+  // .1 * 1e-4 is lost entirely.
+  auto pid = *InstrumentedPid::Create(
+      {.kp = 1, .ki = 1e-4, .kd = 0, .output_min = -10, .output_max = 10});
+  pid.set_setpoint(.1);
+  pid.Update(0, 0);
+  for (int t = 0; t < 10; ++t) pid.Update(0, 1);
+  EXPECT_EQ(pid.diagnostics().underflows, 10);
+  EXPECT_EQ(pid.diagnostics().overflows, 0);
+  // A larger error is enough to integrate.
+  pid.ClearDiagnostics();
+  pid.set_setpoint(1);
+  pid.Update(0, 1);
+  EXPECT_EQ(pid.diagnostics().underflows, 0);
+  // A negative step floors to -1 LSB rather than vanishing.
+  pid.set_setpoint(-.1);
+  pid.Update(0, 1);
+  EXPECT_EQ(pid.diagnostics().underflows, 0);
+}
+
+TEST(Diagnostics, CountsUnderflowsInTheDerivativeFilter) {
+  // The filter gain is .5, so after the step the filtered D term halves
+  // towards 0 until half of its last LSB is lost, and it sticks there.
+  auto pid = *InstrumentedPid::Create({.kp = 1,
+                                       .ki = 0,
+                                       .kd = 1,
+                                       .output_min = -10,
+                                       .output_max = 10,
+                                       .derivative_filter = 1});
+  pid.set_setpoint(0);
+  pid.Update(0, 0);
+  for (int t = 0; t < 30; ++t) pid.Update(1, 1);
+  EXPECT_GE(pid.diagnostics().underflows, 10);
+  EXPECT_EQ(pid.diagnostics().overflows, 0);
+}
+
+TEST(Diagnostics, FloatCountsOnlySaturation) {
+  auto pid = *InstrumentedFloat::Create(
+      {.kp = 200, .ki = 1e-6, .kd = 0, .output_min = -100, .output_max = 100});
+  pid.set_setpoint(0);
+  pid.Update(0, 0);
+  pid.Update(-200, 1);
+  EXPECT_EQ(pid.diagnostics().saturations, 1);
+  EXPECT_EQ(pid.diagnostics().overflows, 0);
+  EXPECT_EQ(pid.diagnostics().underflows, 0);
+}
+
+// Instrumentation only watches; the outputs are the same.
+TEST(Diagnostics, DoesNotChangeTheOutput) {
+  auto instrumented = *InstrumentedPid::Create(kConfig);
+  auto plain = *PidNoTelemetry::Create(kConfig);
+  instrumented.set_setpoint(3);
+  plain.set_setpoint(3);
+  for (int t = 0; t < 200; ++t) {
+    const SQ15x16 m = (t * 37 % 200 - 100) / 4.f;
+    const SQ15x16 dt = t % 7;
+    ASSERT_EQ(instrumented.Update(m, dt).getInternal(),
+              plain.Update(m, dt).getInternal());
+  }
+  EXPECT_GT(instrumented.diagnostics().saturations, 0);
+}
+
+TEST(Diagnostics, ExportsTelemetryRecords) {
+  const Diagnostics d = {
+      .saturations = 3, .anti_windup = 2, .overflows = 1, .underflows = 40000};
+  const auto records = DiagnosticsRecords(d, 1234, 10);
+  ASSERT_EQ(records.size(), kDiagnosticsChannels);
+  EXPECT_EQ(records[0].channel, 10);
+  EXPECT_EQ(records[0].value(), 3);
+  EXPECT_EQ(records[1].channel, 11);
+  EXPECT_EQ(records[1].value(), 2);
+  EXPECT_EQ(records[2].value(), 1);
+  // Saturated at the largest count SQ15x16 holds.
+  EXPECT_EQ(records[3].channel, 13);
+  EXPECT_EQ(records[3].value(), 32767);
+  EXPECT_EQ(records[3].timestamp, 1234);
+}
+
+}  // namespace
+}  // namespace intpid
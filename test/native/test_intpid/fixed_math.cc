@@ -0,0 +1,41 @@
+#include "fixed_math.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+namespace intpid {
+namespace {
+
+TEST(RoundDiv, RoundsHalfAwayFromZero) {
+  EXPECT_EQ(RoundDiv(7, 2), 4);
+  EXPECT_EQ(RoundDiv(-7, 2), -4);
+  EXPECT_EQ(RoundDiv(5, 3), 2);
+  EXPECT_EQ(RoundDiv(-5, 3), -2);
+  EXPECT_EQ(RoundDiv(4, 3), 1);
+  EXPECT_EQ(RoundDiv(-4, 3), -1);
+  EXPECT_EQ(RoundDiv(0, 3), 0);
+}
+
+TEST(RoundShift, RoundsHalfUp) {
+  EXPECT_EQ(RoundShift(3, 1), 2);
+  EXPECT_EQ(RoundShift(-3, 1), -1);
+  EXPECT_EQ(RoundShift(0x17fff, 16), 1);
+  EXPECT_EQ(RoundShift(0x18000, 16), 2);
+  EXPECT_EQ(RoundShift(-0x18000, 16), -1);
+}
+
+TEST(ISqrt, Exact) {
+  EXPECT_EQ(ISqrt(0), 0);
+  EXPECT_EQ(ISqrt(1), 1);
+  EXPECT_EQ(ISqrt(15), 3);
+  EXPECT_EQ(ISqrt(16), 4);
+  EXPECT_EQ(ISqrt(uint64_t{1} << 62), uint32_t{1} << 31);
+  EXPECT_EQ(ISqrt(UINT64_MAX), UINT32_MAX);
+  EXPECT_EQ(ISqrt(uint64_t{123'456'789} * 123'456'789), 123'456'789u);
+  EXPECT_EQ(ISqrt(uint64_t{123'456'789} * 123'456'789 - 1), 123'456'788u);
+}
+
+}  // namespace
+}  // namespace intpid
@@ -0,0 +1,131 @@
+#include "gain_schedule.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cmath>
+
+#include "intpid.h"
+
+namespace intpid {
+namespace {
+
+constexpr std::array<Breakpoint, 3> kBreakpoints = {{
+    {.at = -10, .kp = 4, .ki = .5, .kd = 2},
+    {.at = 0, .kp = 2, .ki = .25, .kd = 1},
+    {.at = 30, .kp = 8, .ki = .25, .kd = 0},
+}};
+
+constexpr Config kConfig = {
+    .kp = 0, .ki = 0, .kd = 0, .output_min = -100, .output_max = 100};
+
+TEST(GainSchedule, RejectsUnsortedBreakpoints) {
+  std::array<Breakpoint, 3> breakpoints = kBreakpoints;
+  breakpoints[2].at = 0;
+  EXPECT_FALSE(GainSchedule<3>::Create(breakpoints).has_value());
+  breakpoints[2].at = -20;
+  EXPECT_FALSE(GainSchedule<3>::Create(breakpoints).has_value());
+}
+
+TEST(GainSchedule, HitsTheBreakpointsExactly) {
+  const auto schedule = *GainSchedule<3>::Create(kBreakpoints);
+  for (const Breakpoint& b : kBreakpoints) {
+    const Gains<SQ15x16> gains = schedule.Lookup(b.at);
+    EXPECT_EQ(gains.kp, SQ15x16(b.kp));
+    EXPECT_EQ(gains.ki, SQ15x16(b.ki));
+    EXPECT_EQ(gains.kd, SQ15x16(b.kd));
+  }
+}
+
+TEST(GainSchedule, InterpolatesBetweenBreakpoints) {
+  const auto schedule = *GainSchedule<3>::Create(kBreakpoints);
+  for (float x = -10; x <= 30; x += .37) {
+    const float kp = x < 0 ? 2 - .2 * x : 2 + .2 * x;
+    const float ki = x < 0 ? .25 - .025 * x : .25;
+    const float kd = x < 0 ? 1 - .1 * x : 1 - x / 30;
+    const Gains<SQ15x16> gains = schedule.Lookup(x);
+    EXPECT_NEAR(float{gains.kp}, kp, 1e-4) << x;
+    EXPECT_NEAR(float{gains.ki}, ki, 1e-4) << x;
+    EXPECT_NEAR(float{gains.kd}, kd, 1e-4) << x;
+  }
+}
+
+TEST(GainSchedule, HoldsTheEndsBeyondTheTable) {
+  const auto schedule = *GainSchedule<3>::Create(kBreakpoints);
+  EXPECT_EQ(schedule.Lookup(-1000).kp, 4);
+  EXPECT_EQ(schedule.Lookup(-10.5).kd, 2);
+  EXPECT_EQ(schedule.Lookup(31).kp, 8);
+  EXPECT_EQ(schedule.Lookup(30000).kd, 0);
+}
+
+// Interpolation keeps its precision across wide segments and tiny gains: the
+// position along a segment has 16 bits, so the error is within 2^-16 of the
+// change in the gain.
+TEST(GainSchedule, KeepsPrecisionOverWideSegments) {
+  const std::array<Breakpoint, 2> breakpoints = {{
+      {.at = -20000, .kp = 0, .ki = .001, .kd = 0},
+      {.at = 20000, .kp = 1000, .ki = .002, .kd = 0},
+  }};
+  const auto schedule = *GainSchedule<2>::Create(breakpoints);
+  const Gains<SQ15x16> gains = schedule.Lookup(10000);
+  EXPECT_NEAR(float{gains.kp}, 750, 1000. / (1 << 16));
+  EXPECT_NEAR(float{gains.ki}, .00175, 2e-5);
+}
+
+TEST(ScheduledPid, OneBreakpointMatchesAPlainPid) {
+  const std::array<Breakpoint, 1> breakpoints = {
+      {{.at = 0, .kp = 2, .ki = .5, .kd = 1}}};
+  auto scheduled = *ScheduledPid<1>::Create(kConfig, breakpoints);
+  Config config = kConfig;
+  config.kp = 2;
+  config.ki = .5;
+  config.kd = 1;
+  auto pid = *Pid::Create(config);
+  scheduled.set_setpoint(5);
+  pid.set_setpoint(5);
+  scheduled.Update(0, 0, 0);
+  pid.Update(0, 0);
+  for (int t = 0; t < 100; ++t) {
+    const SQ15x16 m = std::sin(t * .1) * 20;
+    ASSERT_EQ(scheduled.Update(m, 1, t).getInternal(),
+              pid.Update(m, 1).getInternal());
+  }
+}
+
+TEST(ScheduledPid, GainChangesAreBumpless) {
+  // A step in kp from 1 to 10 at a scheduling variable of 0.
+  const std::array<Breakpoint, 2> breakpoints = {{
+      {.at = -.01, .kp = 1, .ki = .1, .kd = 0},
+      {.at = 0, .kp = 10, .ki = .1, .kd = 0},
+  }};
+  auto pid = *ScheduledPid<2>::Create(kConfig, breakpoints);
+  pid.set_setpoint(4);
+  pid.Update(0, 0, -1);
+  SQ15x16 before = 0;
+  for (int t = 0; t < 10; ++t) before = pid.Update(1, 1, -1);
+  // Only the integrator's step for this update, .1 * 3, may separate the
+  // outputs.
+  const SQ15x16 after = pid.Update(1, 1, 1);
+  EXPECT_NEAR(float{after - before}, .3, 1e-3);
+  EXPECT_EQ(pid.pid().gains().kp, 10);
+  // From here the new gains act on changes in the error as usual.
+  EXPECT_NEAR(float{pid.Update(2, 1, 1) - after}, -10 + .2, 1e-3);
+}
+
+TEST(ScheduledPid, RestartReplacesTheGains) {
+  auto pid = *ScheduledPid<3>::Create(kConfig, kBreakpoints);
+  pid.set_setpoint(1);
+  pid.Update(0, 0, 30);
+  // No integrator left over from the move from breakpoint 0's gains.
+  EXPECT_EQ(pid.Update(0, 1, 30), 8 + .25);
+}
+
+TEST(ScheduledPid, RejectsAnInvalidConfig) {
+  Config config = kConfig;
+  config.derivative_filter = -1;
+  EXPECT_FALSE(ScheduledPid<3>::Create(config, kBreakpoints).has_value());
+}
+
+}  // namespace
+}  // namespace intpid
@@ -0,0 +1,76 @@
+#include "pid_bank.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "intpid.h"
+
+namespace intpid {
+namespace {
+
+constexpr size_t kLoops = 4;
+
+std::array<Config, kLoops> TestConfigs() {
+  return {{
+      {.kp = 15., .ki = .002, .kd = 75, .output_min = 0, .output_max = 100},
+      {.kp = 2, .ki = .5, .kd = 0, .output_min = -255, .output_max = 255},
+      {.kp = .5,
+       .ki = .1,
+       .kd = 3,
+       .output_min = -1000,
+       .output_max = 1000,
+       .p_setpoint_weight = .5,
+       .d_setpoint_weight = 1},
+      {.kp = 40,
+       .ki = 1,
+       .kd = 10,
+       .output_min = -50,
+       .output_max = 50,
+       .derivative_filter = 8},
+  }};
+}
+
+// The bank must produce bit-identical outputs to independent controllers,
+// including through saturation, anti-windup, setpoint weights, the derivative
+// filter and dt <= 0 resets.
+TEST(PidBank, MatchesIndependentPids) {
+  const auto configs = TestConfigs();
+  auto bank = *PidBank<kLoops>::Create(configs);
+  std::vector<Pid> pids;
+  for (const Config& config : configs) pids.push_back(*Pid::Create(config));
+
+  std::mt19937 rng(1234);
+  std::uniform_real_distribution<float> measurement_dist(-200, 200);
+  std::uniform_int_distribution<int> dt_dist(-1, 20);
+
+  for (int tick = 0; tick < 10'000; ++tick) {
+    std::array<SQ15x16, kLoops> measurements, dts, outputs;
+    for (size_t i = 0; i < kLoops; ++i) {
+      if (tick % 500 == 0) {
+        const SQ15x16 setpoint = measurement_dist(rng);
+        bank.set_setpoint(i, setpoint);
+        pids[i].set_setpoint(setpoint);
+      }
+      measurements[i] = measurement_dist(rng);
+      dts[i] = dt_dist(rng);
+    }
+    bank.Update(measurements, dts, outputs);
+    for (size_t i = 0; i < kLoops; ++i) {
+      ASSERT_EQ(outputs[i].getInternal(),
+                pids[i].Update(measurements[i], dts[i]).getInternal())
+          << "tick " << tick << " loop " << i;
+    }
+  }
+}
+
+TEST(PidBank, RejectsAnInvalidConfig) {
+  auto configs = TestConfigs();
+  configs[2].derivative_filter = -1;
+  EXPECT_FALSE(PidBank<kLoops>::Create(configs).has_value());
+}
+
+}  // namespace
+}  // namespace intpid
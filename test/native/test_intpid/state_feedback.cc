@@ -0,0 +1,67 @@
+#include "state_feedback.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <array>
+#include <random>
+
+namespace intpid {
+namespace {
+
+constexpr StateFeedbackConfig<4> kConfig = {
+    .gains = {{{-16.63, -1.748, -0.0939, -0.3564}}},
+    .output_min = -255,
+    .output_max = 255,
+};
+
+TEST(StateFeedback, MatchesTheProductInDouble) {
+  const auto controller = *StateFeedback<4>::Create(kConfig);
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<float> dist(-10, 10);
+  for (int i = 0; i < 1000; ++i) {
+    std::array<SQ15x16, 4> state;
+    double expected = 0;
+    for (int j = 0; j < 4; ++j) {
+      state[j] = dist(rng);
+      expected -= kConfig.gains[0][j] * double{state[j]};
+    }
+    // Only the gains are quantized, to within 2^-16 each.
+    double bound = 1. / (1 << 16);
+    for (const SQ15x16 x : state) bound += std::abs(double{x}) / (1 << 16);
+    ASSERT_NEAR(double{controller.Update(state)}, expected, bound);
+  }
+}
+
+TEST(StateFeedback, Saturates) {
+  const auto controller = *StateFeedback<4>::Create(kConfig);
+  EXPECT_EQ(controller.Update(std::array<SQ15x16, 4>{30, 0, 0, 0}), 255);
+  EXPECT_EQ(controller.Update(std::array<SQ15x16, 4>{-30, 0, 0, 0}), -255);
+  // Terms far past the limits still sum without overflowing.
+  EXPECT_EQ(controller.Update(std::array<SQ15x16, 4>{30000, 30000, 30000,
+                                                     30000}),
+            255);
+}
+
+TEST(StateFeedback, DrivesSeveralInputs) {
+  const StateFeedbackConfig<2, 2> config = {
+      .gains = {{{1, 2}, {-3, 0.5}}}, .output_min = -100, .output_max = 100};
+  const auto controller = *StateFeedback<2, 2>::Create(config);
+  std::array<SQ15x16, 2> outputs;
+  controller.Update(std::array<SQ15x16, 2>{2, -1}, outputs);
+  EXPECT_EQ(outputs[0], 0);
+  EXPECT_EQ(outputs[1], 6.5);
+}
+
+TEST(StateFeedback, RejectsGainsOutsideSQ15x16) {
+  StateFeedbackConfig<4> config = kConfig;
+  config.gains[0][2] = 40000;
+  EXPECT_FALSE(StateFeedback<4>::Create(config).has_value());
+  config.gains[0][2] = 1e-6;
+  EXPECT_FALSE(StateFeedback<4>::Create(config).has_value());
+  config.gains[0][2] = 0;
+  EXPECT_TRUE(StateFeedback<4>::Create(config).has_value());
+}
+
+}  // namespace
+}  // namespace intpid
@@ -0,0 +1,80 @@
+#include "double_buffer.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+#include <thread>
+
+namespace motor {
+namespace {
+
+TEST(DoubleBuffer, EmptyUntilPublished) {
+  DoubleBuffer<int> buffer;
+  int value = 7;
+  EXPECT_EQ(buffer.Read(value), 0);
+  EXPECT_EQ(value, 7);
+  buffer.Publish(1);
+  buffer.Publish(2);
+  EXPECT_EQ(buffer.Read(value), 2);
+  EXPECT_EQ(value, 2);
+}
+
+// A value whose halves must always match. A torn read would break that.
+struct Pair {
+  uint64_t a;
+  uint64_t b;
+};
+
+TEST(DoubleBuffer, ReaderNeverSeesTornValue) {
+  constexpr uint64_t kCount = 1'000'000;
+  DoubleBuffer<Pair> buffer;
+  std::atomic<bool> done = false;
+  std::thread writer([&] {
+    for (uint64_t i = 1; i <= kCount; ++i) buffer.Publish({i, ~i});
+    done = true;
+  });
+
+  uint32_t last = 0;
+  int reads = 0;
+  while (!done || last != kCount) {
+    Pair pair;
+    const uint32_t sequence = buffer.Read(pair);
+    if (sequence == 0) continue;
+    ASSERT_EQ(pair.b, ~pair.a);
+    ASSERT_EQ(pair.a, sequence);
+    ASSERT_GE(sequence, last);
+    last = sequence;
+    ++reads;
+  }
+  writer.join();
+  EXPECT_GT(reads, 0);
+}
+
+// A value big enough that the writer laps a reader partway through copying
+// it, so the reader has to notice and retry.
+TEST(DoubleBuffer, ReaderRetriesWhenLapped) {
+  constexpr uint64_t kCount = 200'000;
+  DoubleBuffer<std::array<uint64_t, 256>> buffer;
+  std::atomic<bool> done = false;
+  std::thread writer([&] {
+    std::array<uint64_t, 256> value;
+    for (uint64_t i = 1; i <= kCount; ++i) {
+      value.fill(i);
+      buffer.Publish(value);
+    }
+    done = true;
+  });
+
+  while (!done) {
+    std::array<uint64_t, 256> value;
+    const uint32_t sequence = buffer.Read(value);
+    if (sequence == 0) continue;
+    for (const uint64_t word : value) ASSERT_EQ(word, sequence);
+  }
+  writer.join();
+}
+
+}  // namespace
+}  // namespace motor
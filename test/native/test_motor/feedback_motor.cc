@@ -0,0 +1,234 @@
+#include "feedback_motor.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <optional>
+#include <vector>
+
+namespace motor {
+namespace {
+
+class FakeMotor : public Motor {
+ public:
+  void Stop(StopMode mode) override {
+    stopped = true;
+    effort = 0;
+  }
+  void SetDirection(Direction direction) override {}
+  void SetDuty(int duty) override {}
+  void SetEffort(int e) override {
+    stopped = false;
+    effort = e;
+    ++efforts;
+  }
+
+  bool stopped = false;
+  int effort = 0;
+  int efforts = 0;
+};
+
+class FakeSensor : public Sensor {
+ public:
+  SQ15x16 angle() override { return angle_; }
+  SQ15x16 rate() override { return rate_; }
+  void SetAngle(SQ15x16 angle) override { angle_ = angle; }
+
+  SQ15x16 angle_ = 0;
+  SQ15x16 rate_ = 0;
+};
+
+// A motor whose speed in degrees/sec is proportional to the effort.
+constexpr float kDegreesPerSecPerEffort = 4;
+constexpr float kDtMs = 2;
+
+FeedbackConfig TestConfig() {
+  return FeedbackConfig{
+      .velocity = {.kp = 0.05,
+                   .ki = 0.02,
+                   .kd = 0,
+                   .output_min = -255,
+                   .output_max = 255},
+      .position = {.kp = 4,
+                   .ki = 0,
+                   .kd = 0,
+                   .output_min = -360,
+                   .output_max = 360},
+      .position_divider = 5,
+  };
+}
+
+class FeedbackMotorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    auto fm = FeedbackMotor::Create(&motor_, &sensor_, TestConfig());
+    ASSERT_TRUE(fm.has_value()) << fm.error();
+    feedback_motor_.emplace(*std::move(fm));
+  }
+
+  // Runs the controller and the simulated motor for n steps.
+  void Step(int n) {
+    for (int i = 0; i < n; ++i) {
+      feedback_motor_->Update(kDtMs);
+      sensor_.rate_ = motor_.effort * kDegreesPerSecPerEffort;
+      sensor_.angle_ += sensor_.rate_ * SQ15x16{kDtMs / 1000};
+    }
+  }
+
+  FakeMotor motor_;
+  FakeSensor sensor_;
+  std::optional<FeedbackMotor> feedback_motor_;
+};
+
+TEST(FeedbackMotorCreate, RejectsBadArguments) {
+  FakeMotor motor;
+  FakeSensor sensor;
+  EXPECT_FALSE(FeedbackMotor::Create(nullptr, &sensor, TestConfig()));
+  EXPECT_FALSE(FeedbackMotor::Create(&motor, nullptr, TestConfig()));
+  FeedbackConfig config = TestConfig();
+  config.position_divider = 0;
+  EXPECT_EQ(FeedbackMotor::Create(&motor, &sensor, config).error(),
+            ErrorMessage(Error::kBadPositionDivider));
+}
+
+TEST(FeedbackMotorCreate, NamesTheLoopItRejects) {
+  FakeMotor motor;
+  FakeSensor sensor;
+  FeedbackConfig config = TestConfig();
+  config.position.derivative_filter = -1;
+  EXPECT_EQ(FeedbackMotor::Create(&motor, &sensor, config).error(),
+            "bad position loop config: derivative_filter must not be negative");
+}
+
+TEST_F(FeedbackMotorTest, StoppedDoesNothing) {
+  EXPECT_EQ(feedback_motor_->mode(), FeedbackMotor::kStopped);
+  Step(10);
+  EXPECT_EQ(motor_.efforts, 0);
+}
+
+TEST_F(FeedbackMotorTest, HoldsSpeed) {
+  feedback_motor_->SetTargetSpeed(200);
+  Step(500);
+  EXPECT_EQ(feedback_motor_->mode(), FeedbackMotor::kSpeed);
+  EXPECT_NEAR(float{sensor_.rate_}, 200, 4);
+  EXPECT_GT(motor_.effort, 0);
+}
+
+TEST_F(FeedbackMotorTest, HoldsNegativeSpeed) {
+  feedback_motor_->SetTargetSpeed(-200);
+  Step(500);
+  EXPECT_NEAR(float{sensor_.rate_}, -200, 4);
+  EXPECT_LT(motor_.effort, 0);
+}
+
+TEST_F(FeedbackMotorTest, MovesToPosition) {
+  sensor_.angle_ = 10;
+  feedback_motor_->SetTargetPosition(100);
+  Step(1000);
+  EXPECT_EQ(feedback_motor_->mode(), FeedbackMotor::kPosition);
+  EXPECT_NEAR(float{sensor_.angle_}, 100, 1);
+  EXPECT_NEAR(float{feedback_motor_->target_speed()}, 0, 4);
+
+  feedback_motor_->SetTargetPosition(-50);
+  Step(1000);
+  EXPECT_NEAR(float{sensor_.angle_}, -50, 1);
+}
+
+TEST_F(FeedbackMotorTest, PositionLoopRunsAtDividedRate) {
+  // Close enough that the outer loop does not saturate.
+  feedback_motor_->SetTargetPosition(10);
+  // The outer loop runs on the first update after a new target, then once
+  // every position_divider updates.
+  std::vector<float> targets;
+  for (int i = 0; i < 11; ++i) {
+    Step(1);
+    targets.push_back(float{feedback_motor_->target_speed()});
+  }
+  for (int i = 1; i < 11; ++i) {
+    if (i % 5 == 0) {
+      EXPECT_NE(targets[i], targets[i - 1]) << i;
+    } else {
+      EXPECT_EQ(targets[i], targets[i - 1]) << i;
+    }
+  }
+  EXPECT_EQ(motor_.efforts, 11);
+}
+
+TEST_F(FeedbackMotorTest, StopStopsTheMotor) {
+  feedback_motor_->SetTargetSpeed(100);
+  Step(10);
+  feedback_motor_->Stop(kBrake);
+  EXPECT_TRUE(motor_.stopped);
+  EXPECT_EQ(feedback_motor_->effort(), 0);
+  const int efforts = motor_.efforts;
+  Step(10);
+  EXPECT_EQ(motor_.efforts, efforts);
+}
+
+// With a position kd, a loop that kept its derivative history would see the
+// whole angle as a jump in the error on its first update.
+TEST_F(FeedbackMotorTest, PositionTargetAtTheCurrentAngleHolds) {
+  FeedbackConfig config = TestConfig();
+  config.position.kd = 0.5;
+  auto fm = *FeedbackMotor::Create(&motor_, &sensor_, config);
+  sensor_.angle_ = 1000;
+  fm.SetTargetPosition(1000);
+  fm.Update(kDtMs);
+  EXPECT_NEAR(float{fm.target_speed()}, 0, 1);
+  EXPECT_EQ(fm.effort(), 0);
+}
+
+// The integrator wound up against a stalled wheel does not outlive Stop.
+TEST_F(FeedbackMotorTest, ResumesWithoutTheOldIntegrator) {
+  feedback_motor_->SetTargetSpeed(200);
+  for (int i = 0; i < 500; ++i) feedback_motor_->Update(kDtMs);
+  EXPECT_EQ(motor_.effort, 255);
+  feedback_motor_->Stop(kBrake);
+  feedback_motor_->SetTargetSpeed(0);
+  feedback_motor_->Update(kDtMs);
+  EXPECT_EQ(feedback_motor_->effort(), 0);
+}
+
+// A motor and sensor with no virtual functions, as a board's concrete drivers
+// would be bound at compile time.
+struct StaticMotor {
+  void SetEffort(int e) { effort = e; }
+  void Stop(StopMode) { effort = 0; }
+  int effort = 0;
+};
+
+struct StaticSensor {
+  SQ15x16 angle() const { return angle_; }
+  SQ15x16 rate() const { return rate_; }
+  SQ15x16 angle_ = 0;
+  SQ15x16 rate_ = 0;
+};
+
+static_assert(MotorLike<StaticMotor> && MotorLike<Motor>);
+static_assert(SensorLike<StaticSensor> && SensorLike<Sensor>);
+static_assert(!MotorLike<StaticSensor> && !SensorLike<StaticMotor>);
+
+TEST_F(FeedbackMotorTest, StaticBindingMatchesVirtual) {
+  StaticMotor motor;
+  StaticSensor sensor;
+  auto fm = BasicFeedbackMotor<StaticMotor, StaticSensor>::Create(
+      &motor, &sensor, TestConfig());
+  ASSERT_TRUE(fm.has_value()) << fm.error();
+  EXPECT_FALSE((BasicFeedbackMotor<StaticMotor, StaticSensor>::Create(
+      nullptr, &sensor, TestConfig())));
+
+  sensor.angle_ = sensor_.angle_ = 10;
+  fm->SetTargetPosition(100);
+  feedback_motor_->SetTargetPosition(100);
+  for (int i = 0; i < 300; ++i) {
+    fm->Update(kDtMs);
+    sensor.rate_ = motor.effort * kDegreesPerSecPerEffort;
+    sensor.angle_ += sensor.rate_ * SQ15x16{kDtMs / 1000};
+    Step(1);
+    ASSERT_EQ(motor.effort, motor_.effort) << i;
+  }
+  EXPECT_EQ(sensor.angle_, sensor_.angle_);
+}
+
+}  // namespace
+}  // namespace motor
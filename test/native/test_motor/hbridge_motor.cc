@@ -0,0 +1,183 @@
+#include "hbridge_motor.h"
+
+#include <Arduino.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <climits>
+#include <cmath>
+#include <vector>
+
+#include "hosthal.h"
+#include "three_wire_motor.h"
+
+namespace motor {
+namespace {
+
+constexpr int kPwm = 0;
+constexpr int kForward = 1;
+constexpr int kReverse = 8;
+constexpr int kChannel = 2;
+constexpr uint32_t kForwardBit = 1 << kForward;
+constexpr uint32_t kReverseBit = 1 << kReverse;
+
+class HBridgeMotorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    hosthal::Reset();
+    ASSERT_TRUE(motor_.Begin());
+  }
+
+  static uint32_t inputs() {
+    return hosthal::Registers().gpio_out & (kForwardBit | kReverseBit);
+  }
+  static uint32_t duty() { return hosthal::Registers().ledc_duty[kChannel]; }
+
+  // Register writes made by fn.
+  template <typename Fn>
+  static int WritesBy(Fn&& fn) {
+    const int before = hosthal::TotalRegisterWrites();
+    fn();
+    return hosthal::TotalRegisterWrites() - before;
+  }
+
+  HBridgeMotor motor_{{.pwm = kPwm,
+                       .forward = kForward,
+                       .reverse = kReverse,
+                       .channel = kChannel},
+                      20'000,
+                      8};
+};
+
+TEST_F(HBridgeMotorTest, BeginCoasts) {
+  EXPECT_EQ(hosthal::Pin(kForward).mode, OUTPUT);
+  EXPECT_EQ(hosthal::Pin(kReverse).mode, OUTPUT);
+  EXPECT_EQ(hosthal::Registers().ledc_pin[kChannel], kPwm);
+  EXPECT_EQ(hosthal::Registers().ledc_frequency_hz[kChannel], 20'000);
+  EXPECT_EQ(hosthal::Registers().ledc_resolution_bits[kChannel], 8);
+  EXPECT_EQ(inputs(), 0);
+  EXPECT_EQ(duty(), 0);
+}
+
+TEST_F(HBridgeMotorTest, RejectsABadChannel) {
+  HBridgeMotor motor({.pwm = kPwm,
+                      .forward = kForward,
+                      .reverse = kReverse,
+                      .channel = hosthal::kNumLedcChannels});
+  EXPECT_FALSE(motor.Begin());
+}
+
+TEST_F(HBridgeMotorTest, EffortSetsDirectionAndDuty) {
+  motor_.SetEffort(100);
+  EXPECT_EQ(inputs(), kForwardBit);
+  EXPECT_EQ(duty(), 100);
+  motor_.SetEffort(-60);
+  EXPECT_EQ(inputs(), kReverseBit);
+  EXPECT_EQ(duty(), 60);
+}
+
+TEST_F(HBridgeMotorTest, EffortSaturatesAtFullScale) {
+  EXPECT_EQ(motor_.full_scale(), 256);
+  motor_.SetEffort(-1000);
+  EXPECT_EQ(duty(), 256);
+  motor_.SetEffort(INT_MIN);
+  EXPECT_EQ(duty(), 256);
+  motor_.SetEffort(100'000);
+  EXPECT_EQ(inputs(), kForwardBit);
+  EXPECT_EQ(duty(), 256);
+}
+
+TEST_F(HBridgeMotorTest, SkipsWritesThatChangeNothing) {
+  motor_.SetEffort(10);
+  // Holding a direction is one duty write; holding the duty is none.
+  EXPECT_EQ(WritesBy([&] { motor_.SetEffort(20); }), 1);
+  EXPECT_EQ(WritesBy([&] { motor_.SetEffort(20); }), 0);
+  // Zero keeps the direction.
+  EXPECT_EQ(WritesBy([&] { motor_.SetEffort(0); }), 1);
+  EXPECT_EQ(inputs(), kForwardBit);
+  // A reversal: release, duty, engage.
+  EXPECT_EQ(WritesBy([&] { motor_.SetEffort(-20); }), 3);
+}
+
+struct BridgeState {
+  uint32_t inputs, duty;
+};
+std::vector<BridgeState> bridge_states;
+
+TEST_F(HBridgeMotorTest, ReversalNeverDrivesTheOldDuty) {
+  motor_.SetEffort(200);
+  bridge_states.clear();
+  hosthal::Registers().on_write = [](const hosthal::RegisterFile&) {
+    bridge_states.push_back({inputs(), duty()});
+  };
+  motor_.SetEffort(-30);
+  hosthal::Registers().on_write = nullptr;
+  // Coast, then the new duty while still coasting, then the new direction.
+  ASSERT_EQ(bridge_states.size(), 3);
+  EXPECT_EQ(bridge_states[0].inputs, 0);
+  EXPECT_EQ(bridge_states[0].duty, 200);
+  EXPECT_EQ(bridge_states[1].inputs, 0);
+  EXPECT_EQ(bridge_states[1].duty, 30);
+  EXPECT_EQ(bridge_states[2].inputs, kReverseBit);
+  EXPECT_EQ(bridge_states[2].duty, 30);
+}
+
+TEST_F(HBridgeMotorTest, StopBrakesAndCoasts) {
+  motor_.SetEffort(50);
+  motor_.Stop(kBrake);
+  EXPECT_EQ(inputs(), kForwardBit | kReverseBit);
+  EXPECT_EQ(duty(), 0);
+  motor_.SetEffort(-50);
+  EXPECT_EQ(inputs(), kReverseBit);
+  EXPECT_EQ(duty(), 50);
+  motor_.Stop(kCoast);
+  EXPECT_EQ(inputs(), 0);
+  EXPECT_EQ(duty(), 0);
+}
+
+TEST_F(HBridgeMotorTest, MotorInterfaceStillWorks) {
+  Motor& motor = motor_;
+  motor.SetDirection(kCounterClockwise);
+  motor.SetDuty(128);
+  EXPECT_EQ(inputs(), kReverseBit);
+  EXPECT_EQ(duty(), 128);
+  motor.SetEffort(40);
+  EXPECT_EQ(inputs(), kForwardBit);
+  EXPECT_EQ(duty(), 40);
+  motor.SetDuty(1000);
+  EXPECT_EQ(duty(), 256);
+  motor.Stop();
+  EXPECT_EQ(inputs(), 0);
+}
+
+TEST_F(HBridgeMotorTest, UsesNoArduinoWritesAfterBegin) {
+  const int pin_writes = hosthal::TotalPinWrites();
+  for (int effort = -200; effort <= 200; effort += 7) {
+    motor_.SetEffort(effort);
+  }
+  motor_.Stop(kBrake);
+  EXPECT_EQ(hosthal::TotalPinWrites(), pin_writes);
+}
+
+// The same efforts through ThreeWireMotor and HBridgeMotor, as a control
+// loop would issue them: a slow sine, so most ticks repeat the last effort,
+// with reversals.
+TEST_F(HBridgeMotorTest, WritesLessThanThreeWireMotor) {
+  ThreeWireMotor three_wire(kPwm, kForward, kReverse);
+  three_wire.Begin();
+  int three_wire_writes = 0, hbridge_writes = 0;
+  for (int i = 0; i < 1000; ++i) {
+    const int effort = static_cast<int>(20 * std::sin(i * 0.02));
+    const int pin_writes = hosthal::TotalPinWrites();
+    three_wire.SetEffort(effort);
+    three_wire_writes += hosthal::TotalPinWrites() - pin_writes;
+    hbridge_writes +=
+        WritesBy([&] { motor_.SetEffort(effort); });
+  }
+  // ThreeWireMotor writes the duty on every tick.
+  EXPECT_GE(three_wire_writes, 1000);
+  EXPECT_LT(hbridge_writes, three_wire_writes / 3);
+}
+
+}  // namespace
+}  // namespace motor
@@ -0,0 +1,145 @@
+#include "mlx90393_acquisition.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "hosthal.h"
+#include "mlx90393_sensor.h"
+
+namespace motor {
+namespace {
+
+constexpr int kDrdy = 6;
+
+class MLX90393AcquisitionTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    hosthal::Reset();
+    acquisition_.Begin(kDrdy);
+  }
+
+  // The sensor's INT pin pulses when a conversion completes.
+  void DataReady() {
+    hosthal::SetInput(kDrdy, HIGH);
+    hosthal::SetInput(kDrdy, LOW);
+  }
+
+  // Queues a field sample whose X component identifies it.
+  void Queue(int id) { fake_.PushSample(id, 1); }
+
+  Adafruit_MLX90393 fake_;
+  MLX90393Acquisition acquisition_{&fake_};
+};
+
+TEST_F(MLX90393AcquisitionTest, NothingWithoutInterrupt) {
+  Queue(1);
+  FieldSample sample;
+  EXPECT_FALSE(acquisition_.Service());
+  EXPECT_FALSE(acquisition_.TryConsume(sample));
+  EXPECT_EQ(fake_.reads(), 0);
+}
+
+TEST_F(MLX90393AcquisitionTest, EverySampleReadAndConsumedOnce) {
+  for (int i = 1; i <= 100; ++i) Queue(i);
+  for (int i = 1; i <= 100; ++i) {
+    hosthal::AdvanceMicros(1000);
+    DataReady();
+    ASSERT_TRUE(acquisition_.Service());
+    EXPECT_FALSE(acquisition_.Service());  // No second read per interrupt.
+
+    FieldSample sample;
+    ASSERT_TRUE(acquisition_.TryConsume(sample));
+    EXPECT_EQ(sample.sequence, i);
+    EXPECT_EQ(sample.field[0], i);
+    EXPECT_FALSE(acquisition_.TryConsume(sample));  // Not consumed twice.
+  }
+  EXPECT_EQ(acquisition_.interrupts(), 100);
+  EXPECT_EQ(fake_.reads(), 100);
+  EXPECT_EQ(acquisition_.missed_conversions(), 0);
+  EXPECT_EQ(acquisition_.skipped(), 0);
+}
+
+TEST_F(MLX90393AcquisitionTest, TimestampIsInterruptTime) {
+  fake_.set_read_duration_us(300);
+  Queue(1);
+  hosthal::SetMicros(1000);
+  DataReady();
+  hosthal::AdvanceMicros(50);  // Task wake-up latency.
+  ASSERT_TRUE(acquisition_.Service());
+  FieldSample sample;
+  ASSERT_TRUE(acquisition_.TryConsume(sample));
+  EXPECT_EQ(sample.timestamp_us, 1000);
+  EXPECT_EQ(hosthal::Micros(), 1350);
+}
+
+TEST_F(MLX90393AcquisitionTest, CountsMissedConversions) {
+  Queue(1);
+  Queue(2);
+  DataReady();
+  DataReady();
+  ASSERT_TRUE(acquisition_.Service());
+  EXPECT_EQ(acquisition_.missed_conversions(), 1);
+  EXPECT_EQ(fake_.reads(), 1);
+}
+
+TEST_F(MLX90393AcquisitionTest, SlowConsumerGetsLatest) {
+  for (int i = 1; i <= 3; ++i) {
+    Queue(i);
+    DataReady();
+    ASSERT_TRUE(acquisition_.Service());
+  }
+  FieldSample sample;
+  ASSERT_TRUE(acquisition_.TryConsume(sample));
+  EXPECT_EQ(sample.field[0], 3);
+  EXPECT_EQ(acquisition_.skipped(), 2);
+  EXPECT_EQ(acquisition_.missed_conversions(), 0);
+}
+
+TEST_F(MLX90393AcquisitionTest, ReadFailureIsNotPublished) {
+  fake_.PushFailure();
+  Queue(2);
+  DataReady();
+  EXPECT_FALSE(acquisition_.Service());
+  EXPECT_EQ(acquisition_.read_failures(), 1);
+  FieldSample sample;
+  EXPECT_FALSE(acquisition_.TryConsume(sample));
+
+  DataReady();
+  ASSERT_TRUE(acquisition_.Service());
+  ASSERT_TRUE(acquisition_.TryConsume(sample));
+  EXPECT_EQ(sample.field[0], 2);
+  EXPECT_EQ(sample.sequence, 1);
+}
+
+TEST_F(MLX90393AcquisitionTest, OnlyRisingEdges) {
+  Queue(1);
+  hosthal::SetInput(kDrdy, HIGH);
+  hosthal::SetInput(kDrdy, HIGH);
+  hosthal::SetInput(kDrdy, LOW);
+  EXPECT_EQ(acquisition_.interrupts(), 1);
+}
+
+// With interrupt timestamps, the rate is right even if Update runs late.
+TEST_F(MLX90393AcquisitionTest, SensorUsesConversionTime) {
+  MLX90393Sensor sensor(&acquisition_);
+  for (int a = 0; a <= 40; a += 2) {
+    const double radians = a * PI / 180;
+    fake_.PushSample(400 * cos(radians), 400 * sin(radians));
+  }
+  for (int i = 0; i <= 20; ++i) {
+    hosthal::SetMicros(i * 10'000);
+    DataReady();
+    ASSERT_TRUE(acquisition_.Service());
+    // Jitter between the conversion and the control loop.
+    hosthal::AdvanceMicros(i % 3 * 1'500);
+    ASSERT_TRUE(sensor.Update());
+    EXPECT_FALSE(sensor.Update());
+    if (i > 0) {
+      EXPECT_NEAR(float{sensor.rate()}, 200, 1) << i;
+    }
+  }
+  EXPECT_NEAR(float{sensor.angle()}, 40, 1e-2);
+}
+
+}  // namespace
+}  // namespace motor
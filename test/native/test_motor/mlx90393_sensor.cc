@@ -0,0 +1,100 @@
+#include "mlx90393_sensor.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "hosthal.h"
+
+namespace motor {
+namespace {
+
+// Places the field vector at the given angle (in degrees) on a circle of a
+// typical magnitude for the sensor.
+void PushAngle(Adafruit_MLX90393& fake, double degrees) {
+  constexpr double kMagnitude = 400;
+  const double radians = degrees * PI / 180;
+  fake.PushSample(kMagnitude * cos(radians), kMagnitude * sin(radians));
+}
+
+class MLX90393SensorTest : public ::testing::Test {
+ protected:
+  void SetUp() override { hosthal::Reset(); }
+
+  Adafruit_MLX90393 fake_;
+};
+
+TEST(VectorToAngleDecidegrees, Axes) {
+  EXPECT_EQ(VectorToAngleDecidegrees(0, 0), 0);
+  EXPECT_EQ(VectorToAngleDecidegrees(1, 0), 0);
+  EXPECT_EQ(VectorToAngleDecidegrees(0, 1), 90);
+  EXPECT_NEAR(float{VectorToAngleDecidegrees(-1, 0)}, 180, 1e-3);
+  EXPECT_EQ(VectorToAngleDecidegrees(0, -1), 270);
+}
+
+TEST(VectorToAngleDecidegrees, Quadrants) {
+  EXPECT_NEAR(float{VectorToAngleDecidegrees(1, 1)}, 45, 1e-3);
+  EXPECT_NEAR(float{VectorToAngleDecidegrees(-1, 1)}, 135, 1e-3);
+  EXPECT_NEAR(float{VectorToAngleDecidegrees(-1, -1)}, 225, 1e-3);
+  EXPECT_NEAR(float{VectorToAngleDecidegrees(1, -1)}, 315, 1e-3);
+}
+
+TEST_F(MLX90393SensorTest, FailedReadLeavesStateAlone) {
+  MLX90393Sensor sensor(&fake_);
+  PushAngle(fake_, 30);
+  fake_.PushFailure();
+  ASSERT_TRUE(sensor.Update());
+  EXPECT_FALSE(sensor.Update());
+  EXPECT_NEAR(float{sensor.angle()}, 30, 1e-2);
+  EXPECT_EQ(fake_.reads(), 2);
+  EXPECT_FALSE(sensor.Update());  // Queue exhausted.
+}
+
+TEST_F(MLX90393SensorTest, AccumulatesAcrossWrap) {
+  MLX90393Sensor sensor(&fake_);
+  // Two full turns clockwise in 30 degree steps, then back one turn.
+  for (int a = 0; a <= 720; a += 30) PushAngle(fake_, a % 360);
+  for (int a = 690; a >= 360; a -= 30) PushAngle(fake_, a % 360);
+  while (fake_.pending() > 0) {
+    hosthal::AdvanceMicros(1000);
+    ASSERT_TRUE(sensor.Update());
+  }
+  EXPECT_NEAR(float{sensor.angle()}, 360, 1e-1);
+}
+
+TEST_F(MLX90393SensorTest, SetAngleRebases) {
+  MLX90393Sensor sensor(&fake_);
+  PushAngle(fake_, 10);
+  PushAngle(fake_, 20);
+  ASSERT_TRUE(sensor.Update());
+  sensor.SetAngle(100);
+  ASSERT_TRUE(sensor.Update());
+  EXPECT_NEAR(float{sensor.angle()}, 110, 1e-2);
+}
+
+TEST_F(MLX90393SensorTest, RateIsDegreesPerSecond) {
+  MLX90393Sensor sensor(&fake_);
+  for (int a = 0; a <= 50; a += 2) PushAngle(fake_, a);
+  ASSERT_TRUE(sensor.Update());
+  EXPECT_EQ(sensor.rate(), 0);  // The first sample has nothing to compare to.
+  while (fake_.pending() > 0) {
+    hosthal::AdvanceMicros(10'000);
+    ASSERT_TRUE(sensor.Update());
+    EXPECT_NEAR(float{sensor.rate()}, 200, 1);
+  }
+}
+
+TEST_F(MLX90393SensorTest, UsesGivenEstimator) {
+  MovingAverageEstimator<4> estimator;
+  MLX90393Sensor sensor(&fake_, &estimator);
+  for (int a = 0; a <= 30; a += 3) PushAngle(fake_, a);
+  while (fake_.pending() > 0) {
+    hosthal::AdvanceMicros(10'000);
+    ASSERT_TRUE(sensor.Update());
+  }
+  EXPECT_NEAR(float{sensor.rate()}, 300, 0.5);
+  // The sensor fed this estimator: three of its four samples are 3 degrees.
+  EXPECT_NEAR(float{estimator.Update(0, 10)}, 225, 0.5);
+}
+
+}  // namespace
+}  // namespace motor
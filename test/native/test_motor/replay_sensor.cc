@@ -0,0 +1,108 @@
+#include "replay_sensor.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include "hosthal.h"
+#include "mlx90393_sensor.h"
+#include "trace.h"
+#include "trace_reader.h"
+#include "velocity_estimator.h"
+
+namespace motor {
+namespace {
+
+class ReplaySensorTest : public ::testing::Test {
+ protected:
+  void SetUp() override { hosthal::Reset(); }
+
+  // Runs a live sensor over a noisy turn and a half, recording it, and
+  // returns the dumped and parsed trace. The angle and rate after each
+  // sample go to angles and rates.
+  std::vector<TraceEvent> RecordLive(VelocityEstimator* estimator) {
+    for (int i = 0; i < 540; i += 3) {
+      const double radians = (i + 0.3 * std::sin(i)) * PI / 180;
+      fake_.PushSample(400 * cos(radians), 400 * sin(radians));
+    }
+    fake_.PushFailure();
+    std::array<TraceEvent, 512> buffer;
+    TraceRecorder recorder(buffer);
+    MLX90393Sensor sensor(&fake_, estimator);
+    sensor.set_recorder(&recorder);
+    while (fake_.pending() > 0) {
+      hosthal::AdvanceMicros(9'000 + fake_.pending() % 7 * 300);
+      if (!sensor.Update()) continue;
+      // A command after every sample, as the control loop would issue.
+      recorder.RecordCommand(micros(), TraceEvent::kSetEffort,
+                             sensor.rate().getInteger());
+      angles_.push_back(sensor.angle());
+      rates_.push_back(sensor.rate());
+    }
+    std::vector<uint8_t> bytes;
+    recorder.Dump([&](const uint8_t* data, size_t size) {
+      bytes.insert(bytes.end(), data, data + size);
+    });
+    return *ParseTrace(bytes);
+  }
+
+  Adafruit_MLX90393 fake_;
+  std::vector<SQ15x16> angles_, rates_;
+};
+
+TEST_F(ReplaySensorTest, ReproducesTheLiveSensorExactly) {
+  MovingAverageEstimator<4> live_estimator, replay_estimator;
+  const std::vector<TraceEvent> trace = RecordLive(&live_estimator);
+  ASSERT_EQ(trace.size(), 2 * angles_.size());
+
+  ReplaySensor replay(trace, &replay_estimator);
+  for (size_t i = 0; i < angles_.size(); ++i) {
+    ASSERT_TRUE(replay.Update());
+    EXPECT_EQ(replay.angle(), angles_[i]) << i;
+    EXPECT_EQ(replay.rate(), rates_[i]) << i;
+    EXPECT_EQ(replay.timestamp_us(), trace[2 * i].timestamp_us);
+    // The command issued in response is next.
+    EXPECT_EQ(trace[replay.position()].kind, TraceEvent::kSetEffort);
+  }
+  EXPECT_TRUE(replay.done());
+  EXPECT_FALSE(replay.Update());
+  EXPECT_NEAR(float{replay.angle()}, 537, 1);
+}
+
+TEST_F(ReplaySensorTest, SkipsCommandsAndEndsCleanly) {
+  const std::vector<TraceEvent> trace = {
+      {.timestamp_us = 0, .kind = TraceEvent::kStop},
+      {.timestamp_us = 1000, .kind = TraceEvent::kSample, .field = {1, 0}},
+      {.timestamp_us = 1500, .kind = TraceEvent::kSetDuty, .command = 3},
+      {.timestamp_us = 11000, .kind = TraceEvent::kSample, .field = {0, 1}},
+      {.timestamp_us = 11500, .kind = TraceEvent::kSetDuty, .command = 4},
+  };
+  ReplaySensor replay(trace);
+  EXPECT_FALSE(replay.done());
+  ASSERT_TRUE(replay.Update());
+  EXPECT_EQ(replay.angle(), 0);
+  ASSERT_TRUE(replay.Update());
+  EXPECT_NEAR(float{replay.angle()}, 90, 1e-2);
+  EXPECT_NEAR(float{replay.rate()}, 9000, 1);
+  EXPECT_TRUE(replay.done());
+  EXPECT_FALSE(replay.Update());
+  EXPECT_EQ(replay.position(), trace.size());
+}
+
+TEST_F(ReplaySensorTest, SetAngleRebases) {
+  const std::vector<TraceEvent> trace = {
+      {.timestamp_us = 0, .kind = TraceEvent::kSample, .field = {1, 0}},
+      {.timestamp_us = 10, .kind = TraceEvent::kSample, .field = {1, 1}},
+  };
+  ReplaySensor replay(trace);
+  replay.Update();
+  replay.SetAngle(100);
+  replay.Update();
+  EXPECT_NEAR(float{replay.angle()}, 145, 1e-2);
+}
+
+}  // namespace
+}  // namespace motor
@@ -0,0 +1,83 @@
+#include "three_wire_motor.h"
+
+#include <Arduino.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "hosthal.h"
+
+namespace motor {
+namespace {
+
+constexpr int kPwm = 0;
+constexpr int kForward = 1;
+constexpr int kReverse = 8;
+
+class ThreeWireMotorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    hosthal::Reset();
+    motor_.Begin();
+  }
+
+  ThreeWireMotor motor_{kPwm, kForward, kReverse};
+};
+
+TEST_F(ThreeWireMotorTest, BeginCoasts) {
+  EXPECT_EQ(hosthal::Pin(kPwm).mode, OUTPUT);
+  EXPECT_EQ(hosthal::Pin(kForward).digital, LOW);
+  EXPECT_EQ(hosthal::Pin(kReverse).digital, LOW);
+  EXPECT_EQ(hosthal::Pin(kPwm).analog, 0);
+}
+
+TEST_F(ThreeWireMotorTest, Direction) {
+  motor_.SetDirection(kClockwise);
+  EXPECT_EQ(hosthal::Pin(kForward).digital, HIGH);
+  EXPECT_EQ(hosthal::Pin(kReverse).digital, LOW);
+  motor_.SetDirection(kCounterClockwise);
+  EXPECT_EQ(hosthal::Pin(kForward).digital, LOW);
+  EXPECT_EQ(hosthal::Pin(kReverse).digital, HIGH);
+}
+
+TEST_F(ThreeWireMotorTest, DutyAndBrake) {
+  motor_.SetDuty(128);
+  EXPECT_EQ(hosthal::Pin(kPwm).analog, 128);
+  motor_.Stop(kBrake);
+  EXPECT_EQ(hosthal::Pin(kForward).digital, HIGH);
+  EXPECT_EQ(hosthal::Pin(kReverse).digital, HIGH);
+  EXPECT_EQ(hosthal::Pin(kPwm).analog, 0);
+}
+
+TEST_F(ThreeWireMotorTest, EffortSetsDirectionAndDuty) {
+  motor_.SetEffort(100);
+  EXPECT_EQ(hosthal::Pin(kForward).digital, HIGH);
+  EXPECT_EQ(hosthal::Pin(kReverse).digital, LOW);
+  EXPECT_EQ(hosthal::Pin(kPwm).analog, 100);
+  motor_.SetEffort(-60);
+  EXPECT_EQ(hosthal::Pin(kForward).digital, LOW);
+  EXPECT_EQ(hosthal::Pin(kReverse).digital, HIGH);
+  EXPECT_EQ(hosthal::Pin(kPwm).analog, 60);
+}
+
+TEST_F(ThreeWireMotorTest, EffortOnlyWritesDirectionOnSignChange) {
+  motor_.SetEffort(10);
+  const int direction_writes = hosthal::Pin(kForward).digital_writes;
+  motor_.SetEffort(20);
+  motor_.SetEffort(0);
+  EXPECT_EQ(hosthal::Pin(kForward).digital_writes, direction_writes);
+  EXPECT_EQ(hosthal::Pin(kPwm).analog, 0);
+  motor_.SetEffort(-20);
+  EXPECT_EQ(hosthal::Pin(kForward).digital_writes, direction_writes + 1);
+}
+
+TEST_F(ThreeWireMotorTest, EffortAfterStopRestoresDirection) {
+  motor_.SetEffort(50);
+  motor_.Stop(kBrake);
+  motor_.SetEffort(50);
+  EXPECT_EQ(hosthal::Pin(kForward).digital, HIGH);
+  EXPECT_EQ(hosthal::Pin(kReverse).digital, LOW);
+  EXPECT_EQ(hosthal::Pin(kPwm).analog, 50);
+}
+
+}  // namespace
+}  // namespace motor
@@ -0,0 +1,186 @@
+#include "trace.h"
+
+#include <Arduino.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "hosthal.h"
+#include "three_wire_motor.h"
+#include "trace_reader.h"
+
+namespace motor {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Field;
+
+class TraceTest : public ::testing::Test {
+ protected:
+  void SetUp() override { hosthal::Reset(); }
+
+  // Dumps recorder the way the firmware does to Serial.
+  static std::vector<uint8_t> Dump(const TraceRecorder& recorder) {
+    std::vector<uint8_t> bytes;
+    recorder.Dump([&](const uint8_t* data, size_t size) {
+      bytes.insert(bytes.end(), data, data + size);
+    });
+    return bytes;
+  }
+};
+
+TEST_F(TraceTest, KeepFirstDropsWhenFull) {
+  std::array<TraceEvent, 3> buffer;
+  TraceRecorder recorder(buffer);
+  for (uint32_t t = 1; t <= 5; ++t) recorder.RecordSample(t, {1, 2});
+  EXPECT_TRUE(recorder.full());
+  EXPECT_EQ(recorder.dropped(), 2);
+  EXPECT_EQ(recorder[0].timestamp_us, 1);
+  EXPECT_EQ(recorder[2].timestamp_us, 3);
+}
+
+TEST_F(TraceTest, KeepLatestOverwritesTheOldest) {
+  std::array<TraceEvent, 3> buffer;
+  TraceRecorder recorder(buffer, TraceRecorder::kKeepLatest);
+  for (uint32_t t = 1; t <= 5; ++t) recorder.RecordSample(t, {1, 2});
+  EXPECT_EQ(recorder.size(), 3);
+  EXPECT_EQ(recorder.dropped(), 2);
+  EXPECT_EQ(recorder[0].timestamp_us, 3);
+  EXPECT_EQ(recorder[1].timestamp_us, 4);
+  EXPECT_EQ(recorder[2].timestamp_us, 5);
+}
+
+TEST_F(TraceTest, PausesAndClears) {
+  std::array<TraceEvent, 4> buffer;
+  TraceRecorder recorder(buffer);
+  recorder.RecordSample(1, {});
+  recorder.set_recording(false);
+  recorder.RecordSample(2, {});
+  EXPECT_EQ(recorder.size(), 1);
+  recorder.Clear();
+  EXPECT_TRUE(recorder.recording());
+  EXPECT_EQ(recorder.size(), 0);
+}
+
+TEST_F(TraceTest, SaturatesCommands) {
+  std::array<TraceEvent, 2> buffer;
+  TraceRecorder recorder(buffer);
+  recorder.RecordCommand(0, TraceEvent::kSetEffort, 100'000);
+  recorder.RecordCommand(0, TraceEvent::kSetEffort, -100'000);
+  EXPECT_EQ(recorder[0].command, INT16_MAX);
+  EXPECT_EQ(recorder[1].command, INT16_MIN);
+}
+
+TEST_F(TraceTest, TracingMotorRecordsAndForwards) {
+  std::array<TraceEvent, 8> buffer;
+  TraceRecorder recorder(buffer);
+  ThreeWireMotor real(0, 1, 8);
+  TracingMotor motor(&real, &recorder);
+  hosthal::SetMicros(10);
+  motor.SetDirection(kCounterClockwise);
+  motor.SetDuty(128);
+  hosthal::SetMicros(20);
+  motor.SetEffort(-64);
+  motor.Stop(kBrake);
+  EXPECT_EQ(hosthal::Pin(0).analog, 0);
+  EXPECT_EQ(hosthal::Pin(1).digital, HIGH);
+  EXPECT_EQ(hosthal::Pin(8).digital, HIGH);
+
+  ASSERT_EQ(recorder.size(), 4);
+  EXPECT_EQ(recorder[0].kind, TraceEvent::kSetDirection);
+  EXPECT_EQ(recorder[0].command, kCounterClockwise);
+  EXPECT_EQ(recorder[0].timestamp_us, 10);
+  EXPECT_EQ(recorder[1].kind, TraceEvent::kSetDuty);
+  EXPECT_EQ(recorder[1].command, 128);
+  EXPECT_EQ(recorder[2].kind, TraceEvent::kSetEffort);
+  EXPECT_EQ(recorder[2].command, -64);
+  EXPECT_EQ(recorder[2].timestamp_us, 20);
+  EXPECT_EQ(recorder[3].kind, TraceEvent::kStop);
+  EXPECT_EQ(recorder[3].command, kBrake);
+}
+
+TEST_F(TraceTest, DumpRoundTripsThroughOtherOutput) {
+  std::array<TraceEvent, 4> buffer;
+  TraceRecorder recorder(buffer, TraceRecorder::kKeepLatest);
+  recorder.RecordSample(5, {-1.5, 1e-3});
+  recorder.RecordCommand(6, TraceEvent::kSetEffort, -255);
+  recorder.RecordSample(7, {400, -300.25});
+  recorder.RecordCommand(8, TraceEvent::kStop, kCoast);
+  recorder.RecordSample(0xFFFFFFFF, {3, 4});
+
+  const std::string before = ">ANGLE:1:2.5\n";
+  std::vector<uint8_t> serial(before.begin(), before.end());
+  const std::vector<uint8_t> dump = Dump(recorder);
+  EXPECT_EQ(dump.size(), kTraceHeaderSize + 4 * kTraceEventSize + 2);
+  serial.insert(serial.end(), dump.begin(), dump.end());
+  serial.push_back('\n');
+
+  const auto events = ParseTrace(serial);
+  ASSERT_TRUE(events.has_value()) << events.error();
+  using E = TraceEvent;
+  EXPECT_THAT(*events,
+              ElementsAre(Field(&E::kind, E::kSetEffort),
+                          Field(&E::field, std::array<float, 2>{400, -300.25}),
+                          Field(&E::kind, E::kStop),
+                          Field(&E::timestamp_us, 0xFFFFFFFF)));
+  EXPECT_EQ((*events)[0].command, -255);
+  EXPECT_EQ((*events)[0].timestamp_us, 6);
+}
+
+TEST_F(TraceTest, ParseRejectsDamage) {
+  std::array<TraceEvent, 2> buffer;
+  TraceRecorder recorder(buffer);
+  recorder.RecordSample(1, {1, 2});
+  recorder.RecordSample(2, {3, 4});
+  std::vector<uint8_t> dump = Dump(recorder);
+
+  EXPECT_FALSE(ParseTrace(std::span(dump).first(4)).has_value());
+  EXPECT_FALSE(ParseTrace(std::span(dump).first(dump.size() - 1)));
+  dump[kTraceHeaderSize + 3] ^= 1;
+  EXPECT_EQ(ParseTrace(dump).error(), "trace checksum mismatch");
+  EXPECT_EQ(ParseTrace(std::span(dump).subspan(1)).error(), "no trace found");
+}
+
+TEST_F(TraceTest, ParseSkipsMagicThatStartsNoTrace) {
+  std::array<TraceEvent, 1> buffer;
+  TraceRecorder recorder(buffer);
+  recorder.RecordSample(1, {1, 2});
+  const std::vector<uint8_t> dump = Dump(recorder);
+
+  // The magic in text, then a dump cut off by a reset, then a whole one.
+  const std::string text = "TRCE is the magic\n";
+  std::vector<uint8_t> serial(text.begin(), text.end());
+  serial.insert(serial.end(), dump.begin(), dump.end() - 3);
+  serial.insert(serial.end(), dump.begin(), dump.end());
+
+  const auto events = ParseTrace(serial);
+  ASSERT_TRUE(events.has_value()) << events.error();
+  ASSERT_EQ(events->size(), 1);
+  EXPECT_EQ((*events)[0].timestamp_us, 1);
+
+  serial.resize(serial.size() - dump.size());
+  EXPECT_EQ(ParseTrace(serial).error(), "unsupported trace version 32");
+}
+
+TEST_F(TraceTest, ParseReturnsTheFirstOfSeveralTraces) {
+  std::array<TraceEvent, 1> buffer;
+  TraceRecorder recorder(buffer);
+  recorder.RecordSample(1, {1, 2});
+  std::vector<uint8_t> serial = Dump(recorder);
+  recorder.Clear();
+  recorder.RecordSample(2, {3, 4});
+  const std::vector<uint8_t> second = Dump(recorder);
+  const size_t first_size = serial.size();
+  serial.insert(serial.end(), second.begin(), second.end());
+
+  EXPECT_EQ((*ParseTrace(serial))[0].timestamp_us, 1);
+  EXPECT_EQ((*ParseTrace(std::span(serial).subspan(first_size)))[0]
+                .timestamp_us,
+            2);
+}
+
+}  // namespace
+}  // namespace motor
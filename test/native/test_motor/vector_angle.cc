@@ -0,0 +1,69 @@
+#include "vector_angle.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <string>
+
+#include "mlx90393_sensor.h"
+
+namespace motor {
+namespace {
+
+using AngleFn = SQ15x16 (*)(int32_t, int32_t);
+
+// Returns the absolute difference between two angles in degrees, accounting
+// for the wrap at 360.
+double AngleDiff(double a, double b) {
+  const double d = std::fabs(a - b);
+  return d > 180 ? 360 - d : d;
+}
+
+// Sweeps the full circle at several magnitudes and returns the largest
+// difference from the double precision reference.
+double MaxError(AngleFn fn) {
+  double max_err = 0;
+  for (int magnitude : {300, 4'000, 60'000, 1'000'000, 1'000'000'000}) {
+    for (int i = 0; i < 36'000; ++i) {
+      const double radians = i * 2 * PI / 36'000;
+      const int32_t x = std::lround(magnitude * cos(radians));
+      const int32_t y = std::lround(magnitude * sin(radians));
+      const double want = float{VectorToAngleDecidegrees(x, y)};
+      const double got = float{fn(x, y)};
+      EXPECT_GE(got, 0);
+      EXPECT_LT(got, 360);
+      max_err = std::max(max_err, AngleDiff(got, want));
+    }
+  }
+  return max_err;
+}
+
+TEST(VectorAngle, Axes) {
+  for (AngleFn fn : {&VectorToAngleCordic, &VectorToAngleTable}) {
+    EXPECT_EQ(fn(0, 0), 0);
+    EXPECT_NEAR(float{fn(5, 0)}, 0, 2e-3);
+    EXPECT_NEAR(float{fn(0, 5)}, 90, 2e-3);
+    EXPECT_NEAR(float{fn(-5, 0)}, 180, 2e-3);
+    EXPECT_NEAR(float{fn(0, -5)}, 270, 2e-3);
+    EXPECT_NEAR(float{fn(INT32_MAX, INT32_MAX)}, 45, 2e-3);
+    EXPECT_NEAR(float{fn(-INT32_MAX, -INT32_MAX)}, 225, 2e-3);
+  }
+}
+
+// The accuracy sweep. The bounds here are the ones documented in
+// vector_angle.h; the measured values are recorded in the test output.
+TEST(VectorAngle, CordicAccuracy) {
+  const double err = MaxError(&VectorToAngleCordic);
+  RecordProperty("max_error_degrees", std::to_string(err));
+  EXPECT_LT(err, 0.002);
+}
+
+TEST(VectorAngle, TableAccuracy) {
+  const double err = MaxError(&VectorToAngleTable);
+  RecordProperty("max_error_degrees", std::to_string(err));
+  EXPECT_LT(err, 0.0015);
+}
+
+}  // namespace
+}  // namespace motor
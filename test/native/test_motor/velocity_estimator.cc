@@ -0,0 +1,172 @@
+#include "velocity_estimator.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace motor {
+namespace {
+
+constexpr double kDtMs = 1;
+
+// Angle as a function of time in seconds.
+using Trace = std::function<double(double)>;
+
+// Feeds the estimator n samples of trace, with Gaussian angle noise of the
+// given standard deviation in degrees, and returns the estimates.
+std::vector<double> RunTrace(VelocityEstimator& estimator, const Trace& trace,
+                             int n, double noise_degrees) {
+  std::mt19937 rng(1234);
+  std::normal_distribution<double> noise(0, noise_degrees);
+  std::vector<double> rates;
+  // The sensor quantizes the angle to SQ15x16 before differencing, so do the
+  // same here.
+  SQ15x16 prev = trace(0);
+  for (int i = 1; i <= n; ++i) {
+    const SQ15x16 angle = trace(i * kDtMs / 1000) + noise(rng);
+    rates.push_back(float{estimator.Update(angle - prev, kDtMs)});
+    prev = angle;
+  }
+  return rates;
+}
+
+struct Stats {
+  double mean = 0;
+  double stddev = 0;
+};
+
+// Returns the mean and standard deviation of want - got over the second half
+// of the run, once every estimator has settled.
+Stats ErrorStats(const std::vector<double>& got,
+                 const std::function<double(int)>& want) {
+  Stats stats;
+  const int size = got.size();
+  const int start = size / 2;
+  const int n = size - start;
+  for (int i = start; i < size; ++i) stats.mean += want(i) - got[i];
+  stats.mean /= n;
+  for (int i = start; i < size; ++i) {
+    const double e = want(i) - got[i] - stats.mean;
+    stats.stddev += e * e;
+  }
+  stats.stddev = std::sqrt(stats.stddev / n);
+  return stats;
+}
+
+constexpr double kSpeed = 300;          // degrees/sec
+constexpr double kAcceleration = 2000;  // degrees/sec^2
+constexpr double kNoise = 0.05;         // degrees, about what the sensor gives
+constexpr int kSamples = 2000;
+
+struct Report {
+  double bias;    // degrees/sec, at constant speed without noise
+  double noise;   // degrees/sec RMS, at constant speed with kNoise
+  double lag_ms;  // behind a constant acceleration
+};
+
+Report Measure(VelocityEstimator& estimator) {
+  Report report;
+  const Trace constant = [](double t) { return kSpeed * t; };
+  const auto speed = [](int) { return kSpeed; };
+
+  estimator.Reset();
+  report.bias =
+      ErrorStats(RunTrace(estimator, constant, kSamples, 0), speed).mean;
+
+  estimator.Reset();
+  report.noise =
+      ErrorStats(RunTrace(estimator, constant, kSamples, kNoise), speed).stddev;
+
+  // The ramp's speed is sampled at the same instants as its angle: sample i
+  // is taken at (i + 1) * kDtMs.
+  estimator.Reset();
+  const Trace ramp = [](double t) { return kAcceleration * t * t / 2; };
+  const auto ramp_speed = [](int i) {
+    return kAcceleration * (i + 1) * kDtMs / 1000;
+  };
+  report.lag_ms =
+      ErrorStats(RunTrace(estimator, ramp, kSamples, 0), ramp_speed).mean /
+      kAcceleration * 1000;
+  return report;
+}
+
+struct EstimatorCase {
+  std::string name;
+  std::function<std::unique_ptr<VelocityEstimator>()> make;
+  // Bounds for this estimator.
+  double max_noise;
+  double max_lag_ms;
+};
+
+class VelocityEstimatorTest : public ::testing::TestWithParam<EstimatorCase> {
+};
+
+// Every estimator follows a constant speed without bias, and its noise and
+// lag stay within the bounds the tuning was chosen for. The measured values
+// are recorded in the test output for comparison.
+TEST_P(VelocityEstimatorTest, BiasNoiseAndLag) {
+  const EstimatorCase& c = GetParam();
+  auto estimator = c.make();
+  const Report report = Measure(*estimator);
+  RecordProperty("bias", std::to_string(report.bias));
+  RecordProperty("noise", std::to_string(report.noise));
+  RecordProperty("lag_ms", std::to_string(report.lag_ms));
+  EXPECT_LT(std::fabs(report.bias), 0.1);
+  EXPECT_LT(report.noise, c.max_noise);
+  EXPECT_LT(report.lag_ms, c.max_lag_ms);
+}
+
+TEST_P(VelocityEstimatorTest, IgnoresZeroDt) {
+  auto estimator = GetParam().make();
+  for (int i = 0; i < 100; ++i) estimator->Update(SQ15x16{0.3}, kDtMs);
+  const SQ15x16 rate = estimator->Update(SQ15x16{0.3}, kDtMs);
+  EXPECT_EQ(estimator->Update(5, 0), rate);
+}
+
+TEST_P(VelocityEstimatorTest, FollowsReverse) {
+  auto estimator = GetParam().make();
+  const Trace reverse = [](double t) { return -kSpeed * t; };
+  const std::vector<double> rates =
+      RunTrace(*estimator, reverse, kSamples, 0);
+  EXPECT_NEAR(rates.back(), -kSpeed, 0.1);
+}
+
+// First difference amplifies angle noise by 1/dt: sqrt(2) * 0.05 deg / 1 ms
+// is about 70 deg/s. The others trade some of that for lag.
+INSTANTIATE_TEST_SUITE_P(
+    Estimators, VelocityEstimatorTest,
+    ::testing::Values(
+        EstimatorCase{
+            "FirstDifference",
+            [] { return std::make_unique<FirstDifferenceEstimator>(); }, 80,
+            0.6},
+        EstimatorCase{
+            "MovingAverage8",
+            [] { return std::make_unique<MovingAverageEstimator<8>>(); }, 10,
+            4.1},
+        EstimatorCase{
+            "AlphaBeta",
+            [] { return std::make_unique<AlphaBetaEstimator>(0.1, 0.005); },
+            1, 22},
+        EstimatorCase{
+            "TrackingLoop20Hz",
+            [] { return std::make_unique<TrackingLoopEstimator>(20); }, 2,
+            17}),
+    [](const auto& info) { return info.param.name; });
+
+TEST(RatePerSecond, KeepsPrecisionAndSaturates) {
+  EXPECT_EQ(RatePerSecond(SQ15x16{0.5}, 10), 50);
+  EXPECT_NEAR(float{RatePerSecond(SQ15x16{0.25}, 3)}, 250 / 3.0, 1e-4);
+  EXPECT_EQ(RatePerSecond(180, SQ15x16{0.5}).getInternal(), INT32_MAX);
+  EXPECT_EQ(RatePerSecond(-180, SQ15x16{0.5}).getInternal(), INT32_MIN);
+  EXPECT_EQ(RatePerSecond(1, 0), 0);
+}
+
+}  // namespace
+}  // namespace motor
@@ -0,0 +1,194 @@
+#include "balance_kalman.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <numbers>
+#include <random>
+#include <string>
+
+namespace orientation {
+namespace {
+
+constexpr double kGravity = 9.81;
+constexpr double kPi = std::numbers::pi;
+constexpr double kDtMs = 1;
+
+// The IMU sample for a pitch in degrees and a gyro rate in degrees/sec.
+ImuSample Sample(double pitch, double gyro_y, double accel_noise = 0) {
+  const double radians = pitch * kPi / 180;
+  return {.accel_x = -std::sin(radians) * kGravity + accel_noise,
+          .accel_y = 0,
+          .accel_z = std::cos(radians) * kGravity,
+          .gyro_x = 0,
+          .gyro_y = gyro_y,
+          .gyro_z = 0};
+}
+
+// A synthetic balance: the pitch sways at 1 Hz and the wheels swing at
+// 0.5 Hz, seen through a gyro with bias and noise, an accelerometer with
+// vibration, and a wheel angle sensor with noise and 0.1 degree steps.
+struct Sway {
+  double pitch_amplitude = 10;
+  double wheel_amplitude = 200;
+  double gyro_bias = 0;
+  double gyro_noise = 0.05;
+  double accel_noise = 0.3;
+  double wheel_noise = 0.05;
+};
+
+struct Errors {
+  // RMS over the second half of the run.
+  double pitch = 0, pitch_rate = 0, wheel_angle = 0, wheel_rate = 0;
+  // Of a first difference of the wheel angle readings, for comparison.
+  double differenced_wheel_rate = 0;
+  // The fraction of steps in the second half where each of the four errors
+  // was within three of the filter's own standard deviations.
+  double within_three_sigma = 0;
+};
+
+template <typename T>
+Errors Run(BasicBalanceKalman<T>& filter, const Sway& sway, double seconds) {
+  std::mt19937 rng(7);
+  std::normal_distribution<double> noise(0, 1);
+  const int n = seconds * 1000 / kDtMs;
+  Errors errors;
+  int counted = 0, within = 0;
+  double last_reading = 0;
+  for (int i = 0; i < n; ++i) {
+    const double t = i * kDtMs / 1000;
+    const double pitch = sway.pitch_amplitude * std::sin(2 * kPi * t);
+    const double rate = sway.pitch_amplitude * 2 * kPi * std::cos(2 * kPi * t);
+    const double wheel = sway.wheel_amplitude * std::sin(kPi * t);
+    const double wheel_rate = sway.wheel_amplitude * kPi * std::cos(kPi * t);
+    const double reading =
+        std::round((wheel + sway.wheel_noise * noise(rng)) / 0.1) * 0.1;
+    filter.Update(Sample(pitch, rate + sway.gyro_bias +
+                                    sway.gyro_noise * noise(rng),
+                         sway.accel_noise * noise(rng)),
+                  T(reading), T(kDtMs));
+    if (i >= n / 2) {
+      const double e[4] = {static_cast<float>(filter.pitch()) - pitch,
+                           static_cast<float>(filter.pitch_rate()) - rate,
+                           static_cast<float>(filter.wheel_angle()) - wheel,
+                           static_cast<float>(filter.wheel_rate()) -
+                               wheel_rate};
+      errors.pitch += e[0] * e[0];
+      errors.pitch_rate += e[1] * e[1];
+      errors.wheel_angle += e[2] * e[2];
+      errors.wheel_rate += e[3] * e[3];
+      const double differenced =
+          (reading - last_reading) * 1000 / kDtMs - wheel_rate;
+      errors.differenced_wheel_rate += differenced * differenced;
+      bool all_within = true;
+      for (int s = 0; s < 4; ++s) {
+        const double variance =
+            static_cast<float>(filter.covariance()[s][s]);
+        all_within &= e[s] * e[s] <= 9 * variance;
+      }
+      within += all_within;
+      ++counted;
+    }
+    last_reading = reading;
+  }
+  errors.pitch = std::sqrt(errors.pitch / counted);
+  errors.pitch_rate = std::sqrt(errors.pitch_rate / counted);
+  errors.wheel_angle = std::sqrt(errors.wheel_angle / counted);
+  errors.wheel_rate = std::sqrt(errors.wheel_rate / counted);
+  errors.differenced_wheel_rate =
+      std::sqrt(errors.differenced_wheel_rate / counted);
+  errors.within_three_sigma = double(within) / counted;
+  return errors;
+}
+
+template <typename T>
+class BalanceKalmanTest : public ::testing::Test {};
+
+using Types = ::testing::Types<SQ15x16, float>;
+TYPED_TEST_SUITE(BalanceKalmanTest, Types);
+
+TYPED_TEST(BalanceKalmanTest, FirstSamplesInitialize) {
+  BasicBalanceKalman<TypeParam> filter;
+  filter.Predict(TypeParam(kDtMs));
+  filter.UpdateImu(Sample(-40, 0));
+  filter.UpdateWheelAngle(TypeParam(1234.5));
+  EXPECT_NEAR(static_cast<float>(filter.pitch()), -40, 0.01);
+  EXPECT_NEAR(static_cast<float>(filter.wheel_angle()), 1234.5, 1e-3);
+  EXPECT_EQ(filter.wheel_rate(), 0);
+
+  filter.Reset();
+  filter.UpdateImu({});
+  EXPECT_EQ(filter.pitch(), 0);
+  filter.UpdateImu(Sample(15, 0));
+  EXPECT_NEAR(static_cast<float>(filter.pitch()), 15, 0.01);
+}
+
+TYPED_TEST(BalanceKalmanTest, IgnoresZeroDt) {
+  BasicBalanceKalman<TypeParam> filter;
+  filter.Update(Sample(0, 100), TypeParam(0), TypeParam(kDtMs));
+  const auto before = filter.state();
+  filter.Predict(TypeParam(0));
+  EXPECT_EQ(filter.state(), before);
+}
+
+// A wider initial sigma would overflow the fixed point covariance.
+TEST(BalanceKalman, ClampsInitialSigmas) {
+  BalanceKalman filter({.initial_wheel_rate_sigma = 1000});
+  EXPECT_EQ(filter.config().initial_wheel_rate_sigma,
+            BalanceKalman::kMaxInitialSigma);
+  filter.Update(Sample(0, 0), 0, kDtMs);
+  EXPECT_GT(filter.covariance()[kWheelRate][kWheelRate], 30'000);
+
+  BasicBalanceKalman<float> unclamped({.initial_wheel_rate_sigma = 1000});
+  EXPECT_EQ(unclamped.config().initial_wheel_rate_sigma, 1000);
+}
+
+// Held still at a tilt with a biased gyro, the filter learns the bias, so
+// the pitch and rate settle on the truth.
+TYPED_TEST(BalanceKalmanTest, LearnsGyroBias) {
+  BasicBalanceKalman<TypeParam> filter;
+  for (int i = 0; i < 20'000; ++i) {
+    filter.Update(Sample(10, 2), TypeParam(50), TypeParam(kDtMs));
+  }
+  EXPECT_NEAR(static_cast<float>(filter.gyro_bias()), 2, 0.05);
+  EXPECT_NEAR(static_cast<float>(filter.pitch_rate()), 0, 0.05);
+  EXPECT_NEAR(static_cast<float>(filter.pitch()), 10, 0.05);
+  EXPECT_NEAR(static_cast<float>(filter.wheel_angle()), 50, 0.01);
+  EXPECT_NEAR(static_cast<float>(filter.wheel_rate()), 0, 0.05);
+}
+
+// The covariance stays symmetric and positive on the diagonal, settles, and
+// the estimate's errors match it.
+TYPED_TEST(BalanceKalmanTest, CovarianceIsConsistent) {
+  BasicBalanceKalman<TypeParam> filter;
+  const Errors errors = Run(filter, {.gyro_bias = 1.5}, 20);
+  const auto& p = filter.covariance();
+  for (size_t i = 0; i < kNumBalanceStates; ++i) {
+    EXPECT_GT(p[i][i], 0) << i;
+    for (size_t j = 0; j < i; ++j) EXPECT_EQ(p[i][j], p[j][i]) << i << j;
+  }
+  EXPECT_GT(errors.within_three_sigma, 0.95);
+}
+
+// The sway with realistic sensor errors and a 1.5 deg/s gyro bias. The
+// measured errors are recorded in the test output for comparison.
+TYPED_TEST(BalanceKalmanTest, Sway) {
+  BasicBalanceKalman<TypeParam> filter;
+  const Errors errors = Run(filter, {.gyro_bias = 1.5}, 20);
+  this->RecordProperty("rms_error_degrees", std::to_string(errors.pitch));
+  this->RecordProperty("rms_rate_error", std::to_string(errors.pitch_rate));
+  this->RecordProperty("rms_wheel_error", std::to_string(errors.wheel_angle));
+  this->RecordProperty("rms_wheel_rate_error",
+                       std::to_string(errors.wheel_rate));
+  this->RecordProperty("rms_differenced_wheel_rate_error",
+                       std::to_string(errors.differenced_wheel_rate));
+  EXPECT_LT(errors.pitch, 0.1);
+  EXPECT_LT(errors.pitch_rate, 0.2);
+  EXPECT_LT(errors.wheel_angle, 0.1);
+  EXPECT_LT(errors.wheel_rate, errors.differenced_wheel_rate / 5);
+  EXPECT_NEAR(static_cast<float>(filter.gyro_bias()), 1.5, 0.25);
+}
+
+}  // namespace
+}  // namespace orientation
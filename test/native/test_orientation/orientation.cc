@@ -0,0 +1,194 @@
+#include "orientation.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <numbers>
+#include <random>
+#include <string>
+
+#include "complementary_filter.h"
+#include "mahony_filter.h"
+
+namespace orientation {
+namespace {
+
+constexpr double kGravity = 9.81;
+constexpr double kPi = std::numbers::pi;
+constexpr double kDegrees = 180 / kPi;
+
+// The up vector the IMU sees when pitched and then rolled.
+std::array<double, 3> Up(double pitch_degrees, double roll_degrees) {
+  const double pitch = pitch_degrees / kDegrees;
+  const double roll = roll_degrees / kDegrees;
+  return {-std::sin(pitch), std::sin(roll) * std::cos(pitch),
+          std::cos(roll) * std::cos(pitch)};
+}
+
+TEST(PitchFromGravity, Angles) {
+  EXPECT_EQ(PitchFromGravity(0, 0, 0), 0);
+  EXPECT_EQ(PitchFromGravity(0, 0, 1000), 0);
+  EXPECT_NEAR(float{PitchFromGravity(-1000, 0, 1000)}, 45, 2e-3);
+  EXPECT_NEAR(float{PitchFromGravity(1000, 0, 1000)}, -45, 2e-3);
+  EXPECT_NEAR(float{PitchFromGravity(-1000, 0, 0)}, 90, 2e-3);
+  EXPECT_NEAR(float{PitchFromGravity(1000, 0, 0)}, -90, 2e-3);
+}
+
+TEST(PitchFromGravity, IgnoresRoll) {
+  for (double roll : {-60, -10, 0, 25, 80}) {
+    const auto up = Up(30, roll);
+    EXPECT_NEAR(float{PitchFromGravity(up[0] * 1e6, up[1] * 1e6,
+                                       up[2] * 1e6)},
+                30, 2e-3)
+        << roll;
+  }
+}
+
+constexpr double kDtMs = 1;  // 1 kHz, next to the wheel loops.
+
+// A synthetic IMU. The true pitch follows pitch(t) in degrees; the gyro has a
+// constant bias and white noise, and the accelerometer sees gravity plus
+// vibration.
+struct Trace {
+  std::function<double(double)> pitch;
+  double roll = 0;
+  double gyro_bias = 0;    // degrees/sec
+  double gyro_noise = 0;   // degrees/sec RMS
+  double accel_noise = 0;  // m/s^2 RMS
+};
+
+struct Result {
+  double rms_error = 0;  // degrees, once settled
+  double max_error = 0;
+  double final_rate_error = 0;  // degrees/sec
+};
+
+// Replays seconds of trace through the filter and measures the pitch error
+// over the last half.
+Result Replay(OrientationFilter& filter, const Trace& trace, double seconds) {
+  std::mt19937 rng(42);
+  std::normal_distribution<double> gyro_noise(0, trace.gyro_noise);
+  std::normal_distribution<double> accel_noise(0, trace.accel_noise);
+  const auto noisy = [&](double v, auto& noise) {
+    return SQ15x16{v + (noise.stddev() > 0 ? noise(rng) : 0)};
+  };
+
+  Result result;
+  const int n = seconds * 1000 / kDtMs;
+  int counted = 0;
+  for (int i = 0; i < n; ++i) {
+    const double t = i * kDtMs / 1000;
+    const double pitch = trace.pitch(t);
+    // Central difference for the true rate.
+    const double rate =
+        (trace.pitch(t + 1e-4) - trace.pitch(t - 1e-4)) / 2e-4;
+    const auto up = Up(pitch, trace.roll);
+    ImuSample sample = {
+        .accel_x = noisy(up[0] * kGravity, accel_noise),
+        .accel_y = noisy(up[1] * kGravity, accel_noise),
+        .accel_z = noisy(up[2] * kGravity, accel_noise),
+        .gyro_x = noisy(0, gyro_noise),
+        .gyro_y = noisy(rate + trace.gyro_bias, gyro_noise),
+        .gyro_z = noisy(0, gyro_noise),
+    };
+    filter.Update(sample, kDtMs);
+    if (i >= n / 2) {
+      const double error = float{filter.pitch()} - pitch;
+      result.rms_error += error * error;
+      result.max_error = std::max(result.max_error, std::fabs(error));
+      ++counted;
+      result.final_rate_error = float{filter.pitch_rate()} - rate;
+    }
+  }
+  result.rms_error = std::sqrt(result.rms_error / counted);
+  return result;
+}
+
+struct FilterCase {
+  std::string name;
+  std::function<std::unique_ptr<OrientationFilter>()> make;
+  // Bounds on the RMS error for the sway trace with and without gyro bias.
+  double max_sway_error;
+  double max_biased_error;
+};
+
+class OrientationFilterTest : public ::testing::TestWithParam<FilterCase> {};
+
+TEST_P(OrientationFilterTest, StaticTilt) {
+  auto filter = GetParam().make();
+  const Trace trace = {.pitch = [](double) { return 25.0; }, .roll = 15};
+  const Result result = Replay(*filter, trace, 2);
+  EXPECT_LT(result.max_error, 0.01);
+  EXPECT_NEAR(result.final_rate_error, 0, 1e-3);
+}
+
+TEST_P(OrientationFilterTest, FirstSampleAligns) {
+  auto filter = GetParam().make();
+  const auto up = Up(-40, 0);
+  filter->Update({.accel_x = up[0], .accel_y = up[1], .accel_z = up[2]},
+                 kDtMs);
+  EXPECT_NEAR(float{filter->pitch()}, -40, 0.01);
+  filter->Reset();
+  filter->Update({.accel_x = 0, .accel_y = 0, .accel_z = 1}, kDtMs);
+  EXPECT_NEAR(float{filter->pitch()}, 0, 0.01);
+}
+
+TEST_P(OrientationFilterTest, IgnoresZeroDt) {
+  auto filter = GetParam().make();
+  filter->Update({.accel_z = 1}, kDtMs);
+  filter->Update({.accel_x = -1, .accel_z = 0, .gyro_y = 1000}, 0);
+  EXPECT_EQ(filter->pitch(), 0);
+}
+
+// A balancing sway with realistic sensor errors: 0.05 deg/s gyro noise per
+// sample, 0.3 m/s^2 of vibration on the accelerometer, and, in the biased
+// case, a 1.5 deg/s gyro bias. The measured errors are recorded in the test
+// output for comparison.
+TEST_P(OrientationFilterTest, Sway) {
+  const FilterCase& c = GetParam();
+  Trace trace = {
+      .pitch = [](double t) { return 15 * std::sin(2 * kPi * t); },
+      .gyro_noise = 0.05,
+      .accel_noise = 0.3,
+  };
+  auto filter = c.make();
+  const Result unbiased = Replay(*filter, trace, 10);
+
+  trace.gyro_bias = 1.5;
+  filter->Reset();
+  const Result biased = Replay(*filter, trace, 10);
+
+  RecordProperty("rms_error_degrees", std::to_string(unbiased.rms_error));
+  RecordProperty("max_error_degrees", std::to_string(unbiased.max_error));
+  RecordProperty("biased_rms_error_degrees", std::to_string(biased.rms_error));
+  EXPECT_LT(unbiased.rms_error, c.max_sway_error);
+  EXPECT_LT(biased.rms_error, c.max_biased_error);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Filters, OrientationFilterTest,
+    ::testing::Values(
+        FilterCase{"Complementary",
+                   [] { return std::make_unique<ComplementaryFilter>(500); },
+                   0.1, 1},
+        FilterCase{"Mahony",
+                   [] { return std::make_unique<MahonyFilter>(2, 1); }, 0.1,
+                   0.1}),
+    [](const auto& info) { return info.param.name; });
+
+TEST(MahonyFilter, LearnsGyroBias) {
+  MahonyFilter filter(2, 1);
+  const Trace trace = {.pitch = [](double) { return 10.0; }, .gyro_bias = 2};
+  const Result result = Replay(filter, trace, 20);
+  EXPECT_NEAR(float{filter.gyro_bias()[1]}, 2, 0.05);
+  EXPECT_NEAR(result.final_rate_error, 0, 0.05);
+  EXPECT_LT(result.max_error, 0.05);
+}
+
+}  // namespace
+}  // namespace orientation
@@ -0,0 +1,62 @@
+#include "memory_report.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+
+namespace sched {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+constexpr HeapMemory kHeap = {.free_bytes = 200000,
+                               .min_free_bytes = 150000,
+                               .largest_free_block = 110592};
+
+TEST(MemoryReport, ListsEveryTaskAndTheHeap) {
+  const TaskMemory tasks[] = {
+      {.name = "motor", .stack_bytes = 2048, .stack_min_free = 1200},
+      {.name = "telemetry",
+       .stack_bytes = 4096,
+       .stack_min_free = 3000,
+       .heap_bytes = 64},
+  };
+  char text[512];
+  const size_t length = FormatMemoryReport(tasks, kHeap, text);
+  EXPECT_EQ(length, strlen(text));
+  const std::string report = text;
+  EXPECT_THAT(report,
+              HasSubstr("motor              2048    848   1200       ?\n"));
+  EXPECT_THAT(report,
+              HasSubstr("telemetry          4096   1096   3000      64\n"));
+  EXPECT_THAT(report,
+              HasSubstr("heap free 200000 min 150000 largest 110592\n"));
+  EXPECT_THAT(report, Not(HasSubstr("LOW")));
+}
+
+TEST(MemoryReport, FlagsATaskWithLittleHeadroom) {
+  const TaskMemory task = {
+      .name = "mlx90393", .stack_bytes = 2048, .stack_min_free = 100};
+  EXPECT_TRUE(LowOnStack(task));
+  EXPECT_EQ(task.stack_peak(), 1948u);
+  char text[512];
+  FormatMemoryReport({&task, 1}, kHeap, text);
+  EXPECT_THAT(std::string(text), HasSubstr("1948    100       ? LOW\n"));
+}
+
+TEST(MemoryReport, TruncatesToTheBuffer) {
+  const TaskMemory task = {
+      .name = "motor", .stack_bytes = 2048, .stack_min_free = 1200};
+  char text[40];
+  memset(text, 'x', sizeof(text));
+  const size_t length = FormatMemoryReport({&task, 1}, kHeap, text);
+  EXPECT_EQ(length, sizeof(text) - 1);
+  EXPECT_EQ(text[sizeof(text) - 1], '\0');
+  EXPECT_EQ(FormatMemoryReport({&task, 1}, kHeap, std::span<char>()), 0u);
+}
+
+}  // namespace
+}  // namespace sched
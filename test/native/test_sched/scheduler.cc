@@ -0,0 +1,202 @@
+#include "scheduler.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "clock.h"
+#include "intpid.h"
+#include "jitter_histogram.h"
+
+namespace sched {
+namespace {
+
+constexpr uint32_t kPeriod = 1000;
+
+// Records every tick it sees and takes a configurable time to run.
+class RecordingStage : public Stage {
+ public:
+  explicit RecordingStage(VirtualClock* clock) : clock_(clock) {}
+
+  void Run(const Tick& tick) override {
+    ticks.push_back(tick);
+    const uint32_t cost =
+        run_time_for_tick ? run_time_for_tick(tick.index) : run_time;
+    clock_->Advance(cost);
+  }
+
+  std::vector<Tick> ticks;
+  uint32_t run_time = 0;
+  uint32_t (*run_time_for_tick)(uint32_t index) = nullptr;
+
+ private:
+  VirtualClock* const clock_;
+};
+
+TEST(JitterHistogram, Buckets) {
+  EXPECT_EQ(JitterHistogram::BucketOf(0), 0);
+  EXPECT_EQ(JitterHistogram::BucketOf(1), 1);
+  EXPECT_EQ(JitterHistogram::BucketOf(2), 2);
+  EXPECT_EQ(JitterHistogram::BucketOf(3), 2);
+  EXPECT_EQ(JitterHistogram::BucketOf(4), 3);
+  EXPECT_EQ(JitterHistogram::BucketOf(0xffffffff),
+            JitterHistogram::kNumBuckets - 1);
+
+  JitterHistogram h;
+  for (int i = 0; i < 99; ++i) h.Add(3);
+  h.Add(500);
+  EXPECT_EQ(h.count(), 100);
+  EXPECT_EQ(h.max(), 500);
+  EXPECT_EQ(h.bucket(2), 99);
+  EXPECT_EQ(h.Percentile(.5), 3);
+  EXPECT_EQ(h.Percentile(1), 500);
+}
+
+TEST(Scheduler, RunsStagesInOrderAtFixedPeriod) {
+  VirtualClock clock;
+  clock.set_now(123);
+  Scheduler<2> scheduler(&clock, kPeriod);
+  RecordingStage sense(&clock), compute(&clock);
+  sense.run_time = 100;
+  compute.run_time = 250;
+  ASSERT_TRUE(scheduler.AddStage(&sense));
+  ASSERT_TRUE(scheduler.AddStage(&compute));
+  EXPECT_FALSE(scheduler.AddStage(&compute));
+
+  for (int i = 0; i < 10; ++i) scheduler.RunOnce();
+
+  ASSERT_EQ(sense.ticks.size(), 10);
+  for (uint32_t i = 0; i < 10; ++i) {
+    EXPECT_EQ(sense.ticks[i].index, i);
+    EXPECT_EQ(sense.ticks[i].start_us, 123 + i * kPeriod);
+    // Both stages see the same tick.
+    EXPECT_EQ(compute.ticks[i].start_us, sense.ticks[i].start_us);
+    if (i > 0) {
+      EXPECT_EQ(sense.ticks[i].dt_us, kPeriod);
+    }
+  }
+  EXPECT_EQ(scheduler.stats().overruns, 0);
+  EXPECT_EQ(scheduler.stats().start_jitter.max(), 0);
+  EXPECT_EQ(scheduler.stats().max_busy_us, 350);
+}
+
+TEST(Scheduler, LateWakeupsDoNotDrift) {
+  VirtualClock clock;
+  clock.set_wake_latency(40);
+  Scheduler<1> scheduler(&clock, kPeriod);
+  RecordingStage stage(&clock);
+  scheduler.AddStage(&stage);
+
+  for (int i = 0; i < 100; ++i) scheduler.RunOnce();
+
+  // Every tick after the first is 40us late, but the deadlines stay put and
+  // the measured dt stays at the period.
+  EXPECT_EQ(stage.ticks.back().deadline_us, 99 * kPeriod);
+  EXPECT_EQ(stage.ticks.back().start_us, 99 * kPeriod + 40);
+  EXPECT_EQ(stage.ticks.back().dt_us, kPeriod);
+  const JitterHistogram& jitter = scheduler.stats().start_jitter;
+  EXPECT_EQ(jitter.bucket(JitterHistogram::BucketOf(40)), 99);
+  EXPECT_EQ(jitter.max(), 40);
+}
+
+TEST(Scheduler, OverrunStartsNextTickImmediately) {
+  VirtualClock clock;
+  Scheduler<1> scheduler(&clock, kPeriod);
+  RecordingStage stage(&clock);
+  stage.run_time_for_tick = [](uint32_t index) -> uint32_t {
+    return index == 2 ? 1300 : 100;
+  };
+  scheduler.AddStage(&stage);
+
+  for (int i = 0; i < 5; ++i) scheduler.RunOnce();
+
+  // Tick 2 starts at 2000 and runs until 3300, so tick 3 starts 300us late.
+  // Tick 4 is back on schedule.
+  EXPECT_EQ(stage.ticks[3].start_us, 3300);
+  EXPECT_EQ(stage.ticks[3].dt_us, 1300);
+  EXPECT_EQ(stage.ticks[4].start_us, 4000);
+  EXPECT_EQ(stage.ticks[4].dt_us, 700);
+  EXPECT_EQ(scheduler.stats().overruns, 1);
+  EXPECT_EQ(scheduler.stats().skipped_ticks, 0);
+  EXPECT_EQ(scheduler.stats().start_jitter.max(), 300);
+}
+
+TEST(Scheduler, LongOverrunSkipsTicks) {
+  VirtualClock clock;
+  Scheduler<1> scheduler(&clock, kPeriod);
+  RecordingStage stage(&clock);
+  stage.run_time_for_tick = [](uint32_t index) -> uint32_t {
+    return index == 1 ? 3500 : 100;
+  };
+  scheduler.AddStage(&stage);
+
+  for (int i = 0; i < 4; ++i) scheduler.RunOnce();
+
+  // Tick 1 runs from 1000 to 4500. The deadlines at 2000 and 3000 are skipped
+  // and the one at 4000 runs late.
+  ASSERT_EQ(stage.ticks.size(), 4);
+  EXPECT_EQ(stage.ticks[2].index, 4);
+  EXPECT_EQ(stage.ticks[2].start_us, 4500);
+  EXPECT_EQ(stage.ticks[3].index, 5);
+  EXPECT_EQ(stage.ticks[3].start_us, 5000);
+  EXPECT_EQ(scheduler.stats().overruns, 1);
+  EXPECT_EQ(scheduler.stats().skipped_ticks, 2);
+}
+
+TEST(Scheduler, SurvivesClockWrap) {
+  VirtualClock clock;
+  clock.set_now(0xffffffff - 2500);
+  Scheduler<1> scheduler(&clock, kPeriod);
+  RecordingStage stage(&clock);
+  stage.run_time = 10;
+  scheduler.AddStage(&stage);
+  for (int i = 0; i < 6; ++i) scheduler.RunOnce();
+  for (size_t i = 1; i < stage.ticks.size(); ++i) {
+    EXPECT_EQ(stage.ticks[i].dt_us, kPeriod);
+  }
+  EXPECT_EQ(scheduler.stats().overruns, 0);
+}
+
+// The measured dt is what the controller should integrate over. A stage that
+// feeds it to Pid::Update accumulates error * time correctly even when ticks
+// are late.
+class PidStage : public Stage {
+ public:
+  PidStage()
+      : pid_(*intpid::Pid::Create({.kp = 0,
+                                   .ki = 1,
+                                   .kd = 0,
+                                   .output_min = -10'000,
+                                   .output_max = 10'000})) {
+    pid_.set_setpoint(1);
+  }
+
+  void Run(const Tick& tick) override {
+    output = pid_.Update(0, tick.index == 0 ? SQ15x16(0) : tick.dt_ms());
+  }
+
+  SQ15x16 output = 0;
+
+ private:
+  intpid::Pid pid_;
+};
+
+TEST(Scheduler, PassesRealDtToPid) {
+  VirtualClock clock;
+  Scheduler<2> scheduler(&clock, kPeriod);
+  PidStage pid;
+  RecordingStage stage(&clock);
+  stage.run_time_for_tick = [](uint32_t index) -> uint32_t {
+    return index == 5 ? 1500 : 0;
+  };
+  scheduler.AddStage(&pid);
+  scheduler.AddStage(&stage);
+  for (int i = 0; i < 11; ++i) scheduler.RunOnce();
+  // Ten milliseconds have elapsed, so the integral of an error of 1 is 10
+  // regardless of the overrun in the middle.
+  EXPECT_NEAR(float{pid.output}, 10, 1e-2);
+}
+
+}  // namespace
+}  // namespace sched
@@ -0,0 +1,145 @@
+#include "balancing_robot.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <numbers>
+
+namespace sim {
+namespace {
+
+constexpr double kDegrees = 180 / std::numbers::pi;
+
+RobotParams Frictionless() {
+  RobotParams params;
+  params.motor.viscous_friction = 0;
+  return params;
+}
+
+TEST(BalancingRobot, ClampedWheelReachesFreeSpeed) {
+  RobotParams params;
+  params.mount = RobotParams::kClamped;
+  BalancingRobot robot(params);
+  robot.motor(kLeft).SetEffort(255);
+  robot.Advance(2'000'000);
+
+  const DcMotorParams& m = params.motor;
+  const double gain = m.torque_constant * m.gear_ratio;
+  const double free_speed = gain * m.supply_volts /
+                            (gain * gain + m.viscous_friction *
+                                               m.resistance_ohms);
+  EXPECT_NEAR(robot.wheel_rate_dps(kLeft), free_speed * kDegrees, 0.1);
+  EXPECT_EQ(robot.wheel_rate_dps(kRight), 0);
+  EXPECT_EQ(robot.pitch_degrees(), 0);
+  EXPECT_FALSE(robot.fallen());
+}
+
+TEST(BalancingRobot, UprightAtRestStaysPut) {
+  BalancingRobot robot;
+  robot.Advance(10'000'000);
+  EXPECT_EQ(robot.pitch_degrees(), 0);
+  EXPECT_EQ(robot.position_m(), 0);
+  EXPECT_EQ(robot.time_us(), 10'000'000u);
+}
+
+// Linearized about upright with no torque, the pitch grows as cosh(t / T)
+// with T^2 = (a c - b^2) / (a M g l).
+TEST(BalancingRobot, SmallTiltFallsAtThePendulumRate) {
+  const RobotParams params = Frictionless();
+  const BodyParams& body = params.body;
+  BalancingRobot robot(params);
+  robot.Reset(0.01);
+  robot.Advance(300'000);
+
+  const double r = body.wheel_radius_m;
+  const double a = body.mass_kg + 2 * body.wheel_mass_kg +
+                   2 * body.wheel_inertia / (r * r);
+  const double b = body.mass_kg * body.com_height_m;
+  const double c = b * body.com_height_m + body.pitch_inertia;
+  const double rate = std::sqrt(a * b * body.gravity / (a * c - b * b));
+  EXPECT_NEAR(robot.pitch_degrees(), 0.01 * std::cosh(rate * 0.3), 1e-4);
+  // The wheels roll back as the chassis tips forward.
+  EXPECT_LT(robot.position_m(), 0);
+}
+
+TEST(BalancingRobot, CoastingConservesEnergy) {
+  BalancingRobot robot(Frictionless());
+  robot.Reset(1, 20);
+  const double energy = robot.Energy();
+  ASSERT_GT(energy, 0);
+  robot.Advance(250'000);
+  ASSERT_FALSE(robot.fallen());
+  EXPECT_GT(robot.pitch_degrees(), 20);
+  EXPECT_NEAR(robot.Energy(), energy, 1e-9);
+}
+
+TEST(BalancingRobot, FallsOver) {
+  BalancingRobot robot;
+  robot.Reset(-5);
+  robot.Advance(2'000'000);
+  EXPECT_TRUE(robot.fallen());
+  EXPECT_DOUBLE_EQ(robot.pitch_degrees(), -60);
+  EXPECT_EQ(robot.pitch_rate_dps(), 0);
+
+  robot.Reset();
+  EXPECT_FALSE(robot.fallen());
+  EXPECT_EQ(robot.pitch_degrees(), 0);
+}
+
+TEST(BalancingRobot, DrivingForwardTipsTheChassisBack) {
+  BalancingRobot robot;
+  robot.motor(kLeft).SetEffort(100);
+  robot.motor(kRight).SetEffort(100);
+  EXPECT_GT(robot.accelerations().forward, 0);
+  EXPECT_LT(robot.accelerations().pitch, 0);
+  robot.Advance(50'000);
+  EXPECT_GT(robot.velocity_mps(), 0);
+  EXPECT_LT(robot.pitch_degrees(), 0);
+  EXPECT_NEAR(robot.yaw_degrees(), 0, 1e-9);
+  // The wheels turn forward relative to the chassis.
+  EXPECT_GT(robot.wheel_degrees(kLeft), 0);
+  EXPECT_DOUBLE_EQ(robot.wheel_degrees(kLeft), robot.wheel_degrees(kRight));
+}
+
+TEST(BalancingRobot, OppositeEffortsTurnInPlace) {
+  BalancingRobot robot;
+  robot.motor(kLeft).SetEffort(100);
+  robot.motor(kRight).SetEffort(-100);
+  robot.Advance(500'000);
+  // Left forward, right back: a clockwise turn seen from above.
+  EXPECT_LT(robot.yaw_rate_dps(), 0);
+  EXPECT_LT(robot.yaw_degrees(), 0);
+  EXPECT_NEAR(robot.position_m(), 0, 1e-9);
+  EXPECT_NEAR(robot.pitch_degrees(), 0, 1e-9);
+}
+
+// Near upright, the linear model predicts the nonlinear model's
+// accelerations.
+TEST(BalancingRobot, LinearizationMatchesNearUpright) {
+  const RobotParams params;
+  const LinearModel model = BalancingRobot::Linearize(params);
+  BalancingRobot robot(params);
+  robot.Reset(0.5, 5);
+  robot.motor(kLeft).SetEffort(40);
+  robot.motor(kRight).SetEffort(40);
+
+  const double x[4] = {robot.pitch_degrees(), robot.pitch_rate_dps(),
+                       robot.wheel_degrees(kLeft),
+                       robot.wheel_rate_dps(kLeft)};
+  double dx[4];
+  for (int i = 0; i < 4; ++i) {
+    dx[i] = model.b[i] * 40;
+    for (int j = 0; j < 4; ++j) dx[i] += model.a[i][j] * x[j];
+  }
+  const BalancingRobot::Accelerations accel = robot.accelerations();
+  const double wheel_accel =
+      accel.forward / params.body.wheel_radius_m * kDegrees - accel.pitch;
+  EXPECT_EQ(dx[0], x[1]);
+  EXPECT_NEAR(dx[1], accel.pitch, std::abs(accel.pitch) * 0.01);
+  EXPECT_EQ(dx[2], x[3]);
+  EXPECT_NEAR(dx[3], wheel_accel, std::abs(wheel_accel) * 0.01);
+}
+
+}  // namespace
+}  // namespace sim
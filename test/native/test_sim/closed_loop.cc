@@ -0,0 +1,281 @@
+// Runs the robot's own controller code against the simulator.
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <optional>
+#include <string>
+
+#include "balance_gains.h"
+#include "balance_kalman.h"
+#include "balancing_robot.h"
+#include "complementary_filter.h"
+#include "feedback_motor.h"
+#include "magnet_sensor.h"
+#include "sim_imu.h"
+#include "state_feedback.h"
+
+namespace sim {
+namespace {
+
+constexpr uint32_t kPeriodUs = 1000;
+constexpr SQ15x16 kDtMs = 1;
+
+motor::FeedbackConfig BenchConfig() {
+  return {
+      .velocity = {.kp = 0.05,
+                   .ki = 0.02,
+                   .kd = 0,
+                   .output_min = -255,
+                   .output_max = 255},
+      .position = {.kp = 4,
+                   .ki = 0,
+                   .kd = 0,
+                   .output_min = -720,
+                   .output_max = 720},
+      .position_divider = 5,
+  };
+}
+
+class BenchTest : public ::testing::Test {
+ protected:
+  BenchTest() : robot_(BenchParams()), sensor_(&robot_, kLeft) {}
+
+  static RobotParams BenchParams() {
+    RobotParams params;
+    params.mount = RobotParams::kClamped;
+    return params;
+  }
+
+  void SetUp() override {
+    auto fm = motor::FeedbackMotor::Create(&robot_.motor(kLeft), &sensor_,
+                                           BenchConfig());
+    ASSERT_TRUE(fm.has_value()) << fm.error();
+    feedback_motor_.emplace(*std::move(fm));
+  }
+
+  void RunFor(double seconds) {
+    for (int i = 0; i < seconds * 1e6 / kPeriodUs; ++i) {
+      sensor_.Update();
+      feedback_motor_->Update(kDtMs);
+      robot_.Advance(kPeriodUs);
+    }
+  }
+
+  BalancingRobot robot_;
+  MagnetSensor sensor_;
+  std::optional<motor::FeedbackMotor> feedback_motor_;
+};
+
+TEST_F(BenchTest, FeedbackMotorHoldsSpeed) {
+  feedback_motor_->SetTargetSpeed(720);
+  RunFor(1);
+  const double start = robot_.wheel_degrees(kLeft);
+  RunFor(10);
+  EXPECT_NEAR((robot_.wheel_degrees(kLeft) - start) / 10, 720, 720 * 0.01);
+}
+
+TEST_F(BenchTest, FeedbackMotorReachesPosition) {
+  feedback_motor_->SetTargetPosition(1800);
+  RunFor(5);
+  EXPECT_NEAR(robot_.wheel_degrees(kLeft), 1800, 2);
+  RunFor(1);
+  EXPECT_NEAR(robot_.wheel_degrees(kLeft), 1800, 2);
+}
+
+// A hand-tuned state feedback balancer on the fixed-point filter and
+// sensors: pitch and pitch rate from the IMU, and the wheels' mean angle and
+// rate from the magnet sensors.
+class Balancer {
+ public:
+  explicit Balancer(BalancingRobot* robot)
+      : robot_(robot),
+        imu_(robot),
+        left_(robot, kLeft, {}, 2),
+        right_(robot, kRight, {}, 3) {}
+
+  void Step() {
+    left_.Update();
+    right_.Update();
+    filter_.Update(imu_.Read(), kDtMs);
+    const double wheel_angle =
+        (float{left_.angle()} + float{right_.angle()}) / 2;
+    const double wheel_rate = (float{left_.rate()} + float{right_.rate()}) / 2;
+    const double effort =
+        25 * float{filter_.pitch()} + 3 * float{filter_.pitch_rate()} +
+        0.2 * wheel_rate + 0.02 * wheel_angle;
+    const int duty = std::lround(std::clamp(effort, -255.0, 255.0));
+    robot_->motor(kLeft).SetEffort(duty);
+    robot_->motor(kRight).SetEffort(duty);
+    robot_->Advance(kPeriodUs);
+  }
+
+ private:
+  BalancingRobot* const robot_;
+  SimImu imu_;
+  MagnetSensor left_, right_;
+  orientation::ComplementaryFilter filter_{200};
+};
+
+TEST(ClosedLoop, RecoversFromATilt) {
+  BalancingRobot robot;
+  robot.Reset(8);
+  Balancer balancer(&robot);
+  for (int i = 0; i < 5'000; ++i) balancer.Step();
+  EXPECT_FALSE(robot.fallen());
+  EXPECT_NEAR(robot.pitch_degrees(), 0, 0.5);
+}
+
+// Twenty minutes of simulated balancing, to catch slow drifts and
+// overflows.
+TEST(ClosedLoop, BalancesForTwentyMinutes) {
+  BalancingRobot robot;
+  Balancer balancer(&robot);
+  double worst_pitch = 0;
+  for (int i = 0; i < 1'200'000; ++i) {
+    balancer.Step();
+    worst_pitch = std::max(worst_pitch, std::abs(robot.pitch_degrees()));
+  }
+  EXPECT_FALSE(robot.fallen());
+  EXPECT_LT(worst_pitch, 1);
+  EXPECT_NEAR(robot.position_m(), 0, 0.1);
+  EXPECT_EQ(robot.time_us(), 1'200'000'000u);
+}
+
+// The same sensors and filter as Balancer, with the LQR gains designed by
+// tools/lqr_gains from the linearized model in intpid::StateFeedback.
+class LqrBalancer {
+ public:
+  explicit LqrBalancer(BalancingRobot* robot)
+      : robot_(robot),
+        imu_(robot),
+        left_(robot, kLeft, {}, 2),
+        right_(robot, kRight, {}, 3),
+        controller_(*intpid::StateFeedback<4>::Create(kBalanceGains)) {}
+
+  void Step() {
+    left_.Update();
+    right_.Update();
+    filter_.Update(imu_.Read(), kDtMs);
+    const std::array<SQ15x16, 4> state = {
+        filter_.pitch(), filter_.pitch_rate(),
+        (left_.angle() + right_.angle()) / 2,
+        (left_.rate() + right_.rate()) / 2};
+    const int effort = controller_.Update(state).getInteger();
+    robot_->motor(kLeft).SetEffort(effort);
+    robot_->motor(kRight).SetEffort(effort);
+    robot_->Advance(kPeriodUs);
+  }
+
+ private:
+  BalancingRobot* const robot_;
+  SimImu imu_;
+  MagnetSensor left_, right_;
+  orientation::ComplementaryFilter filter_{200};
+  intpid::StateFeedback<4> controller_;
+};
+
+TEST(ClosedLoop, LqrRecoversFromATilt) {
+  BalancingRobot robot;
+  robot.Reset(8);
+  LqrBalancer balancer(&robot);
+  for (int i = 0; i < 5'000; ++i) balancer.Step();
+  EXPECT_FALSE(robot.fallen());
+  EXPECT_NEAR(robot.pitch_degrees(), 0, 0.5);
+  // Unlike Balancer, it also drives back to where it started.
+  EXPECT_NEAR(robot.position_m(), 0, 0.05);
+}
+
+TEST(ClosedLoop, LqrBalancesForTwentyMinutes) {
+  BalancingRobot robot;
+  LqrBalancer balancer(&robot);
+  double worst_pitch = 0;
+  for (int i = 0; i < 1'200'000; ++i) {
+    balancer.Step();
+    worst_pitch = std::max(worst_pitch, std::abs(robot.pitch_degrees()));
+  }
+  EXPECT_FALSE(robot.fallen());
+  EXPECT_LT(worst_pitch, 1);
+  EXPECT_NEAR(robot.position_m(), 0, 0.1);
+}
+
+// LqrBalancer with BalanceKalman in place of the complementary filter and
+// the sensors' own wheel rates, and a biased gyro.
+class KalmanBalancer {
+ public:
+  explicit KalmanBalancer(BalancingRobot* robot)
+      : robot_(robot),
+        imu_(robot, {.gyro_bias = 1.5}),
+        left_(robot, kLeft, {}, 2),
+        right_(robot, kRight, {}, 3),
+        controller_(*intpid::StateFeedback<4>::Create(kBalanceGains)) {}
+
+  void Step() {
+    left_.Update();
+    right_.Update();
+    filter_.Update(imu_.Read(), (left_.angle() + right_.angle()) / 2, kDtMs);
+    const int effort = controller_.Update(filter_.balance_state()).getInteger();
+    robot_->motor(kLeft).SetEffort(effort);
+    robot_->motor(kRight).SetEffort(effort);
+    robot_->Advance(kPeriodUs);
+  }
+
+  const orientation::BalanceKalman& filter() const { return filter_; }
+
+ private:
+  BalancingRobot* const robot_;
+  SimImu imu_;
+  MagnetSensor left_, right_;
+  orientation::BalanceKalman filter_;
+  intpid::StateFeedback<4> controller_;
+};
+
+// The estimate, taken before each Advance, against the simulator's truth at
+// that moment, once it has recovered from a tilt. During the recovery the
+// accelerometer also sees the chassis accelerate, which pulls the pitch and
+// bias off by several tenths of a degree for the first few seconds.
+TEST(ClosedLoop, KalmanTracksTheRobot) {
+  BalancingRobot robot;
+  robot.Reset(8);
+  KalmanBalancer balancer(&robot);
+  double worst_pitch_error = 0, worst_rate_error = 0;
+  double worst_wheel_error = 0, worst_wheel_rate_error = 0;
+  for (int i = 0; i < 15'000; ++i) {
+    const double pitch = robot.pitch_degrees();
+    const double rate = robot.pitch_rate_dps();
+    const double wheel =
+        (robot.wheel_degrees(kLeft) + robot.wheel_degrees(kRight)) / 2;
+    const double wheel_rate =
+        (robot.wheel_rate_dps(kLeft) + robot.wheel_rate_dps(kRight)) / 2;
+    balancer.Step();
+    if (i < 5'000) continue;
+    const auto& f = balancer.filter();
+    worst_pitch_error =
+        std::max(worst_pitch_error, std::abs(float{f.pitch()} - pitch));
+    worst_rate_error =
+        std::max(worst_rate_error, std::abs(float{f.pitch_rate()} - rate));
+    worst_wheel_error =
+        std::max(worst_wheel_error, std::abs(float{f.wheel_angle()} - wheel));
+    worst_wheel_rate_error = std::max(
+        worst_wheel_rate_error, std::abs(float{f.wheel_rate()} - wheel_rate));
+  }
+  EXPECT_FALSE(robot.fallen());
+  EXPECT_NEAR(robot.pitch_degrees(), 0, 0.5);
+  EXPECT_NEAR(robot.position_m(), 0, 0.05);
+  EXPECT_NEAR(float{balancer.filter().gyro_bias()}, 1.5, 0.25);
+  RecordProperty("worst_pitch_error", std::to_string(worst_pitch_error));
+  RecordProperty("worst_rate_error", std::to_string(worst_rate_error));
+  RecordProperty("worst_wheel_error", std::to_string(worst_wheel_error));
+  RecordProperty("worst_wheel_rate_error",
+                 std::to_string(worst_wheel_rate_error));
+  EXPECT_LT(worst_pitch_error, 0.5);
+  EXPECT_LT(worst_rate_error, 0.5);
+  EXPECT_LT(worst_wheel_error, 0.25);
+  EXPECT_LT(worst_wheel_rate_error, 40);
+}
+
+}  // namespace
+}  // namespace sim
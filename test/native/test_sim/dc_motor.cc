@@ -0,0 +1,78 @@
+#include "dc_motor.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace sim {
+namespace {
+
+constexpr DcMotorParams kParams;
+// Output torque per amp, and the motor's electrical damping at the output.
+constexpr double kGain = kParams.torque_constant * kParams.gear_ratio;
+constexpr double kShortedDamping = kGain * kGain / kParams.resistance_ohms;
+
+TEST(DcMotor, StartsCoasting) {
+  DcMotor motor;
+  EXPECT_EQ(motor.Current(10), 0);
+  EXPECT_DOUBLE_EQ(motor.Torque(10), -kParams.viscous_friction * 10);
+}
+
+TEST(DcMotor, FullEffortGivesStallTorque) {
+  DcMotor motor;
+  motor.SetEffort(255);
+  EXPECT_DOUBLE_EQ(motor.volts(), kParams.supply_volts);
+  EXPECT_DOUBLE_EQ(motor.Torque(0),
+                   kGain * kParams.supply_volts / kParams.resistance_ohms);
+}
+
+TEST(DcMotor, NegativeEffortReverses) {
+  DcMotor motor;
+  motor.SetEffort(-51);
+  EXPECT_DOUBLE_EQ(motor.volts(), -kParams.supply_volts / 5);
+  EXPECT_LT(motor.Torque(0), 0);
+}
+
+TEST(DcMotor, BackEmfReducesTorque) {
+  DcMotor motor;
+  motor.SetEffort(255);
+  const double free_speed = kParams.supply_volts / kGain;
+  EXPECT_NEAR(motor.Current(free_speed), 0, 1e-12);
+  EXPECT_LT(motor.Torque(free_speed / 2), motor.Torque(0));
+}
+
+TEST(DcMotor, DutyIsClamped) {
+  DcMotor motor;
+  motor.SetDirection(motor::kClockwise);
+  motor.SetDuty(1000);
+  EXPECT_DOUBLE_EQ(motor.volts(), kParams.supply_volts);
+  motor.SetDuty(-5);
+  EXPECT_EQ(motor.volts(), 0);
+}
+
+TEST(DcMotor, BrakeShortsTheWinding) {
+  DcMotor motor;
+  motor.SetEffort(200);
+  motor.Stop(motor::kBrake);
+  EXPECT_EQ(motor.volts(), 0);
+  EXPECT_DOUBLE_EQ(motor.Torque(10),
+                   -(kShortedDamping + kParams.viscous_friction) * 10);
+}
+
+TEST(DcMotor, ZeroDutyWhileDrivingBrakes) {
+  DcMotor motor;
+  motor.SetEffort(0);
+  DcMotor braked;
+  braked.Stop(motor::kBrake);
+  EXPECT_DOUBLE_EQ(motor.Torque(10), braked.Torque(10));
+}
+
+TEST(DcMotor, CoastAfterDrivingOpensTheWinding) {
+  DcMotor motor;
+  motor.SetEffort(-200);
+  motor.Stop(motor::kCoast);
+  EXPECT_EQ(motor.Current(-10), 0);
+  EXPECT_DOUBLE_EQ(motor.Torque(-10), kParams.viscous_friction * 10);
+}
+
+}  // namespace
+}  // namespace sim
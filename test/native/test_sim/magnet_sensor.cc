@@ -0,0 +1,98 @@
+#include "magnet_sensor.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "balancing_robot.h"
+
+namespace sim {
+namespace {
+
+// The wheels turn freely on the bench, so a test can spin one at a steady
+// speed.
+RobotParams Bench() {
+  RobotParams params;
+  params.mount = RobotParams::kClamped;
+  return params;
+}
+
+constexpr MagnetSensorParams kExact = {.resolution_degrees = 0,
+                                       .noise_degrees = 0,
+                                       .conversion_period_us = 1000};
+
+TEST(MagnetSensor, TracksTheWheelOverManyTurns) {
+  BalancingRobot robot(Bench());
+  MagnetSensor sensor(&robot, kRight, kExact);
+  robot.motor(kRight).SetEffort(150);
+  for (int i = 0; i < 3000; ++i) {
+    sensor.Update();
+    robot.Advance(1000);
+  }
+  sensor.Update();
+  ASSERT_GT(robot.wheel_degrees(kRight), 3 * 360);
+  EXPECT_NEAR(float{sensor.angle()}, robot.wheel_degrees(kRight), 0.01);
+  EXPECT_NEAR(float{sensor.rate()}, robot.wheel_rate_dps(kRight), 1);
+}
+
+TEST(MagnetSensor, QuantizesTheReading) {
+  BalancingRobot robot(Bench());
+  MagnetSensor sensor(&robot, kLeft,
+                      {.resolution_degrees = 2, .noise_degrees = 0});
+  robot.motor(kLeft).SetEffort(20);
+  for (int i = 0; i < 500; ++i) {
+    sensor.Update();
+    const double angle = float{sensor.angle()};
+    ASSERT_EQ(angle, 2 * std::round(angle / 2));
+    ASSERT_NEAR(angle, robot.wheel_degrees(kLeft) - 1, 1);
+    robot.Advance(1000);
+  }
+}
+
+TEST(MagnetSensor, WaitsForTheNextConversion) {
+  BalancingRobot robot(Bench());
+  MagnetSensor sensor(&robot, kLeft, kExact);
+  EXPECT_TRUE(sensor.Update());
+  EXPECT_FALSE(sensor.Update());
+  robot.Advance(999);
+  EXPECT_FALSE(sensor.Update());
+  robot.Advance(1);
+  EXPECT_TRUE(sensor.Update());
+}
+
+TEST(MagnetSensor, NoiseHasTheConfiguredSpread) {
+  BalancingRobot robot(Bench());
+  MagnetSensor sensor(&robot, kLeft,
+                      {.resolution_degrees = 0.001,
+                       .noise_degrees = 0.5,
+                       .conversion_period_us = 0});
+  constexpr int kSamples = 10'000;
+  double sum = 0, sum_squares = 0;
+  for (int i = 0; i < kSamples; ++i) {
+    sensor.Update();
+    const double angle = float{sensor.angle()};
+    sum += angle;
+    sum_squares += angle * angle;
+  }
+  const double mean = sum / kSamples;
+  EXPECT_NEAR(mean, 0, 0.02);
+  EXPECT_NEAR(std::sqrt(sum_squares / kSamples - mean * mean), 0.5, 0.02);
+}
+
+TEST(MagnetSensor, SameSeedGivesTheSameReadings) {
+  BalancingRobot robot(Bench());
+  MagnetSensor a(&robot, kLeft, {}, 7);
+  MagnetSensor b(&robot, kLeft, {}, 7);
+  robot.motor(kLeft).SetEffort(80);
+  for (int i = 0; i < 100; ++i) {
+    a.Update();
+    b.Update();
+    ASSERT_EQ(a.angle(), b.angle());
+    ASSERT_EQ(a.rate(), b.rate());
+    robot.Advance(1000);
+  }
+}
+
+}  // namespace
+}  // namespace sim
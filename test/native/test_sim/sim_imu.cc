@@ -0,0 +1,49 @@
+#include "sim_imu.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <numbers>
+
+#include "balancing_robot.h"
+
+namespace sim {
+namespace {
+
+constexpr ImuParams kExact = {.accel_noise = 0, .gyro_noise = 0};
+
+TEST(SimImu, SeesGravityAtRest) {
+  BalancingRobot robot;
+  SimImu imu(&robot, kExact);
+  const orientation::ImuSample sample = imu.Read();
+  EXPECT_NEAR(float{sample.accel_x}, 0, 1e-4);
+  EXPECT_NEAR(float{sample.accel_z}, 9.81, 1e-4);
+  EXPECT_EQ(sample.gyro_y, 0);
+}
+
+TEST(SimImu, GyroFollowsThePitchRate) {
+  BalancingRobot robot;
+  SimImu imu(&robot, {.accel_noise = 0, .gyro_noise = 0, .gyro_bias = 1.5});
+  robot.Reset(2);
+  robot.Advance(200'000);
+  ASSERT_GT(robot.pitch_rate_dps(), 10);
+  EXPECT_NEAR(float{imu.Read().gyro_y}, robot.pitch_rate_dps() + 1.5, 1e-3);
+}
+
+// In free fall about the axle, the accelerometer no longer sees the tilt
+// cleanly: the chassis' own acceleration adds to gravity.
+TEST(SimImu, AccelerometerSeesTheChassisAcceleration) {
+  BalancingRobot robot;
+  SimImu imu(&robot, kExact);
+  robot.motor(kLeft).SetEffort(255);
+  robot.motor(kRight).SetEffort(255);
+  const orientation::ImuSample sample = imu.Read();
+  const BalancingRobot::Accelerations accel = robot.accelerations();
+  const double expected =
+      accel.forward + kExact.height_m * accel.pitch * std::numbers::pi / 180;
+  EXPECT_NEAR(float{sample.accel_x}, expected, 1e-3);
+  EXPECT_NE(float{sample.accel_x}, 0);
+}
+
+}  // namespace
+}  // namespace sim
@@ -0,0 +1,169 @@
+#include "log_format.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "log_export.h"
+#include "log_reader.h"
+#include "log_writer.h"
+
+namespace telemetry {
+namespace {
+
+constexpr ChannelInfo kChannels[] = {{0, "angle"}, {1, "speed"}};
+
+// Encodes the records as a complete log, one frame per frame_size bytes.
+std::vector<uint8_t> Encode(const std::vector<Record>& records,
+                            size_t frame_size = 256) {
+  std::vector<uint8_t> log(64);
+  log.resize(EncodeHeader(1'000'000, kChannels, log));
+  std::vector<uint8_t> buffer(frame_size);
+  FrameEncoder encoder(buffer);
+  auto append = [&](std::span<const uint8_t> frame) {
+    log.insert(log.end(), frame.begin(), frame.end());
+  };
+  for (const Record& r : records) {
+    if (!encoder.Add(r)) {
+      append(encoder.Finish());
+      EXPECT_TRUE(encoder.Add(r));
+    }
+  }
+  append(encoder.Finish());
+  return log;
+}
+
+std::vector<Sample> Decode(std::span<const uint8_t> log,
+                           size_t* corrupt = nullptr) {
+  auto reader = LogReader::Parse(log);
+  EXPECT_TRUE(reader.has_value()) << reader.error();
+  std::vector<Sample> samples;
+  reader->ForEach([&](const Sample& s) { samples.push_back(s); });
+  if (corrupt != nullptr) *corrupt = reader->corrupt_frames();
+  return samples;
+}
+
+std::vector<Record> TestRecords(int n, uint32_t start = 0) {
+  std::vector<Record> records;
+  for (int i = 0; i < n; ++i) {
+    records.push_back(Record::Make(start + i * 1000, i % 2,
+                                   SQ15x16::fromInternal(i * 7919 - 50'000)));
+  }
+  return records;
+}
+
+TEST(LogFormat, Varint) {
+  for (uint32_t v : {0u, 1u, 127u, 128u, 300u, 0xffffffffu}) {
+    uint8_t buf[kMaxVarintSize];
+    const size_t n = PutVarint(v, buf);
+    const uint8_t* p = buf;
+    uint32_t got;
+    ASSERT_TRUE(GetVarint(p, buf + n, got));
+    EXPECT_EQ(got, v);
+    EXPECT_EQ(p, buf + n);
+  }
+}
+
+TEST(LogFormat, HeaderRoundTrip) {
+  const auto log = Encode({});
+  auto reader = LogReader::Parse(log);
+  ASSERT_TRUE(reader.has_value());
+  EXPECT_EQ(reader->ticks_per_second(), 1'000'000);
+  ASSERT_EQ(reader->channels().size(), 2);
+  EXPECT_EQ(reader->ChannelNameOf(1), "speed");
+  EXPECT_EQ(reader->ChannelNameOf(9), "");
+}
+
+TEST(LogFormat, RecordsRoundTripAcrossFrames) {
+  const auto records = TestRecords(1000);
+  const auto log = Encode(records, 64);
+  // A steady stream costs well under the 12 bytes of a raw Record.
+  EXPECT_LT(log.size(), records.size() * 9);
+  size_t corrupt;
+  const auto samples = Decode(log, &corrupt);
+  EXPECT_EQ(corrupt, 0);
+  ASSERT_EQ(samples.size(), records.size());
+  for (size_t i = 0; i < records.size(); ++i) {
+    EXPECT_EQ(samples[i].timestamp, records[i].timestamp);
+    EXPECT_EQ(samples[i].channel, records[i].channel);
+    EXPECT_EQ(samples[i].raw_value, records[i].raw_value);
+  }
+}
+
+TEST(LogFormat, TimestampsExtendPastWrap) {
+  const auto samples = Decode(Encode(TestRecords(100, 0xffff0000u), 64));
+  ASSERT_EQ(samples.size(), 100);
+  EXPECT_EQ(samples.back().timestamp, uint64_t{0xffff0000u} + 99 * 1000);
+}
+
+TEST(LogFormat, SkipsCorruptAndTruncatedFrames) {
+  auto log = Encode(TestRecords(100), 64);
+  const size_t header_size = Encode({}).size();
+  // Damage a byte inside the first frame's payload and cut the last frame.
+  log[header_size + kFrameHeaderSize + 2] ^= 0x40;
+  log.resize(log.size() - 3);
+  size_t corrupt;
+  const auto samples = Decode(log, &corrupt);
+  EXPECT_EQ(corrupt, 2);
+  EXPECT_LT(samples.size(), 100);
+  EXPECT_GT(samples.size(), 80);
+  for (size_t i = 1; i < samples.size(); ++i) {
+    EXPECT_GT(samples[i].timestamp, samples[i - 1].timestamp);
+  }
+}
+
+// A capture that starts mid-stream, with the header repeated between frames
+// as the firmware does.
+TEST(LogFormat, SyncsOnARepeatedHeader) {
+  const std::vector<uint8_t> header = Encode({});
+  const std::vector<uint8_t> first = Encode(TestRecords(10));
+  const std::vector<uint8_t> second = Encode(TestRecords(10, 100'000));
+  const std::vector<uint8_t> third = Encode(TestRecords(10, 200'000));
+  std::vector<uint8_t> capture(first.begin() + header.size() + 5, first.end());
+  capture.insert(capture.end(), second.begin(), second.end());
+  capture.insert(capture.end(), third.begin(), third.end());
+
+  size_t corrupt;
+  const auto samples = Decode(capture, &corrupt);
+  EXPECT_EQ(corrupt, 0);
+  ASSERT_EQ(samples.size(), 20);
+  EXPECT_EQ(samples[0].timestamp, 100'000);
+  EXPECT_EQ(samples[10].timestamp, 200'000);
+
+  EXPECT_FALSE(LogReader::Parse(std::span(first).subspan(1)).has_value());
+}
+
+TEST(LogFormat, WriterAndExport) {
+  const std::string path = testing::TempDir() + "log_format_test.tlog";
+  {
+    auto writer = LogWriter::Open(path, 1000, kChannels);
+    ASSERT_TRUE(writer.has_value()) << writer.error();
+    for (int i = 0; i < 3; ++i) {
+      (*writer)->Write(i * 500, 0, SQ15x16(i));
+      (*writer)->Write(i * 500, 1, SQ15x16(i * 2));
+    }
+  }
+  auto file = MappedFile::Open(path);
+  ASSERT_TRUE(file.has_value()) << file.error();
+  auto reader = LogReader::Parse(file->data());
+  ASSERT_TRUE(reader.has_value());
+
+  char* text = nullptr;
+  size_t size = 0;
+  FILE* out = open_memstream(&text, &size);
+  WriteWideCsv(*reader, out);
+  fclose(out);
+  EXPECT_EQ(std::string(text, size),
+            "t,angle,speed\n"
+            "0.000000,0.00000,0.00000\n"
+            "0.500000,1.00000,2.00000\n"
+            "1.000000,2.00000,4.00000\n");
+  free(text);
+}
+
+}  // namespace
+}  // namespace telemetry
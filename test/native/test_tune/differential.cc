@@ -0,0 +1,130 @@
+#include "differential.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdlib>
+
+namespace tune {
+namespace {
+
+// How many random cases the property test runs. Set PID_DIFF_CASES to fuzz
+// with more.
+int CaseCount() {
+  const char* count = std::getenv("PID_DIFF_CASES");
+  return count != nullptr ? std::atoi(count) : 100;
+}
+
+// True if every nonzero gain has at least 8 significant bits in SQ15x16.
+// Below that the gain itself is too coarse for the comparison to mean much.
+bool GainsArePrecise(const intpid::Config& config) {
+  for (const float gain : {config.kp, config.ki, config.kd}) {
+    if (gain != 0 && std::abs(gain) < 1.f / (1 << 8)) return false;
+  }
+  return true;
+}
+
+DifferentialCase LagCase() {
+  return {.config = {.kp = 2,
+                     .ki = .5,
+                     .kd = 1,
+                     .output_min = -100,
+                     .output_max = 100},
+          .plant = {.kind = PlantParams::kLag, .gain = 1, .tau = 20},
+          .profile = {{10, 500}, {-20, 500}, {5, 500}},
+          .dt = 1,
+          .scale = 20,
+          .limit_cycle_band = .2};
+}
+
+TEST(Differential, ExactGainsTrackTheReference) {
+  const DifferentialReport report = RunDifferential(LagCase());
+  // The gains and dt are exact in SQ15x16, so all that differs is the
+  // rounding of the measurements and of the integrator's steps.
+  EXPECT_LT(report.max_output_divergence, 1e-2);
+  EXPECT_LT(report.max_tracking_divergence, 1e-3);
+  EXPECT_FALSE(report.limit_cycle);
+  EXPECT_EQ(report.output_range, 200);
+}
+
+// The property test: inside the range the fixed point Pid is meant for,
+// it controls every random plant as well as double does. Outside it (see
+// the Flags tests below), it does not, and the harness says so.
+TEST(Differential, AgreesWithTheReferenceInRange) {
+  const CaseRanges ranges = {.min_scale = 1,
+                             .max_scale = 1000,
+                             .min_limit = 10,
+                             .max_limit = 10000,
+                             .periods = {1, .01}};
+  const int cases = CaseCount();
+  int checked = 0;
+  for (int seed = 1; seed <= cases; ++seed) {
+    const DifferentialCase c = RandomDifferentialCase(seed, ranges);
+    if (!GainsArePrecise(c.config)) continue;
+    ++checked;
+    const DifferentialReport report = RunDifferential(c);
+    EXPECT_LT(report.rms_tracking_divergence, .05 * c.scale) << Describe(c);
+    EXPECT_LT(report.rms_output_divergence, .05 * report.output_range)
+        << Describe(c);
+    EXPECT_FALSE(report.limit_cycle) << Describe(c);
+  }
+  EXPECT_GT(checked, cases * 3 / 4);
+}
+
+// An integral gain of 2.9e-5 is 1.9 in SQ15x16's last place, which holds
+// only 1 of it, so the fixed point integrator runs at half speed.
+TEST(Differential, FlagsAnIntegralGainTooCoarseForFixedPoint) {
+  DifferentialCase c = LagCase();
+  c.config.ki = 2.9e-5;
+  c.config.kd = 0;
+  c.config.kp = 0;
+  c.plant.gain = 50;
+  c.plant.tau = 100;
+  c.profile = {{10, 20000}, {-10, 20000}};
+  const DifferentialReport report = RunDifferential(c);
+  EXPECT_GT(report.rms_tracking_divergence, .05 * c.scale);
+}
+
+// Updates of a millisecond with a small measurement scale: err * dt keeps
+// only a few bits, and the loops part ways.
+TEST(Differential, FlagsALossOfPrecisionInErrTimesDt) {
+  int diverged = 0;
+  for (int seed = 1; seed <= 20; ++seed) {
+    const DifferentialCase c = RandomDifferentialCase(
+        seed, {.min_scale = .1, .max_scale = .2, .periods = {.001}});
+    const DifferentialReport report = RunDifferential(c);
+    if (report.rms_tracking_divergence > .05 * c.scale ||
+        report.limit_cycle) {
+      ++diverged;
+    }
+  }
+  EXPECT_GE(diverged, 3);
+}
+
+TEST(Differential, RejectedConfigsDivergeInfinitely) {
+  DifferentialCase c = LagCase();
+  c.config.derivative_filter = -1;
+  const DifferentialReport report = RunDifferential(c);
+  EXPECT_TRUE(std::isinf(report.max_output_divergence));
+  EXPECT_TRUE(std::isinf(report.rms_tracking_divergence));
+}
+
+TEST(Differential, RandomCasesAreReproducible) {
+  const DifferentialCase a = RandomDifferentialCase(42);
+  const DifferentialCase b = RandomDifferentialCase(42);
+  EXPECT_EQ(Describe(a), Describe(b));
+  EXPECT_EQ(RunDifferential(a).rms_output_divergence,
+            RunDifferential(b).rms_output_divergence);
+  EXPECT_NE(Describe(a), Describe(RandomDifferentialCase(43)));
+}
+
+TEST(Differential, MeasuresUpdateCost) {
+  const UpdateCost cost = MeasureUpdateCost(LagCase().config, 10'000);
+  EXPECT_GT(cost.fixed_ns, 0);
+  EXPECT_GT(cost.reference_ns, 0);
+  EXPECT_GE(cost.fixed_cycles, 0);
+}
+
+}  // namespace
+}  // namespace tune
@@ -0,0 +1,93 @@
+#include "lqr.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+namespace tune {
+namespace {
+
+void ExpectNear(const Matrix& actual, const Matrix& expected, double error) {
+  ASSERT_EQ(actual.rows(), expected.rows());
+  ASSERT_EQ(actual.cols(), expected.cols());
+  for (int r = 0; r < actual.rows(); ++r) {
+    for (int c = 0; c < actual.cols(); ++c) {
+      EXPECT_NEAR(actual(r, c), expected(r, c), error) << r << ", " << c;
+    }
+  }
+}
+
+// A double integrator: position and velocity, driven by acceleration.
+const Matrix kDoubleIntegratorA = {{0, 1}, {0, 0}};
+const Matrix kDoubleIntegratorB = {{0}, {1}};
+
+TEST(Lqr, Inverse) {
+  const Matrix m = {{4, 7}, {2, 6}};
+  const auto inverse = Inverse(m);
+  ASSERT_TRUE(inverse.has_value()) << inverse.error();
+  ExpectNear(*inverse, {{.6, -.7}, {-.2, .4}}, 1e-12);
+  ExpectNear(m * *inverse, Matrix::Identity(2), 1e-12);
+  EXPECT_FALSE(Inverse({{1, 2}, {2, 4}}).has_value());
+}
+
+TEST(Lqr, Exp) {
+  ExpectNear(Exp(Matrix::Diagonal({1, -2})),
+             Matrix::Diagonal({std::exp(1), std::exp(-2)}), 1e-12);
+  // The generator of a rotation by 3 radians.
+  ExpectNear(Exp({{0, -3}, {3, 0}}),
+             {{std::cos(3), -std::sin(3)}, {std::sin(3), std::cos(3)}},
+             1e-12);
+}
+
+TEST(Lqr, DiscretizesWithAZeroOrderHold) {
+  const DiscreteModel model =
+      Discretize(kDoubleIntegratorA, kDoubleIntegratorB, .1);
+  ExpectNear(model.a, {{1, .1}, {0, 1}}, 1e-15);
+  ExpectNear(model.b, {{.005}, {.1}}, 1e-15);
+}
+
+TEST(Lqr, SolvesTheScalarRiccatiEquation) {
+  // p = q + a^2 p - a^2 b^2 p^2 / (r + b^2 p) with a = 2 and b = q = r = 1
+  // is p^2 - 4 p - 1 = 0.
+  const auto p = SolveDare({{{2}}, {{1}}}, {{1}}, {{1}});
+  ASSERT_TRUE(p.has_value()) << p.error();
+  EXPECT_NEAR((*p)(0, 0), 2 + std::sqrt(5), 1e-12);
+}
+
+TEST(Lqr, StabilizesADoubleIntegrator) {
+  const DiscreteModel model =
+      Discretize(kDoubleIntegratorA, kDoubleIntegratorB, .01);
+  const Matrix q = Matrix::Diagonal({1, .1});
+  const Matrix r = {{.01}};
+  const auto p = SolveDare(model, q, r);
+  ASSERT_TRUE(p.has_value()) << p.error();
+  // P solves the equation.
+  const Matrix at = model.a.Transposed(), bt = model.b.Transposed();
+  const Matrix residual =
+      at * *p * model.a -
+      at * *p * model.b * *Inverse(r + bt * *p * model.b) * bt * *p * model.a +
+      q - *p;
+  EXPECT_LT(residual.Norm(), 1e-9 * p->Norm());
+
+  const auto k = LqrGain(model, q, r);
+  ASSERT_TRUE(k.has_value()) << k.error();
+  EXPECT_GT((*k)(0, 0), 0);
+  EXPECT_GT((*k)(0, 1), 0);
+  EXPECT_LT(SpectralRadius(ClosedLoop(model, *k)), 1);
+}
+
+TEST(Lqr, RejectsAnUncontrollableModel) {
+  // The first state grows and the input cannot reach it.
+  const DiscreteModel model = {Matrix::Diagonal({2, 1}), {{0}, {1}}};
+  EXPECT_FALSE(LqrGain(model, Matrix::Identity(2), {{1}}).has_value());
+}
+
+TEST(Lqr, SpectralRadius) {
+  EXPECT_NEAR(SpectralRadius({{.5, 1}, {0, .9}}), .9, 1e-6);
+  EXPECT_NEAR(SpectralRadius({{0, -1.5}, {1.5, 0}}), 1.5, 1e-6);
+  EXPECT_EQ(SpectralRadius({{0, 1}, {0, 0}}), 0);
+}
+
+}  // namespace
+}  // namespace tune
@@ -0,0 +1,82 @@
+#include "metrics.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+
+namespace tune {
+namespace {
+
+TEST(MetricsRecorder, IntegratesError) {
+  MetricsRecorder recorder(0.5);
+  recorder.Add(2, 10, 7, false);
+  recorder.Add(1, 10, 11, false);
+  const Metrics& m = recorder.metrics();
+  EXPECT_DOUBLE_EQ(m.ise, 2 * 9 + 1 * 1);
+  EXPECT_DOUBLE_EQ(m.iae, 2 * 3 + 1 * 1);
+  EXPECT_DOUBLE_EQ(m.duration, 3);
+}
+
+TEST(MetricsRecorder, OvershootIsPastTheSetpoint) {
+  MetricsRecorder recorder(0.5);
+  // Approached from below, so only going above counts.
+  recorder.Add(1, 10, 0, false);
+  recorder.Add(1, 10, 12, false);
+  recorder.Add(1, 10, 9, false);
+  EXPECT_DOUBLE_EQ(recorder.metrics().overshoot, 2);
+
+  // A step down is approached from above.
+  recorder.Add(1, -10, 9, false);
+  recorder.Add(1, -10, -13, false);
+  EXPECT_DOUBLE_EQ(recorder.metrics().overshoot, 3);
+}
+
+TEST(MetricsRecorder, SettlingTimeIsSummedOverSteps) {
+  MetricsRecorder recorder(1);
+  recorder.Add(1, 10, 0, false);
+  recorder.Add(1, 10, 5, false);
+  recorder.Add(1, 10, 9.5, false);
+  recorder.Add(1, 10, 11.5, false);  // Leaves the band again.
+  recorder.Add(1, 10, 10, false);
+  EXPECT_DOUBLE_EQ(recorder.metrics().settling_time, 4);
+
+  recorder.Add(1, 0, 10, false);
+  recorder.Add(1, 0, 0, false);
+  recorder.Add(1, 0, 0, false);
+  EXPECT_DOUBLE_EQ(recorder.metrics().settling_time, 4 + 1);
+}
+
+TEST(MetricsRecorder, CountsSaturatedTime) {
+  MetricsRecorder recorder(1);
+  recorder.Add(2, 10, 0, true);
+  recorder.Add(3, 10, 5, false);
+  recorder.Add(4, 10, 9, true);
+  EXPECT_DOUBLE_EQ(recorder.metrics().saturated_time, 6);
+}
+
+TEST(Cost, IsTheWeightedSum) {
+  const Metrics m = {.ise = 1,
+                     .iae = 2,
+                     .overshoot = 3,
+                     .settling_time = 4,
+                     .saturated_time = 5};
+  EXPECT_DOUBLE_EQ(Cost(m, {}), 1);
+  EXPECT_DOUBLE_EQ(Cost(m, {.ise = 1,
+                            .iae = 10,
+                            .overshoot = 100,
+                            .settling_time = 1000,
+                            .saturated_time = 10000}),
+                   54321);
+}
+
+TEST(Cost, DivergedRunsCostInfinity) {
+  MetricsRecorder recorder(1);
+  recorder.Add(1, 10, std::numeric_limits<double>::quiet_NaN(), false);
+  EXPECT_EQ(Cost(recorder.metrics(), {.ise = 0, .overshoot = 1}),
+            std::numeric_limits<double>::infinity());
+}
+
+}  // namespace
+}  // namespace tune
@@ -0,0 +1,165 @@
+#include "search.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cmath>
+#include <set>
+
+#include "scenario.h"
+
+namespace tune {
+namespace {
+
+constexpr intpid::Config kBase = {
+    .kp = 1, .ki = 0.1, .kd = 0, .output_min = -100, .output_max = 100};
+
+// A cost bowl with its minimum at kp = 4, ki = 0.02, kd = 0.5, and some
+// bookkeeping about how it was called.
+class BowlScenario : public Scenario {
+ public:
+  std::string_view name() const override { return "bowl"; }
+  intpid::Config base_config() const override { return kBase; }
+
+  Metrics Run(const intpid::Config& config) const override {
+    ++runs;
+    const double kp = std::log10(config.kp / 4);
+    const double ki = std::log10(config.ki / 0.02);
+    const double kd = config.kd - 0.5;
+    return {.ise = kp * kp + ki * ki + kd * kd,
+            .saturated_time = config.output_max};
+  }
+
+  mutable std::atomic<int> runs = 0;
+};
+
+constexpr SearchSpace kSpace = {.kp = {0.01, 100},
+                                .ki = {0.0001, 1},
+                                .kd = {0, 2}};
+
+TEST(Search, ValidatesRanges) {
+  EXPECT_TRUE(Validate(kSpace).has_value());
+  EXPECT_FALSE(Validate({.kp = {2, 1}, .ki = {0, 1}, .kd = {0, 1}}));
+  EXPECT_FALSE(Validate({.kp = {-1, 1}, .ki = {0, 1}, .kd = {0, 1}}));
+}
+
+TEST(Search, GridCoversEveryCombination) {
+  const auto configs = GridConfigs(kSpace, kBase, 5);
+  ASSERT_EQ(configs.size(), 5 * 5 * 5);
+  std::set<float> kps;
+  for (const intpid::Config& c : configs) {
+    kps.insert(c.kp);
+    EXPECT_EQ(c.output_min, kBase.output_min);
+    EXPECT_EQ(c.output_max, kBase.output_max);
+  }
+  // Log spaced: one point per decade.
+  EXPECT_THAT(kps, testing::ElementsAre(testing::FloatEq(0.01),
+                                        testing::FloatEq(0.1),
+                                        testing::FloatEq(1),
+                                        testing::FloatEq(10),
+                                        testing::FloatEq(100)));
+}
+
+TEST(Search, GridHoldsFixedGains) {
+  const auto configs =
+      GridConfigs({.kp = {0.01, 100}, .ki = {0.5, 0.5}, .kd = {0, 0}},
+                  kBase, 7);
+  ASSERT_EQ(configs.size(), 7);
+  for (const intpid::Config& c : configs) {
+    EXPECT_EQ(c.ki, 0.5f);
+    EXPECT_EQ(c.kd, 0);
+  }
+}
+
+TEST(Search, RandomIsReproducibleAndInRange) {
+  const auto a = RandomConfigs(kSpace, kBase, 100, 3);
+  const auto b = RandomConfigs(kSpace, kBase, 100, 3);
+  ASSERT_EQ(a.size(), 100);
+  for (size_t i = 0; i < a.size(); ++i) {
+    EXPECT_EQ(a[i].kp, b[i].kp);
+    EXPECT_GE(a[i].kp, kSpace.kp.min);
+    EXPECT_LE(a[i].kp, kSpace.kp.max);
+    EXPECT_GE(a[i].kd, kSpace.kd.min);
+    EXPECT_LE(a[i].kd, kSpace.kd.max);
+  }
+}
+
+TEST(Search, EvaluateRunsEachConfigOnceInOrder) {
+  BowlScenario scenario;
+  const auto configs = RandomConfigs(kSpace, kBase, 200, 1);
+  const auto candidates = Evaluate(scenario, {}, configs, 4);
+  EXPECT_EQ(scenario.runs, 200);
+  const auto serial = Evaluate(scenario, {}, configs, 1);
+  ASSERT_EQ(candidates.size(), 200);
+  for (size_t i = 0; i < configs.size(); ++i) {
+    EXPECT_EQ(candidates[i].config.kp, configs[i].kp);
+    EXPECT_EQ(candidates[i].cost, serial[i].cost);
+  }
+}
+
+TEST(Search, SortByCostPutsTheBestFirst) {
+  BowlScenario scenario;
+  auto candidates =
+      Evaluate(scenario, {}, GridConfigs(kSpace, kBase, 9), 2);
+  SortByCost(candidates);
+  for (size_t i = 1; i < candidates.size(); ++i) {
+    EXPECT_LE(candidates[i - 1].cost, candidates[i].cost);
+  }
+  // The grid point nearest kp = 4, at half-decade spacing.
+  EXPECT_FLOAT_EQ(candidates[0].config.kp, std::sqrt(10.0f));
+}
+
+TEST(Search, EvolutionFindsTheMinimum) {
+  BowlScenario scenario;
+  auto candidates = *EvolutionSearch(scenario, {}, kSpace, kBase,
+                                     {.generations = 30}, 2);
+  EXPECT_EQ(candidates.size(), 30 * 64);
+  SortByCost(candidates);
+  EXPECT_NEAR(candidates[0].config.kp, 4, 0.1);
+  EXPECT_NEAR(candidates[0].config.ki, 0.02, 0.001);
+  EXPECT_NEAR(candidates[0].config.kd, 0.5, 0.02);
+}
+
+TEST(Search, EvolutionRejectsAnEmptyPopulation) {
+  BowlScenario scenario;
+  EXPECT_FALSE(EvolutionSearch(scenario, {}, kSpace, kBase,
+                               {.population = 0, .parents = 0}));
+}
+
+TEST(Search, CostUsesTheWeights) {
+  BowlScenario scenario;
+  const intpid::Config configs[] = {kBase};
+  const auto candidates =
+      Evaluate(scenario, {.ise = 0, .saturated_time = 2}, configs);
+  EXPECT_EQ(candidates[0].cost, 200);
+}
+
+// The hand-tuned gains from the intpid test are a fair starting point, so a
+// short search should at least match them.
+TEST(Search, EvolutionImprovesOnTheWaterHeaterGains) {
+  WaterHeaterScenario scenario;
+  const intpid::Config base = scenario.base_config();
+  const intpid::Config configs[] = {base};
+  const double base_cost = Evaluate(scenario, {}, configs)[0].cost;
+  ASSERT_TRUE(std::isfinite(base_cost));
+
+  auto candidates = *EvolutionSearch(
+      scenario, {},
+      {.kp = {0.15, 1500}, .ki = {2e-5, 0.2}, .kd = {0.75, 7500}}, base,
+      {.generations = 4, .population = 32, .parents = 8});
+  SortByCost(candidates);
+  EXPECT_LT(candidates[0].cost, base_cost);
+}
+
+TEST(Search, MotorScenarioTracksWithTheBenchGains) {
+  MotorSpeedScenario scenario;
+  const Metrics m = scenario.Run(scenario.base_config());
+  EXPECT_DOUBLE_EQ(m.duration, 3000);
+  EXPECT_GT(m.ise, 0);
+  // Each step settles well within its second.
+  EXPECT_LT(m.settling_time, 3 * 500);
+}
+
+}  // namespace
+}  // namespace tune
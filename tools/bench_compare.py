@@ -0,0 +1,75 @@
+# /usr/bin/env python3
+
+import json
+import sys
+
+# Compares two Google Benchmark JSON result files, e.g. from two commits:
+#
+#   pio test -e native_bench -a "--benchmark_out=base.json" \
+#     -a "--benchmark_out_format=json"
+#   ... check out the other commit and write new.json ...
+#   python3 tools/bench_compare.py base.json new.json
+#
+# With a single file, prints the results as a table. With --threshold=PCT,
+# exits non-zero if any benchmark got slower by more than PCT percent.
+
+
+def read_results(file_name):
+    with open(file_name, 'r') as f:
+        data = json.load(f)
+    results = {}
+    for bm in data['benchmarks']:
+        if bm.get('run_type', 'iteration') != 'iteration':
+            continue
+        results[bm['name']] = (bm['cpu_time'], bm.get('cycles_per_op'))
+    return results
+
+
+def format_cycles(cycles):
+    return '' if cycles is None else '%.1f' % cycles
+
+
+def show_one(results):
+    print('%-50s %12s %10s' % ('Benchmark', 'CPU ns', 'cycles'))
+    for name, (ns, cycles) in results.items():
+        print('%-50s %12.2f %10s' % (name, ns, format_cycles(cycles)))
+
+
+def show_diff(base, new, threshold):
+    print('%-50s %12s %12s %8s' % ('Benchmark', 'base ns', 'new ns', 'delta'))
+    regressions = []
+    for name, (new_ns, _) in new.items():
+        if name not in base:
+            print('%-50s %12s %12.2f %8s' % (name, '-', new_ns, 'new'))
+            continue
+        base_ns = base[name][0]
+        delta = 100.0 * (new_ns - base_ns) / base_ns
+        print('%-50s %12.2f %12.2f %+7.1f%%' % (name, base_ns, new_ns, delta))
+        if threshold is not None and delta > threshold:
+            regressions.append(name)
+    return regressions
+
+
+def main():
+    threshold = None
+    files = []
+    for arg in sys.argv[1:]:
+        if arg.startswith('--threshold='):
+            threshold = float(arg[len('--threshold='):])
+        else:
+            files.append(arg)
+    if len(files) not in (1, 2):
+        print('Usage: bench_compare.py [--threshold=PCT] <base.json> [new.json]')
+        sys.exit(1)
+    if len(files) == 1:
+        show_one(read_results(files[0]))
+        return
+    regressions = show_diff(read_results(files[0]), read_results(files[1]),
+                            threshold)
+    if regressions:
+        print('Regressions over %.1f%%: %s' % (threshold, ', '.join(regressions)))
+        sys.exit(2)
+
+
+if __name__ == '__main__':
+    main()
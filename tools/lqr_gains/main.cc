@@ -0,0 +1,179 @@
+// Designs the balancing robot's LQR state feedback and writes the gains as a
+// header of constexpr intpid::StateFeedbackConfig, for intpid::StateFeedback.
+// The model is lib/sim's BalancingRobot linearized about upright (see
+// sim::BalancingRobot::Linearize), sampled at the control period, and the
+// gains come from the discrete Riccati equation (lib/tune/src/lqr.h).
+//
+// Build with `pio run -e lqr_gains`, then for example:
+//
+//   lqr_gains --out include/balance_gains.h
+//   lqr_gains --q 100,0.1,0.05,0.05 --r 2 --mass 0.6
+//
+// The state is pitch (deg), pitch rate (deg/s), wheel angle (deg) and wheel
+// rate (deg/s), the wheel being the mean of both relative to the chassis; the
+// input is the motor effort in duty. The weights are in those units.
+//
+// Options:
+//   --dt S               Control period in seconds (default 0.001).
+//   --q W,W,W,W          State weights, the diagonal of Q (default
+//                        100,0.1,0.01,0.05).
+//   --r W                Effort weight, R (default 1).
+//   --limit L            Effort limit, as output_min = -L and output_max = L
+//                        (default 255).
+//   --name NAME          The constant's name (default kBalanceGains).
+//   --out PATH           Writes the header there instead of to stdout.
+//   --mass KG            Chassis mass.
+//   --com-height M       Height of the chassis' center of mass over the axle.
+//   --wheel-radius M     Wheel radius.
+//   --supply V           Motor supply voltage.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "balancing_robot.h"
+#include "lqr.h"
+
+namespace {
+
+constexpr int kStates = 4;
+constexpr const char* kStateNames[kStates] = {
+    "pitch (deg)", "pitch rate (deg/s)", "wheel angle (deg)",
+    "wheel rate (deg/s)"};
+
+int Usage() {
+  fprintf(stderr,
+          "Usage: lqr_gains [--dt S] [--q W,W,W,W] [--r W] [--limit L] "
+          "[--name NAME] [--out PATH] [--mass KG] [--com-height M] "
+          "[--wheel-radius M] [--supply V]\n");
+  return 1;
+}
+
+bool ParseList(const std::string& text, std::vector<double>& values) {
+  values.clear();
+  size_t start = 0;
+  while (start < text.size()) {
+    size_t end = text.find(',', start);
+    if (end == std::string::npos) end = text.size();
+    const double value = std::strtod(text.c_str() + start, nullptr);
+    if (!(value >= 0)) return false;
+    values.push_back(value);
+    start = end + 1;
+  }
+  return values.size() == kStates;
+}
+
+bool ParsePositive(const std::string& text, double& value) {
+  value = std::strtod(text.c_str(), nullptr);
+  return value > 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  sim::RobotParams params;
+  // The defaults keep the pitch gains low enough that gyro noise through
+  // the complementary filter does not make the effort chatter.
+  double dt = .001, r = 1, limit = 255;
+  std::vector<double> q = {100, .1, .01, .05};
+  std::string name = "kBalanceGains", out;
+  std::string command = "lqr_gains";
+  for (int i = 1; i < argc; i += 2) {
+    if (i + 1 >= argc) return Usage();
+    const std::string_view flag = argv[i];
+    const std::string value = argv[i + 1];
+    command += " " + std::string(flag) + " " + value;
+    bool ok = true;
+    if (flag == "--dt") {
+      ok = ParsePositive(value, dt);
+    } else if (flag == "--q") {
+      ok = ParseList(value, q);
+    } else if (flag == "--r") {
+      ok = ParsePositive(value, r);
+    } else if (flag == "--limit") {
+      ok = ParsePositive(value, limit);
+    } else if (flag == "--name") {
+      name = value;
+    } else if (flag == "--out") {
+      out = value;
+    } else if (flag == "--mass") {
+      ok = ParsePositive(value, params.body.mass_kg);
+    } else if (flag == "--com-height") {
+      ok = ParsePositive(value, params.body.com_height_m);
+    } else if (flag == "--wheel-radius") {
+      ok = ParsePositive(value, params.body.wheel_radius_m);
+    } else if (flag == "--supply") {
+      ok = ParsePositive(value, params.motor.supply_volts);
+    } else {
+      ok = false;
+    }
+    if (!ok) return Usage();
+  }
+
+  const sim::LinearModel linear = sim::BalancingRobot::Linearize(params);
+  tune::Matrix a(kStates, kStates), b(kStates, 1);
+  for (int i = 0; i < kStates; ++i) {
+    for (int j = 0; j < kStates; ++j) a(i, j) = linear.a[i][j];
+    b(i, 0) = linear.b[i];
+  }
+  const tune::DiscreteModel model = tune::Discretize(a, b, dt);
+  const auto k = tune::LqrGain(model, tune::Matrix::Diagonal(q), {{r}});
+  if (!k) {
+    fprintf(stderr, "%s\n", k.error().c_str());
+    return 1;
+  }
+
+  // The slowest closed-loop mode decays by this factor every update.
+  const double radius = tune::SpectralRadius(tune::ClosedLoop(model, *k));
+  fprintf(stderr, "K =");
+  for (int j = 0; j < kStates; ++j) fprintf(stderr, " %.6g", (*k)(0, j));
+  fprintf(stderr, "\nslowest closed-loop time constant %.3g s\n",
+          -dt / std::log(radius));
+
+  FILE* file = out.empty() ? stdout : fopen(out.c_str(), "w");
+  if (file == nullptr) {
+    fprintf(stderr, "%s: could not write\n", out.c_str());
+    return 1;
+  }
+  fprintf(file,
+          "// Generated by tools/lqr_gains; do not edit. Regenerate with\n"
+          "//\n"
+          "//   %s\n"
+          "//\n"
+          "// LQR state feedback for the balancing robot, updated every %g s\n"
+          "// with Q = diag(%g, %g, %g, %g) and R = %g: effort = -K x, where\n"
+          "// x is\n",
+          command.c_str(), dt, q[0], q[1], q[2], q[3], r);
+  for (int j = 0; j < kStates; ++j) {
+    fprintf(file, "//   %s\n", kStateNames[j]);
+  }
+  fprintf(file,
+          "\n"
+          "#ifndef BALANCE_GAINS_H\n"
+          "#define BALANCE_GAINS_H\n"
+          "\n"
+          "#include \"state_feedback.h\"\n"
+          "\n"
+          "constexpr intpid::StateFeedbackConfig<%d> %s = {\n"
+          "    .gains = {{{",
+          kStates, name.c_str());
+  for (int j = 0; j < kStates; ++j) {
+    fprintf(file, "%s%.9g", j == 0 ? "" : ", ", (*k)(0, j));
+  }
+  fprintf(file,
+          "}}},\n"
+          "    .output_min = %g,\n"
+          "    .output_max = %g,\n"
+          "};\n"
+          "\n"
+          "#endif  // BALANCE_GAINS_H\n",
+          -limit, limit);
+  if (file != stdout && fclose(file) != 0) {
+    fprintf(stderr, "%s: could not write\n", out.c_str());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,188 @@
+// Runs the fixed point Pid against its double precision reference over many
+// random plants and configs, and reports how far they part. See
+// lib/tune/src/differential.h.
+//
+// Build with `pio run -e pid_diff`, then for example:
+//
+//   pid_diff                                      # 1000 cases, full range
+//   pid_diff --cases 10000 --scale 1:1000 --dt 1,0.01
+//   pid_diff --top 20 --csv out.csv
+//
+// Options:
+//   --cases N          Random cases to run (default 1000).
+//   --seed N           The first case's seed; the rest follow (default 1).
+//   --scale MIN:MAX    Setpoint magnitudes (default 0.1:1000).
+//   --limit MIN:MAX    Output limit magnitudes (default 1:10000).
+//   --dt DT,...        Update periods (default 1,0.01,0.001).
+//   --top N            Worst cases to print (default 10).
+//   --csv PATH         Writes every case's description and divergences.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "differential.h"
+
+namespace {
+
+int Usage() {
+  fprintf(stderr,
+          "Usage: pid_diff [--cases N] [--seed N] [--scale MIN:MAX] "
+          "[--limit MIN:MAX] [--dt DT,...] [--top N] [--csv PATH]\n");
+  return 1;
+}
+
+bool ParseRange(const std::string& text, double& min, double& max) {
+  const size_t colon = text.find(':');
+  if (colon == std::string::npos) return false;
+  min = std::strtod(text.c_str(), nullptr);
+  max = std::strtod(text.c_str() + colon + 1, nullptr);
+  return min > 0 && max >= min;
+}
+
+bool ParseList(const std::string& text, std::vector<double>& values) {
+  values.clear();
+  size_t start = 0;
+  while (start < text.size()) {
+    size_t end = text.find(',', start);
+    if (end == std::string::npos) end = text.size();
+    const double value = std::strtod(text.c_str() + start, nullptr);
+    if (!(value > 0)) return false;
+    values.push_back(value);
+    start = end + 1;
+  }
+  return !values.empty();
+}
+
+struct Result {
+  tune::DifferentialCase c;
+  tune::DifferentialReport report;
+
+  // The tracking divergence in proportion to the setpoint scale, which is
+  // what the cases are ranked by.
+  double relative_tracking() const {
+    return report.rms_tracking_divergence / c.scale;
+  }
+};
+
+// The q-quantile of values, which must be sorted.
+double Quantile(const std::vector<double>& values, double q) {
+  if (values.empty()) return 0;
+  return values[static_cast<size_t>(q * (values.size() - 1))];
+}
+
+void PrintQuantiles(const char* name, std::vector<double> values) {
+  std::sort(values.begin(), values.end());
+  printf("%-28s %10.3g %10.3g %10.3g %10.3g %10.3g\n", name,
+         Quantile(values, .5), Quantile(values, .9), Quantile(values, .99),
+         Quantile(values, .999), Quantile(values, 1));
+}
+
+bool WriteCsv(const std::string& path, const std::vector<Result>& results) {
+  FILE* out = fopen(path.c_str(), "w");
+  if (out == nullptr) return false;
+  fprintf(out,
+          "seed,max_output,rms_output,output_range,max_tracking,rms_tracking,"
+          "scale,limit_cycle_swing,limit_cycle,case\n");
+  for (const Result& r : results) {
+    const tune::DifferentialReport& d = r.report;
+    fprintf(out, "%u,%g,%g,%g,%g,%g,%g,%g,%d,\"%s\"\n", r.c.seed,
+            d.max_output_divergence, d.rms_output_divergence, d.output_range,
+            d.max_tracking_divergence, d.rms_tracking_divergence, r.c.scale,
+            d.limit_cycle_swing, d.limit_cycle,
+            tune::Describe(r.c).c_str());
+  }
+  return fclose(out) == 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  tune::CaseRanges ranges;
+  std::string csv;
+  int cases = 1000, top = 10;
+  uint32_t seed = 1;
+  for (int i = 1; i < argc; i += 2) {
+    if (i + 1 >= argc) return Usage();
+    const std::string_view flag = argv[i];
+    const std::string value = argv[i + 1];
+    bool ok = true;
+    if (flag == "--cases") {
+      cases = std::atoi(value.c_str());
+    } else if (flag == "--seed") {
+      seed = std::strtoul(value.c_str(), nullptr, 10);
+    } else if (flag == "--scale") {
+      ok = ParseRange(value, ranges.min_scale, ranges.max_scale);
+    } else if (flag == "--limit") {
+      ok = ParseRange(value, ranges.min_limit, ranges.max_limit);
+    } else if (flag == "--dt") {
+      ok = ParseList(value, ranges.periods);
+    } else if (flag == "--top") {
+      top = std::atoi(value.c_str());
+    } else if (flag == "--csv") {
+      csv = value;
+    } else {
+      ok = false;
+    }
+    if (!ok) return Usage();
+  }
+
+  std::vector<Result> results;
+  results.reserve(cases);
+  for (int i = 0; i < cases; ++i) {
+    tune::DifferentialCase c = tune::RandomDifferentialCase(seed + i, ranges);
+    const tune::DifferentialReport report = tune::RunDifferential(c);
+    results.push_back({std::move(c), report});
+  }
+
+  std::vector<double> max_output, rms_output, max_tracking, rms_tracking;
+  int limit_cycles = 0;
+  for (const Result& r : results) {
+    max_output.push_back(r.report.max_output_divergence /
+                         r.report.output_range);
+    rms_output.push_back(r.report.rms_output_divergence /
+                         r.report.output_range);
+    max_tracking.push_back(r.report.max_tracking_divergence / r.c.scale);
+    rms_tracking.push_back(r.relative_tracking());
+    limit_cycles += r.report.limit_cycle;
+  }
+  printf("%d cases, seeds %u to %u\n\n", cases, seed, seed + cases - 1);
+  printf("%-28s %10s %10s %10s %10s %10s\n", "divergence", "p50", "p90", "p99",
+         "p99.9", "max");
+  PrintQuantiles("output / output range", max_output);
+  PrintQuantiles("  rms", rms_output);
+  PrintQuantiles("tracking / setpoint scale", max_tracking);
+  PrintQuantiles("  rms", rms_tracking);
+  printf("\nlimit cycles: %d (%.2f%%)\n", limit_cycles,
+         cases > 0 ? 100.0 * limit_cycles / cases : 0);
+
+  std::sort(results.begin(), results.end(),
+            [](const Result& a, const Result& b) {
+              return a.relative_tracking() > b.relative_tracking();
+            });
+  printf("\nworst:\n");
+  for (int i = 0; i < top && i < static_cast<int>(results.size()); ++i) {
+    const Result& r = results[i];
+    printf("rms tracking %-10.3g swing %-10.3g %s\n    %s\n",
+           r.relative_tracking(), r.report.limit_cycle_swing,
+           r.report.limit_cycle ? "LIMIT CYCLE" : "",
+           tune::Describe(r.c).c_str());
+  }
+
+  const intpid::Config config = {
+      .kp = 2, .ki = .5, .kd = 1, .output_min = -100, .output_max = 100};
+  const tune::UpdateCost cost = tune::MeasureUpdateCost(config, 1'000'000);
+  printf("\nUpdate cost: fixed %.1f cycles (%.1f ns), double %.1f cycles "
+         "(%.1f ns)\n",
+         cost.fixed_cycles, cost.fixed_ns, cost.reference_cycles,
+         cost.reference_ns);
+
+  if (!csv.empty() && !WriteCsv(csv, results)) {
+    fprintf(stderr, "%s: could not write\n", csv.c_str());
+    return 1;
+  }
+  return 0;
+}
@@ -1,6 +1,7 @@
 # /usr/bin/env python3
 
 import matplotlib.pyplot as plt
+import struct
 import sys
 
 # Function to read CSV from a file.
@@ -14,6 +15,94 @@ def read_csv(file_name):
             data.append(line.strip().split(','))
     return data
 
+# Functions to read a binary telemetry log (see
+# lib/telemetry/src/log_format.h). Returns the log's ticks per second, a
+# {channel id: name} dictionary and a list of (timestamp, channel id, value).
+
+
+def read_varint(buf, pos):
+    result = 0
+    shift = 0
+    while True:
+        byte = buf[pos]
+        pos += 1
+        result |= (byte & 0x7f) << shift
+        if byte & 0x80 == 0:
+            return result, pos
+        shift += 7
+
+
+def fletcher16(buf):
+    a = 0
+    b = 0
+    for byte in buf:
+        a = (a + byte) % 255
+        b = (b + a) % 255
+    return (b << 8) | a
+
+
+def read_tlog(file_name):
+    with open(file_name, 'rb') as f:
+        buf = f.read()
+    if buf[0:4] != b'TLOG' or buf[4] != 1:
+        raise ValueError('%s is not a version 1 telemetry log' % file_name)
+    pos = 5
+    ticks_per_second, pos = read_varint(buf, pos)
+    num_channels, pos = read_varint(buf, pos)
+    channels = {}
+    for _ in range(num_channels):
+        channel, pos = read_varint(buf, pos)
+        length, pos = read_varint(buf, pos)
+        channels[channel] = buf[pos:pos + length].decode()
+        pos += length
+
+    records = []
+    epoch = 0
+    last_base = 0
+    while pos + 10 <= len(buf):
+        if buf[pos] != 0xa5 or buf[pos + 1] != 0x5a:
+            pos += 1
+            continue
+        payload_size, base = struct.unpack_from('<HI', buf, pos + 2)
+        end = pos + 8 + payload_size
+        if end + 2 > len(buf) or fletcher16(buf[pos + 2:end]) != \
+                struct.unpack_from('<H', buf, end)[0]:
+            pos += 1
+            continue
+        if base < last_base:
+            epoch += 1 << 32
+        last_base = base
+        timestamp = epoch + base
+        pos += 8
+        while pos < end:
+            channel, pos = read_varint(buf, pos)
+            delta, pos = read_varint(buf, pos)
+            raw, = struct.unpack_from('<i', buf, pos)
+            pos += 4
+            timestamp += delta
+            records.append((timestamp, channel, raw / 65536.0))
+        pos = end + 2
+    return ticks_per_second, channels, records
+
+# Converts the PID channels of a telemetry log into the same rows as the CSV
+# files: time, setpoint, measurement, output, p, i, d.
+
+
+def tlog_to_rows(ticks_per_second, channels, records):
+    columns = ['setpoint', 'measurement', 'output', 'p', 'i', 'd']
+    index = {channel: columns.index(name)
+             for channel, name in channels.items() if name in columns}
+    rows = []
+    row = None
+    for timestamp, channel, value in records:
+        if channel not in index:
+            continue
+        if row is None or row[0] != timestamp:
+            row = [timestamp] + [0.0] * len(columns)
+            rows.append(row)
+        row[1 + index[channel]] = value
+    return rows
+
 # Function to recast CSV data into appropriate numeric types.
 
 
@@ -67,9 +156,12 @@ def show_graph(data):
 
 def main():
     if len(sys.argv) < 2:
-        print("Usage: pid_plotter.py <file.csv>")
+        print("Usage: pid_plotter.py <file.csv|file.tlog>")
         sys.exit(1)
-    data = read_csv(sys.argv[1])
+    if sys.argv[1].endswith('.tlog'):
+        data = tlog_to_rows(*read_tlog(sys.argv[1]))
+    else:
+        data = read_csv(sys.argv[1])
     data = recast_csv(data)
     show_graph(data)
 
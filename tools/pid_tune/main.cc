@@ -0,0 +1,224 @@
+// Searches for PID gains by simulating a closed-loop scenario once per
+// candidate, on every core. See lib/tune/src/search.h.
+//
+// Build with `pio run -e pid_tune`, then for example:
+//
+//   pid_tune water_heater                         # evolve around the base
+//   pid_tune motor_speed --search grid --budget 1000 --kd 0:0
+//   pid_tune water_heater --weights ise=1,overshoot=1000 --csv out.csv
+//
+// Options:
+//   --search grid|random|evolve  Search strategy (default evolve).
+//   --budget N                   Simulations to run (default 2000).
+//   --threads N                  Worker threads (default: every core).
+//   --kp, --ki, --kd MIN:MAX     Gain ranges. By default each gain is searched
+//                                from 1/100 to 100 times its base value, and
+//                                a gain that is 0 in the base stays 0.
+//   --weights NAME=W,...         Cost weights for ise, iae, overshoot,
+//                                settling_time and saturated_time (default
+//                                ise=1).
+//   --seed N                     Seed for random and evolve.
+//   --top N                      Configs to print (default 5).
+//   --csv PATH                   Writes every candidate's gains and metrics.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "metrics.h"
+#include "scenario.h"
+#include "search.h"
+
+namespace {
+
+int Usage() {
+  fprintf(stderr,
+          "Usage: pid_tune <water_heater|motor_speed> [--search "
+          "grid|random|evolve] [--budget N] [--threads N] [--kp MIN:MAX] "
+          "[--ki MIN:MAX] [--kd MIN:MAX] [--weights NAME=W,...] [--seed N] "
+          "[--top N] [--csv PATH]\n");
+  return 1;
+}
+
+bool ParseRange(const std::string& text, tune::GainRange& range) {
+  const size_t colon = text.find(':');
+  if (colon == std::string::npos) return false;
+  range.min = std::strtof(text.c_str(), nullptr);
+  range.max = std::strtof(text.c_str() + colon + 1, nullptr);
+  return true;
+}
+
+bool ParseWeights(const std::string& text, tune::CostWeights& weights) {
+  weights = {.ise = 0};
+  size_t start = 0;
+  while (start < text.size()) {
+    size_t end = text.find(',', start);
+    if (end == std::string::npos) end = text.size();
+    const std::string item = text.substr(start, end - start);
+    const size_t equals = item.find('=');
+    if (equals == std::string::npos) return false;
+    const std::string name = item.substr(0, equals);
+    const double weight = std::strtod(item.c_str() + equals + 1, nullptr);
+    if (name == "ise") {
+      weights.ise = weight;
+    } else if (name == "iae") {
+      weights.iae = weight;
+    } else if (name == "overshoot") {
+      weights.overshoot = weight;
+    } else if (name == "settling_time") {
+      weights.settling_time = weight;
+    } else if (name == "saturated_time") {
+      weights.saturated_time = weight;
+    } else {
+      return false;
+    }
+    start = end + 1;
+  }
+  return true;
+}
+
+tune::GainRange DefaultRange(float base) {
+  return {base / 100, base * 100};
+}
+
+void PrintConfig(const tune::Candidate& c) {
+  printf(
+      "cost %-12g {.kp = %g, .ki = %g, .kd = %g, .output_min = %g, "
+      ".output_max = %g}\n",
+      c.cost, c.config.kp, c.config.ki, c.config.kd, c.config.output_min,
+      c.config.output_max);
+  printf(
+      "    ise %g  iae %g  overshoot %g  settling_time %g  "
+      "saturated_time %g\n",
+      c.metrics.ise, c.metrics.iae, c.metrics.overshoot,
+      c.metrics.settling_time, c.metrics.saturated_time);
+}
+
+bool WriteCsv(const std::string& path,
+              const std::vector<tune::Candidate>& candidates) {
+  FILE* out = fopen(path.c_str(), "w");
+  if (out == nullptr) return false;
+  fprintf(out,
+          "kp,ki,kd,cost,ise,iae,overshoot,settling_time,saturated_time\n");
+  for (const tune::Candidate& c : candidates) {
+    fprintf(out, "%g,%g,%g,%g,%g,%g,%g,%g,%g\n", c.config.kp, c.config.ki,
+            c.config.kd, c.cost, c.metrics.ise, c.metrics.iae,
+            c.metrics.overshoot, c.metrics.settling_time,
+            c.metrics.saturated_time);
+  }
+  return fclose(out) == 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) return Usage();
+  std::unique_ptr<tune::Scenario> scenario;
+  const std::string_view name = argv[1];
+  if (name == "water_heater") {
+    scenario = std::make_unique<tune::WaterHeaterScenario>();
+  } else if (name == "motor_speed") {
+    scenario = std::make_unique<tune::MotorSpeedScenario>();
+  } else {
+    return Usage();
+  }
+
+  const intpid::Config base = scenario->base_config();
+  tune::SearchSpace space = {.kp = DefaultRange(base.kp),
+                             .ki = DefaultRange(base.ki),
+                             .kd = DefaultRange(base.kd)};
+  tune::CostWeights weights;
+  std::string search = "evolve", csv;
+  int budget = 2000, threads = 0, top = 5;
+  uint32_t seed = 1;
+  for (int i = 2; i < argc; i += 2) {
+    if (i + 1 >= argc) return Usage();
+    const std::string_view flag = argv[i];
+    const std::string value = argv[i + 1];
+    bool ok = true;
+    if (flag == "--search") {
+      search = value;
+    } else if (flag == "--budget") {
+      budget = std::atoi(value.c_str());
+    } else if (flag == "--threads") {
+      threads = std::atoi(value.c_str());
+    } else if (flag == "--kp") {
+      ok = ParseRange(value, space.kp);
+    } else if (flag == "--ki") {
+      ok = ParseRange(value, space.ki);
+    } else if (flag == "--kd") {
+      ok = ParseRange(value, space.kd);
+    } else if (flag == "--weights") {
+      ok = ParseWeights(value, weights);
+    } else if (flag == "--seed") {
+      seed = std::strtoul(value.c_str(), nullptr, 10);
+    } else if (flag == "--top") {
+      top = std::atoi(value.c_str());
+    } else if (flag == "--csv") {
+      csv = value;
+    } else {
+      ok = false;
+    }
+    if (!ok) return Usage();
+  }
+  if (auto valid = tune::Validate(space); !valid) {
+    fprintf(stderr, "%s\n", valid.error().c_str());
+    return 1;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<tune::Candidate> candidates;
+  if (search == "grid") {
+    const int free_axes = (space.kp.min != space.kp.max) +
+                          (space.ki.min != space.ki.max) +
+                          (space.kd.min != space.kd.max);
+    const int points =
+        free_axes == 0 ? 1 : std::floor(std::pow(budget, 1.0 / free_axes));
+    candidates = tune::Evaluate(*scenario, weights,
+                                tune::GridConfigs(space, base, points),
+                                threads);
+  } else if (search == "random") {
+    candidates = tune::Evaluate(*scenario, weights,
+                                tune::RandomConfigs(space, base, budget, seed),
+                                threads);
+  } else if (search == "evolve") {
+    tune::EvolutionOptions options{.seed = seed};
+    options.generations = std::max(1, budget / options.population);
+    auto evolved = tune::EvolutionSearch(*scenario, weights, space, base,
+                                         options, threads);
+    if (!evolved) {
+      fprintf(stderr, "%s\n", evolved.error().c_str());
+      return 1;
+    }
+    candidates = std::move(*evolved);
+  } else {
+    return Usage();
+  }
+  const double seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+  tune::SortByCost(candidates);
+
+  printf("%s: %zu simulations in %.2f s (%.0f/s)\n\n",
+         std::string(scenario->name()).c_str(), candidates.size(), seconds,
+         candidates.size() / seconds);
+  printf("base:\n");
+  const intpid::Config base_config[] = {base};
+  PrintConfig(tune::Evaluate(*scenario, weights, base_config, 1)[0]);
+  printf("\nbest:\n");
+  for (int i = 0; i < top && i < static_cast<int>(candidates.size()); ++i) {
+    PrintConfig(candidates[i]);
+  }
+
+  if (!csv.empty() && !WriteCsv(csv, candidates)) {
+    fprintf(stderr, "%s: could not write\n", csv.c_str());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,86 @@
+# /usr/bin/env python3
+
+import subprocess
+import sys
+
+# Reports the static RAM the firmware needs: the size of .data and .bss, the
+# largest variables in them, and the task stacks among them. With every task
+# on a static stack (see src/main.cpp) this is all the RAM our code uses
+# outside the heap; the heap at run time is in src/main.cpp's MEMORY_REPORT.
+#
+#   pio run -e esp32-c6-devkitc-1
+#   python3 tools/ram_report.py .pio/build/esp32-c6-devkitc-1/firmware.elf
+#
+# Options:
+#   --nm=PATH     the nm to run (default riscv32-esp-elf-nm, from the
+#                 PlatformIO toolchain; put it on PATH or pass its path)
+#   --top=N       list the N largest variables (default 20)
+#   --budget=B    exit non-zero if .data and .bss together exceed B bytes
+
+# nm symbol types: d/D initialized data, b/B zero-initialized data. Read-only
+# data (r/R) lives in flash on the ESP32 and is not counted.
+SECTIONS = {'d': '.data', 'b': '.bss'}
+
+
+def read_symbols(nm, elf):
+    output = subprocess.run([nm, '-S', '--size-sort', '-C', elf],
+                            check=True, capture_output=True,
+                            text=True).stdout
+    symbols = []
+    for line in output.splitlines():
+        fields = line.split(maxsplit=3)
+        if len(fields) < 4:
+            continue
+        section = SECTIONS.get(fields[2].lower())
+        if section is None:
+            continue
+        symbols.append((int(fields[1], 16), section, fields[3]))
+    symbols.sort(reverse=True)
+    return symbols
+
+
+def main():
+    nm = 'riscv32-esp-elf-nm'
+    top = 20
+    budget = None
+    files = []
+    for arg in sys.argv[1:]:
+        if arg.startswith('--nm='):
+            nm = arg[len('--nm='):]
+        elif arg.startswith('--top='):
+            top = int(arg[len('--top='):])
+        elif arg.startswith('--budget='):
+            budget = int(arg[len('--budget='):])
+        else:
+            files.append(arg)
+    if len(files) != 1:
+        print('usage: ram_report.py [--nm=PATH] [--top=N] [--budget=BYTES] '
+              'firmware.elf', file=sys.stderr)
+        return 2
+
+    symbols = read_symbols(nm, files[0])
+    totals = {name: 0 for name in SECTIONS.values()}
+    for size, section, _ in symbols:
+        totals[section] += size
+    stacks = [(size, name) for size, _, name in symbols
+              if name.endswith('_task_stack')]
+
+    print('%-50s %8s %6s' % ('Variable', 'bytes', 'in'))
+    for size, section, name in symbols[:top]:
+        print('%-50s %8d %6s' % (name[:50], size, section))
+    print()
+    for name, size in totals.items():
+        print('%-8s %8d' % (name, size))
+    print('%-8s %8d' % ('total', sum(totals.values())))
+    print('%-8s %8d  (%s)' % ('stacks', sum(s for s, _ in stacks),
+                              ', '.join('%s %d' % (n, s) for s, n in stacks)))
+
+    if budget is not None and sum(totals.values()) > budget:
+        print('static RAM is over the budget of %d bytes' % budget,
+              file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
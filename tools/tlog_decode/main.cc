@@ -0,0 +1,75 @@
+// Converts a binary telemetry log (see lib/telemetry/src/log_format.h) to CSV
+// or to per-channel column files.
+//
+// Build with `pio run -e tlog_decode`, then:
+//
+//   tlog_decode capture.tlog                  # long CSV to stdout
+//   tlog_decode capture.tlog --wide out.csv   # one column per channel
+//   tlog_decode capture.tlog --columns out    # out.<channel>.{t,v}
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "log_export.h"
+#include "log_reader.h"
+
+namespace {
+
+int Usage() {
+  fprintf(stderr,
+          "Usage: tlog_decode <in.tlog> [--long <out.csv> | --wide <out.csv> "
+          "| --columns <prefix>]\n");
+  return 1;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc != 2 && argc != 4) return Usage();
+  const std::string mode = argc == 4 ? argv[2] : "--long";
+  const std::string out_path = argc == 4 ? argv[3] : "-";
+  if (mode != "--long" && mode != "--wide" && mode != "--columns") {
+    return Usage();
+  }
+
+  auto file = telemetry::MappedFile::Open(argv[1]);
+  if (!file) {
+    fprintf(stderr, "%s\n", file.error().c_str());
+    return 1;
+  }
+  auto reader = telemetry::LogReader::Parse(file->data());
+  if (!reader) {
+    fprintf(stderr, "%s: %s\n", argv[1], reader.error().c_str());
+    return 1;
+  }
+
+  if (mode == "--columns") {
+    if (auto result = telemetry::WriteColumns(*reader, out_path); !result) {
+      fprintf(stderr, "%s\n", result.error().c_str());
+      return 1;
+    }
+  } else {
+    FILE* out = out_path == "-" ? stdout : fopen(out_path.c_str(), "w");
+    if (out == nullptr) {
+      fprintf(stderr, "%s: %s\n", out_path.c_str(), strerror(errno));
+      return 1;
+    }
+    // Large buffers matter when exporting multi-gigabyte captures.
+    static char buffer[1 << 20];
+    setvbuf(out, buffer, _IOFBF, sizeof(buffer));
+    if (mode == "--wide") {
+      telemetry::WriteWideCsv(*reader, out);
+    } else {
+      telemetry::WriteLongCsv(*reader, out);
+    }
+    if (out != stdout) fclose(out);
+  }
+
+  if (reader->corrupt_frames() > 0) {
+    fprintf(stderr, "warning: skipped %zu corrupt frames\n",
+            reader->corrupt_frames());
+  }
+  return 0;
+}